@@ -0,0 +1,280 @@
+/*
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU Lesser General Public License as published by
+the Free Software Foundation, either version 3.0 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU Lesser General Public License for more details.
+
+You should have received a copy of the GNU Lesser General Public License
+along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#include "AS7DeviceIndex.h"
+
+#include <algorithm>
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+#include <system_error>
+
+#include "AS7DeviceResolver.h"
+#include "cmStringUtils.h"
+
+static const char* const index_header = "AS7DeviceIndex 1"; /**< Index file format identifier, bump it whenever the format changes */
+
+/**
+ * @brief Reads the value of an attribute from an xml start tag
+ * @param tag       : start tag, e.g. <device name="ATmega328P" architecture="AVR8">
+ * @param attribute : attribute name
+ * @return attribute value, empty if not found
+ */
+static std::string get_attribute(const std::string& tag, const std::string& attribute)
+{
+  const std::string pattern = " " + attribute + "=\"";
+  const std::size_t start = tag.find(pattern);
+  if (start == std::string::npos) {
+    return "";
+  }
+  const std::size_t value_start = start + pattern.size();
+  const std::size_t value_end = tag.find('"', value_start);
+  if (value_end == std::string::npos) {
+    return "";
+  }
+  return tag.substr(value_start, value_end - value_start);
+}
+
+/**
+ * @brief Extracts the start tag of the first element matching the given opening, starting from a given position
+ * @return start tag, empty if not found
+ */
+static std::string find_start_tag(const std::string& xml, const std::string& opening, std::size_t from = 0)
+{
+  const std::size_t start = xml.find(opening, from);
+  if (start == std::string::npos) {
+    return "";
+  }
+  const std::size_t end = xml.find('>', start);
+  if (end == std::string::npos) {
+    return "";
+  }
+  return xml.substr(start, end - start + 1);
+}
+
+/**
+ * @brief Splits an index line into its tab separated fields, empty fields included
+ */
+static std::vector<std::string> split_fields(const std::string& line)
+{
+  std::vector<std::string> out;
+  std::size_t start = 0;
+  std::size_t end = line.find('\t');
+  while (end != std::string::npos) {
+    out.push_back(line.substr(start, end - start));
+    start = end + 1;
+    end = line.find('\t', start);
+  }
+  out.push_back(line.substr(start));
+  return out;
+}
+
+static std::string read_file(const std::filesystem::path& path)
+{
+  std::ifstream file(path, std::ios::binary);
+  std::ostringstream content;
+  content << file.rdbuf();
+  return content.str();
+}
+
+std::string AS7DeviceIndex::Device::get_include_dir() const
+{
+  return "%24(PackRepoDir)\\atmel\\" + dfp_name + "\\" + version + "\\include\\";
+}
+
+std::string AS7DeviceIndex::Device::get_gcc_dev_dir() const
+{
+  return "%24(PackRepoDir)\\atmel\\" + dfp_name + "\\" + version + "\\gcc\\dev\\" + key;
+}
+
+std::string AS7DeviceIndex::compute_stamp(const std::string& pack_repo_dir)
+{
+  std::error_code ec;
+  const std::filesystem::path atmel_dir = std::filesystem::path(pack_repo_dir) / "atmel";
+  if (pack_repo_dir.empty() || !std::filesystem::is_directory(atmel_dir, ec)) {
+    return "";
+  }
+
+  std::vector<std::string> dfps;
+  for (const auto& entry : std::filesystem::directory_iterator(atmel_dir, ec)) {
+    if (!entry.is_directory(ec)) {
+      continue;
+    }
+    const auto time = std::filesystem::last_write_time(entry.path(), ec);
+    dfps.push_back(entry.path().filename().string() + ":" + std::to_string(time.time_since_epoch().count()));
+  }
+  std::sort(dfps.begin(), dfps.end());
+
+  std::string out = pack_repo_dir;
+  for (const std::string& dfp : dfps) {
+    out += "|" + dfp;
+  }
+  return out;
+}
+
+bool AS7DeviceIndex::parse_atdf(const std::string& atdf, Device& device)
+{
+  const std::string device_tag = find_start_tag(atdf, "<device ");
+  const std::string name = get_attribute(device_tag, "name");
+  if (name.empty()) {
+    return false;
+  }
+
+  device.name = name;
+  device.key = cmutils::strings::to_lowercase(name);
+  device.architecture = get_attribute(device_tag, "architecture");
+  device.family = get_attribute(device_tag, "family");
+
+  // Signature bytes are given by SIGNATURE0, SIGNATURE1, ... properties
+  device.signature.clear();
+  for (int i = 0;; i++) {
+    const std::string property = find_start_tag(atdf, "<property name=\"SIGNATURE" + std::to_string(i) + "\"");
+    std::string value = get_attribute(property, "value");
+    if (value.size() < 3 || value.compare(0, 2, "0x") != 0) {
+      break;
+    }
+    value = cmutils::strings::to_uppercase(value.substr(2));
+    if (value.size() < 2) {
+      value.insert(0, 1, '0');
+    }
+    device.signature += value;
+  }
+  if (!device.signature.empty()) {
+    device.signature.insert(0, "0x");
+  }
+  return true;
+}
+
+void AS7DeviceIndex::scan(const std::string& pack_repo_dir)
+{
+  stamp = compute_stamp(pack_repo_dir);
+  devices.clear();
+
+  std::error_code ec;
+  const std::filesystem::path atmel_dir = std::filesystem::path(pack_repo_dir) / "atmel";
+  if (pack_repo_dir.empty() || !std::filesystem::is_directory(atmel_dir, ec)) {
+    return;
+  }
+
+  std::vector<std::filesystem::path> dfps;
+  for (const auto& entry : std::filesystem::directory_iterator(atmel_dir, ec)) {
+    if (entry.is_directory(ec)) {
+      dfps.push_back(entry.path());
+    }
+  }
+  std::sort(dfps.begin(), dfps.end());
+
+  for (const std::filesystem::path& dfp : dfps) {
+    const std::string version = AS7DeviceResolver::get_max_packs_version(dfp.string());
+    if (version.empty()) {
+      continue;
+    }
+
+    const std::filesystem::path atdf_dir = dfp / version / "atdf";
+    for (const auto& entry : std::filesystem::directory_iterator(atdf_dir, ec)) {
+      if (cmutils::strings::to_lowercase(entry.path().extension().string()) != ".atdf") {
+        continue;
+      }
+      Device device;
+      if (parse_atdf(read_file(entry.path()), device)) {
+        device.dfp_name = dfp.filename().string();
+        device.version = version;
+        devices.push_back(std::move(device));
+      }
+    }
+  }
+
+  // A device described by several DFPs is resolved to the first one, in DFP names order
+  std::stable_sort(devices.begin(), devices.end(), [](const Device& a, const Device& b) { return a.key < b.key; });
+  devices.erase(std::unique(devices.begin(), devices.end(), [](const Device& a, const Device& b) { return a.key == b.key; }),
+                devices.end());
+}
+
+bool AS7DeviceIndex::load(const std::string& index_file, const std::string& expected_stamp)
+{
+  std::ifstream file(index_file);
+  std::string line;
+  if (!std::getline(file, line) || line != index_header) {
+    return false;
+  }
+  if (!std::getline(file, line) || line != expected_stamp) {
+    return false;
+  }
+
+  std::vector<Device> loaded;
+  while (std::getline(file, line)) {
+    const std::vector<std::string> fields = split_fields(line);
+    if (fields.size() != 7) {
+      return false;
+    }
+    Device device;
+    device.key = fields[0];
+    device.name = fields[1];
+    device.architecture = fields[2];
+    device.family = fields[3];
+    device.dfp_name = fields[4];
+    device.version = fields[5];
+    device.signature = fields[6];
+    loaded.push_back(std::move(device));
+  }
+
+  if (!std::is_sorted(loaded.begin(), loaded.end(), [](const Device& a, const Device& b) { return a.key < b.key; })) {
+    return false;
+  }
+  stamp = expected_stamp;
+  devices = std::move(loaded);
+  return true;
+}
+
+bool AS7DeviceIndex::save(const std::string& index_file) const
+{
+  std::ofstream file(index_file, std::ios::trunc);
+  if (!file) {
+    return false;
+  }
+
+  file << index_header << '\n' << stamp << '\n';
+  for (const Device& device : devices) {
+    file << device.key << '\t' << device.name << '\t' << device.architecture << '\t' << device.family << '\t'
+         << device.dfp_name << '\t' << device.version << '\t' << device.signature << '\n';
+  }
+  return static_cast<bool>(file);
+}
+
+bool AS7DeviceIndex::load_or_scan(const std::string& pack_repo_dir, const std::string& index_file)
+{
+  if (load(index_file, compute_stamp(pack_repo_dir))) {
+    return true;
+  }
+  scan(pack_repo_dir);
+  save(index_file);
+  return false;
+}
+
+const AS7DeviceIndex::Device* AS7DeviceIndex::find(const std::string& device_name) const
+{
+  const std::string key = cmutils::strings::to_lowercase(device_name);
+  auto found = std::lower_bound(devices.begin(), devices.end(), key,
+                                [](const Device& device, const std::string& value) { return device.key < value; });
+  if (found == devices.end() || found->key != key) {
+    return nullptr;
+  }
+  return &(*found);
+}
+
+std::size_t AS7DeviceIndex::size() const
+{
+  return devices.size();
+}
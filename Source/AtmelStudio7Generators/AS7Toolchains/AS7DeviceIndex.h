@@ -0,0 +1,120 @@
+/*
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU Lesser General Public License as published by
+the Free Software Foundation, either version 3.0 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU Lesser General Public License for more details.
+
+You should have received a copy of the GNU Lesser General Public License
+along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#pragma once
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+/**
+ * @brief Index of the devices described by the Device Family Packs (DFP) installed in Atmel packs folder.
+ *
+ * Packs folder is scanned once : each DFP (only its highest version) describes its devices in .atdf files, which give
+ * the exact device name, its architecture and its signature. The index is then written to a flat file, sorted by
+ * device name, and reloaded by subsequent runs as long as the packs folder did not change (see compute_stamp()).
+ * Devices are looked up using a binary search, no heuristic nor filesystem access is involved.
+ */
+class AS7DeviceIndex
+{
+public:
+  /**
+   * @brief Device description
+   */
+  struct Device
+  {
+    std::string key;          /**< Lower case device name, as given to the -mmcu option (e.g. atmega328p)    */
+    std::string name;         /**< Device name using Atmel Studio 7 naming conventions (e.g. ATmega328P)   */
+    std::string architecture; /**< Device architecture as written in its .atdf file (AVR8, AVR8X, ARM...) */
+    std::string family;       /**< Device family as written in its .atdf file (megaAVR, tinyAVR...)       */
+    std::string dfp_name;     /**< Name of the DFP describing this device (e.g. ATmega_DFP)                */
+    std::string version;      /**< Version of the DFP (e.g. 1.2.209)                                       */
+    std::string signature;    /**< Device signature bytes (e.g. 0x1E950F), empty if none is described      */
+
+    /**
+     * @brief Retrieves the DFP include directory using Atmel Studio 7 formalism.
+     *      E.g : %24(PackRepoDir)\atmel\ATmega_DFP\1.2.209\include\
+     */
+    std::string get_include_dir() const;
+
+    /**
+     * @brief Retrieves the avr-gcc device specs directory (given to the -B option) using Atmel Studio 7 formalism.
+     *      E.g : %24(PackRepoDir)\atmel\ATmega_DFP\1.2.209\gcc\dev\atmega328p
+     */
+    std::string get_gcc_dev_dir() const;
+  };
+
+  /**
+   * @brief Computes the stamp of a packs folder : its path alongside the modification time of each DFP folder
+   * (installing or removing a DFP version modifies its folder).
+   * @param pack_repo_dir : Atmel packs folder
+   * @return stamp of the packs folder, empty if the packs folder does not exist
+   */
+  static std::string compute_stamp(const std::string& pack_repo_dir);
+
+  /**
+   * @brief Builds the index from the .atdf files of the highest version of each DFP found in the packs folder.
+   * @param pack_repo_dir : Atmel packs folder
+   */
+  void scan(const std::string& pack_repo_dir);
+
+  /**
+   * @brief Loads an index previously written by save().
+   * @param index_file  : index file path
+   * @param stamp       : stamp of the packs folder, as returned by compute_stamp()
+   * @return true if the index was loaded, false if the file does not exist or was built from another packs folder stamp
+   */
+  bool load(const std::string& index_file, const std::string& stamp);
+
+  /**
+   * @brief Writes the index to a file
+   * @param index_file : index file path
+   * @return true on success
+   */
+  bool save(const std::string& index_file) const;
+
+  /**
+   * @brief Loads the index file if it is up to date with the packs folder, scans the packs folder and rewrites the
+   * index file otherwise.
+   * @param pack_repo_dir : Atmel packs folder
+   * @param index_file    : index file path
+   * @return true if the index was loaded from the index file, false if the packs folder was scanned
+   */
+  bool load_or_scan(const std::string& pack_repo_dir, const std::string& index_file);
+
+  /**
+   * @brief Finds a device using its name.
+   * @param device_name : device name, case does not matter (e.g. atmega328p or ATmega328P)
+   * @return device description, nullptr if this device is unknown
+   */
+  const Device* find(const std::string& device_name) const;
+
+  /**
+   * @brief returns the number of indexed devices
+   */
+  std::size_t size() const;
+
+  /**
+   * @brief Parses the description of a device from the content of its .atdf file.
+   * @param atdf    : .atdf file content
+   * @param device  : parsed device, only its name, key, architecture, family and signature are written
+   * @return true if a device was found
+   */
+  static bool parse_atdf(const std::string& atdf, Device& device);
+
+private:
+  std::string stamp;           /**< Stamp of the packs folder this index was built from */
+  std::vector<Device> devices; /**< Indexed devices, sorted by key                      */
+};
@@ -17,15 +17,58 @@ along with this program.  If not, see <https://www.gnu.org/licenses/>.
 
 #include <algorithm>
 #include <filesystem>
+#include <mutex>
 #include <numeric>
 #include <regex>
+#include <unordered_map>
+#include <system_error>
+#include <utility>
 #include <vector>
-#include <cmath>
 
 #include "cmStringUtils.h"
 
 namespace AS7DeviceResolver {
 
+namespace {
+
+/**
+ * @brief Thread safe cache of results computed from a device string.
+ * Projects usually target a handful of devices at most, so results are never evicted.
+ */
+template <typename Value>
+class ResultsCache
+{
+public:
+  /**
+   * @brief returns the cached result for the given key, computing it on first use.
+   * @param key     : device string used as a key
+   * @param compute : callable computing the result from the key
+   * @return cached or freshly computed result
+   */
+  template <typename Compute>
+  Value get(const std::string& key, Compute compute)
+  {
+    {
+      std::lock_guard<std::mutex> lock(mutex);
+      auto found = results.find(key);
+      if (found != results.end()) {
+        return found->second;
+      }
+    }
+
+    Value value = compute(key);
+    std::lock_guard<std::mutex> lock(mutex);
+    results.emplace(key, value);
+    return value;
+  }
+
+private:
+  std::mutex mutex;
+  std::unordered_map<std::string, Value> results;
+};
+
+}
+
 std::string apply_naming_convention(Core core, const std::string& device_name)
 {
   std::string out;
@@ -33,14 +76,14 @@ std::string apply_naming_convention(Core core, const std::string& device_name)
 
   switch (core) {
     case Core::ATautomotive: {
-      std::regex pattern("ATA([0-9]+)(.*)");
+      static const std::regex pattern("ATA([0-9]+)(.*)");
       std::smatch matches;
       std::regex_match(dev_up, matches, pattern);
       out = "ATA" + matches[1].str() + matches[2].str();
     } break;
 
     case Core::ATmega: {
-      std::regex pattern("ATMEGA([0-9]+)(.*)");
+      static const std::regex pattern("ATMEGA([0-9]+)(.*)");
       std::smatch matches;
       std::regex_match(dev_up, matches, pattern);
       out = "ATmega" + matches[1].str() + matches[2].str();
@@ -51,7 +94,7 @@ std::string apply_naming_convention(Core core, const std::string& device_name)
     } break;
 
     case Core::ATtiny: {
-      std::regex pattern("ATTINY([0-9]+)(.*)");
+      static const std::regex pattern("ATTINY([0-9]+)(.*)");
       std::smatch matches;
       std::regex_match(dev_up, matches, pattern);
 
@@ -64,7 +107,7 @@ std::string apply_naming_convention(Core core, const std::string& device_name)
     } break;
 
     case Core::ATxmega: {
-      std::regex pattern("ATXMEGA([0-9]+)(.*)");
+      static const std::regex pattern("ATXMEGA([0-9]+)(.*)");
       std::smatch matches;
       std::regex_match(dev_up, matches, pattern);
       out = "ATxmega" + matches[1].str() + matches[2].str();
@@ -84,7 +127,7 @@ std::string apply_naming_convention(Core core, const std::string& device_name)
   return out;
 }
 
-std::string resolve_from_mmcu(const std::string& mmcu_option)
+static std::string compute_from_mmcu(const std::string& mmcu_option)
 {
   Core core = Core::Unknown;
   std::string option = cmutils::strings::to_lowercase(mmcu_option);
@@ -102,6 +145,12 @@ std::string resolve_from_mmcu(const std::string& mmcu_option)
   return apply_naming_convention(core, option);
 }
 
+std::string resolve_from_mmcu(const std::string& mmcu_option)
+{
+  static ResultsCache<std::string> cache;
+  return cache.get(mmcu_option, compute_from_mmcu);
+}
+
 std::string resolve_from_defines(const std::vector<std::string>& definitions)
 {
   for (auto& elem : definitions) {
@@ -113,16 +162,20 @@ std::string resolve_from_defines(const std::vector<std::string>& definitions)
   return "";
 }
 
-static std::string resolve_single_core(const std::string& input, const std::string& regex_pattern, const std::string& output_radical)
+/**
+ * @brief matches input against the "<prefix>(.*)__" pattern, without relying on regular expressions
+ * as this is called several times for each definition of each target.
+ * @return output_radical followed by the captured part, or an empty string if input does not match
+ */
+static std::string resolve_single_core(const std::string& input, const std::string& prefix, const std::string& output_radical)
 {
+  static const std::string suffix = "__";
   std::string device;
-  std::regex pattern;
-  std::smatch matches;
 
-  pattern.assign(regex_pattern);
-  std::regex_match(input, matches, pattern);
-  if (matches.size() > 1) {
-    device = output_radical + matches[1].str();
+  if (input.size() >= prefix.size() + suffix.size() &&
+      input.compare(0, prefix.size(), prefix) == 0 &&
+      input.compare(input.size() - suffix.size(), suffix.size(), suffix) == 0) {
+    device = output_radical + input.substr(prefix.size(), input.size() - prefix.size() - suffix.size());
   }
 
   return device;
@@ -138,28 +191,28 @@ std::string resolve_from_defines(const std::string& definition)
   std::string device;
 
   // Check for AVR cores (8 bit)
-  device = resolve_single_core(definition, "__AVR_(.*)__", "");
+  device = resolve_single_core(definition, "__AVR_", "");
 
   // Check for AVR32 cores (32 bit)
   if (device.empty()) {
-    device = resolve_single_core(definition, "__AVR32_UC(.*)__", "AT32UC");
+    device = resolve_single_core(definition, "__AVR32_UC", "AT32UC");
   }
 
   // AT32 defines could as well be provided with __AT32UC...__ root
   // such as __AT32UC3A4256S__
   if (device.empty()) {
-    device = resolve_single_core(definition, "__AT32UC(.*)__", "AT32UC");
+    device = resolve_single_core(definition, "__AT32UC", "AT32UC");
   }
 
   // SAM devices check
   if (device.empty()) {
-    device = resolve_single_core(definition, "__SAM(.*)__", "ATSAM");
+    device = resolve_single_core(definition, "__SAM", "ATSAM");
   }
 
   return device;
 }
 
-Core resolve_core_from_name(const std::string& device_name)
+static Core compute_core_from_name(const std::string& device_name)
 {
   Core core = Core::Unknown;
 
@@ -197,12 +250,19 @@ Core resolve_core_from_name(const std::string& device_name)
   return core;
 }
 
+Core resolve_core_from_name(const std::string& device_name)
+{
+  static ResultsCache<Core> cache;
+  return cache.get(device_name, compute_core_from_name);
+}
+
 static std::string resolve_sam_dfps(const std::string& device_name)
 {
+  static const std::regex series_pattern("ATSAM([0-9][A-Z]).*");
+  static const std::regex family_pattern("ATSAM([A-Z][0-9]+).*");
   std::string out;
-  std::regex pattern("ATSAM([0-9][A-Z]).*");
   std::smatch matches;
-  std::regex_match(device_name, matches, pattern);
+  std::regex_match(device_name, matches, series_pattern);
 
   if (!matches.empty()) {
     out = "SAM" + matches[1].str() + "_DFP";
@@ -212,8 +272,7 @@ static std::string resolve_sam_dfps(const std::string& device_name)
     if (device_name.find("ATSAMG") != std::string::npos) {
       out = "SAMG_DFP";
     } else {
-      pattern.assign("ATSAM([A-Z][0-9]+).*");
-      std::regex_match(device_name, matches, pattern);
+      std::regex_match(device_name, matches, family_pattern);
       if (!matches.empty()) {
         out = "SAM" + matches[1].str() + "_DFP";
       }
@@ -225,18 +284,18 @@ static std::string resolve_sam_dfps(const std::string& device_name)
 
 static std::string resolve_at32uc_dfps(const std::string& device_name)
 {
+  static const std::regex at32uc_pattern("AT32UC3([A-Z]).*");
+  static const std::regex atuc_pattern("ATUC[0-9]+([A-Z])([0-9])");
   std::string out;
-  std::regex pattern("AT32UC3([A-Z]).*");
   std::smatch matches;
 
-  std::regex_match(device_name, matches, pattern);
+  std::regex_match(device_name, matches, at32uc_pattern);
   if (!matches.empty()) {
     out = "UC3" + matches[1].str() + "_DFP";
   }
 
   if (out.empty()) {
-    pattern.assign("ATUC[0-9]+([A-Z])([0-9])");
-    std::regex_match(device_name, matches, pattern);
+    std::regex_match(device_name, matches, atuc_pattern);
 
     if (!matches.empty()) {
       out = "UC" + matches[2].str() + matches[1].str() + "_DFP";
@@ -248,8 +307,8 @@ static std::string resolve_at32uc_dfps(const std::string& device_name)
 
 static std::string resolve_xmega_dfps(const std::string& device_name)
 {
+  static const std::regex pattern("ATxmega[0-9]+([A-Z]).*");
   std::string out;
-  std::regex pattern("ATxmega[0-9]+([A-Z]).*");
   std::smatch matches;
 
   std::regex_match(device_name, matches, pattern);
@@ -260,7 +319,7 @@ static std::string resolve_xmega_dfps(const std::string& device_name)
   return out;
 }
 
-std::string resolve_device_dfp_name(const std::string& device_name)
+static std::string compute_device_dfp_name(const std::string& device_name)
 {
   Core core = resolve_core_from_name(device_name);
   std::string out = "";
@@ -304,46 +363,72 @@ std::string resolve_device_dfp_name(const std::string& device_name)
   return out;
 }
 
-std::string get_max_packs_version(const std::string& path)
+std::string resolve_device_dfp_name(const std::string& device_name)
 {
-  std::string out;
-  if (!std::filesystem::exists(path)) {
-    return out;
+  static ResultsCache<std::string> cache;
+  return cache.get(device_name, compute_device_dfp_name);
+}
+
+bool parse_pack_version(const std::string& name, PackVersion& version)
+{
+  PackVersion parsed = {};
+  std::size_t field = 0;
+  bool has_digit = false;
+  for (const char c : name) {
+    if (c >= '0' && c <= '9') {
+      parsed[field] = parsed[field] * 10 + static_cast<unsigned long>(c - '0');
+      has_digit = true;
+    } else if (c == '.' && has_digit && field + 1 < parsed.size()) {
+      field++;
+      has_digit = false;
+    } else {
+      return false;
+    }
   }
 
-  std::vector<std::string> versions;
+  // only accept folder versions like "12.34.56" with 2 dots
+  if (!has_digit || field + 1 != parsed.size()) {
+    return false;
+  }
+  version = parsed;
+  return true;
+}
 
-  for (const auto& entry : std::filesystem::directory_iterator(path)) {
-    if (std::filesystem::is_directory(entry)) {
-      std::string entry_name = entry.path().filename().string();
+std::vector<std::string> get_packs_versions(const std::string& path)
+{
+  std::vector<std::pair<PackVersion, std::string>> versions;
+  std::error_code ec;
+  if (!std::filesystem::is_directory(path, ec)) {
+    return {};
+  }
 
-      // only accept folder versions like "12.34.56" with 2 dots
-      if (std::count(entry_name.begin(), entry_name.end(), '.') == 2) {
-        versions.push_back(entry_name);
+  for (const auto& entry : std::filesystem::directory_iterator(path, ec)) {
+    if (entry.is_directory(ec)) {
+      std::string entry_name = entry.path().filename().string();
+      PackVersion version;
+      if (parse_pack_version(entry_name, version)) {
+        versions.emplace_back(version, entry_name);
       }
     }
   }
 
-  // Computes weighted sum to discriminate the max folder version
-  auto max_version = std::max_element(versions.begin(), versions.end(), [](const std::string& left, const std::string& right) {
-    auto l = cmutils::strings::split(left, '.');
-    auto r = cmutils::strings::split(right, '.');
-
-    uint64_t lsum = 0;
-    uint64_t rsum = 0;
-    for (unsigned int i = 0; i < l.size(); i++) {
-      lsum += (uint64_t)(std::stoi(l[i]) * pow(10, (l.size() - i)));
-      rsum += (uint64_t)(std::stoi(r[i]) * pow(10, (l.size() - i)));
-    }
-
-    return lsum < rsum;
-  });
+  std::sort(versions.begin(), versions.end());
 
-  // Guard against cases where versions is empty
-  if (max_version != versions.end()) {
-    out = *max_version;
+  std::vector<std::string> out;
+  out.reserve(versions.size());
+  for (auto& version : versions) {
+    out.push_back(std::move(version.second));
   }
   return out;
 }
 
+std::string get_max_packs_version(const std::string& path)
+{
+  std::vector<std::string> versions = get_packs_versions(path);
+  if (versions.empty()) {
+    return "";
+  }
+  return versions.back();
+}
+
 }
@@ -15,6 +15,7 @@ along with this program.  If not, see <https://www.gnu.org/licenses/>.
 
 #pragma once
 
+#include <array>
 #include <string>
 #include <vector>
 
@@ -80,6 +81,26 @@ Core resolve_core_from_name(const std::string& device_name);
  */
 std::string resolve_device_dfp_name(const std::string& device_name);
 
+/**
+ * @brief Numeric representation of a package version, used to compare versions such as "1.2.209" and "1.10.0"
+ */
+using PackVersion = std::array<unsigned long, 3>;
+
+/**
+ * @brief parses a package folder name into its numeric representation.
+ * @param name    : package folder name, e.g. "1.2.209"
+ * @param version : parsed version, only written on success
+ * @return true if name is a valid "major.minor.patch" version, false otherwise
+ */
+bool parse_pack_version(const std::string& name, PackVersion& version);
+
+/**
+ * @brief lists all package versions found in the given DFP folder.
+ * @param path : input path to be inspected (DFP folder absolute path)
+ * @return package versions (folder names), sorted from the lowest to the highest
+ */
+std::vector<std::string> get_packs_versions(const std::string& path);
+
 /**
  * @brief retrieves the highest package version using the given input path.
  * @param path : input path to be inspected (DFP folder absolute path)
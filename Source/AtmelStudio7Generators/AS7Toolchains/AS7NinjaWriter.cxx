@@ -0,0 +1,264 @@
+/*
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU Lesser General Public License as published by
+the Free Software Foundation, either version 3.0 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU Lesser General Public License for more details.
+
+You should have received a copy of the GNU Lesser General Public License
+along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#include "AS7NinjaWriter.h"
+
+#include <utility>
+
+#include "AvrGCC8Toolchain.h"
+#include "cmStringUtils.h"
+
+static const char* const pack_repo_dir_macro = "%24(PackRepoDir)"; /**< Atmel Studio 7 macro pointing to the packs folder */
+
+/**
+ * @brief Quotes a command line argument if it holds characters interpreted by the shell
+ */
+static std::string quote(const std::string& argument)
+{
+  if (argument.find_first_of(" \"'()<>&|;*?") == std::string::npos) {
+    return argument;
+  }
+  std::string out = "\"";
+  for (const char c : argument) {
+    if (c == '"' || c == '\\') {
+      out += '\\';
+    }
+    out += c;
+  }
+  out += '"';
+  return out;
+}
+
+AS7NinjaWriter::AS7NinjaWriter(std::ostream& output)
+  : output(output)
+{
+}
+
+void AS7NinjaWriter::write_rules(const Tools& tools)
+{
+  const std::string redirect = tools.windows_shell ? "cmd.exe /C " : "";
+
+  output << "# Generated by CMake, Atmel Studio 7 projects built with the avr toolchain.\n"
+         << "ninja_required_version = 1.5\n\n"
+         << "as7_pack_repo_dir = " << cmutils::strings::replace(tools.pack_repo_dir, "$", "$$") << "\n\n";
+
+  const std::vector<std::pair<std::string, std::string>> compilers = {
+    { "C", tools.c_compiler },
+    { "CXX", tools.cxx_compiler },
+  };
+  for (const auto& compiler : compilers) {
+    const std::string lang_switch = (compiler.first == "CXX") ? "c++" : "c";
+    output << "rule AS7_" << compiler.first << "_COMPILER\n"
+           << "  command = " << quote(compiler.second) << " -x " << lang_switch
+           << " $flags -c -MD -MP -MF $out.d -MT $out -o $out $in\n"
+           << "  depfile = $out.d\n"
+           << "  deps = gcc\n"
+           << "  description = Building " << compiler.first << " object $out\n\n";
+
+    output << "rule AS7_" << compiler.first << "_LINKER\n"
+           << "  command = " << quote(compiler.second) << " -o $out $in $link_flags\n"
+           << "  description = Linking " << compiler.first << " executable $out\n\n";
+  }
+
+  output << "rule AS7_ARCHIVER\n"
+         << "  command = " << quote(tools.archiver) << " $archiver_flags $out $in\n"
+         << "  description = Linking static library $out\n\n";
+
+  // Images are produced the way Atmel Studio 7 post build steps do
+  output << "rule AS7_HEX\n"
+         << "  command = " << quote(tools.objcopy)
+         << " -O ihex -R .eeprom -R .fuse -R .lock -R .signature -R .user_signatures $in $out\n"
+         << "  description = Generating $out\n\n";
+
+  output << "rule AS7_EEP\n"
+         << "  command = " << quote(tools.objcopy)
+         << " -j .eeprom --set-section-flags=.eeprom=alloc,load --change-section-lma .eeprom=0 --no-change-warnings -O ihex $in $out\n"
+         << "  description = Generating $out\n\n";
+
+  output << "rule AS7_LSS\n"
+         << "  command = " << redirect << quote(tools.objdump) << " -h -S $in > $out\n"
+         << "  description = Generating $out\n\n";
+
+  output << "rule AS7_SREC\n"
+         << "  command = " << quote(tools.objcopy)
+         << " -O srec -R .eeprom -R .fuse -R .lock -R .signature -R .user_signatures $in $out\n"
+         << "  description = Generating $out\n\n";
+}
+
+void AS7NinjaWriter::write_configuration(const Target& target, const std::string& config, const AvrToolchain::AS7AvrGCC8& toolchain)
+{
+  const std::string output_dir = target.binary_dir + "/" + config;
+  output << "# Target " << target.name << ", configuration " << config << "\n\n";
+
+  std::vector<std::string> objects;
+  const std::vector<std::pair<std::string, const std::vector<std::string>*>> languages = {
+    { "C", &target.c_sources },
+    { "CXX", &target.cxx_sources },
+  };
+  for (const auto& lang : languages) {
+    if (lang.second->empty()) {
+      continue;
+    }
+    const std::string flags = to_variable_value(toolchain.generate_compile_flags(lang.first));
+    for (const std::string& source : *lang.second) {
+      objects.push_back(get_object_path(target, config, source));
+      output << "build " << escape_path(objects.back()) << ": AS7_" << lang.first << "_COMPILER " << escape_path(source) << "\n"
+             << "  flags = " << flags << "\n";
+    }
+    output << "\n";
+  }
+
+  std::string inputs;
+  for (const std::string& object : objects) {
+    inputs += " " + escape_path(object);
+  }
+
+  std::vector<std::string> outputs;
+  switch (target.type) {
+    case OutputType::Executable: {
+      const std::string elf = output_dir + "/" + target.name + ".elf";
+      const std::string lang = target.cxx_sources.empty() ? "C" : "CXX";
+
+      // Dependencies are rebuilt first, and relinking happens whenever one of them changes
+      std::string dependencies;
+      for (const std::string& dependency : target.dependencies) {
+        dependencies += " " + escape_path(get_phony_name(dependency, config));
+      }
+
+      output << "build " << escape_path(elf) << ": AS7_" << lang << "_LINKER" << inputs
+             << (dependencies.empty() ? "" : " |" + dependencies) << "\n"
+             << "  link_flags = " << to_variable_value(toolchain.generate_link_flags(output_dir + "/" + target.name + ".map"))
+             << "\n";
+      outputs.push_back(elf);
+
+      const std::vector<std::pair<bool, std::string>> images = {
+        { toolchain.common.outputfiles.hex, "HEX" },
+        { toolchain.common.outputfiles.eep, "EEP" },
+        { toolchain.common.outputfiles.lss, "LSS" },
+        { toolchain.common.outputfiles.srec, "SREC" },
+      };
+      for (const auto& image : images) {
+        if (!image.first) {
+          continue;
+        }
+        const std::string path = output_dir + "/" + target.name + "." + cmutils::strings::to_lowercase(image.second);
+        output << "build " << escape_path(path) << ": AS7_" << image.second << " " << escape_path(elf) << "\n";
+        outputs.push_back(path);
+      }
+    } break;
+
+    case OutputType::StaticLibrary: {
+      const std::string archive = output_dir + "/lib" + target.name + ".a";
+      output << "build " << escape_path(archive) << ": AS7_ARCHIVER" << inputs << "\n"
+             << "  archiver_flags = " << to_variable_value(cmutils::strings::split(toolchain.archiver_flags)) << "\n";
+      outputs.push_back(archive);
+    } break;
+
+    case OutputType::None:
+    default:
+      outputs = objects;
+      break;
+  }
+
+  output << "build " << escape_path(get_phony_name(target.name, config)) << ": phony";
+  for (const std::string& out : outputs) {
+    output << " " << escape_path(out);
+  }
+  output << "\n\n";
+}
+
+void AS7NinjaWriter::write_configuration_aggregate(const std::vector<std::string>& targets, const std::string& config)
+{
+  output << "build " << escape_path("all-" + config) << ": phony";
+  for (const std::string& target : targets) {
+    output << " " << escape_path(get_phony_name(target, config));
+  }
+  output << "\n";
+}
+
+void AS7NinjaWriter::write_default(const std::string& target)
+{
+  output << "\ndefault " << escape_path(target) << "\n";
+}
+
+void AS7NinjaWriter::write_subninja(const std::string& path)
+{
+  output << "subninja " << escape_path(path) << "\n";
+}
+
+std::string AS7NinjaWriter::escape_path(const std::string& path)
+{
+  std::string out;
+  out.reserve(path.size());
+  for (const char c : path) {
+    if (c == '$' || c == ' ' || c == ':') {
+      out += '$';
+    }
+    out += c;
+  }
+  return out;
+}
+
+std::string AS7NinjaWriter::to_variable_value(const std::vector<std::string>& flags)
+{
+  std::string out;
+  for (const std::string& flag : flags) {
+    if (flag.empty()) {
+      continue;
+    }
+    std::string value = cmutils::strings::replace(flag, "$", "$$");
+
+    // Paths are written using Atmel Studio 7 formalism, convert them back to plain paths
+    const bool has_pack_repo_dir = value.find(pack_repo_dir_macro) != std::string::npos;
+    if (has_pack_repo_dir || value.compare(0, 2, "-I") == 0 || value.compare(0, 2, "-L") == 0) {
+      value = cmutils::strings::replace(value, '\\', '/');
+    }
+    value = quote(value);
+    if (has_pack_repo_dir) {
+      // Packs folder may hold spaces as well, so the expanded path always needs to be quoted
+      value = cmutils::strings::replace(value, pack_repo_dir_macro, "${as7_pack_repo_dir}");
+      if (value.front() != '"') {
+        value = "\"" + value + "\"";
+      }
+    }
+
+    if (!out.empty()) {
+      out += ' ';
+    }
+    out += value;
+  }
+  return out;
+}
+
+std::string AS7NinjaWriter::get_phony_name(const std::string& target, const std::string& config)
+{
+  return target + "-" + config;
+}
+
+std::string AS7NinjaWriter::get_object_path(const Target& target, const std::string& config, const std::string& source)
+{
+  // Objects mirror the sources layout and keep the source extension the way CMake's own generators do (main.c gives
+  // main.c.o), so that main.c and main.cpp of the same directory do not build the same object
+  std::string relative = source;
+  const std::string prefix = target.source_dir + "/";
+  if (relative.compare(0, prefix.size(), prefix) == 0) {
+    relative = relative.substr(prefix.size());
+  } else {
+    relative = cmutils::strings::replace(relative, ":", "");
+    relative = cmutils::strings::trim(relative, '/', cmutils::strings::TransformLocation::Start);
+  }
+  relative = cmutils::strings::replace(relative, "..", "__");
+  return target.binary_dir + "/" + config + "/" + target.name + ".dir/" + relative + ".o";
+}
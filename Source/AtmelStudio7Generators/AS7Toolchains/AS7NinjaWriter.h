@@ -0,0 +1,137 @@
+/*
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU Lesser General Public License as published by
+the Free Software Foundation, either version 3.0 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU Lesser General Public License for more details.
+
+You should have received a copy of the GNU Lesser General Public License
+along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#pragma once
+
+#include <ostream>
+#include <string>
+#include <vector>
+
+namespace AvrToolchain {
+struct AS7AvrGCC8;
+}
+
+/**
+ * @brief Writes ninja build statements which drive the avr toolchain directly, using the options translated for
+ * Atmel Studio 7 (AvrToolchain::AS7AvrGCC8) : command line builds match what the IDE does.
+ *
+ * Rules are written once (write_rules()) in the top level build.ninja, whereas each target writes its build
+ * statements (write_configuration()) in its own file, included with subninja. Each target and configuration
+ * pair is gathered under a phony <target>-<configuration> build statement.
+ */
+class AS7NinjaWriter
+{
+public:
+  /**
+   * @brief Tools used by the build rules
+   */
+  struct Tools
+  {
+    std::string c_compiler;     /**< avr-gcc                                                    */
+    std::string cxx_compiler;   /**< avr-g++                                                    */
+    std::string archiver;       /**< avr-ar                                                     */
+    std::string objcopy;        /**< avr-objcopy                                                */
+    std::string objdump;        /**< avr-objdump                                                */
+    std::string pack_repo_dir;  /**< Atmel packs folder, replaces %24(PackRepoDir) in options    */
+    bool windows_shell = false; /**< Output redirections need to run through cmd.exe            */
+  };
+
+  /**
+   * @brief Kind of output produced by a target
+   */
+  enum class OutputType
+  {
+    Executable,    /**< <name>.elf, alongside its .hex, .eep, .lss and .srec images when enabled */
+    StaticLibrary, /**< lib<name>.a                                                               */
+    None           /**< Objects only                                                              */
+  };
+
+  /**
+   * @brief Describes a target (a.k.a. Atmel Studio 7 project), all paths use forward slashes
+   */
+  struct Target
+  {
+    std::string name;                      /**< Target name                                              */
+    std::string source_dir;                /**< Source directory, object files mirror its layout        */
+    std::string binary_dir;                /**< Binary directory, outputs go to <binary_dir>/<config>    */
+    OutputType type = OutputType::None;    /**< Kind of output                                           */
+    std::vector<std::string> c_sources;    /**< C sources                                                */
+    std::vector<std::string> cxx_sources;  /**< C++ sources (the executable is then linked by avr-g++)   */
+    std::vector<std::string> dependencies; /**< Names of the targets this one depends on                 */
+  };
+
+  /**
+   * @brief Builds a writer which appends ninja statements to the given output stream.
+   * @param output : output stream
+   */
+  AS7NinjaWriter(std::ostream& output);
+
+  /**
+   * @brief Writes the header and the rules shared by all targets.
+   * @param tools : tools used by the rules
+   */
+  void write_rules(const Tools& tools);
+
+  /**
+   * @brief Writes the build statements of a target for a given configuration.
+   * @param target      : target description
+   * @param config      : build configuration (e.g. Debug)
+   * @param toolchain   : toolchain options translated for this configuration
+   */
+  void write_configuration(const Target& target, const std::string& config, const AvrToolchain::AS7AvrGCC8& toolchain);
+
+  /**
+   * @brief Writes the phony build statement gathering all targets of a configuration, named all-<config>.
+   * @param targets : names of the targets
+   * @param config  : build configuration
+   */
+  void write_configuration_aggregate(const std::vector<std::string>& targets, const std::string& config);
+
+  /**
+   * @brief Writes the default build statement
+   * @param target : name of the target built by default
+   */
+  void write_default(const std::string& target);
+
+  /**
+   * @brief Writes a subninja statement
+   * @param path : path to the included ninja file
+   */
+  void write_subninja(const std::string& path);
+
+  /**
+   * @brief Escapes a path used in a build statement ($, spaces and colons).
+   */
+  static std::string escape_path(const std::string& path);
+
+  /**
+   * @brief Converts a list of flags to a ninja variable value : each flag is quoted for the shell if need be,
+   * paths are converted from Atmel Studio 7 formalism (%24(PackRepoDir) and backslashes) to plain paths.
+   */
+  static std::string to_variable_value(const std::vector<std::string>& flags);
+
+  /**
+   * @brief Computes the name of the phony build statement of a target for a given configuration
+   */
+  static std::string get_phony_name(const std::string& target, const std::string& config);
+
+private:
+  /**
+   * @brief Computes the object file path of a source file
+   */
+  static std::string get_object_path(const Target& target, const std::string& config, const std::string& source);
+
+  std::ostream& output; /**< Output stream */
+};
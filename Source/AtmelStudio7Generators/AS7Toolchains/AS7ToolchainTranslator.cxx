@@ -14,20 +14,45 @@ along with this program.  If not, see <https://www.gnu.org/licenses/>.
 */
 
 #include "AS7ToolchainTranslator.h"
-#include "pugixml.hpp"
+#include "AS7XmlWriter.h"
 #include "cmAvrGccCompiler.h"
 #include "AvrGCC8Toolchain.h"
 
 namespace AvrToolchain
 {
 
+bool AS7ToolchainTranslator::supports_language(const std::string& lang)
+{
+    return (lang == "CXX") || (lang == "C");
+}
+
 void AS7ToolchainTranslator::parse(const std::vector<std::string>& flags, const std::string& lang)
 {
-    if (lang != "CXX" && lang != "C")
+    if (!supports_language(lang))
+    {
+        return;
+    }
+
+    // Compiler abstraction is always instanciated anew, as previous instances
+    // might be shared with other translators (see set_compiler()).
+    auto model = std::make_shared<compiler::cmAvrGccCompiler>();
+    model->parse_flags(flags);
+    set_compiler(model, lang);
+}
+
+void AS7ToolchainTranslator::set_compiler(const std::shared_ptr<const compiler::AbstractCompilerModel>& model, const std::string& lang)
+{
+    if (!supports_language(lang) || model == nullptr)
     {
         return;
     }
 
+    update_targeted_language(lang);
+    compilers[lang] = model;
+}
+
+void AS7ToolchainTranslator::update_targeted_language(const std::string& lang)
+{
     // If Cxx is selected, then we need both C++ and C abstractions
     // However if C is selected and C++ has not been declared previously,
     // C++ abstraction is not needed.
@@ -42,20 +67,6 @@ void AS7ToolchainTranslator::parse(const std::vector<std::string>& flags, const
             targeted_language = lang;
         }
     }
-
-    // Compiler abstraction is only instanciated when needed, previous
-    // instance is cleared before parsing takes place.
-    auto found_compiler = compilers.find(lang);
-    if (found_compiler == compilers.end())
-    {
-        compilers[lang] = std::unique_ptr<compiler::AbstractCompilerModel>(new compiler::cmAvrGccCompiler());
-        compilers[lang]->parse_flags(flags);
-    }
-    else
-    {
-        found_compiler->second->clear();
-        found_compiler->second->parse_flags(flags);
-    }
 }
 
 std::string AS7ToolchainTranslator::get_targeted_language() const
@@ -69,11 +80,17 @@ void AS7ToolchainTranslator::clear()
     compilers.clear();
 }
 
-void AS7ToolchainTranslator::generate_xml(pugi::xml_node& parent)
+void AS7ToolchainTranslator::generate_xml(AS7XmlWriter& writer)
 {
     sync_toolchain_languages();
     translate();
-    toolchain.generate_xml(parent, targeted_language);
+    toolchain.generate_xml(writer, targeted_language);
+}
+
+void AS7ToolchainTranslator::inherit_shared_settings(const AS7ToolchainTranslator& previous)
+{
+    toolchain.common = previous.toolchain.common;
+    toolchain.archiver_flags = previous.toolchain.archiver_flags;
 }
 
 void AS7ToolchainTranslator::sync_toolchain_languages()
@@ -94,7 +111,7 @@ void AS7ToolchainTranslator::translate()
     }
 }
 
-compiler::AbstractCompilerModel* AS7ToolchainTranslator::get_compiler(const std::string& lang)
+const compiler::AbstractCompilerModel* AS7ToolchainTranslator::get_compiler(const std::string& lang) const
 {
     auto found_compiler = compilers.find(lang);
     if (found_compiler != compilers.end())
@@ -15,6 +15,7 @@ along with this program.  If not, see <https://www.gnu.org/licenses/>.
 
 #pragma once
 
+#include <memory>
 #include <string>
 #include <vector>
 #include <unordered_map>
@@ -22,10 +23,7 @@ along with this program.  If not, see <https://www.gnu.org/licenses/>.
 #include "AvrGCC8Toolchain.h"
 #include "AbstractCompilerModel.h"
 
-namespace pugi
-{
-    class xml_node;
-}
+class AS7XmlWriter;
 
 namespace AvrToolchain
 {
@@ -47,11 +45,35 @@ public:
     */
     void parse(const std::vector<std::string>& flags, const std::string& lang = "C");
 
+    /**
+     * @brief Uses an already parsed compiler abstraction for the given language instead of parsing flags again.
+     * The model is shared with its provider (e.g. a cache) and is never modified by this translator.
+     * @param   model   :   parsed compiler abstraction
+     * @param   lang    :   Targeted language associated to given compiler abstraction
+    */
+    void set_compiler(const std::shared_ptr<const compiler::AbstractCompilerModel>& model, const std::string& lang = "C");
+
+    /**
+     * @brief tells whether the given language is handled by the translator (only C and CXX are supported so far)
+     * @param   lang    :   language to be checked
+     * @return true if flags of this language can be parsed and translated
+    */
+    static bool supports_language(const std::string& lang);
+
     /**
      * @brief Generates an xml representing the current toolchain using Atmel Studio 7 compatible format
-     * @param   parent  :   parent node of Xml representation
+     * @param   writer  :   xml writer, the representation is written as children of its current element
     */
-    void generate_xml(pugi::xml_node& parent);
+    void generate_xml(AS7XmlWriter& writer);
+
+    /**
+     * @brief Carries the settings which are shared by all build configurations over from the translator
+     * used for the previous configuration (e.g. the targeted device, which is resolved once).
+     * Replaying configurations with several translators this way yields the exact same xml as a single
+     * translator generating all of them in a row.
+     * @param   previous    :   translator which generated the previous configuration
+    */
+    void inherit_shared_settings(const AS7ToolchainTranslator& previous);
 
     /**
      * @brief gives a matching compiler abstraction for a given language
@@ -60,7 +82,7 @@ public:
      *      pointer to a compiler abstraction if one exists for selected language
      *      nullptr if no compiler abstraction could be found
     */
-    compiler::AbstractCompilerModel* get_compiler(const std::string& lang);
+    const compiler::AbstractCompilerModel* get_compiler(const std::string& lang) const;
 
     /**
      * @brief returns targeted language. This method resolves the "highest" language used in
@@ -91,10 +113,16 @@ private:
     */
     void translate();
 
+    /**
+     * @brief Updates the targeted language using the newly parsed one (C++ > C).
+     * @param   lang    :   language which has just been parsed
+    */
+    void update_targeted_language(const std::string& lang);
+
     std::string targeted_language;   /**< Stores the language used. If C++ was given,
                                          then C and C++ abstractions will be used.
                                          Otherwise, only C is activated                 */
-    std::unordered_map <std::string, std::unique_ptr<compiler::AbstractCompilerModel>> compilers; /**< Collection of compiler abstractions        */
+    std::unordered_map <std::string, std::shared_ptr<const compiler::AbstractCompilerModel>> compilers; /**< Collection of compiler abstractions  */
 };
 
 
@@ -0,0 +1,173 @@
+/*
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU Lesser General Public License as published by
+the Free Software Foundation, either version 3.0 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU Lesser General Public License for more details.
+
+You should have received a copy of the GNU Lesser General Public License
+along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#include "AS7XmlWriter.h"
+
+#include <sstream>
+
+/**
+ * @brief tells whether a character needs to be escaped. Escaped characters are the same as pugixml's ones :
+ * markup characters and control characters, except tabulations (and line breaks for text values).
+ */
+static bool needs_escaping(const char c, const bool attribute)
+{
+  switch (c) {
+    case '&':
+    case '<':
+    case '>':
+      return true;
+
+    case '"':
+      return attribute;
+
+    case '\t':
+      return false;
+
+    case '\n':
+    case '\r':
+      return attribute;
+
+    default:
+      return static_cast<unsigned char>(c) < 32;
+  }
+}
+
+AS7XmlWriter::AS7XmlWriter(std::ostream& output, const std::string& indentation, std::size_t level)
+  : output(output)
+  , indentation(indentation)
+  , base_level(level)
+{
+}
+
+AS7XmlWriter::~AS7XmlWriter()
+{
+  while (!elements.empty()) {
+    end_element();
+  }
+}
+
+void AS7XmlWriter::write_bom()
+{
+  output << "\xEF\xBB\xBF";
+}
+
+void AS7XmlWriter::write_declaration(const std::string& version, const std::string& encoding)
+{
+  start_line();
+  output << "<?xml version=\"" << version << "\" encoding=\"" << encoding << "\"?>\n";
+}
+
+void AS7XmlWriter::start_element(const std::string& name)
+{
+  start_line();
+  output << '<' << name;
+  elements.push_back(name);
+  start_tag_opened = true;
+}
+
+void AS7XmlWriter::attribute(const std::string& name, const std::string& value)
+{
+  output << ' ' << name << "=\"";
+  write_escaped(value, true);
+  output << '"';
+}
+
+void AS7XmlWriter::end_element()
+{
+  if (start_tag_opened) {
+    output << " />\n";
+    start_tag_opened = false;
+  } else {
+    for (std::size_t i = 1; i < level(); i++) {
+      output << indentation;
+    }
+    output << "</" << elements.back() << ">\n";
+  }
+  elements.pop_back();
+}
+
+void AS7XmlWriter::element(const std::string& name, const std::string& value)
+{
+  start_line();
+  output << '<' << name;
+  if (value.empty()) {
+    output << " />\n";
+    return;
+  }
+  output << '>';
+  write_escaped(value, false);
+  output << "</" << name << ">\n";
+}
+
+void AS7XmlWriter::close_start_tag()
+{
+  if (start_tag_opened) {
+    output << ">\n";
+    start_tag_opened = false;
+  }
+}
+
+std::size_t AS7XmlWriter::level() const
+{
+  return base_level + elements.size();
+}
+
+std::string AS7XmlWriter::escape(const std::string& value, bool attribute)
+{
+  std::ostringstream out;
+  AS7XmlWriter writer(out);
+  writer.write_escaped(value, attribute);
+  return out.str();
+}
+
+void AS7XmlWriter::start_line()
+{
+  close_start_tag();
+  for (std::size_t i = 0; i < level(); i++) {
+    output << indentation;
+  }
+}
+
+void AS7XmlWriter::write_escaped(const std::string& value, bool attribute)
+{
+  std::size_t written = 0;
+  for (std::size_t i = 0; i < value.size(); i++) {
+    const char c = value[i];
+    if (!needs_escaping(c, attribute)) {
+      continue;
+    }
+
+    output.write(value.data() + written, static_cast<std::streamsize>(i - written));
+    written = i + 1;
+    switch (c) {
+      case '&':
+        output << "&amp;";
+        break;
+      case '<':
+        output << "&lt;";
+        break;
+      case '>':
+        output << "&gt;";
+        break;
+      case '"':
+        output << "&quot;";
+        break;
+      default:
+        output << "&#" << static_cast<char>('0' + c / 10) << static_cast<char>('0' + c % 10) << ';';
+        break;
+    }
+  }
+  output.write(value.data() + written, static_cast<std::streamsize>(value.size() - written));
+}
@@ -0,0 +1,122 @@
+/*
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU Lesser General Public License as published by
+the Free Software Foundation, either version 3.0 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU Lesser General Public License for more details.
+
+You should have received a copy of the GNU Lesser General Public License
+along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#pragma once
+
+#include <cstddef>
+#include <ostream>
+#include <string>
+#include <vector>
+
+/**
+ * @brief Forward-only xml emitter used to write Atmel Studio 7 project files.
+ *
+ * Elements are written to the output stream as soon as they are described, no document is kept in memory.
+ * The output layout is the one of pugixml's indented format (which was used to write project files so far) :
+ *  - each element is written on its own line, indented by its depth ;
+ *  - elements without content are written as <name /> ;
+ *  - elements holding a single text value are written inline : <name>value</name>.
+ */
+class AS7XmlWriter
+{
+public:
+  /**
+   * @brief Builds a writer which appends xml to the given output stream.
+   * @param output      : output stream
+   * @param indentation : string used to indent elements, once per depth level
+   * @param level       : depth of the first elements written by this writer. This is used to write
+   *                      the content of an element with a separate writer (@see close_start_tag())
+   */
+  AS7XmlWriter(std::ostream& output, const std::string& indentation = "  ", std::size_t level = 0);
+
+  /**
+   * @brief Closes all elements which are still opened.
+   */
+  ~AS7XmlWriter();
+
+  AS7XmlWriter(const AS7XmlWriter&) = delete;
+  AS7XmlWriter& operator=(const AS7XmlWriter&) = delete;
+
+  /**
+   * @brief Writes the UTF-8 Byte Order Mark (BOM), shall be called before anything else
+   */
+  void write_bom();
+
+  /**
+   * @brief Writes the xml declaration : <?xml version="1.0" encoding="utf-8"?>
+   */
+  void write_declaration(const std::string& version = "1.0", const std::string& encoding = "utf-8");
+
+  /**
+   * @brief Opens a new element, which becomes the parent of subsequently written elements until end_element() is called.
+   * @param name : element name
+   */
+  void start_element(const std::string& name);
+
+  /**
+   * @brief Adds an attribute to the element which was just opened (before any content is written into it).
+   * @param name  : attribute name
+   * @param value : attribute value, escaped on the fly
+   */
+  void attribute(const std::string& name, const std::string& value);
+
+  /**
+   * @brief Closes the last opened element.
+   */
+  void end_element();
+
+  /**
+   * @brief Writes a complete element holding a single text value : <name>value</name>.
+   * @param name  : element name
+   * @param value : element text value, escaped on the fly. An empty value produces an empty element <name />
+   */
+  void element(const std::string& name, const std::string& value = "");
+
+  /**
+   * @brief Closes the start tag of the last opened element : the content of this element can then be written
+   * separately, using another writer built with the level() of this one, and inserted at the current position.
+   */
+  void close_start_tag();
+
+  /**
+   * @brief returns the depth at which the next element would be written
+   */
+  std::size_t level() const;
+
+  /**
+   * @brief Escapes a string so that it can be used as an element text value or as an attribute value.
+   * @param value     : raw value
+   * @param attribute : escapes double quotes and line breaks as well (attribute value)
+   * @return escaped value
+   */
+  static std::string escape(const std::string& value, bool attribute = false);
+
+private:
+  /**
+   * @brief Writes the indentation of the next element, closing the start tag of its parent if need be
+   */
+  void start_line();
+
+  /**
+   * @brief Writes an escaped value to the output stream
+   */
+  void write_escaped(const std::string& value, bool attribute);
+
+  std::ostream& output;               /**< Output stream                                                 */
+  std::string indentation;            /**< Indentation string, written once per depth level              */
+  std::size_t base_level;             /**< Depth of the first elements written by this writer            */
+  std::vector<std::string> elements;  /**< Names of the opened elements                                  */
+  bool start_tag_opened = false;      /**< Start tag of the last opened element awaits its closing '>'   */
+};
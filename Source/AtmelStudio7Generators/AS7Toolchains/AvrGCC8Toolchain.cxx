@@ -26,7 +26,7 @@ along with this program.  If not, see <https://www.gnu.org/licenses/>.
 #include "cmAvrGccOptimizationOption.h"
 #include "cmStringUtils.h"
 
-#include "pugixml.hpp"
+#include "AS7XmlWriter.h"
 
 namespace AvrToolchain {
 
@@ -169,17 +169,12 @@ void AS7AvrGCC8::convert_from(const compiler::AbstractCompilerModel& compiler_mo
   // Note: do not clear the toolchain as it could have been partially configured by external code.
   // This method shall only override the part which is described in the compiler_model, nothing more.
 
-  // TODO : Use the device resolver to perform device deduction. note that the TargetedDevice code from TargetGenerator
-  // first has to be moved closer for this to be enabled. For now, default -mmcu handling is proposed
-
-  // This option is a bit special and requires dedicated handling
-  if (common.Device.empty()) {
-    if (compiler_model.has_option("-mmcu")) {
-      compiler::CompilerOption* opt = compiler_model.get_option("-mmcu");
-      auto option = dynamic_cast<compiler::MachineOption*>(opt);
-      common.Device = "-mmcu=" + option->value;
-    }
-    common.Device += " -B \"%24(PackRepoDir)\\atmel\\ATmega_DFP\\1.2.209\\gcc\\dev\\atmega328p\"";
+  // Device is usually resolved beforehand (using the installed packs, see AS7DeviceIndex) along with its device specs
+  // folder (-B option). Only the -mmcu option is known here, DFP folder cannot be guessed from it.
+  if (common.Device.empty() && compiler_model.has_option("-mmcu")) {
+    compiler::CompilerOption* opt = compiler_model.get_option("-mmcu");
+    auto option = static_cast<compiler::MachineOption*>(opt);
+    common.Device = "-mmcu=" + option->value;
   }
 
   common.relax_branches = compiler_model.has_option("-mrelax");
@@ -196,7 +191,7 @@ void AS7AvrGCC8::convert_from(const compiler::AbstractCompilerModel& compiler_mo
   {
     const auto& definitions = compiler_model.get_options(compiler::CompilerOption::Type::Definition);
     for (const auto& def : definitions) {
-      auto* def_ptr = dynamic_cast<compiler::DefinitionOption*>(def.get());
+      auto* def_ptr = static_cast<compiler::DefinitionOption*>(def.get());
       tool->symbols.def_symbols.push_back(def_ptr->generate(true));
     }
   }
@@ -211,8 +206,8 @@ void AS7AvrGCC8::convert_from(const compiler::AbstractCompilerModel& compiler_mo
                                            [](const compiler::cmAvrGccCompiler::ShrdOption& opt1,
                                               const compiler::cmAvrGccCompiler::ShrdOption& opt2)
                                               {
-                                                const auto* copt1 = dynamic_cast<compiler::OptimizationOption*>(opt1.get());
-                                                const auto* copt2 = dynamic_cast<compiler::OptimizationOption*>(opt2.get());
+                                                const auto* copt1 = static_cast<compiler::OptimizationOption*>(opt1.get());
+                                                const auto* copt2 = static_cast<compiler::OptimizationOption*>(opt2.get());
                                                 return  *copt1 < *copt2;
                                               });
 
@@ -305,102 +300,97 @@ void AS7AvrGCC8::convert_from(const compiler::AbstractCompilerModel& compiler_mo
   assembler.debugging.debug_level = compiler_model.has_option("-Wa,-g") ? "Default (-Wa,-g)" : "";
 }
 
-void xml_append_inline(pugi::xml_node& parent, const std::string& node_name, const std::string& value = "")
-{
-  pugi::xml_node node = parent.append_child(node_name.c_str());
-  if (0 != value.size()) {
-    pugi::xml_node child = node.append_child(pugi::node_pcdata);
-    child.set_value(value.c_str());
-  }
-}
-
-void AS7AvrGCC8::generate_xml_per_language(pugi::xml_node& parent, const std::string& toolname, const AS7AvrGcc8_Base& target) const
+void AS7AvrGCC8::generate_xml_per_language(AS7XmlWriter& writer, const std::string& toolname, const AS7AvrGcc8_Base& target) const
 {
-  xml_append_inline(parent, toolname + ".compiler.general.SubroutinesFunctionPrologues", target.general.subroutine_function_prologue ? "True" : "False");
-  xml_append_inline(parent, toolname + ".compiler.general.ChangeSPWithoutDisablingInterrupts", target.general.change_stack_pointer_without_disabling_interrupt ? "True" : "False");
-  xml_append_inline(parent, toolname + ".compiler.general.ChangeDefaultCharTypeUnsigned", target.general.change_default_chartype_unsigned ? "True" : "False");
-  xml_append_inline(parent, toolname + ".compiler.general.ChangeDefaultBitFieldUnsigned", target.general.change_default_bitfield_unsigned ? "True" : "False");
+  writer.element(toolname + ".compiler.general.SubroutinesFunctionPrologues", target.general.subroutine_function_prologue ? "True" : "False");
+  writer.element(toolname + ".compiler.general.ChangeSPWithoutDisablingInterrupts", target.general.change_stack_pointer_without_disabling_interrupt ? "True" : "False");
+  writer.element(toolname + ".compiler.general.ChangeDefaultCharTypeUnsigned", target.general.change_default_chartype_unsigned ? "True" : "False");
+  writer.element(toolname + ".compiler.general.ChangeDefaultBitFieldUnsigned", target.general.change_default_bitfield_unsigned ? "True" : "False");
 
-  xml_append_inline(parent, toolname + ".compiler.preprocessor.DoNotSearchSystemDirectories", target.preprocessor.do_not_search_system_directories ? "True" : "False");
-  xml_append_inline(parent, toolname + ".compiler.preprocessor.PreprocessOnly", target.preprocessor.preprocess_only ? "True" : "False");
+  writer.element(toolname + ".compiler.preprocessor.DoNotSearchSystemDirectories", target.preprocessor.do_not_search_system_directories ? "True" : "False");
+  writer.element(toolname + ".compiler.preprocessor.PreprocessOnly", target.preprocessor.preprocess_only ? "True" : "False");
 
   // Symbols definition
   if (!target.symbols.def_symbols.empty()) {
-    pugi::xml_node defsymbols_node = parent.append_child((toolname + ".compiler.symbols.DefSymbols").c_str());
-    pugi::xml_node list_values_node = defsymbols_node.append_child("ListValues");
+    writer.start_element(toolname + ".compiler.symbols.DefSymbols");
+    writer.start_element("ListValues");
     for (const auto& symbol : target.symbols.def_symbols) {
-      xml_append_inline(list_values_node, "Value", symbol);
+      writer.element("Value", symbol);
     }
+    writer.end_element();
+    writer.end_element();
   }
 
   // Include directories definition
   if (!target.directories.include_paths.empty()) {
-    pugi::xml_node include_path_node = parent.append_child((toolname + ".compiler.directories.IncludePaths").c_str());
-    pugi::xml_node list_values_node = include_path_node.append_child("ListValues");
+    writer.start_element(toolname + ".compiler.directories.IncludePaths");
+    writer.start_element("ListValues");
     for (const auto& include : target.directories.include_paths) {
-      xml_append_inline(list_values_node, "Value", include);
+      writer.element("Value", include);
     }
+    writer.end_element();
+    writer.end_element();
   }
 
   // Optimizations and debug flags
-  xml_append_inline(parent, toolname + ".compiler.optimization.level", target.optimizations.level);
+  writer.element(toolname + ".compiler.optimization.level", target.optimizations.level);
   if (!target.optimizations.other_flags.empty()) {
     std::string other_flags = cmutils::strings::trim(target.optimizations.other_flags, ' ', cmutils::strings::TransformLocation::Both);
-    xml_append_inline(parent, toolname + ".compiler.optimization.OtherFlags", other_flags);
+    writer.element(toolname + ".compiler.optimization.OtherFlags", other_flags);
   }
 
-  xml_append_inline(parent, toolname + ".compiler.optimization.PrepareFunctionsForGarbageCollection", target.optimizations.prepare_function_for_garbage_collection ? "True" : "False");
-  xml_append_inline(parent, toolname + ".compiler.optimization.PrepareDataForGarbageCollection", target.optimizations.prepare_data_for_garbage_collection ? "True" : "False");
-  xml_append_inline(parent, toolname + ".compiler.optimization.PackStructureMembers", target.optimizations.pack_structure_members ? "True" : "False");
-  xml_append_inline(parent, toolname + ".compiler.optimization.AllocateBytesNeededForEnum", target.optimizations.allocate_bytes_needed_for_enum ? "True" : "False");
-  xml_append_inline(parent, toolname + ".compiler.optimization.UseShortCalls", target.optimizations.use_short_calls ? "True" : "False");
-  xml_append_inline(parent, toolname + ".compiler.optimization.DebugLevel", target.optimizations.debug_level);
+  writer.element(toolname + ".compiler.optimization.PrepareFunctionsForGarbageCollection", target.optimizations.prepare_function_for_garbage_collection ? "True" : "False");
+  writer.element(toolname + ".compiler.optimization.PrepareDataForGarbageCollection", target.optimizations.prepare_data_for_garbage_collection ? "True" : "False");
+  writer.element(toolname + ".compiler.optimization.PackStructureMembers", target.optimizations.pack_structure_members ? "True" : "False");
+  writer.element(toolname + ".compiler.optimization.AllocateBytesNeededForEnum", target.optimizations.allocate_bytes_needed_for_enum ? "True" : "False");
+  writer.element(toolname + ".compiler.optimization.UseShortCalls", target.optimizations.use_short_calls ? "True" : "False");
+  writer.element(toolname + ".compiler.optimization.DebugLevel", target.optimizations.debug_level);
 
   if (!target.optimizations.other_debugging_flags.empty()) {
     std::string other_flags = cmutils::strings::trim(target.optimizations.other_debugging_flags, ' ', cmutils::strings::TransformLocation::Both);
-    xml_append_inline(parent, toolname + ".compiler.optimization.OtherDebuggingFlags", other_flags);
+    writer.element(toolname + ".compiler.optimization.OtherDebuggingFlags", other_flags);
   }
 
   // Warnings
-  xml_append_inline(parent, toolname + ".compiler.warnings.AllWarnings", target.warnings.all_warnings ? "True" : "False");
+  writer.element(toolname + ".compiler.warnings.AllWarnings", target.warnings.all_warnings ? "True" : "False");
 
   // Note : only avrgcc supports -Wextra in AtmelStudio7 ...
   if (toolname == "avrgcc") {
-    xml_append_inline(parent, toolname + ".compiler.warnings.ExtraWarnings", target.warnings.extra_warnings ? "True" : "False");
+    writer.element(toolname + ".compiler.warnings.ExtraWarnings", target.warnings.extra_warnings ? "True" : "False");
   }
-  xml_append_inline(parent, toolname + ".compiler.warnings.Undefined", target.warnings.undefined ? "True" : "False");
-  xml_append_inline(parent, toolname + ".compiler.warnings.WarningsAsErrors", target.warnings.warnings_as_error ? "True" : "False");
-  xml_append_inline(parent, toolname + ".compiler.warnings.CheckSyntaxOnly", target.warnings.check_syntax_only ? "True" : "False");
-  xml_append_inline(parent, toolname + ".compiler.warnings.Pedantic", target.warnings.pedantic ? "True" : "False");
-  xml_append_inline(parent, toolname + ".compiler.warnings.PedanticWarningsAsErrors", target.warnings.pedantic_warnings_as_errors ? "True" : "False");
-  xml_append_inline(parent, toolname + ".compiler.warnings.InhibitAllWarnings", target.warnings.inhibit_all_warnings ? "True" : "False");
+  writer.element(toolname + ".compiler.warnings.Undefined", target.warnings.undefined ? "True" : "False");
+  writer.element(toolname + ".compiler.warnings.WarningsAsErrors", target.warnings.warnings_as_error ? "True" : "False");
+  writer.element(toolname + ".compiler.warnings.CheckSyntaxOnly", target.warnings.check_syntax_only ? "True" : "False");
+  writer.element(toolname + ".compiler.warnings.Pedantic", target.warnings.pedantic ? "True" : "False");
+  writer.element(toolname + ".compiler.warnings.PedanticWarningsAsErrors", target.warnings.pedantic_warnings_as_errors ? "True" : "False");
+  writer.element(toolname + ".compiler.warnings.InhibitAllWarnings", target.warnings.inhibit_all_warnings ? "True" : "False");
 
   // Miscellaneous flags
   if (!target.miscellaneous.other_flags.empty()) {
     std::string other_flags = cmutils::strings::trim(target.miscellaneous.other_flags, ' ', cmutils::strings::TransformLocation::Both);
-    xml_append_inline(parent, toolname + ".compiler.miscellaneous.OtherFlags", other_flags);
+    writer.element(toolname + ".compiler.miscellaneous.OtherFlags", other_flags);
   }
 
-  xml_append_inline(parent, toolname + ".compiler.miscellaneous.Verbose", target.miscellaneous.verbose ? "True" : "False");
-  xml_append_inline(parent, toolname + ".compiler.miscellaneous.SupportAnsiPrograms", target.miscellaneous.support_ansi_programs ? "True" : "False");
-  xml_append_inline(parent, toolname + ".compiler.miscellaneous.DoNotDeleteTemporaryFiles", target.miscellaneous.do_not_delete_temporary_files ? "True" : "False");
+  writer.element(toolname + ".compiler.miscellaneous.Verbose", target.miscellaneous.verbose ? "True" : "False");
+  writer.element(toolname + ".compiler.miscellaneous.SupportAnsiPrograms", target.miscellaneous.support_ansi_programs ? "True" : "False");
+  writer.element(toolname + ".compiler.miscellaneous.DoNotDeleteTemporaryFiles", target.miscellaneous.do_not_delete_temporary_files ? "True" : "False");
 }
 
-void AS7AvrGCC8::generate_xml(pugi::xml_node& parent, const std::string& lang) const
+void AS7AvrGCC8::generate_xml(AS7XmlWriter& writer, const std::string& lang) const
 {
-  xml_append_inline(parent, "avrgcc.common.Device", common.Device);
-  xml_append_inline(parent, "avrgcc.common.optimization.RelaxBranches", common.relax_branches ? "True" : "False");
-  xml_append_inline(parent, "avrgcc.common.ExternalRamMemOvflw.", common.external_ram_mem_ovflw ? "True" : "False");
-  xml_append_inline(parent, "avrgcc.common.outputfiles.hex", common.outputfiles.hex ? "True" : "False");
-  xml_append_inline(parent, "avrgcc.common.outputfiles.lss", common.outputfiles.lss ? "True" : "False");
-  xml_append_inline(parent, "avrgcc.common.outputfiles.eep", common.outputfiles.eep ? "True" : "False");
-  xml_append_inline(parent, "avrgcc.common.outputfiles.srec", common.outputfiles.srec ? "True" : "False");
-  xml_append_inline(parent, "avrgcc.common.outputfiles.usersignatures", common.outputfiles.usersignatures ? "True" : "False");
-
-  generate_xml_per_language(parent, "avrgcc", avrgcc);
+  writer.element("avrgcc.common.Device", common.Device);
+  writer.element("avrgcc.common.optimization.RelaxBranches", common.relax_branches ? "True" : "False");
+  writer.element("avrgcc.common.ExternalRamMemOvflw.", common.external_ram_mem_ovflw ? "True" : "False");
+  writer.element("avrgcc.common.outputfiles.hex", common.outputfiles.hex ? "True" : "False");
+  writer.element("avrgcc.common.outputfiles.lss", common.outputfiles.lss ? "True" : "False");
+  writer.element("avrgcc.common.outputfiles.eep", common.outputfiles.eep ? "True" : "False");
+  writer.element("avrgcc.common.outputfiles.srec", common.outputfiles.srec ? "True" : "False");
+  writer.element("avrgcc.common.outputfiles.usersignatures", common.outputfiles.usersignatures ? "True" : "False");
+
+  generate_xml_per_language(writer, "avrgcc", avrgcc);
   std::string linker_ref = "avrgcc";
   if (lang != "C") {
-    generate_xml_per_language(parent, "avrgcccpp", avrgcccpp);
+    generate_xml_per_language(writer, "avrgcccpp", avrgcccpp);
     // Weird thing from AtmelStudio side, linker parameters use the last compiler name ...
     linker_ref = "avrgcccpp";
   }
@@ -408,61 +398,277 @@ void AS7AvrGCC8::generate_xml(pugi::xml_node& parent, const std::string& lang) c
   ////////////////////////////// Linker //////////////////////////////
 
   // Linker general informations
-  xml_append_inline(parent, linker_ref + ".linker.general.DoNotUseStandardStartFiles", linker.general.do_not_use_standard_start_file ? "True" : "False");
-  xml_append_inline(parent, linker_ref + ".linker.general.DoNotUseDefaultLibraries", linker.general.do_not_use_default_libraries ? "True" : "False");
-  xml_append_inline(parent, linker_ref + ".linker.general.NoStartupOrDefaultLibs", linker.general.no_startup_or_default_libs ? "True" : "False");
-  xml_append_inline(parent, linker_ref + ".linker.general.OmitAllSymbolInformation", linker.general.omit_all_symbol_information ? "True" : "False");
-  xml_append_inline(parent, linker_ref + ".linker.general.NoSharedLibraries", linker.general.no_shared_libraries ? "True" : "False");
+  writer.element(linker_ref + ".linker.general.DoNotUseStandardStartFiles", linker.general.do_not_use_standard_start_file ? "True" : "False");
+  writer.element(linker_ref + ".linker.general.DoNotUseDefaultLibraries", linker.general.do_not_use_default_libraries ? "True" : "False");
+  writer.element(linker_ref + ".linker.general.NoStartupOrDefaultLibs", linker.general.no_startup_or_default_libs ? "True" : "False");
+  writer.element(linker_ref + ".linker.general.OmitAllSymbolInformation", linker.general.omit_all_symbol_information ? "True" : "False");
+  writer.element(linker_ref + ".linker.general.NoSharedLibraries", linker.general.no_shared_libraries ? "True" : "False");
 
   // This one is some kind of a bug from Atmel Studio : only avrgcc can get this option mapped to!
-  xml_append_inline(parent, "avrgcc.linker.general.GenerateMAPFile", linker.general.generate_map_file ? "True" : "False");
-  xml_append_inline(parent, linker_ref + ".linker.general.UseVprintfLibrary", linker.general.use_vprintf_library ? "True" : "False");
+  writer.element("avrgcc.linker.general.GenerateMAPFile", linker.general.generate_map_file ? "True" : "False");
+  writer.element(linker_ref + ".linker.general.UseVprintfLibrary", linker.general.use_vprintf_library ? "True" : "False");
 
   // Link libraries
   if (!linker.libraries.libraries.empty()) {
-    pugi::xml_node link_libraries_node = parent.append_child((linker_ref + ".linker.libraries.Libraries").c_str());
-    pugi::xml_node list_values_node = link_libraries_node.append_child("ListValues");
+    writer.start_element(linker_ref + ".linker.libraries.Libraries");
+    writer.start_element("ListValues");
     for (const auto& lib : linker.libraries.libraries) {
-      xml_append_inline(list_values_node, "Value", lib);
+      writer.element("Value", lib);
     }
+    writer.end_element();
+    writer.end_element();
   }
 
   // Link libraries search path
   if (!linker.libraries.search_path.empty()) {
-    pugi::xml_node link_libraries_search_path_node = parent.append_child((linker_ref + ".linker.libraries.LibrarySearchPaths").c_str());
-    pugi::xml_node list_values_node = link_libraries_search_path_node.append_child("ListValues");
+    writer.start_element(linker_ref + ".linker.libraries.LibrarySearchPaths");
+    writer.start_element("ListValues");
     for (const auto& lib : linker.libraries.search_path) {
-      xml_append_inline(list_values_node, "Value", lib);
+      writer.element("Value", lib);
     }
+    writer.end_element();
+    writer.end_element();
   }
 
-  xml_append_inline(parent, linker_ref + ".linker.optimization.GarbageCollectUnusedSections", linker.optimizations.garbage_collect_unused_sections ? "True" : "False");
-  xml_append_inline(parent, linker_ref + ".linker.optimization.PutReadOnlyDataInWritableDataSection", linker.optimizations.put_read_only_data_in_writable_data_section ? "True" : "False");
+  writer.element(linker_ref + ".linker.optimization.GarbageCollectUnusedSections", linker.optimizations.garbage_collect_unused_sections ? "True" : "False");
+  writer.element(linker_ref + ".linker.optimization.PutReadOnlyDataInWritableDataSection", linker.optimizations.put_read_only_data_in_writable_data_section ? "True" : "False");
 
   if (!linker.miscellaneous.linker_flags.empty()) {
     std::string other_flags = cmutils::strings::trim(linker.miscellaneous.linker_flags, ' ', cmutils::strings::TransformLocation::Both);
-    xml_append_inline(parent, linker_ref + ".linker.miscellaneous.LinkerFlags", other_flags);
+    writer.element(linker_ref + ".linker.miscellaneous.LinkerFlags", other_flags);
   }
 
   ////////////////////////////// Assembler //////////////////////////////
   // Assembler include path
   if (!assembler.general.include_path.empty()) {
-    pugi::xml_node assembler_include_path_node = parent.append_child((linker_ref + ".assembler.general.IncludePaths").c_str());
-    pugi::xml_node list_values_node = assembler_include_path_node.append_child("ListValues");
+    writer.start_element(linker_ref + ".assembler.general.IncludePaths");
+    writer.start_element("ListValues");
     for (const auto& include : assembler.general.include_path) {
-      xml_append_inline(list_values_node, "Value", include);
+      writer.element("Value", include);
     }
+    writer.end_element();
+    writer.end_element();
   }
-  xml_append_inline(parent, linker_ref + ".assembler.general.AnounceVersion", assembler.general.anounce_version ? " True" : "False");
+  writer.element(linker_ref + ".assembler.general.AnounceVersion", assembler.general.anounce_version ? " True" : "False");
 
   if (!assembler.debugging.debug_level.empty()) {
-    xml_append_inline(parent, linker_ref + ".assembler.debugging.DebugLevel", assembler.debugging.debug_level);
+    writer.element(linker_ref + ".assembler.debugging.DebugLevel", assembler.debugging.debug_level);
   }
 
   // Archiver parameters
   if (archiver_flags != "-r") {
-    xml_append_inline(parent, linker_ref + ".archiver.general.ArchiverFlags", archiver_flags);
+    writer.element(linker_ref + ".archiver.general.ArchiverFlags", archiver_flags);
+  }
+}
+
+/**
+ * @brief Converts an Atmel Studio 7 option description back to its command line flag : the flag is written
+ * between parentheses (e.g. "Optimize more (-O2)" gives -O2). Descriptions without flag (e.g. "None") give an empty string.
+ */
+static std::string description_to_flag(const std::string& description)
+{
+  const std::size_t opening = description.rfind('(');
+  const std::size_t closing = description.rfind(')');
+  if (opening == std::string::npos || closing == std::string::npos || closing < opening) {
+    return "";
+  }
+  return description.substr(opening + 1, closing - opening - 1);
+}
+
+/**
+ * @brief Splits a space separated list of flags and appends them to the output, empty flags are dropped.
+ */
+static void append_flags(std::vector<std::string>& out, const std::string& flags)
+{
+  for (auto& flag : cmutils::strings::split(flags)) {
+    if (!flag.empty()) {
+      out.push_back(std::move(flag));
+    }
+  }
+}
+
+std::vector<std::string> AS7AvrGCC8::generate_device_flags() const
+{
+  // Device field is a small command line in its own right, which may hold quoted paths
+  std::vector<std::string> out;
+  std::string current;
+  bool quoted = false;
+  for (const char c : common.Device) {
+    if (c == '"') {
+      quoted = !quoted;
+    } else if (c == ' ' && !quoted) {
+      if (!current.empty()) {
+        out.push_back(current);
+        current.clear();
+      }
+    } else {
+      current += c;
+    }
+  }
+  if (!current.empty()) {
+    out.push_back(current);
+  }
+  return out;
+}
+
+std::vector<std::string> AS7AvrGCC8::generate_compile_flags(const std::string& lang) const
+{
+  const AS7AvrGcc8_Base& tool = (lang == "CXX") ? avrgcccpp : avrgcc;
+  std::vector<std::string> out;
+
+  if (tool.general.change_default_chartype_unsigned) {
+    out.emplace_back("-funsigned-char");
+  }
+  if (tool.general.change_default_bitfield_unsigned) {
+    out.emplace_back("-funsigned-bitfields");
+  }
+  if (tool.general.subroutine_function_prologue) {
+    out.emplace_back("-mcall-prologues");
+  }
+  if (tool.general.change_stack_pointer_without_disabling_interrupt) {
+    out.emplace_back("-mno-interrupts");
+  }
+
+  if (tool.preprocessor.do_not_search_system_directories) {
+    out.emplace_back("-nostdinc");
+  }
+  if (tool.preprocessor.preprocess_only) {
+    out.emplace_back("-E");
+  }
+
+  for (const auto& symbol : tool.symbols.def_symbols) {
+    out.push_back("-D" + symbol);
+  }
+  for (const auto& include : tool.directories.include_paths) {
+    out.push_back("-I" + include);
+  }
+
+  // Optimizations and debug flags
+  const std::string optimization_level = description_to_flag(tool.optimizations.level);
+  if (!optimization_level.empty()) {
+    out.push_back(optimization_level);
+  }
+  append_flags(out, tool.optimizations.other_flags);
+  if (tool.optimizations.prepare_function_for_garbage_collection) {
+    out.emplace_back("-ffunction-sections");
+  }
+  if (tool.optimizations.prepare_data_for_garbage_collection) {
+    out.emplace_back("-fdata-sections");
   }
+  if (tool.optimizations.pack_structure_members) {
+    out.emplace_back("-fpack-struct");
+  }
+  if (tool.optimizations.allocate_bytes_needed_for_enum) {
+    out.emplace_back("-fshort-enums");
+  }
+  if (tool.optimizations.use_short_calls) {
+    out.emplace_back("-mshort-calls");
+  }
+  if (common.relax_branches) {
+    out.emplace_back("-mrelax");
+  }
+  const std::string debug_level = description_to_flag(tool.optimizations.debug_level);
+  if (!debug_level.empty()) {
+    out.push_back(debug_level);
+  }
+  append_flags(out, tool.optimizations.other_debugging_flags);
+
+  // Warnings, note that only avrgcc supports -Wextra in AtmelStudio7 (see generate_xml_per_language())
+  if (tool.warnings.all_warnings) {
+    out.emplace_back("-Wall");
+  }
+  if (tool.warnings.extra_warnings && lang != "CXX") {
+    out.emplace_back("-Wextra");
+  }
+  if (tool.warnings.undefined) {
+    out.emplace_back("-Wundef");
+  }
+  if (tool.warnings.warnings_as_error) {
+    out.emplace_back("-Werror");
+  }
+  if (tool.warnings.check_syntax_only) {
+    out.emplace_back("-fsyntax-only");
+  }
+  if (tool.warnings.pedantic) {
+    out.emplace_back("-pedantic");
+  }
+  if (tool.warnings.pedantic_warnings_as_errors) {
+    out.emplace_back("-pedantic-errors");
+  }
+  if (tool.warnings.inhibit_all_warnings) {
+    out.emplace_back("-w");
+  }
+
+  // Device selection comes before miscellaneous flags, as in Atmel Studio 7 generated makefiles
+  std::vector<std::string> device = generate_device_flags();
+  out.insert(out.end(), device.begin(), device.end());
+
+  append_flags(out, tool.miscellaneous.other_flags);
+  if (tool.miscellaneous.verbose) {
+    out.emplace_back("-v");
+  }
+  if (tool.miscellaneous.support_ansi_programs) {
+    out.emplace_back("-ansi");
+  }
+  if (tool.miscellaneous.do_not_delete_temporary_files) {
+    out.emplace_back("-save-temps");
+  }
+
+  return out;
+}
+
+std::vector<std::string> AS7AvrGCC8::generate_link_flags(const std::string& map_file) const
+{
+  std::vector<std::string> out;
+
+  if (linker.general.generate_map_file && !map_file.empty()) {
+    out.push_back("-Wl,-Map=" + map_file);
+  }
+
+  // Libraries are given using their project name, or their file name for system ones (e.g. libm gives -lm)
+  out.emplace_back("-Wl,--start-group");
+  for (const auto& lib : linker.libraries.libraries) {
+    const bool has_prefix = lib.compare(0, 3, "lib") == 0 && lib.size() > 3;
+    out.push_back("-Wl,-l" + (has_prefix ? lib.substr(3) : lib));
+  }
+  out.emplace_back("-Wl,--end-group");
+  for (const auto& path : linker.libraries.search_path) {
+    out.push_back("-L" + path);
+  }
+
+  if (linker.general.do_not_use_standard_start_file) {
+    out.emplace_back("-nostartfiles");
+  }
+  if (linker.general.do_not_use_default_libraries) {
+    out.emplace_back("-nodefaultlibs");
+  }
+  if (linker.general.no_startup_or_default_libs) {
+    out.emplace_back("-nostdlib");
+  }
+  if (linker.general.omit_all_symbol_information) {
+    out.emplace_back("-Wl,-s");
+  }
+  if (linker.general.no_shared_libraries) {
+    out.emplace_back("-Wl,-static");
+  }
+  if (linker.general.use_vprintf_library) {
+    out.emplace_back("-Wl,-u,vprintf");
+  }
+  if (linker.optimizations.garbage_collect_unused_sections) {
+    out.emplace_back("-Wl,--gc-sections");
+  }
+  if (linker.optimizations.put_read_only_data_in_writable_data_section) {
+    out.emplace_back("-Wl,--rodata-writable");
+  }
+  if (common.relax_branches) {
+    out.emplace_back("-mrelax");
+  }
+
+  std::vector<std::string> device = generate_device_flags();
+  out.insert(out.end(), device.begin(), device.end());
+
+  append_flags(out, linker.miscellaneous.linker_flags);
+  return out;
 }
 
 void Common::clear()
@@ -23,9 +23,7 @@ namespace compiler {
   class AbstractCompilerModel;
 }
 
-namespace pugi {
-  class xml_node;
-}
+class AS7XmlWriter;
 
 namespace AvrToolchain {
 
@@ -375,10 +373,30 @@ struct AS7AvrGCC8
    *  C     | ASM and C
    *  ASM   | only ASM
    *
-   * @param parent  : parent xml node
+   * @param writer  : xml writer, options are written as children of its current element
    * @param lang    : the highest level language selected.
    */
-  void generate_xml(pugi::xml_node& parent, const std::string& lang = "C") const;
+  void generate_xml(AS7XmlWriter& writer, const std::string& lang = "C") const;
+
+  /**
+   * @brief Generates the avr-gcc (C) or avr-g++ (CXX) flags used to compile a translation unit, the same way
+   * Atmel Studio 7 does when it builds the project : each option is converted back to its command line form
+   * (e.g. "Optimize more (-O2)" gives -O2) and options which are not set are omitted.
+   * Paths are left untouched (Atmel Studio 7 formalism, e.g. %24(PackRepoDir)\atmel\...).
+   *
+   * @param lang    : language of the translation unit (C or CXX)
+   * @return compiler flags, input and output files excluded
+   */
+  std::vector<std::string> generate_compile_flags(const std::string& lang = "C") const;
+
+  /**
+   * @brief Generates the flags given to avr-gcc to link an executable, the same way Atmel Studio 7 does.
+   * Libraries are linked in a group (-Wl,--start-group ... -Wl,--end-group) and found in the library search paths.
+   *
+   * @param map_file    : path to the map file, only used if the toolchain generates one
+   * @return linker flags, input and output files excluded
+   */
+  std::vector<std::string> generate_link_flags(const std::string& map_file = "") const;
 
   /**
    * @brief Clears memory and resets all options to their default state
@@ -390,11 +408,17 @@ private:
   /**
    * @brief selectively generates a language representation using the adequate node name (aka toolname).
    *
-   * @param parent      : parent xml node
+   * @param writer      : xml writer, options are written as children of its current element
    * @param toolname    : toolname used as the main "xml node". E.g : "C lang -> <AvrGcc> node, C++ lang -> <AvrGccCpp> node)
    * @param target      : targeted AvrGcc8_base structure to be serialized
    */
-  void generate_xml_per_language(pugi::xml_node& parent, const std::string& toolname, const AS7AvrGcc8_Base& target) const;
+  void generate_xml_per_language(AS7XmlWriter& writer, const std::string& toolname, const AS7AvrGcc8_Base& target) const;
+
+  /**
+   * @brief Generates the flags selecting the targeted device, out of the common Device field
+   * (e.g. -mmcu=atmega328p -B "%24(PackRepoDir)\atmel\ATmega_DFP\1.2.209\gcc\dev\atmega328p")
+   */
+  std::vector<std::string> generate_device_flags() const;
 
   /**
    * @brief Returns a list of unsupported options parsed from command line input for a particular
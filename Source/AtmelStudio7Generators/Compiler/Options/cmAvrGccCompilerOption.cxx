@@ -14,6 +14,7 @@ along with this program.  If not, see <https://www.gnu.org/licenses/>.
 */
 
 #include "cmAvrGccCompilerOption.h"
+#include "cmStringUtils.h"
 
 namespace compiler
 {
@@ -77,6 +78,21 @@ std::string CompilerOption::get_token() const
   return token;
 }
 
+std::string CompilerOption::get_name() const
+{
+  return token;
+}
+
+std::string CompilerOption::get_lookup_name(const std::string& input_token)
+{
+  // Concatenated options such as "-Wl,--gc-sections" are looked up using their second element
+  const auto split_result = cmutils::strings::split(input_token, ',');
+  if (split_result.size() >= 2) {
+    return split_result[1];
+  }
+  return input_token;
+}
+
 bool CompilerOption::contains(const std::string& input_token) const
 {
   return input_token == token;
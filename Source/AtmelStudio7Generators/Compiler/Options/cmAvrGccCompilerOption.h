@@ -17,6 +17,7 @@ along with this program.  If not, see <https://www.gnu.org/licenses/>.
 
 #include <memory>
 #include <string>
+#include <string_view>
 #include <unordered_map>
 #include <vector>
 
@@ -130,6 +131,22 @@ struct CompilerOption
   */
   std::string get_token() const;
 
+  /**
+   * @brief returns the name of this option, used as a lookup key by option storages.
+   * It defaults to the token itself (for instance, "-mmcu" for a "-mmcu=atmega328p" machine option), but
+   * some options might be recognized under a shorter form (e.g. linker options, see LinkerOption::get_name()).
+   * @return option name
+   */
+  virtual std::string get_name() const;
+
+  /**
+   * @brief computes the name under which an incoming token could be recognized by an option.
+   * This is the counterpart of get_name() for raw tokens : "-Wl,--gc-sections" gives "--gc-sections"
+   * @param token : a raw token
+   * @return lookup name of the token
+   */
+  static std::string get_lookup_name(const std::string& token);
+
   /**
    * @brief Cheks if incoming token is recognized by current option.
    *
@@ -153,6 +170,18 @@ protected:
 // A simple namespace will do it, no need for any object instantiation
 namespace CompilerOptionFactory {
 
+/**
+ * @brief Categorizes a raw token using the table of known avr-gcc flags.
+ * Known flags are resolved first (e.g. "-fsyntax-only" or "-pedantic"), then flags families
+ * are matched using their prefix (e.g. "-Wl," for linker options, "-W" for warnings).
+ *
+ * @param token : raw token parsed from command line input
+ * @param type  : deduced type of the option, only written when a match is found
+ * @return true  : token was categorized
+ *         false : token does not belong to any known flag or family of flags
+ */
+bool classify(const std::string& token, CompilerOption::Type& type);
+
 /**
  * @brief Checks if the given token can be categorized in any of the available
  * types of compiler options.
@@ -176,6 +205,27 @@ bool is_valid(const std::string& token);
  * real class using their embedded CompilerOption::Type information with a simple static_cast
  */
 std::vector<std::shared_ptr<CompilerOption>> create(const std::string& token);
+
+/**
+ * @brief Tells whether a raw token is an option followed by its argument as the next token,
+ * such as "-include" in "-include config.h" or "-Xlinker" in "-Xlinker --gc-sections".
+ * Options glued to their argument ("-DNAME", "-Iinclude") stand on their own.
+ *
+ * @param token : raw token parsed from command line input
+ * @param next  : raw token following it on the command line
+ * @return true  : next token is the argument of this option
+ *         false : both tokens stand on their own
+ */
+bool takes_separate_argument(std::string_view token, std::string_view next);
+
+/**
+ * @brief Removes duplicated flags wherever they are, keeping the first occurrence of each of them.
+ * An option taking its argument as the next token is compared along with that argument, so that
+ * "-include a.h -include b.h" or "-D A -D B" are kept as they are.
+ *
+ * @param tokens : raw tokens parsed from command line input, deduplicated in place
+ */
+void remove_duplicates(std::vector<std::string_view>& tokens);
 };
 
 }
@@ -92,7 +92,7 @@ std::pair<DebugOption::Level, AS7OptionRepresentation*> DebugOption::resolve(con
 
 std::pair<DebugOption::Level, AS7OptionRepresentation> DebugOption::get_default()
 {
-  auto& default_opt = available_options[Level::None];
+  auto& default_opt = available_options.at(Level::None);
   return {Level::None, default_opt};
 }
 
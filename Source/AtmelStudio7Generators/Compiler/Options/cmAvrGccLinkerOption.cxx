@@ -58,4 +58,9 @@ bool LinkerOption::contains(const std::string& input_token) const
   return split_option == naked_input_token;
 }
 
+std::string LinkerOption::get_name() const
+{
+  return get_lookup_name(this->token);
+}
+
 }
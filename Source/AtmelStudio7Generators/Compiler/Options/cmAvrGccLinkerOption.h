@@ -73,6 +73,13 @@ struct LinkerOption : public CompilerOption
    */
   virtual bool contains(const std::string& input_token) const override;
 
+  /**
+   * @brief returns the naked linker option name, as ld would consume it.
+   * For instance, "-Wl,--gc-sections" is named "--gc-sections".
+   * @return linker option name
+   */
+  virtual std::string get_name() const override;
+
 };
 
 }
@@ -66,7 +66,7 @@ OptimizationOption::Level OptimizationOption::get_level() const
 
 std::pair<OptimizationOption::Level, AS7OptionRepresentation> OptimizationOption::get_default()
 {
-  auto& default_opt = available_opt[Level::Os];
+  auto& default_opt = available_opt.at(Level::Os);
   return {Level::Os, default_opt};
 }
 
@@ -16,6 +16,11 @@ along with this program.  If not, see <https://www.gnu.org/licenses/>.
 #include "cmAvrGccCompiler.h"
 
 #include <algorithm>
+#include <iterator>
+#include <functional>
+#include <string_view>
+#include <unordered_set>
+#include <utility>
 
 #include "cmStringUtils.h"
 #include "cmAvrGccWarningOption.h"
@@ -28,94 +33,295 @@ along with this program.  If not, see <https://www.gnu.org/licenses/>.
 
 namespace compiler {
 
-bool CompilerOptionFactory::is_valid(const std::string& token)
+namespace {
+
+/**
+ * @brief Associates a flag (or a flag prefix) with the kind of CompilerOption it represents.
+ */
+struct FlagCategory
 {
-  if (token[0] != '-') {
-    return false;
+  std::string_view flag;       /**< Flag or flag prefix, as written on the command line */
+  CompilerOption::Type type;   /**< Kind of CompilerOption built from this flag          */
+};
+
+using Type = CompilerOption::Type;
+
+/**
+ * @brief Well known avr-gcc flags whose category cannot be deduced from their prefix alone.
+ * This table has to be kept sorted, as it is looked up using a binary search.
+ */
+constexpr FlagCategory known_flags[] = {
+  { "-E",                  Type::Generic },
+  { "-ansi",               Type::Generic },
+  { "-fsyntax-only",       Type::Warning },
+  { "-nodefaultlibs",      Type::Generic },
+  { "-nostartfiles",       Type::Generic },
+  { "-nostdinc",           Type::Generic },
+  { "-nostdlib",           Type::Generic },
+  { "-pedantic",           Type::Warning },
+  { "-pedantic-errors",    Type::Warning },
+  { "-pipe",               Type::Generic },
+  { "-save-temps",         Type::Generic },
+  { "-v",                  Type::Generic },
+  { "-w",                  Type::Warning },
+};
+
+/**
+ * @brief Families of flags, recognized by their prefix.
+ * Longest prefixes come first so that "-Wl," is not mistaken for a plain "-W" warning flag.
+ */
+constexpr FlagCategory known_prefixes[] = {
+  { "-std=",  Type::LanguageStandard },
+  { "-Wa,",   Type::Warning },
+  { "-Wl,",   Type::Linker },
+  { "-Wp,",   Type::Warning },
+  { "-D",     Type::Definition },
+  { "-E",     Type::Generic },
+  { "-O",     Type::Optimization },
+  { "-W",     Type::Warning },
+  { "-f",     Type::Generic },
+  { "-g",     Type::Debug },
+  { "-m",     Type::Machine },
+  { "-n",     Type::Generic },
+  { "-p",     Type::Generic },
+  { "-s",     Type::Generic },
+  { "-w",     Type::Generic },
+};
+
+template <std::size_t N>
+constexpr bool is_sorted(const FlagCategory (&table)[N])
+{
+  for (std::size_t i = 1; i < N; i++) {
+    if (!(table[i - 1].flag < table[i].flag)) {
+      return false;
+    }
   }
-
-  // FIXME : this is not really flexible and could (will) bring maintainability issues in the future.
-  // Better switch to another way of parsing options instead of their flag...
-  // Not to mention that some options (e.g. '-f..." flags) may belong to a category such as Linker options
-  // or Warning options, and the distinction is not present in their naming convention...
-  // One solution could be to store every known flag/option in maps alongside the right
-  // category (Linker, Optimization, Warnings, etc). Parsing might then be automated while comparing
-  // against existing option/flag within those maps, retrieving their categorization at the same time.
-
-  const std::string prefixes = "WfODgwEnmsp";
-  // Check if second character of token is part of the above characters list
-  return (prefixes.find(token[1]) != std::string::npos);
+  return true;
 }
 
-cmAvrGccCompiler::~cmAvrGccCompiler()
+/**
+ * @brief avr-gcc options which may take their argument as the next token (e.g. "-include config.h").
+ * This table has to be kept sorted, as it is looked up using a binary search.
+ */
+constexpr std::string_view separate_argument_flags[] = {
+  "--param",
+  "-D",
+  "-I",
+  "-L",
+  "-MF",
+  "-MQ",
+  "-MT",
+  "-T",
+  "-U",
+  "-Xassembler",
+  "-Xlinker",
+  "-Xpreprocessor",
+  "-aux-info",
+  "-e",
+  "-idirafter",
+  "-imacros",
+  "-imultilib",
+  "-include",
+  "-iprefix",
+  "-iquote",
+  "-isysroot",
+  "-isystem",
+  "-iwithprefix",
+  "-iwithprefixbefore",
+  "-l",
+  "-o",
+  "-u",
+  "-x",
+  "-z",
+};
+
+template <std::size_t N>
+constexpr bool is_sorted(const std::string_view (&table)[N])
 {
+  for (std::size_t i = 1; i < N; i++) {
+    if (!(table[i - 1] < table[i])) {
+      return false;
+    }
+  }
+  return true;
 }
 
-std::vector<std::shared_ptr<CompilerOption>> CompilerOptionFactory::create(const std::string& token)
+static_assert(is_sorted(known_flags), "known_flags table must be sorted for binary search to work");
+static_assert(is_sorted(separate_argument_flags), "separate_argument_flags table must be sorted for binary search to work");
+
+/**
+ * @brief An option along with its separate argument, if any.
+ */
+struct FlagUnit
 {
-  std::vector<std::shared_ptr<CompilerOption>> out;
-  if (!is_valid(token)) {
-    return out;
+  std::string_view flag;
+  std::string_view argument;
+
+  bool operator==(const FlagUnit& other) const
+  {
+    return flag == other.flag && argument == other.argument;
+  }
+};
+
+struct FlagUnitHash
+{
+  std::size_t operator()(const FlagUnit& unit) const
+  {
+    const std::hash<std::string_view> hash;
+    return hash(unit.flag) ^ (hash(unit.argument) * 31);
   }
+};
 
-  switch (token[1]) {
-    case 'O':
+/**
+ * @brief Instantiates options on the heap, each one of them owning its own control block.
+ */
+struct HeapAllocator
+{
+  template <typename T, typename... Args>
+  std::shared_ptr<CompilerOption> make(Args&&... args)
+  {
+    return std::make_shared<T>(std::forward<Args>(args)...);
+  }
+};
+
+/**
+ * @brief Builds the option(s) matching an already classified token, and hands each of them to the sink.
+ * @param token     : raw token parsed from command line input
+ * @param type      : category of the token, as given by CompilerOptionFactory::classify()
+ * @param allocator : provides the make<T>(args...) method used to instantiate options
+ * @param sink      : callable consuming each built option
+ */
+template <typename Allocator, typename Sink>
+void build_options(const std::string& token, const Type type, Allocator& allocator, Sink&& sink)
+{
+  switch (type) {
+    case Type::Optimization:
       if (OptimizationOption::can_create(token)) {
-        out.push_back(std::make_shared<OptimizationOption>(token));
+        sink(allocator.template make<OptimizationOption>(token));
       }
       break;
 
-    // Compile definitions
-    case 'D':
-      out.push_back(std::make_shared<DefinitionOption>(token));
+    case Type::Debug:
+      if (DebugOption::can_create(token)) {
+        sink(allocator.template make<DebugOption>(token));
+      }
       break;
 
-    // Debug flags
-    case 'g':
-      if (DebugOption::can_create(token)) {
-        out.push_back(std::make_shared<DebugOption>(token));
+    // Concatenated linker options such as "-Wl,--gc-sections,--relax" give several options
+    case Type::Linker:
+      for (const auto& elem : LinkerOption::split_concatenated_options(token)) {
+        sink(allocator.template make<LinkerOption>(elem));
       }
       break;
 
+    case Type::Definition:
+      sink(allocator.template make<DefinitionOption>(token));
+      break;
 
-    // Warning flags or linker flags (this is resolved with the help of the next character)
-    case 'W':
-    case 'p':
-      if (token[2] == 'l') {
-        const auto& split_tokens = LinkerOption::split_concatenated_options(token);
-        for (auto& elem : split_tokens) {
-          out.push_back(std::make_shared<LinkerOption>(elem));
-        }
-      }
-      else
-      {
-        out.push_back(std::make_shared<WarningOption>(token));
-      }
+    case Type::Warning:
+      sink(allocator.template make<WarningOption>(token));
       break;
 
-    // Machine-dependent options
-    case 'm':
-      out.push_back(std::make_shared<MachineOption>(token));
+    case Type::Machine:
+      sink(allocator.template make<MachineOption>(token));
       break;
 
-    // Language standard
-    case 's':
-      if (token.find("-std") != std::string::npos)
-      {
-        out.push_back(std::make_shared<LanguageStandardOption>(token));
-      }
+    case Type::LanguageStandard:
+      sink(allocator.template make<LanguageStandardOption>(token));
       break;
 
-    // Generic, normal flags
-    case 'f':
-    case 'w':
-    case 'n':
+    case Type::Generic:
     default:
-      out.push_back(std::make_shared<CompilerOption>(CompilerOption::Type::Generic, token));
+      sink(allocator.template make<CompilerOption>(Type::Generic, token));
       break;
+  }
+}
+
+}
+
+bool CompilerOptionFactory::classify(const std::string& token, CompilerOption::Type& type)
+{
+  const std::string_view flag(token);
+  const auto found_flag = std::lower_bound(std::begin(known_flags), std::end(known_flags), flag,
+                                           [](const FlagCategory& entry, std::string_view value)
+                                           {
+                                             return entry.flag < value;
+                                           });
+  if (found_flag != std::end(known_flags) && found_flag->flag == flag) {
+    type = found_flag->type;
+    return true;
+  }
+
+  for (const auto& family : known_prefixes) {
+    if (flag.compare(0, family.flag.size(), family.flag) == 0) {
+      type = family.type;
+      return true;
+    }
+  }
+  return false;
+}
+
+bool CompilerOptionFactory::is_valid(const std::string& token)
+{
+  CompilerOption::Type type;
+  if (!classify(token, type)) {
+    return false;
+  }
+
+  // Optimization and debug levels are only valid if they are known by their respective option
+  switch (type) {
+    case CompilerOption::Type::Optimization:
+      return OptimizationOption::can_create(token);
+    case CompilerOption::Type::Debug:
+      return DebugOption::can_create(token);
+    default:
+      return true;
+  }
+}
 
+bool CompilerOptionFactory::takes_separate_argument(std::string_view token, std::string_view next)
+{
+  if (next.empty()) {
+    return false;
   }
+  return std::binary_search(std::begin(separate_argument_flags), std::end(separate_argument_flags), token);
+}
 
+void CompilerOptionFactory::remove_duplicates(std::vector<std::string_view>& tokens)
+{
+  std::unordered_set<FlagUnit, FlagUnitHash> seen;
+  seen.reserve(tokens.size());
+  std::size_t kept = 0;
+  std::size_t i = 0;
+  while (i < tokens.size()) {
+    const bool has_argument = (i + 1 < tokens.size()) && takes_separate_argument(tokens[i], tokens[i + 1]);
+    const std::size_t length = has_argument ? 2 : 1;
+    if (seen.insert(FlagUnit{ tokens[i], has_argument ? tokens[i + 1] : std::string_view() }).second) {
+      for (std::size_t j = 0; j < length; j++) {
+        tokens[kept++] = tokens[i + j];
+      }
+    }
+    i += length;
+  }
+  tokens.resize(kept);
+}
+
+cmAvrGccCompiler::~cmAvrGccCompiler()
+{
+}
+
+std::vector<std::shared_ptr<CompilerOption>> CompilerOptionFactory::create(const std::string& token)
+{
+  std::vector<std::shared_ptr<CompilerOption>> out;
+  CompilerOption::Type type;
+  if (!classify(token, type)) {
+    return out;
+  }
+
+  HeapAllocator allocator;
+  build_options(token, type, allocator, [&out](std::shared_ptr<CompilerOption>&& option) {
+    out.push_back(std::move(option));
+  });
   return out;
 }
 
@@ -155,23 +361,32 @@ std::vector<std::string> cmAvrGccCompiler::get_all_options(const CompilerOption:
 
 void cmAvrGccCompiler::parse_flags(const std::vector<std::string>& tokens)
 {
+  ArenaAllocator allocator{ arena };
   for (const auto& token : tokens)
   {
-    if (compiler::CompilerOptionFactory::is_valid(token))
+    CompilerOption::Type type;
+    if (compiler::CompilerOptionFactory::classify(token, type))
     {
-      std::vector<ShrdOption> option_list = compiler::CompilerOptionFactory::create(token);
-      for (auto& option : option_list)
-      {
+      build_options(token, type, allocator, [this](ShrdOption&& option) {
         this->options.accept_option(option);
-      }
+      });
     }
   }
 }
 
 void cmAvrGccCompiler::Options::push_option(const ShrdOption& option, OptionsVec& vec)
 {
-  if (!contains(option->get_token(), vec)) {
+  // Options are always pushed in the storage vector matching their type, so the uniqueness check
+  // can rely on indexes restricted to that type instead of walking the whole vector.
+  const CompilerOption::Type type = option->get_type();
+  const bool is_storage_vector = (&vec == &storage[type]);
+  const bool already_stored = is_storage_vector ? (find(option->get_token(), &type) != nullptr)
+                                                : contains(option->get_token(), vec);
+  if (!already_stored) {
     vec.push_back(option);
+    if (is_storage_vector) {
+      index_option(option);
+    }
   }
 }
 
@@ -210,11 +425,16 @@ bool cmAvrGccCompiler::has_option(const std::string& option) const
 void cmAvrGccCompiler::Options::clear()
 {
   storage.clear();
+  tokens.clear();
+  names.clear();
 }
 
 void cmAvrGccCompiler::clear()
 {
   options.clear();
+
+  // Options still referenced elsewhere keep the previous arena alive
+  arena = std::make_shared<OptionsArena>();
 }
 
 cmAvrGccCompiler::Options::Options()
@@ -232,13 +452,7 @@ cmAvrGccCompiler::Options::Options()
 
 bool cmAvrGccCompiler::Options::contains(const std::string& token) const
 {
-  for (const auto& vec : storage )
-  {
-    if (contains(token, vec.second)){
-      return true;
-    }
-  }
-  return false;
+  return (find(token) != nullptr);
 }
 
 bool cmAvrGccCompiler::Options::contains(const std::string& token, const OptionsVec& reference) const
@@ -254,16 +468,45 @@ bool cmAvrGccCompiler::Options::contains(const std::string& token, const Options
 
 cmAvrGccCompiler::ShrdOption cmAvrGccCompiler::Options::get_option(const std::string& token) const
 {
-  ShrdOption out;
-  for (const auto& vect : storage)
+  auto found_item = tokens.find(token);
+  if (found_item != tokens.end())
   {
-    out = get_option(token, vect.second);
-    if (out != nullptr)
+    return found_item->second;
+  }
+  return nullptr;
+}
+
+cmAvrGccCompiler::ShrdOption cmAvrGccCompiler::Options::find(const std::string& token, const CompilerOption::Type* type) const
+{
+  auto accepts = [&token, type](const ShrdOption& target)
+  {
+    return (type == nullptr || target->get_type() == *type) && target->contains(token);
+  };
+
+  auto exact_range = tokens.equal_range(token);
+  for (auto it = exact_range.first; it != exact_range.second; ++it)
+  {
+    if (accepts(it->second))
     {
-      break;
+      return it->second;
     }
   }
-  return out;
+
+  auto named_range = names.equal_range(CompilerOption::get_lookup_name(token));
+  for (auto it = named_range.first; it != named_range.second; ++it)
+  {
+    if (accepts(it->second))
+    {
+      return it->second;
+    }
+  }
+  return nullptr;
+}
+
+void cmAvrGccCompiler::Options::index_option(const ShrdOption& option)
+{
+  tokens.emplace(option->get_token(), option);
+  names.emplace(option->get_name(), option);
 }
 
 cmAvrGccCompiler::ShrdOption cmAvrGccCompiler::Options::get_option(const std::string& token, const OptionsVec& vect) const
@@ -15,11 +15,21 @@ along with this program.  If not, see <https://www.gnu.org/licenses/>.
 
 #pragma once
 
+#include <deque>
 #include <string>
+#include <tuple>
+#include <utility>
 #include <vector>
 #include <memory>
 #include <unordered_map>
 #include "cmAvrGccCompilerOption.h"
+#include "cmAvrGccDebugOption.h"
+#include "cmAvrGccDefinitionOption.h"
+#include "cmAvrGccLanguageStandardOption.h"
+#include "cmAvrGccLinkerOption.h"
+#include "cmAvrGccMachineOption.h"
+#include "cmAvrGccOptimizationOption.h"
+#include "cmAvrGccWarningOption.h"
 #include "AbstractCompilerModel.h"
 
 namespace compiler
@@ -122,6 +132,49 @@ public:
 
 private:
 
+    /**
+     * @brief Owns every option built by this compiler model while parsing flags.
+     * Options of the same kind are stored next to each other (in chunks) and handed out as shared_ptr aliasing
+     * the arena itself : building an option does not allocate a dedicated control block, and stored options
+     * remain valid for as long as they are referenced, even after clear() was called.
+     */
+    struct OptionsArena
+    {
+        template <typename T>
+        using Pool = std::deque<T>;
+
+        std::tuple<Pool<CompilerOption>,
+                   Pool<OptimizationOption>,
+                   Pool<DebugOption>,
+                   Pool<WarningOption>,
+                   Pool<LinkerOption>,
+                   Pool<DefinitionOption>,
+                   Pool<MachineOption>,
+                   Pool<LanguageStandardOption>> pools; /**< One pool per concrete kind of option */
+    };
+
+    /**
+     * @brief Instantiates options within an arena.
+     */
+    struct ArenaAllocator
+    {
+        /**
+         * @brief Builds a new option of type T in the arena.
+         * @param args : arguments forwarded to T's constructor
+         * @return shared_ptr to the new option, sharing ownership of the whole arena
+         */
+        template <typename T, typename... Args>
+        ShrdOption make(Args&&... args)
+        {
+            T& option = std::get<OptionsArena::Pool<T>>(arena->pools).emplace_back(std::forward<Args>(args)...);
+            return ShrdOption(arena, &option);
+        }
+
+        std::shared_ptr<OptionsArena> arena; /**< Arena in which options are built */
+    };
+
+    std::shared_ptr<OptionsArena> arena = std::make_shared<OptionsArena>(); /**< Storage of every option parsed so far */
+
     /**
      * @brief Packs all tools to manipulate stored options.
      */
@@ -209,6 +262,28 @@ private:
         void clear();
 
         std::unordered_map<CompilerOption::Type, OptionsVec> storage; /**< Stores multiple vectors of options of different kinds within a single map*/
+
+    private:
+        /**
+         * @brief Looks up indexes to find the first stored option which recognizes given token.
+         * Exact token matches are resolved first, then options are searched by name (e.g. "-mmcu" or "--gc-sections"),
+         * each candidate having the final word through its CompilerOption::contains() method.
+         *
+         * @param token : raw token used as a key
+         * @param type  : if not null, restricts the search to options of this kind
+         * @return non-empty shared_ptr<CompilerOption*> : a matching item was found
+         *         empty shared_ptr<CompilerOption*> (==nullptr) : no match
+         */
+        ShrdOption find(const std::string& token, const CompilerOption::Type* type = nullptr) const;
+
+        /**
+         * @brief Registers a freshly stored option in lookup indexes.
+         * @param option : option to be indexed
+         */
+        void index_option(const ShrdOption& option);
+
+        std::unordered_multimap<std::string, ShrdOption> tokens;  /**< Indexes stored options using their raw token                           */
+        std::unordered_multimap<std::string, ShrdOption> names;   /**< Indexes stored options using their name (see CompilerOption::get_name())  */
     } options;
 };
 
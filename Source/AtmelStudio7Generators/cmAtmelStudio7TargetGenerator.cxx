@@ -18,13 +18,18 @@ along with this program.  If not, see <https://www.gnu.org/licenses/>.
 #include <algorithm>
 #include <iterator>
 #include <set>
+#include <sstream>
 
 #include <cm/memory>
 #include <cm/string_view>
 #include <cm/vector>
 #include <cmext/algorithm>
 
+#include "cmsys/FStream.hxx"
+
+#include "cmAvrGccCompilerOption.h"
 #include "cmAvrGccMachineOption.h"
+#include "cmCryptoHash.h"
 #include "cmGeneratedFileStream.h"
 #include "cmGeneratorExpression.h"
 #include "cmGeneratorTarget.h"
@@ -36,10 +41,13 @@ along with this program.  If not, see <https://www.gnu.org/licenses/>.
 #include "cmStringAlgorithms.h"
 #include "cmStringUtils.h"
 #include "cmSystemTools.h"
+#include "cmValue.h"
+#include "cmVersion.h"
 
+#include "AS7DeviceIndex.h"
 #include "AS7DeviceResolver.h"
 #include "AS7ToolchainTranslator.h"
-#include "pugixml.hpp"
+#include "AS7XmlWriter.h"
 
 #define CMAKE_CHECK_BUILD_SYSTEM_TARGET "ZERO_CHECK"
 
@@ -55,6 +63,14 @@ cmAtmelStudio7TargetGenerator::cmAtmelStudio7TargetGenerator(
 {
   this->Configurations = this->Makefile->GetGeneratorConfigs(cmMakefile::ExcludeEmptyConfig);
   this->InSourceBuild = (this->Makefile->GetCurrentSourceDirectory() == this->Makefile->GetCurrentBinaryDirectory());
+
+  // Directory level flags do not depend on the language nor on the configuration, so they are only retrieved once
+  for (const BT<std::string>& definition : this->Makefile->GetCompileDefinitionsEntries()) {
+    this->DirectoryFlags.emplace_back(definition.Value);
+  }
+  for (const BT<std::string>& option : this->Makefile->GetCompileOptionsEntries()) {
+    this->DirectoryFlags.emplace_back(option.Value);
+  }
 }
 
 cmAtmelStudio7TargetGenerator::~cmAtmelStudio7TargetGenerator()
@@ -86,7 +102,22 @@ static AS7ProjectDescriptor::Type computeProjectFileExtension(cmGeneratorTarget
   return AS7ProjectDescriptor::Type::cproj;
 }
 
+struct cmAtmelStudio7TargetGenerator::PendingToolchain
+{
+  std::size_t Offset;                              /**< Position of the toolchain settings in the project skeleton */
+  std::size_t Level;                               /**< Depth of the toolchain settings elements                  */
+  std::string Configuration;                       /**< Build configuration                                       */
+  AvrToolchain::AS7ToolchainTranslator Translator; /**< Snapshot of the translator of the configuration          */
+};
+
 void cmAtmelStudio7TargetGenerator::Generate()
+{
+  this->BuildProject();
+  this->TranslateProject();
+  this->WriteProjectFile();
+}
+
+void cmAtmelStudio7TargetGenerator::BuildProject()
 {
   // Retrieve project file extension
   const AS7ProjectDescriptor::Type ProjectFileType = computeProjectFileExtension(this->GeneratorTarget);
@@ -96,56 +127,227 @@ void cmAtmelStudio7TargetGenerator::Generate()
   this->GeneratorTarget->Target->SetProperty("GENERATOR_FILE_NAME", this->Name);
   this->GeneratorTarget->Target->SetProperty("GENERATOR_FILE_NAME_EXT", ProjectFileExtension);
 
-  std::string path = cmStrCat(this->LocalGenerator->GetCurrentBinaryDirectory(), '/', this->Name, ProjectFileExtension);
-  cmGeneratedFileStream BuildFileStream(path);
-  const std::string PathToProjectFile = path;
-  BuildFileStream.SetCopyIfDifferent(true);
+  this->ProjectFilePath = cmStrCat(this->LocalGenerator->GetCurrentBinaryDirectory(), '/', this->Name, ProjectFileExtension);
+
+  // Skip xml construction altogether if nothing changed since the previous generation
+  this->FingerprintFilePath = cmStrCat(this->LocalGenerator->GetCurrentBinaryDirectory(), "/CMakeFiles/", this->Name, ".as7fingerprint");
+  this->Fingerprint = this->ComputeFingerprint();
+  this->GlobalGenerator->SetProjectFingerprint(this->GeneratorTarget->GetName(), this->Fingerprint);
+  std::string previous_fingerprint;
+  {
+    cmsys::ifstream fingerprint_file(this->FingerprintFilePath.c_str());
+    std::getline(fingerprint_file, previous_fingerprint);
+  }
+  this->UpToDate = (previous_fingerprint == this->Fingerprint) && cmSystemTools::FileExists(this->ProjectFilePath);
+  if (this->GlobalGenerator->IsNinjaCompanion()) {
+    this->NinjaFragmentPath = this->GlobalGenerator->GetNinjaFragmentPath(this->GeneratorTarget);
+    this->UpToDate = this->UpToDate && cmSystemTools::FileExists(this->NinjaFragmentPath);
+  }
+  if (this->UpToDate) {
+    return;
+  }
 
   // Output project file is an XML file using default UTF-8 encoding
-  pugi::xml_document doc;
-  // Prepend delcaration node will look like this : <?xml version="1.0" encoding="utf-8"?>
+  this->ProjectSkeleton.str("");
+  AS7XmlWriter writer(this->ProjectSkeleton);
   // This is the implementation of XML Byte Order Mask (BOM) for UTF-8 encoding : https://en.wikipedia.org/wiki/Byte_order_mark
-  pugi::xml_node decl = doc.prepend_child(pugi::node_declaration);
-  decl.append_attribute("version") = "1.0";
-  decl.append_attribute("encoding") = "utf-8";
+  writer.write_bom();
+  // Declaration will look like this : <?xml version="1.0" encoding="utf-8"?>
+  writer.write_declaration();
 
-  pugi::xml_node project_node = doc.append_child(pugi::node_element);
-  project_node.set_name("Project");
-  project_node.append_attribute("DefaultTargets") = "Build";
-  project_node.append_attribute("xmlns") = "http://schemas.microsoft.com/developer/msbuild/2003";
-  project_node.append_attribute("ToolsVersion") = "14.0";
+  writer.start_element("Project");
+  writer.attribute("DefaultTargets", "Build");
+  writer.attribute("xmlns", "http://schemas.microsoft.com/developer/msbuild/2003");
+  writer.attribute("ToolsVersion", "14.0");
 
   // Device name is resolved from compiler options
-  BuildDevicePropertyGroup(project_node, this->Name);
+  BuildDevicePropertyGroup(writer, this->Name);
 
   // Iterate over build configurations such as Release, Debug, etc. and write their dedicated descriptions
   // Based on compiler options
-  std::vector<cmGeneratorTarget::AllConfigSource> const& sources = this->GeneratorTarget->GetAllConfigSources();
-  for (std::string const& config : this->Configurations) {
-    std::string configUpper = cmSystemTools::UpperCase(config);
-    BuildConfigurationXmlGroup(project_node, config);
+  for (ConfigurationInputs const& inputs : this->ConfigurationsInputs) {
+    BuildConfigurationXmlGroup(writer, inputs);
   }
 
   // Compile item group which lists sources to be built as part of this target
-  BuildCompileItemGroup(project_node);
+  BuildCompileItemGroup(writer);
 
   // Add projects references
-  BuildProjectReferenceItemGroup(project_node);
+  BuildProjectReferenceItemGroup(writer);
 
   // Last node is dedicated to atmelstudio specific targets
-  pugi::xml_node import_projects_node = project_node.append_child("Import");
-  import_projects_node.append_attribute("Project") = R"($(AVRSTUDIO_EXE_PATH)\\Vs\\Compiler.targets)";
+  writer.start_element("Import");
+  writer.attribute("Project", R"($(AVRSTUDIO_EXE_PATH)\\Vs\\Compiler.targets)");
+  writer.end_element();
 
-  doc.save(BuildFileStream, "  ", (pugi::format_indent | pugi::format_write_bom), pugi::xml_encoding::encoding_utf8);
+  writer.end_element();
+
+  if (this->GlobalGenerator->IsNinjaCompanion()) {
+    this->BuildNinjaTarget();
+  }
+}
+
+void cmAtmelStudio7TargetGenerator::TranslateProject()
+{
+  if (this->UpToDate) {
+    return;
+  }
+
+  const std::string skeleton = this->ProjectSkeleton.str();
+  this->ProjectSkeleton.str("");
+
+  // Configurations are translated in order, each one inheriting the settings resolved by the previous one
+  // (e.g. the device) so that the output is the same as if a single translator generated all of them.
+  // Their xml is inserted in the project skeleton, at the position recorded by BuildConfigurationXmlGroup().
+  std::ostringstream content;
+  std::ostringstream ninja;
+  AS7NinjaWriter ninja_writer(ninja);
+  std::size_t copied = 0;
+  for (std::size_t i = 0; i < this->PendingToolchains.size(); i++) {
+    PendingToolchain& pending = this->PendingToolchains[i];
+    if (i != 0) {
+      pending.Translator.inherit_shared_settings(this->PendingToolchains[i - 1].Translator);
+    }
+    content.write(skeleton.data() + copied, static_cast<std::streamsize>(pending.Offset - copied));
+    copied = pending.Offset;
+
+    AS7XmlWriter writer(content, "  ", pending.Level);
+    pending.Translator.generate_xml(writer);
+
+    // Ninja build statements use the toolchain settings translated for Atmel Studio 7, so both builds match
+    if (!this->NinjaFragmentPath.empty()) {
+      ninja_writer.write_configuration(this->NinjaTarget, pending.Configuration, pending.Translator.toolchain);
+    }
+  }
+  content.write(skeleton.data() + copied, static_cast<std::streamsize>(skeleton.size() - copied));
+  this->ProjectContent = content.str();
+  this->NinjaContent = ninja.str();
+
+  // Rendered content is all we need from now on
+  this->PendingToolchains.clear();
+}
+
+void cmAtmelStudio7TargetGenerator::WriteProjectFile()
+{
+  if (this->UpToDate) {
+    return;
+  }
+
+  cmGeneratedFileStream BuildFileStream(this->ProjectFilePath);
+  BuildFileStream.SetCopyIfDifferent(true);
+  BuildFileStream << this->ProjectContent;
   BuildFileStream.Close();
+
+  if (!this->NinjaFragmentPath.empty()) {
+    cmGeneratedFileStream NinjaFileStream(this->NinjaFragmentPath);
+    NinjaFileStream.SetCopyIfDifferent(true);
+    NinjaFileStream << this->NinjaContent;
+    NinjaFileStream.Close();
+  }
+
+  // Fingerprint is only recorded once the project file is written, so that an interrupted generation is redone
+  cmGeneratedFileStream FingerprintStream(this->FingerprintFilePath);
+  FingerprintStream << this->Fingerprint << '\n';
+  FingerprintStream.Close();
+}
+
+bool cmAtmelStudio7TargetGenerator::IsUpToDate() const
+{
+  return this->UpToDate;
 }
 
-void AppendInlinedNodeChildPcData(pugi::xml_node& parent, const std::string& node_name, const std::string& value)
+std::string cmAtmelStudio7TargetGenerator::ComputeFingerprint()
 {
-  pugi::xml_node node = parent.append_child(node_name.c_str());
-  if (0 != value.size()) {
-    pugi::xml_node child = node.append_child(pugi::node_pcdata);
-    child.set_value(value.c_str());
+  // Bump this version whenever the content of project files changes for the same inputs
+  static const char* const fingerprint_version = "4";
+
+  cmCryptoHash hash(cmCryptoHash::AlgoSHA256);
+  hash.Initialize();
+  // Null character cannot be part of any input, so it is a safe separator
+  auto append = [&hash](cm::string_view value) {
+    hash.Append(value);
+    hash.Append(cm::string_view("\0", 1));
+  };
+  auto append_all = [&append](const auto& values) {
+    append(std::to_string(values.size()));
+    for (cm::string_view value : values) {
+      append(value);
+    }
+  };
+
+  // Generator version
+  append(fingerprint_version);
+  append(cmVersion::GetCMakeVersion());
+  append(this->GlobalGenerator->GetName());
+
+  // Project description
+  append(this->Name);
+  append(this->GUID);
+  append(std::to_string(static_cast<int>(this->GeneratorTarget->GetType())));
+  append(this->ProjectFilePath);
+
+  // Flags, includes and definitions of each configuration
+  this->GatherConfigurationInputs();
+  append_all(this->EnabledLanguages);
+  for (ConfigurationInputs& inputs : this->ConfigurationsInputs) {
+    append(inputs.Name);
+    for (const std::string& lang : this->EnabledLanguages) {
+      append(lang);
+      append_all(inputs.Flags[lang]);
+      append_all(inputs.Includes[lang]);
+      append_all(inputs.Defines[lang]);
+    }
+  }
+
+  // Targeted device (the DFP version and the device specs directory depend on the packs installed on this machine)
+  this->ResolveTargetedDevice();
+  append(this->TargetedDevice.name);
+  append(this->TargetedDevice.DFP_name);
+  append(this->TargetedDevice.version);
+  append(this->TargetedDevice.mmcu_option);
+  append(this->translator.toolchain.common.Device);
+  append(this->GlobalGenerator->GetPackRepoDirectory());
+
+  // Sources
+  for (cmGeneratorTarget::AllConfigSource const& si : this->GeneratorTarget->GetAllConfigSources()) {
+    append(std::to_string(static_cast<int>(si.Kind)));
+    append(si.Source->GetFullPath());
+    append(si.Source->GetLanguage());
+    append(si.Source->GetExtension());
+  }
+
+  // Dependencies
+  for (cmGeneratorTarget const* dependent_target : this->GetTargetDependencies()) {
+    if (!dependent_target->IsInBuildSystem()) {
+      continue;
+    }
+    append(dependent_target->GetName());
+    append(this->GlobalGenerator->GetGUID(dependent_target->GetName()));
+    append(dependent_target->GetLocalGenerator()->GetCurrentBinaryDirectory());
+    append(AS7ProjectDescriptor::get_extension(computeProjectFileExtension(dependent_target)));
+    cmValue external_project = dependent_target->GetProperty("EXTERNAL_MSPROJECT");
+    append(external_project ? *external_project : std::string());
+  }
+
+  return hash.FinalizeHex();
+}
+
+void cmAtmelStudio7TargetGenerator::GatherConfigurationInputs()
+{
+  this->EnabledLanguages.clear();
+  this->GlobalGenerator->GetEnabledLanguages(this->EnabledLanguages);
+
+  this->ConfigurationsInputs.clear();
+  this->ConfigurationsInputs.reserve(this->Configurations.size());
+  for (const std::string& config : this->Configurations) {
+    ConfigurationInputs inputs;
+    inputs.Name = config;
+    inputs.Flags = this->RetrieveCmakeFlags(this->EnabledLanguages, cmutils::strings::to_uppercase(config));
+    for (const std::string& lang : this->EnabledLanguages) {
+      inputs.Includes[lang] = this->GetIncludes(config, lang);
+      inputs.Defines[lang] = this->GetDefines(config, lang);
+    }
+    this->ConfigurationsInputs.push_back(std::move(inputs));
   }
 }
 
@@ -173,15 +375,6 @@ std::vector<std::string> cmAtmelStudio7TargetGenerator::GetDefines(const std::st
   return out;
 }
 
-std::vector<std::string> cmAtmelStudio7TargetGenerator::ConvertBTStringRange(const cmBTStringRange& range) const
-{
-  std::vector<std::string> out;
-  for (auto& val : range) {
-    out.push_back(val.Value);
-  }
-  return out;
-}
-
 // TODO : this util function could be implemented elsewhere, for instance in the cmAvrGccLanguageStandardOption or in a more generic place
 static std::string encode_lang_std(const std::string& std_version, const std::string& lang, bool use_gnu_standard = false)
 {
@@ -201,57 +394,72 @@ static std::string encode_lang_std(const std::string& std_version, const std::st
   return out;
 }
 
-std::unordered_map<std::string, std::vector<std::string>> cmAtmelStudio7TargetGenerator::RetrieveCmakeFlags(const std::vector<std::string>& languages,
-                                                                                                            const std::string& upConfig)
+/**
+ * @brief Splits a space separated flag string, returned views point into the input string.
+ */
+static void append_split_flags(std::vector<cm::string_view>& out, cm::string_view flags)
+{
+  std::size_t start = flags.find_first_not_of(' ');
+  while (start != cm::string_view::npos) {
+    const std::size_t end = flags.find(' ', start);
+    out.push_back(flags.substr(start, end - start));
+    start = flags.find_first_not_of(' ', end);
+  }
+}
+
+std::unordered_map<std::string, std::vector<cm::string_view>> cmAtmelStudio7TargetGenerator::RetrieveCmakeFlags(const std::vector<std::string>& languages,
+                                                                                                                const std::string& upConfig)
 {
-  std::unordered_map<std::string, std::vector<std::string>> out;
-  std::string linker_variable_name = "CMAKE_EXE_LINKER_FLAGS";
+  std::unordered_map<std::string, std::vector<cm::string_view>> out;
 
   // Extract all compiler options, parse them and use them in the final XML file
   for (auto& lang : languages) {
-    std::vector<std::string> all_flags;
-    std::string flag_variable_name = "CMAKE_" + lang + "_FLAGS";
-    std::string flag_variable_config_name = flag_variable_name + "_" + upConfig;
-    std::string lang_standard_varname = "CMAKE_" + lang + "_STANDARD";
-
+    const std::string flag_variable_name = cmStrCat("CMAKE_", lang, "_FLAGS");
     cmValue lang_flags_base = this->Makefile->GetDefinition(flag_variable_name);
-    cmValue lang_flags_config = this->Makefile->GetDefinition(flag_variable_config_name);
-    cmValue lang_standard_def = this->Makefile->GetDefinition(lang_standard_varname);
-
-    auto compile_definitions = ConvertBTStringRange(this->Makefile->GetCompileDefinitionsEntries());
-    auto compile_options = ConvertBTStringRange(this->Makefile->GetCompileOptionsEntries());
-
-    std::vector<std::string> base_flags;
-    std::vector<std::string> config_flags;
-
-    if (lang_flags_base != nullptr) {
-      base_flags = cmutils::strings::split(*lang_flags_base);
+    cmValue lang_flags_config = this->Makefile->GetDefinition(cmStrCat(flag_variable_name, '_', upConfig));
+
+    std::vector<cm::string_view>& all_flags = out[lang];
+    auto standard = this->LanguageStandardFlags.find(lang);
+    if (standard == this->LanguageStandardFlags.end()) {
+      cmValue lang_standard_def = this->Makefile->GetDefinition(cmStrCat("CMAKE_", lang, "_STANDARD"));
+      standard = this->LanguageStandardFlags
+                   .emplace(lang, lang_standard_def ? encode_lang_std(*lang_standard_def, lang, false) : std::string())
+                   .first;
     }
-
-    if (lang_flags_config != nullptr) {
-      config_flags = cmutils::strings::split(*lang_flags_config);
-    }
-
-    if (lang_standard_def != nullptr) {
-      all_flags.push_back(encode_lang_std(*lang_standard_def, lang, false));
+    if (!standard->second.empty()) {
+      all_flags.emplace_back(standard->second);
     }
 
     // Merge all flags within one big vector
-    all_flags.insert(all_flags.end(), base_flags.begin(), base_flags.end());
-    all_flags.insert(all_flags.end(), config_flags.begin(), config_flags.end());
-    all_flags.insert(all_flags.end(), compile_definitions.begin(), compile_definitions.end());
-    all_flags.insert(all_flags.end(), compile_options.begin(), compile_options.end());
-
-    auto last_elem = std::unique(all_flags.begin(), all_flags.end());
-    all_flags.resize(std::distance(all_flags.begin(), last_elem));
+    if (lang_flags_base) {
+      append_split_flags(all_flags, *lang_flags_base);
+    }
+    if (lang_flags_config) {
+      append_split_flags(all_flags, *lang_flags_config);
+    }
+    all_flags.insert(all_flags.end(), this->DirectoryFlags.begin(), this->DirectoryFlags.end());
 
-    out[lang] = all_flags;
+    // Remove duplicated flags wherever they are, keeping the first occurrence of each of them
+    compiler::CompilerOptionFactory::remove_duplicates(all_flags);
   }
   return out;
 }
 
-void cmAtmelStudio7TargetGenerator::BuildConfigurationXmlGroup(pugi::xml_node& parent, const std::string& build_type)
+void cmAtmelStudio7TargetGenerator::LoadCompilerModels(const std::unordered_map<std::string, std::vector<cm::string_view>>& all_flags,
+                                                       const std::string& upConfig)
+{
+  for (auto& flags : all_flags) {
+    if (!AvrToolchain::AS7ToolchainTranslator::supports_language(flags.first)) {
+      continue;
+    }
+    translator.set_compiler(this->LocalGenerator->GetCompilerModel(flags.first, upConfig, flags.second), flags.first);
+  }
+}
+
+void cmAtmelStudio7TargetGenerator::BuildConfigurationXmlGroup(AS7XmlWriter& writer, const ConfigurationInputs& inputs)
 {
+  const std::string& build_type = inputs.Name;
+
   // Clears translator before adding data into it
   translator.toolchain.avrgcc.clear();
   translator.toolchain.avrgcccpp.clear();
@@ -261,35 +469,10 @@ void cmAtmelStudio7TargetGenerator::BuildConfigurationXmlGroup(pugi::xml_node& p
   // Pack built libraries into their proper files.
   // If -r flag is not present in archiver_flags, Atmel Studio fails with the "make : no rules to make <target> needed by all:"
 
-  pugi::xml_node property_group_node = parent.append_child("PropertyGroup");
-  std::string conditionnal_str = " '$(Configuration)' == '" + build_type + "' ";
-  property_group_node.append_attribute("Condition").set_value(conditionnal_str.c_str());
+  const std::vector<std::string>& enabledLanguages = this->EnabledLanguages;
 
-  // Get languages
-  std::vector<std::string> enabledLanguages;
-  this->GlobalGenerator->GetEnabledLanguages(enabledLanguages);
-
-  // Parse flags
-  const std::string upConfig = cmutils::strings::to_uppercase(build_type);
-  //auto CMAKE_CXX_FLAGS = this->Makefile->GetDefinition("CMAKE_CXX_FLAGS");
-
-  // Extract all flags for this config : CMAKE_${LANG}_FLAGS  + CMAKE_${LANG}_FLAGS_${CONFIG}
-  // Works for multiple languages {C,CXX}
-  std::unordered_map<std::string, std::vector<std::string>> all_flags = RetrieveCmakeFlags(enabledLanguages, upConfig);
-
-  // Parse flags for all languages
-  for (auto& flags : all_flags) {
-    // Parse incoming flags
-    translator.parse(flags.second, flags.first);
-  }
-
-  // Open the Toolchain Settings node
-  pugi::xml_node toolchain_settings_node = property_group_node.append_child("ToolchainSettings");
-  std::string avr_gcc_node_name = "AvrGcc";
-  if (std::find(enabledLanguages.begin(), enabledLanguages.end(), "CXX") != enabledLanguages.end()) {
-    avr_gcc_node_name = "AvrGccCpp";
-  }
-  pugi::xml_node avr_gcc_node = toolchain_settings_node.append_child(avr_gcc_node_name.c_str());
+  // Parse flags for all languages : CMAKE_${LANG}_FLAGS + CMAKE_${LANG}_FLAGS_${CONFIG}, gathered with the fingerprint
+  LoadCompilerModels(inputs.Flags, cmutils::strings::to_uppercase(build_type));
 
   // NOTE : this is a "default" setting for Release config which might be annoying, consider removing this if need be
   // Classic default symbols for Release configuration
@@ -299,11 +482,7 @@ void cmAtmelStudio7TargetGenerator::BuildConfigurationXmlGroup(pugi::xml_node& p
   }
 
   // Handle include paths
-  std::string as7_installation_folder = this->GlobalGenerator->GetAtmelStudio7InstallationFolder();
-  std::string dfp_dir = TargetedDevice.get_dfp_path(as7_installation_folder + "\\packs\\");
-  TargetedDevice.version = AS7DeviceResolver::get_max_packs_version(dfp_dir);
-
-  std::string dfp_include_dir = TargetedDevice.get_dfp_include_dir(as7_installation_folder + "\\packs\\");
+  std::string dfp_include_dir = TargetedDevice.get_dfp_include_dir();
 
   translator.toolchain.avrgcc.directories.include_paths.push_back(dfp_include_dir);
   translator.toolchain.avrgcccpp.directories.include_paths.push_back(dfp_include_dir);
@@ -311,8 +490,8 @@ void cmAtmelStudio7TargetGenerator::BuildConfigurationXmlGroup(pugi::xml_node& p
   // This is the only way the toolchain translator could know about those includes as
   // they are not parsed from compiler options alone.
   for (const auto& lang : enabledLanguages) {
-    auto includesList = this->GetIncludes(build_type, lang);
-    auto definesList = this->GetDefines(build_type, lang);
+    const std::vector<std::string>& includesList = inputs.Includes.at(lang);
+    const std::vector<std::string>& definesList = inputs.Defines.at(lang);
 
     for (const auto& singleInclude : includesList) {
       if (lang == "CXX") {
@@ -354,30 +533,47 @@ void cmAtmelStudio7TargetGenerator::BuildConfigurationXmlGroup(pugi::xml_node& p
   }
   translator.toolchain.assembler.general.include_path.push_back(dfp_include_dir);
 
-  // Finally generate the xml project file
-  translator.generate_xml(avr_gcc_node);
+  std::string conditionnal_str = " '$(Configuration)' == '" + build_type + "' ";
+  writer.start_element("PropertyGroup");
+  writer.attribute("Condition", conditionnal_str);
+
+  // Open the Toolchain Settings node
+  writer.start_element("ToolchainSettings");
+  std::string avr_gcc_node_name = "AvrGcc";
+  if (std::find(enabledLanguages.begin(), enabledLanguages.end(), "CXX") != enabledLanguages.end()) {
+    avr_gcc_node_name = "AvrGccCpp";
+  }
+  writer.start_element(avr_gcc_node_name);
+
+  // Toolchain settings are translated to xml later on by TranslateProject(), and inserted here
+  writer.close_start_tag();
+  this->PendingToolchains.push_back({ static_cast<std::size_t>(this->ProjectSkeleton.tellp()), writer.level(), build_type, translator });
+
+  writer.end_element();
+  writer.end_element();
+  writer.end_element();
 }
 
 
-static void add_source_compile_node(pugi::xml_node& item_group_node, const cmGeneratorTarget::AllConfigSource& s)
+static void add_source_compile_node(AS7XmlWriter& writer, const cmGeneratorTarget::AllConfigSource& s)
 {
-  const char* toolname = "Compile";
-  pugi::xml_node compile_node = item_group_node.append_child(toolname);
-  std::string path = s.Source->GetFullPath().c_str();
+  std::string path = s.Source->GetFullPath();
 
   // Convert regular slashes to Windows backslashes
   std::replace(path.begin(), path.end(), '/', '\\');
-  compile_node.append_attribute("Include") = path.c_str();
-  AppendInlinedNodeChildPcData(compile_node, "SubType", "compile");
+  writer.start_element("Compile");
+  writer.attribute("Include", path);
+  writer.element("SubType", "compile");
+  writer.end_element();
 }
 
-void cmAtmelStudio7TargetGenerator::BuildCompileItemGroup(pugi::xml_node& parent)
+void cmAtmelStudio7TargetGenerator::BuildCompileItemGroup(AS7XmlWriter& writer)
 {
   // collect up group information
   std::vector<cmSourceGroup> sourceGroups = this->Makefile->GetSourceGroups();
   std::vector<cmGeneratorTarget::AllConfigSource> const& sources = this->GeneratorTarget->GetAllConfigSources();
 
-  pugi::xml_node item_group_node = parent.append_child("ItemGroup");
+  writer.start_element("ItemGroup");
 
   //
   for (cmGeneratorTarget::AllConfigSource const& si : sources) {
@@ -391,7 +587,7 @@ void cmAtmelStudio7TargetGenerator::BuildCompileItemGroup(pugi::xml_node& parent
         const std::string& lang = si.Source->GetLanguage();
         if (lang == "C" || lang == "CXX")
         {
-          add_source_compile_node(item_group_node, si);
+          add_source_compile_node(writer, si);
         }
       } break;
 
@@ -402,7 +598,7 @@ void cmAtmelStudio7TargetGenerator::BuildCompileItemGroup(pugi::xml_node& parent
         // So we need to check the extension instead (...)
         if (extension == "h")
         {
-          add_source_compile_node(item_group_node, si);
+          add_source_compile_node(writer, si);
         }
       } break;
 
@@ -414,43 +610,73 @@ void cmAtmelStudio7TargetGenerator::BuildCompileItemGroup(pugi::xml_node& parent
         break;
     }
   }
+  writer.end_element();
 }
 
-void cmAtmelStudio7TargetGenerator::BuildDevicePropertyGroup(pugi::xml_node& parent, const std::string& target_name, const std::string& lang)
+void cmAtmelStudio7TargetGenerator::BuildNinjaTarget()
 {
-  // @see http://www.gerald-fahrnholz.eu/sw/DocGenerated/HowToUse/html/group___grp_pugi_xml.html#pugi_xml_generated_file
-  pugi::xml_node property_group = parent.append_child("PropertyGroup");
-  AppendInlinedNodeChildPcData(property_group, "SchemaVersion", "2.0");
-  AppendInlinedNodeChildPcData(property_group, "ProjectVersion", "7.0");
+  this->NinjaTarget.name = this->Name;
+  this->NinjaTarget.source_dir = this->LocalGenerator->GetCurrentSourceDirectory();
+  this->NinjaTarget.binary_dir = this->LocalGenerator->GetCurrentBinaryDirectory();
+
+  switch (this->GeneratorTarget->GetType()) {
+    case cmStateEnums::TargetType::EXECUTABLE:
+      this->NinjaTarget.type = AS7NinjaWriter::OutputType::Executable;
+      break;
+    case cmStateEnums::TargetType::STATIC_LIBRARY:
+      this->NinjaTarget.type = AS7NinjaWriter::OutputType::StaticLibrary;
+      break;
+    default:
+      this->NinjaTarget.type = AS7NinjaWriter::OutputType::None;
+      break;
+  }
+
+  // Same sources as the ones listed in the Compile item group, headers aside
+  for (cmGeneratorTarget::AllConfigSource const& si : this->GeneratorTarget->GetAllConfigSources()) {
+    if (si.Kind != cmGeneratorTarget::SourceKindObjectSource) {
+      continue;
+    }
+    const std::string& lang = si.Source->GetLanguage();
+    if (lang == "C") {
+      this->NinjaTarget.c_sources.push_back(si.Source->GetFullPath());
+    } else if (lang == "CXX") {
+      this->NinjaTarget.cxx_sources.push_back(si.Source->GetFullPath());
+    }
+  }
+
+  for (cmGeneratorTarget const* dependent_target : this->GetTargetDependencies()) {
+    if (!dependent_target->IsInBuildSystem() || dependent_target->GetProperty("EXTERNAL_MSPROJECT")) {
+      continue;
+    }
+    this->NinjaTarget.dependencies.push_back(dependent_target->GetName());
+  }
+}
 
+void cmAtmelStudio7TargetGenerator::ResolveTargetedDevice()
+{
   // Preparse flags from the first configuration to retrieve Device's name !
   std::string device_name;
-  {
-    // Get languages
-    std::vector<std::string> enabledLanguages;
-    this->GlobalGenerator->GetEnabledLanguages(enabledLanguages);
-
-    if (!enabledLanguages.empty()) {
-      std::unordered_map<std::string, std::vector<std::string>> first_config_flags = RetrieveCmakeFlags(enabledLanguages, cmSystemTools::UpperCase(this->Configurations[0]));
-      for (auto& flags : first_config_flags) {
-        translator.parse(flags.second, flags.first);
-      }
 
-      // extract -mmcu option
-      compiler::AbstractCompilerModel* comp = translator.get_compiler(enabledLanguages[0]);
-      if (comp != nullptr) {
-        compiler::CompilerOption* mmcu_opt = comp->get_option("-mmcu");
-        if (mmcu_opt != nullptr) {
-          compiler::MachineOption* opt = static_cast<compiler::MachineOption*>(mmcu_opt);
-          device_name = AS7DeviceResolver::resolve_from_mmcu(opt->value);
-          TargetedDevice.mmcu_option = opt->value;
-        }
+  const std::vector<std::string>& enabledLanguages = this->EnabledLanguages;
 
-        // Try with definitions ... !
-        if (device_name.empty()) {
-          std::vector<std::string> options_vec = comp->get_all_options(compiler::CompilerOption::Type::Definition);
-          device_name = AS7DeviceResolver::resolve_from_defines(options_vec);
-        }
+  if (!enabledLanguages.empty() && !this->ConfigurationsInputs.empty()) {
+    const ConfigurationInputs& first_config = this->ConfigurationsInputs.front();
+    LoadCompilerModels(first_config.Flags, cmutils::strings::to_uppercase(first_config.Name));
+
+    // extract -mmcu option
+    const compiler::AbstractCompilerModel* comp = translator.get_compiler(enabledLanguages[0]);
+    if (comp != nullptr) {
+      compiler::CompilerOption* mmcu_opt = comp->get_option("-mmcu");
+      if (mmcu_opt != nullptr) {
+        compiler::MachineOption* opt = static_cast<compiler::MachineOption*>(mmcu_opt);
+        device_name = AS7DeviceResolver::resolve_from_mmcu(opt->value);
+        TargetedDevice.mmcu_option = opt->value;
+      }
+
+      // Try with definitions ... !
+      if (device_name.empty()) {
+        std::vector<std::string> options_vec = comp->get_all_options(compiler::CompilerOption::Type::Definition);
+        device_name = AS7DeviceResolver::resolve_from_defines(options_vec);
       }
     }
   }
@@ -460,11 +686,42 @@ void cmAtmelStudio7TargetGenerator::BuildDevicePropertyGroup(pugi::xml_node& par
     device_name = "ATmega328P";
   }
 
+  // Installed packs give the exact device description, heuristics are only used for devices out of the device index
+  const AS7DeviceIndex::Device* indexed_device =
+    this->GlobalGenerator->GetDeviceIndex().find(TargetedDevice.mmcu_option.empty() ? device_name : TargetedDevice.mmcu_option);
+  if (indexed_device != nullptr) {
+    TargetedDevice.DFP_name = indexed_device->dfp_name;
+    TargetedDevice.name = indexed_device->name;
+    TargetedDevice.version = indexed_device->version;
+
+    // avr-gcc needs the device specs shipped with the DFP, whether the device was given by -mmcu or by definitions
+    if (cmHasLiteralPrefix(indexed_device->architecture, "AVR8")) {
+      translator.toolchain.common.Device = cmStrCat("-mmcu=", indexed_device->key, " -B \"", indexed_device->get_gcc_dev_dir(), '"');
+    }
+    return;
+  }
+
   // Update targeted Device member for further use in subsequent calls to other methods (for instance when building configurations xml...)
-  AS7DeviceResolver::Core core = AS7DeviceResolver::resolve_core_from_name(device_name);
   TargetedDevice.DFP_name = AS7DeviceResolver::resolve_device_dfp_name(device_name);
   TargetedDevice.name = device_name;
-  TargetedDevice.resolve_version(this->GlobalGenerator->GetAtmelStudio7InstallationFolder() + "\\packs");
+  TargetedDevice.version = this->GlobalGenerator->GetDFPVersion(TargetedDevice.DFP_name);
+
+  // handles devices with mmcu option
+  // TODO : this kind of functionality could be implemented in the AvrGCC8Common structure or whatnot.
+  if (!TargetedDevice.mmcu_option.empty()) {
+    translator.toolchain.common.Device = "-mmcu=" + TargetedDevice.mmcu_option;
+    translator.toolchain.common.Device += " -B \"%24(PackRepoDir)\\atmel\\" + TargetedDevice.DFP_name + '\\' + TargetedDevice.version + "\\gcc\\dev\\" + TargetedDevice.mmcu_option + "\"";
+  }
+}
+
+void cmAtmelStudio7TargetGenerator::BuildDevicePropertyGroup(AS7XmlWriter& writer, const std::string& target_name, const std::string& lang)
+{
+  writer.start_element("PropertyGroup");
+  writer.element("SchemaVersion", "2.0");
+  writer.element("ProjectVersion", "7.0");
+
+  const std::string& device_name = TargetedDevice.name;
+  AS7DeviceResolver::Core core = AS7DeviceResolver::resolve_core_from_name(device_name);
 
   // TODO : put this elsewhere, this could easily be moved to the AS7DeviceResolver namespace or even in AS7Toolchains !
   // This could be a simple function such as :
@@ -490,99 +747,101 @@ void cmAtmelStudio7TargetGenerator::BuildDevicePropertyGroup(pugi::xml_node& par
       break;
   }
 
-  // handles devices with mmcu option
-  // TODO : this kind of functionality could be implemented in the AvrGCC8Common structure or whatnot.
-  if (!TargetedDevice.mmcu_option.empty()) {
-    translator.toolchain.common.Device = "-mmcu=" + TargetedDevice.mmcu_option;
-    translator.toolchain.common.Device += " -B \"%24(PackRepoDir)\\atmel\\" + TargetedDevice.DFP_name + '\\' + TargetedDevice.version + "\\gcc\\dev\\" + TargetedDevice.mmcu_option + "\"";
-  }
-
-  AppendInlinedNodeChildPcData(property_group, "ToolchainName", "com.Atmel." + toolchain + "." + lang);
-  AppendInlinedNodeChildPcData(property_group, "ProjectGuid", this->GUID);
-  AppendInlinedNodeChildPcData(property_group, "avrdevice", device_name);
-  AppendInlinedNodeChildPcData(property_group, "avrdeviceseries", "none");
+  writer.element("ToolchainName", "com.Atmel." + toolchain + "." + lang);
+  writer.element("ProjectGuid", this->GUID);
+  writer.element("avrdevice", device_name);
+  writer.element("avrdeviceseries", "none");
 
   // Shared libraries are not supported for now as they imply to use some real time OS (?)
   if (this->GeneratorTarget->GetType() == cmStateEnums::TargetType::EXECUTABLE) {
-    AppendInlinedNodeChildPcData(property_group, "OutputType", "Executable");
+    writer.element("OutputType", "Executable");
   } else {
-    AppendInlinedNodeChildPcData(property_group, "OutputType", "StaticLibrary");
+    writer.element("OutputType", "StaticLibrary");
   }
 
-  AppendInlinedNodeChildPcData(property_group, "Language", lang);
+  writer.element("Language", lang);
 
   if (this->GeneratorTarget->GetType() == cmStateEnums::TargetType::EXECUTABLE) {
-    AppendInlinedNodeChildPcData(property_group, "OutputFileName", "$(MSBuildProjectName)");
-    AppendInlinedNodeChildPcData(property_group, "OutputFileExtension", ".elf");
+    writer.element("OutputFileName", "$(MSBuildProjectName)");
+    writer.element("OutputFileExtension", ".elf");
   } else {
-    AppendInlinedNodeChildPcData(property_group, "OutputFileName", "lib$(MSBuildProjectName)");
-    AppendInlinedNodeChildPcData(property_group, "OutputFileExtension", ".a");
-  }
-  AppendInlinedNodeChildPcData(property_group, "OutputDirectory", "$(MSBuildProjectDirectory)\\$(Configuration)");
-  AppendInlinedNodeChildPcData(property_group, "AssemblyName", target_name);
-  AppendInlinedNodeChildPcData(property_group, "Name", target_name);
-  AppendInlinedNodeChildPcData(property_group, "RootNamespace", target_name);
-  AppendInlinedNodeChildPcData(property_group, "ToolchainFlavour", "Native");
-  AppendInlinedNodeChildPcData(property_group, "KeepTimersRunning", "true");
-  AppendInlinedNodeChildPcData(property_group, "OverrideVtor", "false");
-  AppendInlinedNodeChildPcData(property_group, "CacheFlash", "true");
-  AppendInlinedNodeChildPcData(property_group, "ProgFlashFromRam", "true");
-  AppendInlinedNodeChildPcData(property_group, "RamSnippetAddress", "0x20000000");
-  AppendInlinedNodeChildPcData(property_group, "UncachedRange");
-  AppendInlinedNodeChildPcData(property_group, "preserveEEPROM", "true");
-  AppendInlinedNodeChildPcData(property_group, "OverrideVtorValue", "exception_table");
-  AppendInlinedNodeChildPcData(property_group, "BootSegment", "2");
-  AppendInlinedNodeChildPcData(property_group, "ResetRule", "0");
-  AppendInlinedNodeChildPcData(property_group, "eraseonlaunchrule", "0");
-  AppendInlinedNodeChildPcData(property_group, "EraseKey");
-
-  pugi::xml_node asf_framework_config = property_group.append_child("AsfFrameworkConfig");
-  pugi::xml_node framework_data_node = asf_framework_config.append_child("framework-data");
-  framework_data_node.append_attribute("xmlns").set_value("");
-  AppendInlinedNodeChildPcData(framework_data_node, "options");
-  AppendInlinedNodeChildPcData(framework_data_node, "configurations");
-  AppendInlinedNodeChildPcData(framework_data_node, "files");
-
-  pugi::xml_node documentation_node = framework_data_node.append_child("documentation");
-  documentation_node.append_attribute("help").set_value("");
-  pugi::xml_node offline_documentation_node = framework_data_node.append_child("offline-documentation");
-  offline_documentation_node.append_attribute("help").set_value("");
-
-  pugi::xml_node dependencies_node = framework_data_node.append_child("dependencies");
-  pugi::xml_node content_extension_node = dependencies_node.append_child("content-extension");
-  content_extension_node.append_attribute("eid").set_value("atmel.asf");
-  content_extension_node.append_attribute("uuidref").set_value("Atmel.ASF");
-  content_extension_node.append_attribute("version").set_value("3.49.1");
-
-  BuildSimulatorConfiguration(property_group);
+    writer.element("OutputFileName", "lib$(MSBuildProjectName)");
+    writer.element("OutputFileExtension", ".a");
+  }
+  writer.element("OutputDirectory", "$(MSBuildProjectDirectory)\\$(Configuration)");
+  writer.element("AssemblyName", target_name);
+  writer.element("Name", target_name);
+  writer.element("RootNamespace", target_name);
+  writer.element("ToolchainFlavour", "Native");
+  writer.element("KeepTimersRunning", "true");
+  writer.element("OverrideVtor", "false");
+  writer.element("CacheFlash", "true");
+  writer.element("ProgFlashFromRam", "true");
+  writer.element("RamSnippetAddress", "0x20000000");
+  writer.element("UncachedRange");
+  writer.element("preserveEEPROM", "true");
+  writer.element("OverrideVtorValue", "exception_table");
+  writer.element("BootSegment", "2");
+  writer.element("ResetRule", "0");
+  writer.element("eraseonlaunchrule", "0");
+  writer.element("EraseKey");
+
+  writer.start_element("AsfFrameworkConfig");
+  writer.start_element("framework-data");
+  writer.attribute("xmlns", "");
+  writer.element("options");
+  writer.element("configurations");
+  writer.element("files");
+
+  writer.start_element("documentation");
+  writer.attribute("help", "");
+  writer.end_element();
+  writer.start_element("offline-documentation");
+  writer.attribute("help", "");
+  writer.end_element();
+
+  writer.start_element("dependencies");
+  writer.start_element("content-extension");
+  writer.attribute("eid", "atmel.asf");
+  writer.attribute("uuidref", "Atmel.ASF");
+  writer.attribute("version", "3.49.1");
+  writer.end_element();
+  writer.end_element();
+  writer.end_element();
+  writer.end_element();
+
+  BuildSimulatorConfiguration(writer);
+  writer.end_element();
 }
 
 // NOTE : this implementation of Simulator configuration is a default one and does not reflect any expected configuration
-void cmAtmelStudio7TargetGenerator::BuildSimulatorConfiguration(pugi::xml_node& parent, const std::string& device_signature, const std::string& stimuli_filepath)
+void cmAtmelStudio7TargetGenerator::BuildSimulatorConfiguration(AS7XmlWriter& writer, const std::string& device_signature, const std::string& stimuli_filepath)
 {
-  AppendInlinedNodeChildPcData(parent, "avrtool", "com.atmel.avrdbg.tool.simulator");
-  AppendInlinedNodeChildPcData(parent, "avrtoolserialnumber");
-  AppendInlinedNodeChildPcData(parent, "avrdeviceexpectedsignature", device_signature.c_str());
-  pugi::xml_node simulator_configuration_node = parent.append_child("com_atmel_avrdbg_tool_simulator");
-  pugi::xml_node tool_options_node = simulator_configuration_node.append_child("ToolOptions");
-  AppendInlinedNodeChildPcData(tool_options_node, "InterfaceProperties");
-  AppendInlinedNodeChildPcData(tool_options_node, "InterfaceName");
-
-  AppendInlinedNodeChildPcData(simulator_configuration_node, "ToolType", "com.atmel.avrdbg.tool.simulator");
-  AppendInlinedNodeChildPcData(simulator_configuration_node, "ToolNumber");
-  AppendInlinedNodeChildPcData(simulator_configuration_node, "ToolName", "Simulator");
+  writer.element("avrtool", "com.atmel.avrdbg.tool.simulator");
+  writer.element("avrtoolserialnumber");
+  writer.element("avrdeviceexpectedsignature", device_signature);
+  writer.start_element("com_atmel_avrdbg_tool_simulator");
+  writer.start_element("ToolOptions");
+  writer.element("InterfaceProperties");
+  writer.element("InterfaceName");
+  writer.end_element();
+
+  writer.element("ToolType", "com.atmel.avrdbg.tool.simulator");
+  writer.element("ToolNumber");
+  writer.element("ToolName", "Simulator");
+  writer.end_element();
 
   if (!stimuli_filepath.empty()) {
-    AppendInlinedNodeChildPcData(parent, "StimuliFile", stimuli_filepath.c_str());
+    writer.element("StimuliFile", stimuli_filepath);
   }
-  AppendInlinedNodeChildPcData(parent, "avrtoolinterface");
+  writer.element("avrtoolinterface");
 }
 
-void cmAtmelStudio7TargetGenerator::BuildProjectReferenceItemGroup(pugi::xml_node& parent)
+void cmAtmelStudio7TargetGenerator::BuildProjectReferenceItemGroup(AS7XmlWriter& writer)
 {
   cmGlobalVisualStudioGenerator::OrderedTargetDependSet target_dependencies = GetTargetDependencies();
 
-  auto item_group_node = parent.append_child("ItemGroup");
+  writer.start_element("ItemGroup");
 
   for (cmGeneratorTarget const* dependent_target : target_dependencies) {
     if (!dependent_target->IsInBuildSystem()) {
@@ -603,12 +862,14 @@ void cmAtmelStudio7TargetGenerator::BuildProjectReferenceItemGroup(pugi::xml_nod
     // Convert to windows paths
     path = cmutils::strings::replace(path, "/", "\\");
 
-    auto project_reference_node = item_group_node.append_child("ProjectReference");
-    project_reference_node.append_attribute("Include") = path.c_str();
-    AppendInlinedNodeChildPcData(project_reference_node, "Name", name);
-    AppendInlinedNodeChildPcData(project_reference_node, "Project", "{" + this->GlobalGenerator->GetGUID(name) + "}");
-    AppendInlinedNodeChildPcData(project_reference_node, "Private", "True");
+    writer.start_element("ProjectReference");
+    writer.attribute("Include", path);
+    writer.element("Name", name);
+    writer.element("Project", "{" + this->GlobalGenerator->GetGUID(name) + "}");
+    writer.element("Private", "True");
+    writer.end_element();
   }
+  writer.end_element();
 }
 
 cmGlobalVisualStudioGenerator::OrderedTargetDependSet cmAtmelStudio7TargetGenerator::GetTargetDependencies() const
@@ -662,22 +923,7 @@ std::string AS7ProjectDescriptor::get_extension(Type type)
   return "";
 }
 
-std::string cmAtmelStudio7TargetGenerator::TargetedDevice_t::get_dfp_path(const std::string& packs_path) const
-{
-  return packs_path + "\\atmel\\" + DFP_name;
-}
-
-std::string cmAtmelStudio7TargetGenerator::TargetedDevice_t::resolve_version(const std::string& packs_path)
+std::string cmAtmelStudio7TargetGenerator::TargetedDevice_t::get_dfp_include_dir() const
 {
-  std::string dfp_dir = get_dfp_path(packs_path);
-  version = AS7DeviceResolver::get_max_packs_version(dfp_dir);
-  return version;
-}
-
-std::string cmAtmelStudio7TargetGenerator::TargetedDevice_t::get_dfp_include_dir(const std::string& packs_path)
-{
-  if (version.empty()) {
-    version = resolve_version(packs_path);
-  }
   return "%24(PackRepoDir)\\atmel\\" + DFP_name + "\\" + version + "\\include\\";
 }
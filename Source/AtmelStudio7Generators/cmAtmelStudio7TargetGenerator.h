@@ -24,13 +24,17 @@ along with this program.  If not, see <https://www.gnu.org/licenses/>.
 #include <map>
 #include <memory>
 #include <set>
+#include <sstream>
 #include <string>
 #include <unordered_map>
 #include <vector>
 
+#include <cm/string_view>
+
 #include "cmGeneratorTarget.h"
 #include "cmStringAlgorithms.h"
 #include "cmGlobalVisualStudioGenerator.h"
+#include "AS7NinjaWriter.h"
 #include "AS7ToolchainTranslator.h"
 
 
@@ -41,24 +45,7 @@ class cmGlobalAtmelStudio7Generator;
 class cmLocalAtmelStudio7Generator;
 class cmMakefile;
 
-/**
-  * @brief forward declaring pugixml classes
-  */
-namespace pugi {
-class xml_node;
-class xml_doc;
-}
-
-
-
-// TODO : Move this function elsewhere : this method has little to do with TargetGenerator and is more related to XML manipulations than anything else.
-/**
- * @brief Appends an inlined xml node to a parent node.
- * @param parent      :   xml parent node reference
- * @param node_name   :   node's name (<node_name>....</node_name>)
- * @param value       :   node's value
- */
-static void AppendInlinedNodeChildPcData(pugi::xml_node& parent, const std::string& node_name, const std::string& value = "");
+class AS7XmlWriter;
 
 /**
  * @brief Describes an AtmelStudio7 Project (a.k.a CMake's Target)
@@ -144,21 +131,100 @@ public:
   /**
    * @brief Entry point to generate the project file using the right formalism.
    * This method is called from the upper Local generator (cmLocalAtmelStudio7Generator) when generating
-   * Build tree
+   * Build tree. It is a shorthand for BuildProject(), TranslateProject() and WriteProjectFile() in a row.
   */
   void Generate();
 
+  /**
+   * @brief Writes the skeleton of the project file using the CMake project description.
+   * Toolchain settings of each configuration are only recorded at this stage, they are translated
+   * to xml by TranslateProject().
+   * Nothing is built when the fingerprint of the project inputs matches the one recorded by the previous
+   * generation (@see IsUpToDate()).
+   * This step queries the generator target and the generators, hence it shall be run from the main thread.
+   */
+  void BuildProject();
+
+  /**
+   * @brief Translates the recorded toolchain settings to xml and inserts them in the project skeleton.
+   * In Ninja companion mode, the ninja build statements of each configuration are rendered from the same settings.
+   * This step only works on data owned by this target generator (and on shared compiler models which are never
+   * modified), so several target generators can be translated concurrently.
+   */
+  void TranslateProject();
+
+  /**
+   * @brief Writes the rendered project file to the build tree (file is only replaced if its content changed).
+   */
+  void WriteProjectFile();
+
+  /**
+   * @brief Tells whether the project file is left untouched because its inputs did not change since
+   * the previous generation. Only relevant once BuildProject() was called.
+   */
+  bool IsUpToDate() const;
+
 private:
 
   /**
-   * @brief Uses the toolchain translator to parse cmake flags from current solution.
+   * @brief Computes a fingerprint of everything the project file is made of : flags, include directories and
+   * definitions of each configuration, sources, targeted device and packs location, dependencies and generator version.
+   * Configuration inputs are gathered and the targeted device is resolved on the way.
+   * @return hexadecimal SHA256 digest of the project inputs
+   */
+  std::string ComputeFingerprint();
+
+  /**
+   * @brief Inputs of a build configuration, evaluated once for the fingerprint and reused to build the project.
+   */
+  struct ConfigurationInputs
+  {
+    std::string Name;                                                    /**< Build configuration                          */
+    std::unordered_map<std::string, std::vector<cm::string_view>> Flags; /**< Flags of each language, see RetrieveCmakeFlags() */
+    std::unordered_map<std::string, std::vector<std::string>> Includes;  /**< Include directories of each language         */
+    std::unordered_map<std::string, std::vector<std::string>> Defines;   /**< Definitions of each language                 */
+  };
+
+  /**
+   * @brief Fills in the EnabledLanguages and ConfigurationsInputs members.
+   */
+  void GatherConfigurationInputs();
+
+  /**
+   * @brief Collects the description of this target used to write its ninja build statements (Ninja companion mode only)
+   */
+  void BuildNinjaTarget();
+
+  /**
+   * @brief Resolves the targeted device from the compiler options of the first configuration (-mmcu option
+   * or -D__AVR_XXX__ definitions) and fills in the TargetedDevice member.
+   * Configuration inputs shall be gathered beforehand.
+   */
+  void ResolveTargetedDevice();
+
+  /**
+   * @brief Gathers the cmake flags of each language for a given configuration : language standard, CMAKE_<LANG>_FLAGS,
+   * CMAKE_<LANG>_FLAGS_<CONFIG>, directory compile definitions and compile options.
+   * Duplicated flags are removed, only the first occurrence of each flag is kept.
    *
    * @param languages   :   list of enabled languages
    * @param upConfig    :   upper case build configuration
-   * @return a list of flags
+   * @return a list of flags per language. Flags are views on the makefile definitions and on this target generator's
+   * storage, they remain valid as long as this target generator lives and the makefile definitions do not change.
+   */
+  std::unordered_map<std::string, std::vector<cm::string_view>> RetrieveCmakeFlags(const std::vector<std::string>& languages,
+                                                                                const std::string& upConfig);
+
+  /**
+   * @brief Loads the parsed compiler models of each language into the toolchain translator.
+   * Models are retrieved from the local generator's cache so that a flag set shared by several
+   * targets (or by several passes of this target generator) is only parsed once.
+   *
+   * @param all_flags   :   flags of each language, as returned by RetrieveCmakeFlags()
+   * @param upConfig    :   upper case build configuration
    */
-  std::unordered_map<std::string, std::vector<std::string>> RetrieveCmakeFlags(const std::vector<std::string>& languages,
-                                                                            const std::string& upConfig);
+  void LoadCompilerModels(const std::unordered_map<std::string, std::vector<cm::string_view>>& all_flags,
+                          const std::string& upConfig);
   /**
    * @brief Retrieves include directories for a given configuration, for a specific language.
    * @param config  :   build configuration used as a reference
@@ -187,6 +253,26 @@ private:
 
   AvrToolchain::AS7ToolchainTranslator translator; /**< Used to parse compiler command line input and convert it to xml                      */
 
+  /**
+   * @brief Toolchain settings of a build configuration, waiting to be translated to xml by TranslateProject()
+   */
+  struct PendingToolchain;
+
+  std::string ProjectFilePath;                     /**< Path to the generated project file                                                   */
+  std::ostringstream ProjectSkeleton;              /**< Project file written by BuildProject(), without the toolchain settings               */
+  std::vector<PendingToolchain> PendingToolchains; /**< Toolchain settings of each configuration, in configurations order                    */
+  std::string ProjectContent;                      /**< Rendered project file                                                                */
+  std::string FingerprintFilePath;                 /**< Path to the fingerprint of the previous generation, in CMakeFiles/                   */
+  std::string Fingerprint;                         /**< Fingerprint of the project inputs                                                    */
+  bool UpToDate = false;                           /**< Project inputs did not change since the previous generation                          */
+  std::string NinjaFragmentPath;                   /**< Path to the ninja build statements of this target (Ninja companion mode)             */
+  AS7NinjaWriter::Target NinjaTarget;              /**< Target description used to write its ninja build statements                          */
+  std::string NinjaContent;                        /**< Rendered ninja build statements                                                      */
+  std::vector<cm::string_view> DirectoryFlags;     /**< Directory compile definitions and options, shared by all languages and configurations */
+  std::unordered_map<std::string, std::string> LanguageStandardFlags; /**< Language standard flag of each language (-std=xxx)          */
+  std::vector<std::string> EnabledLanguages;                   /**< Languages enabled in the global generator                            */
+  std::vector<ConfigurationInputs> ConfigurationsInputs;       /**< Inputs of each configuration, in configurations order                */
+
 
   // FIXME : This could be moved to the toolchain translator (AS7ToolchainTranslator) as
   // all information required to fill it up is available when using the toolchain translator !
@@ -198,45 +284,20 @@ private:
     std::string mmcu_option;            /**< Device's mmcu option if it exists  */
 
     /**
-     * @brief Constructs the DFP path relatively to Atmel Studio installation path.
-     * @param   packs_path : packs folder path within Atmel Studio 7 installation folder (absolute path)
-     * @return an absolute path to the device's DFP folder
-     */
-    std::string get_dfp_path(const std::string& packs_path) const;
-
-    /**
-     * @brief Retrieves the Device's DFP include directory using the packs path (absolute path).
+     * @brief Retrieves the Device's DFP include directory, using the already resolved DFP name and version.
      *
-     * @param packs_path    :   absolute path of the packs folder inside AS7's installation folder
      * @return a relative path pointing to the include directory, using AS7 formalism.
      *      E.g : output = %24(PackRepoDir)\atmel\ATmega_DFP\1.2.209\include
      */
-    std::string get_dfp_include_dir(const std::string& packs_path);
-
-    /**
-     * @brief Resolves DFP pack version using the absolute packs path as an input.
-     * It lists all available package versions and chooses the highest one as the targeted version
-     * @param packs_path    :   absolute path of the packs folder inside AS7's installation folder
-     * @return the selected package version alone (directory name)
-     *      E.g. : output is "1.2.36"
-     */
-    std::string resolve_version(const std::string& packs_path);
+    std::string get_dfp_include_dir() const;
   } TargetedDevice;
 
 
   cmGlobalAtmelStudio7Generator* const GlobalGenerator; /**< Embeds a link to the GlobalGenerator (cmGlobalAtmelStudio7Generator)   */
   cmLocalAtmelStudio7Generator* const LocalGenerator;   /**< Embeds a link to the LocalGenerator (cmLocalAtmelStudio7Generator)     */
 
-  // TODO : remove this method from here as it is not related to TargetGenerators. Put it in a util lib instead
-  /**
-   * @brief Converts CMake's StringRange type to a vector of std::strings.
-   * @param     range : Cmake's StringRange object
-   * @return a collection of strings
-   */
-  std::vector<std::string> ConvertBTStringRange(const cmBTStringRange& range) const;
-
   /**
-   * @brief Builds a configuration group and attaches its xml representation to the parent node.
+   * @brief Builds a configuration group and writes its xml representation.
    *
    * This method retrieves compilation options given to the compiler using the configuration parameter.
    * It also looks for global options (CMAKE_CXX_FLAGS for instance) and appends the flags at the beginning of the
@@ -244,31 +305,31 @@ private:
    * Then options are parsed by the compiler abstractions provided in cmAvrGccCompiler and the compiler options classes
    * and doubles are removed ; priorities are applied between specific options (e.g. -O0 takes over any other -Oxx option)
    *
-   * @param parent      : parent xml node
-   * @param build_type  : build configuration (e.g. Release, MinSizeRel, Debug, etc...)
+   * @param writer      : project xml writer
+   * @param inputs      : inputs of the build configuration (e.g. Release, MinSizeRel, Debug, etc...)
    */
-  void BuildConfigurationXmlGroup(pugi::xml_node& parent, const std::string& build_type);
+  void BuildConfigurationXmlGroup(AS7XmlWriter& writer, const ConfigurationInputs& inputs);
 
   /**
    * @brief Builds the CompileItem group which is common to AtmelStudio and VisualStudio (tells to the IDE what resources to compile/include).
-   * @param parent  :   parent xml node
+   * @param writer  :   project xml writer
    */
-  void BuildCompileItemGroup(pugi::xml_node& parent);
+  void BuildCompileItemGroup(AS7XmlWriter& writer);
 
   /**
    * @brief Builds the device property group which tells to Atmel Studio 7 which device is being targeted and
    * what toolchain needs to be used with it.
    *
-   * Device is resolved using 2 inputs : the -mmcu option in case one is passed to the compiler or the appropriate
+   * Device is resolved beforehand by ResolveTargetedDevice(), using 2 inputs : the -mmcu option in case one is passed to the compiler or the appropriate
    * -D__MACRO__ define given to the compiler.
    * For both options, Device name is resolved using Atmel naming convention and supports
    * ATmega, AT90mega, ATtiny, ATxmega, ATsam (ARM32), AT32uc (AVR32) and ATautomotive chips
    *
-   * @param parent      : parent xml node
+   * @param writer      : project xml writer
    * @param target_name : project name (AS7), CMake terminology (Target)
    * @param lang        : language used to build this project (C, CXX, ASM)
    */
-  void BuildDevicePropertyGroup(pugi::xml_node& parent, const std::string& target_name, const std::string& lang = "C");
+  void BuildDevicePropertyGroup(AS7XmlWriter& writer, const std::string& target_name, const std::string& lang = "C");
 
   /**
    * @brief Builds the Atmel Studio simulator basic configuration.
@@ -278,11 +339,11 @@ private:
    * configuration for the simulator
    * // TODO : investigate this, maybe we can provide macros and functions from a CMake module to enable Simulator configuration
    *
-   * @param parent              : parent xml node
+   * @param writer              : project xml writer
    * @param device_signature    : gives the device signature used with the simulator to atmega328p's signature
    * @param stimuli_filepath    : gives the path to the stimuli file, if it does exist
    */
-  void BuildSimulatorConfiguration(pugi::xml_node& parent, const std::string& device_signature = "0x1E930B", const std::string& stimuli_filepath = "");
+  void BuildSimulatorConfiguration(AS7XmlWriter& writer, const std::string& device_signature = "0x1E930B", const std::string& stimuli_filepath = "");
 
   /**
    * @brief Builds the project reference group for AS7 project file.
@@ -291,9 +352,9 @@ private:
    * libraries for instance when necessary.
    * It is the way AS7 implements dependencies between projects
    *
-   * @param parent  : parent xml node
+   * @param writer  : project xml writer
    */
-  void BuildProjectReferenceItemGroup(pugi::xml_node& parent);
+  void BuildProjectReferenceItemGroup(AS7XmlWriter& writer);
 
   cmGlobalVisualStudioGenerator::OrderedTargetDependSet GetTargetDependencies() const;
 };
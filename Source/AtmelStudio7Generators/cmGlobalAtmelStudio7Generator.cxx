@@ -17,9 +17,15 @@ along with this program.  If not, see <https://www.gnu.org/licenses/>.
 
 #include <utility>
 
+#include "AS7DeviceResolver.h"
+#include "AS7NinjaWriter.h"
+#include "cmsys/FStream.hxx"
+
 #include "cmAlgorithms.h"
+#include "cmCryptoHash.h"
 #include "cmDocumentationEntry.h"
 #include "cmEncoding.h"
+#include "cmFileTime.h"
 #include "cmGeneratedFileStream.h"
 #include "cmGeneratorExpression.h"
 #include "cmGeneratorTarget.h"
@@ -29,7 +35,10 @@ along with this program.  If not, see <https://www.gnu.org/licenses/>.
 #include "cmState.h"
 #include "cmStringAlgorithms.h"
 #include "cmStringUtils.h"
+#include "cmSystemTools.h"
 #include "cmUuid.h"
+#include "cmValue.h"
+#include "cmVersion.h"
 #include "cmake.h"
 
 class cmGlobalAtmelStudio7Generator::Factory : public cmGlobalGeneratorFactory
@@ -41,7 +50,8 @@ public:
   {
     (void)allowArch;
     if (name == cmGlobalAtmelStudio7Generator::TruncatedGeneratorName ||
-        name == cmGlobalAtmelStudio7Generator::GeneratorName)
+        name == cmGlobalAtmelStudio7Generator::GeneratorName ||
+        name == cmGlobalAtmelStudio7Generator::NinjaGeneratorName)
     {
       return std::unique_ptr<cmGlobalAtmelStudio7Generator>( new cmGlobalAtmelStudio7Generator(cm, name));
     }
@@ -51,13 +61,14 @@ public:
   void GetDocumentation(cmDocumentationEntry& entry) const override
   {
     entry.Name = std::string(cmGlobalAtmelStudio7Generator::GeneratorName);
-    entry.Brief = "Generates Atmel Studio 7.0 project files.";
+    entry.Brief = "Generates Atmel Studio 7.0 project files (\"- Ninja\" variant also generates a build.ninja file).";
   }
 
   std::vector<std::string> GetGeneratorNames() const override
   {
     std::vector<std::string> names;
     names.push_back(cmGlobalAtmelStudio7Generator::GeneratorName);
+    names.push_back(cmGlobalAtmelStudio7Generator::NinjaGeneratorName);
     return names;
   }
 
@@ -92,6 +103,7 @@ public:
 
 const char* cmGlobalAtmelStudio7Generator::GeneratorName = "Atmel Studio 7.0";          /**< Generator's name is used to instantiate the generator using command line input (@see cmGlobalAtmelStudio7Generator::Factory)   */
 const char* cmGlobalAtmelStudio7Generator::TruncatedGeneratorName = "Atmel Studio 7";   /**< Same as generator's name, but truncated                                                                                        */
+const char* cmGlobalAtmelStudio7Generator::NinjaGeneratorName = "Atmel Studio 7.0 - Ninja"; /**< Companion mode name : project files are generated alongside a build.ninja driving the avr toolchain directly */
 const char* cmGlobalAtmelStudio7Generator::SolutionFileExtension = ".atsln";            /**< Solution file extension for AtmelStudio7 IDE */
 const char* cmGlobalAtmelStudio7Generator::MinimumVisualStudioVersion = "10.0.40219.1"; /**< Used to generate solution files and project files to indicate the minimum required for Visual Studio IDE)*/
 const char* cmGlobalAtmelStudio7Generator::VisualStudioLastVersion = "14.0.23107.0";    /**< Gives the latest VisualStudio version supported by AtmelStudio7  */
@@ -184,7 +196,31 @@ bool cmGlobalAtmelStudio7Generator::SetGeneratorPlatform(std::string const& p, c
 
 std::string cmGlobalAtmelStudio7Generator::GetName() const
 {
-  return GeneratorName;
+  return this->NinjaCompanion ? NinjaGeneratorName : GeneratorName;
+}
+
+bool cmGlobalAtmelStudio7Generator::IsNinjaCompanion() const
+{
+  return this->NinjaCompanion;
+}
+
+std::string cmGlobalAtmelStudio7Generator::GetNinjaFragmentPath(cmGeneratorTarget const* target) const
+{
+  return cmStrCat(target->GetLocalGenerator()->GetCurrentBinaryDirectory(), "/CMakeFiles/", target->GetName(), ".as7.ninja");
+}
+
+std::string cmGlobalAtmelStudio7Generator::GetPackRepoDirectory() const
+{
+  cmValue packRepoDir = this->CMakeInstance->GetCacheDefinition("CMAKE_AS7_PACK_REPO_DIR");
+  if (cmNonempty(packRepoDir)) {
+    return *packRepoDir;
+  }
+
+  std::string const installationFolder = GetAtmelStudio7InstallationFolder();
+  if (installationFolder.empty()) {
+    return "";
+  }
+  return cmStrCat(installationFolder, "\\packs");
 }
 
 std::vector<cmGlobalAtmelStudio7Generator::LangProp> cmGlobalAtmelStudio7Generator::SupportedLanguagesList = {
@@ -250,7 +286,11 @@ cmGlobalAtmelStudio7Generator::NewFactory()
 cmGlobalAtmelStudio7Generator::cmGlobalAtmelStudio7Generator(
   cmake* cm, const std::string& platformInGeneratorName)
   : cmGlobalGenerator(cm)
+  , NinjaCompanion(platformInGeneratorName == NinjaGeneratorName)
 {
+  if (this->NinjaCompanion) {
+    this->FindMakeProgramFile = "CMakeNinjaFindMake.cmake";
+  }
 }
 
 void cmGlobalAtmelStudio7Generator::WriteATSLNHeader(std::ostream& fout)
@@ -297,17 +337,120 @@ void cmGlobalAtmelStudio7Generator::OutputATSLNFile(
   }
   this->CurrentProject = root->GetProjectName();
 
+  std::vector<std::string> configs =
+    root->GetMakefile()->GetGeneratorConfigs(cmMakefile::ExcludeEmptyConfig);
+
+  // Collect all targets under this root generator and the transitive
+  // closure of their dependencies.
+  TargetDependSet projectTargets;
+  TargetDependSet originalTargets;
+  this->GetTargetSets(projectTargets, originalTargets, root, generators);
+  OrderedTargetDependSet orderedProjectTargets(
+    projectTargets, this->GetStartupProjectName(root));
+
   // Recompose targeted solution file path
   std::string fname = GetATSLNFile(root);
+
+  // Skip the solution altogether if its projects and their inputs did not change since the previous generation
+  const std::string fingerprintFile =
+    cmStrCat(root->GetCurrentBinaryDirectory(), "/CMakeFiles/", root->GetProjectName(), SolutionFileExtension,
+             ".as7fingerprint");
+  const std::string fingerprint = this->ComputeSolutionFingerprint(root, configs, orderedProjectTargets);
+  std::string previous_fingerprint;
+  {
+    cmsys::ifstream fingerprint_file(fingerprintFile.c_str());
+    std::getline(fingerprint_file, previous_fingerprint);
+  }
+  if (previous_fingerprint == fingerprint && cmSystemTools::FileExists(fname)) {
+    return;
+  }
+
   cmGeneratedFileStream fout(fname.c_str());
   fout.SetCopyIfDifferent(true);
   if (!fout) {
     return;
   }
-  this->WriteATSLNFile(fout, root, generators);
+  this->WriteATSLNFile(fout, root, configs, orderedProjectTargets);
   if (fout.Close()) {
     this->FileReplacedDuringGenerate(fname);
   }
+
+  // Fingerprint is only recorded once the solution file is written, so that an interrupted generation is redone
+  cmGeneratedFileStream fingerprintStream(fingerprintFile);
+  fingerprintStream << fingerprint << '\n';
+  fingerprintStream.Close();
+}
+
+std::string cmGlobalAtmelStudio7Generator::ComputeSolutionFingerprint(
+  cmLocalGenerator* root, std::vector<std::string> const& configs,
+  OrderedTargetDependSet const& projectTargets)
+{
+  // Bump this version whenever the content of solution files changes for the same inputs
+  static const char* const fingerprint_version = "1";
+
+  cmCryptoHash hash(cmCryptoHash::AlgoSHA256);
+  hash.Initialize();
+  // Null character cannot be part of any input, so it is a safe separator
+  auto append = [&hash](cm::string_view value) {
+    hash.Append(value);
+    hash.Append(cm::string_view("\0", 1));
+  };
+
+  // Generator version
+  append(fingerprint_version);
+  append(cmVersion::GetCMakeVersion());
+  append(this->GetName());
+
+  // Solution description
+  append(this->GetATSLNFile(root));
+  append(this->GetGUID(root->GetProjectName() + SolutionFileExtension));
+  append(StripPlatformForATSLN(this->CurrentPlatform));
+  append(std::to_string(configs.size()));
+  for (std::string const& config : configs) {
+    append(config);
+  }
+  for (std::string const& key : root->GetMakefile()->GetPropertyKeys()) {
+    if (cmHasLiteralPrefix(key, "VS_GLOBAL_SECTION_")) {
+      cmValue value = root->GetMakefile()->GetProperty(key);
+      append(key);
+      append(value ? *value : std::string());
+    }
+  }
+
+  // Projects, in solution order (the startup project comes first)
+  for (cmGeneratorTarget const* target : projectTargets) {
+    if (!target->IsInBuildSystem()) {
+      continue;
+    }
+    append(target->GetName());
+    append(this->GetGUID(target->GetName()));
+    for (const char* property : { "GENERATOR_FILE_NAME", "GENERATOR_FILE_NAME_EXT", "EXTERNAL_MSPROJECT",
+                                  "VS_PLATFORM_MAPPING" }) {
+      cmValue value = target->GetProperty(property);
+      append(value ? *value : std::string());
+    }
+    for (std::string const& config : configs) {
+      cmValue mapping = target->GetProperty("MAP_IMPORTED_CONFIG_" + cmSystemTools::UpperCase(config));
+      append(mapping ? *mapping : std::string());
+    }
+    auto fingerprint = this->ProjectFingerprints.find(target->GetName());
+    append(fingerprint != this->ProjectFingerprints.end() ? fingerprint->second : std::string());
+
+    // Solution records dependencies and default build configurations even for targets without a project fingerprint
+    OrderedTargetDependSet depends(this->GetTargetDirectDepends(target), std::string());
+    for (cmTargetDepend const& depend : depends) {
+      if (depend->IsInBuildSystem()) {
+        append(this->GetGUID(depend->GetName()));
+      }
+    }
+    for (std::string const& config : this->IsPartOfDefaultBuild(configs, projectTargets, target)) {
+      append(config);
+    }
+    auto utility = this->UtilityDepends.find(target);
+    append(utility != this->UtilityDepends.end() ? utility->second : std::string());
+  }
+
+  return hash.FinalizeHex();
 }
 
 std::string cmGlobalAtmelStudio7Generator::GetStartupProjectName(
@@ -331,8 +474,13 @@ std::string cmGlobalAtmelStudio7Generator::GetStartupProjectName(
   return this->GetAllTargetName();
 }
 
-bool cmGlobalAtmelStudio7Generator::FindMakeProgram(cmMakefile*)
+bool cmGlobalAtmelStudio7Generator::FindMakeProgram(cmMakefile* mf)
 {
+  // Command line builds of the Ninja companion mode need ninja
+  if (this->NinjaCompanion) {
+    return this->cmGlobalGenerator::FindMakeProgram(mf);
+  }
+
   // Atmel Studio generators know how to lookup their build tool
   // directly instead of needing a helper module to do it, so we
   // do not actually need to put CMAKE_MAKE_PROGRAM into the cache.
@@ -340,7 +488,33 @@ bool cmGlobalAtmelStudio7Generator::FindMakeProgram(cmMakefile*)
   return true;
 }
 
-std::string cmGlobalAtmelStudio7Generator::GetGUID(std::string const& name)
+void cmGlobalAtmelStudio7Generator::SetProjectFingerprint(std::string const& name, std::string const& fingerprint)
+{
+  this->ProjectFingerprints[name] = fingerprint;
+}
+
+std::string cmGlobalAtmelStudio7Generator::GetGUID(std::string const& name) const
+{
+  auto found = this->GUIDs.find(name);
+  if (found != this->GUIDs.end()) {
+    return found->second;
+  }
+  return this->ComputeGUID(name);
+}
+
+void cmGlobalAtmelStudio7Generator::ComputeGUIDTable()
+{
+  this->GUIDs.clear();
+  for (const auto& lg : this->LocalGenerators) {
+    const std::string solution_name = lg->GetProjectName() + SolutionFileExtension;
+    this->GUIDs.emplace(solution_name, this->ComputeGUID(solution_name));
+    for (const auto& target : lg->GetGeneratorTargets()) {
+      this->GUIDs.emplace(target->GetName(), this->ComputeGUID(target->GetName()));
+    }
+  }
+}
+
+std::string cmGlobalAtmelStudio7Generator::ComputeGUID(std::string const& name) const
 {
   std::string const& guidStoreName = name + "_GUID_CMAKE";
   cmValue storedGUID = this->CMakeInstance->GetCacheDefinition(guidStoreName);
@@ -365,22 +539,12 @@ std::string cmGlobalAtmelStudio7Generator::GetGUID(std::string const& name)
 
 void cmGlobalAtmelStudio7Generator::WriteATSLNFile(
   std::ostream& fout, cmLocalGenerator* root,
-  std::vector<cmLocalGenerator*>& generators)
+  std::vector<std::string> const& configs,
+  OrderedTargetDependSet const& orderedProjectTargets)
 {
-  std::vector<std::string> configs =
-    root->GetMakefile()->GetGeneratorConfigs(cmMakefile::ExcludeEmptyConfig);
-
   // Write out the header for a SLN file
   this->WriteATSLNHeader(fout);
 
-  // Collect all targets under this root generator and the transitive
-  // closure of their dependencies.
-  TargetDependSet projectTargets;
-  TargetDependSet originalTargets;
-  this->GetTargetSets(projectTargets, originalTargets, root, generators);
-  OrderedTargetDependSet orderedProjectTargets(
-    projectTargets, this->GetStartupProjectName(root));
-
   // Generate the targets specification to a string.  We will put this in
   // the actual .atsln file later.  As a side effect, this method also
   // populates the set of folders.
@@ -432,6 +596,70 @@ std::string cmGlobalAtmelStudio7Generator::GetAtmelStudio7InstallationFolder()
   return "";
 }
 
+std::string cmGlobalAtmelStudio7Generator::GetDFPVersion(const std::string& dfpName)
+{
+  std::lock_guard<std::mutex> lock(this->PacksInventoryMutex);
+  auto versions = this->PacksInventory.find(dfpName);
+  if (versions == this->PacksInventory.end()) {
+    versions =
+      this->PacksInventory.emplace(dfpName, this->LoadDFPVersions(dfpName))
+        .first;
+  }
+
+  if (versions->second.empty()) {
+    return "";
+  }
+  return versions->second.back();
+}
+
+const AS7DeviceIndex& cmGlobalAtmelStudio7Generator::GetDeviceIndex() const
+{
+  return this->DeviceIndex;
+}
+
+void cmGlobalAtmelStudio7Generator::LoadDeviceIndex()
+{
+  std::string const indexFile =
+    cmStrCat(this->CMakeInstance->GetHomeOutputDirectory(), "/CMakeFiles/AS7DeviceIndex.txt");
+  const bool reused = this->DeviceIndex.load_or_scan(this->GetPackRepoDirectory(), indexFile);
+
+  if (this->CMakeInstance->GetDebugOutput()) {
+    cmSystemTools::Message(cmStrCat("   Device index : ", this->DeviceIndex.size(), " device(s), ",
+                                    reused ? "reused " : "rebuilt ", indexFile));
+  }
+}
+
+std::vector<std::string> cmGlobalAtmelStudio7Generator::LoadDFPVersions(
+  const std::string& dfpName)
+{
+  std::string const packRepoDir = this->GetPackRepoDirectory();
+  if (packRepoDir.empty()) {
+    return {};
+  }
+  std::string const dfpPath = cmStrCat(packRepoDir, "/atmel/", dfpName);
+  cmFileTime dfpTime;
+  if (!dfpTime.Load(dfpPath)) {
+    return {};
+  }
+
+  // Reuse the versions listed by a previous run if the DFP folder is untouched
+  std::string const storeName = cmStrCat(dfpName, "_VERSIONS_CMAKE");
+  std::string const stamp = std::to_string(dfpTime.GetTime());
+  std::vector<std::string> versions =
+    cmExpandedList(this->CMakeInstance->GetCacheDefinition(storeName));
+  if (!versions.empty() && versions.front() == stamp) {
+    versions.erase(versions.begin());
+    return versions;
+  }
+
+  versions = AS7DeviceResolver::get_packs_versions(dfpPath);
+  this->CMakeInstance->AddCacheEntry(
+    storeName, cmStrCat(stamp, ';', cmJoin(versions, ";")),
+    "Stored DFP versions, validated by the DFP folder modification time.",
+    cmStateEnums::INTERNAL);
+  return versions;
+}
+
 cmGlobalAtmelStudio7Generator::~cmGlobalAtmelStudio7Generator()
 {
 }
@@ -476,11 +704,72 @@ void cmGlobalAtmelStudio7Generator::EnableLanguage(
 
 void cmGlobalAtmelStudio7Generator::Generate()
 {
+  // Target generators may run in parallel, so these tables are filled beforehand and only read afterwards
+  this->ComputeGUIDTable();
+  this->LoadDeviceIndex();
+  this->ProjectFingerprints.clear();
+
   // Handles generic stuff about generation process
   cmGlobalGenerator::Generate();
 
   // Write the global solution file for this build tree
   this->OutputATSLNFile();
+
+  if (this->NinjaCompanion) {
+    this->WriteNinjaFile();
+  }
+}
+
+void cmGlobalAtmelStudio7Generator::WriteNinjaFile()
+{
+  cmLocalGenerator* root = this->LocalGenerators[0].get();
+  cmMakefile* mf = root->GetMakefile();
+
+  AS7NinjaWriter::Tools tools;
+  tools.c_compiler = mf->GetSafeDefinition("CMAKE_C_COMPILER");
+  tools.cxx_compiler = mf->GetSafeDefinition("CMAKE_CXX_COMPILER");
+  tools.archiver = mf->GetSafeDefinition("CMAKE_AR");
+  tools.objcopy = mf->GetSafeDefinition("CMAKE_OBJCOPY");
+  tools.objdump = mf->GetSafeDefinition("CMAKE_OBJDUMP");
+  tools.pack_repo_dir = cmutils::strings::replace(this->GetPackRepoDirectory(), '\\', '/');
+#ifdef _WIN32
+  tools.windows_shell = true;
+#endif
+
+  std::string const fname = cmStrCat(root->GetCurrentBinaryDirectory(), "/build.ninja");
+  cmGeneratedFileStream fout(fname.c_str());
+  fout.SetCopyIfDifferent(true);
+  if (!fout) {
+    return;
+  }
+
+  AS7NinjaWriter writer(fout);
+  writer.write_rules(tools);
+
+  // Build statements of each target are written by its target generator
+  std::vector<std::string> targets;
+  for (const auto& lg : this->LocalGenerators) {
+    for (const auto& target : lg->GetGeneratorTargets()) {
+      if (!target->IsInBuildSystem() || !target->GetProperty("GENERATOR_FILE_NAME")) {
+        continue;
+      }
+      writer.write_subninja(this->GetNinjaFragmentPath(target.get()));
+      targets.push_back(target->GetName());
+    }
+  }
+  fout << "\n";
+
+  std::vector<std::string> const configs = mf->GetGeneratorConfigs(cmMakefile::ExcludeEmptyConfig);
+  for (std::string const& config : configs) {
+    writer.write_configuration_aggregate(targets, config);
+  }
+  if (!configs.empty()) {
+    writer.write_default("all-" + configs.front());
+  }
+
+  if (fout.Close()) {
+    this->FileReplacedDuringGenerate(fname);
+  }
 }
 
 std::vector<cmGlobalGenerator::GeneratedMakeCommand> cmGlobalAtmelStudio7Generator::GenerateBuildCommand(const std::string& makeProgram, const std::string& projectName,
@@ -490,6 +779,31 @@ std::vector<cmGlobalGenerator::GeneratedMakeCommand> cmGlobalAtmelStudio7Generat
 {
   std::vector<GeneratedMakeCommand> makeCommands;
 
+  // Ninja companion mode : projects are built by ninja, using the phony <target>-<config> build statements
+  if (this->NinjaCompanion) {
+    GeneratedMakeCommand makeCommand;
+    makeCommand.Add(this->SelectMakeProgram(makeProgram));
+    if (jobs > 0) {
+      makeCommand.Add("-j", std::to_string(jobs));
+    }
+    if (verbose) {
+      makeCommand.Add("-v");
+    }
+    makeCommand.Add(makeOptions.begin(), makeOptions.end());
+    if (targetNames.empty() && !config.empty()) {
+      makeCommand.Add("all-" + config);
+    }
+    for (const std::string& target : targetNames) {
+      if (target.empty() || target == this->GetAllTargetName()) {
+        makeCommand.Add("all-" + config);
+      } else {
+        makeCommand.Add(AS7NinjaWriter::get_phony_name(target, config));
+      }
+    }
+    makeCommands.push_back(std::move(makeCommand));
+    return makeCommands;
+  }
+
   // Written by the toolchain file
 
   cmValue compiler;
@@ -21,14 +21,18 @@ along with this program.  If not, see <https://www.gnu.org/licenses/>.
 
 #include <iosfwd>
 #include <map>
+#include <mutex>
 #include <set>
 #include <string>
+#include <unordered_map>
 #include <vector>
 
 #include "cmGlobalGenerator.h"
 #include "cmGlobalGeneratorFactory.h"
 #include "cmTargetDepend.h"
 
+#include "AS7DeviceIndex.h"
+
 class cmGlobalGeneratorFactory;
 class cmCustomCommand;
 class cmGeneratorTarget;
@@ -56,6 +60,7 @@ public:
    */
   static const char* GeneratorName;               /**< Generator's name is used to instantiate the generator using command line input (@see cmGlobalAtmelStudio7Generator::Factory)   */
   static const char* TruncatedGeneratorName;      /**< Same as generator's name, but truncated                                                                                        */
+  static const char* NinjaGeneratorName;          /**< Companion mode name : project files are generated alongside a build.ninja driving the avr toolchain directly      */
   static const char* SolutionFileExtension;       /**< Solution file extension for AtmelStudio7 IDE */
   static const char* MinimumVisualStudioVersion;  /**< Used to generate solution files and project files to indicate the minimum required for Visual Studio IDE)*/
   static const char* VisualStudioLastVersion;     /**< Gives the latest VisualStudio version supported by AtmelStudio7  */
@@ -174,6 +179,26 @@ public:
    */
   std::string GetName() const override;
 
+  /**
+   * @brief Tells whether this generator runs in "Atmel Studio 7.0 - Ninja" mode : a build.ninja is written alongside
+   * the solution, so that the projects can be built from the command line without Atmel Studio 7.
+   */
+  bool IsNinjaCompanion() const;
+
+  /**
+   * @brief Retrieves the path of the ninja file holding the build statements of a target (Ninja companion mode only).
+   * @param target : targeted generator target
+   * @return <target binary dir>/CMakeFiles/<target name>.as7.ninja
+   */
+  std::string GetNinjaFragmentPath(cmGeneratorTarget const* target) const;
+
+  /**
+   * @brief Retrieves the Atmel packs folder, given by the CMAKE_AS7_PACK_REPO_DIR cache entry or found
+   * in Atmel Studio 7 installation folder.
+   * @return packs folder, empty if none was found
+   */
+  std::string GetPackRepoDirectory() const;
+
   /**
    * @brief Creates a Factory used to instantiate this GlobalGenerator.
    * GlobalGenerators are protected in a way that prevents usage of their constructor,
@@ -197,6 +222,22 @@ public:
    */
   static std::string GetAtmelStudio7InstallationFolder();
 
+  /**
+   * @brief Retrieves the highest installed version of a Device Family Pack (DFP) from Atmel Studio packs folder.
+   * Each DFP folder is only listed once per generation, and the versions found are stored in the cache alongside
+   * the DFP folder modification time, so that subsequent runs skip the listing as long as the folder is untouched.
+   *
+   * @param dfpName : name of the DFP, e.g. "ATmega_DFP"
+   * @return the highest version found (e.g. "1.2.209"), empty if none was found
+   */
+  std::string GetDFPVersion(const std::string& dfpName);
+
+  /**
+   * @brief Retrieves the index of the devices described by the installed packs (loaded at the start of generation).
+   * @return device index, empty if no packs folder was found
+   */
+  const AS7DeviceIndex& GetDeviceIndex() const;
+
   /**
    * @brief Creates a new local generator using the adequate CMakeLists.txt file representation matching the
    * targeted folder.
@@ -297,9 +338,10 @@ public:
   /**
    * @brief Used to find the build tool used to make a AtmelStudio7 project.
    * In our case, the default build tool for this task is AtmelStudio7 itself
-   * So as long as it is installed on the system, return true
-   * @param mf  : (unused) CMakeLists.txt class representation
-   * @return true (always)
+   * So as long as it is installed on the system, return true.
+   * In Ninja companion mode, ninja is looked up instead (CMAKE_MAKE_PROGRAM).
+   * @param mf  : CMakeLists.txt class representation
+   * @return true if the build tool is found
    */
   bool FindMakeProgram(cmMakefile* mf) override;
 
@@ -330,8 +372,16 @@ public:
   };
   class OrderedTargetDependSet;
 
-  //! Lookup a stored GUID or compute one deterministically.
-  std::string GetGUID(std::string const& name);
+  //! Lookup the GUID table filled at the start of generation, or compute a GUID for names out of it.
+  std::string GetGUID(std::string const& name) const;
+
+  /**
+   * @brief Records the fingerprint of a target's project, solution files are only written again when one of them changed.
+   * Projects are built serially, so this is never called concurrently.
+   * @param name        : target name
+   * @param fingerprint : fingerprint of the project inputs
+   */
+  void SetProjectFingerprint(std::string const& name, std::string const& fingerprint);
 
 protected:
   class Factory;        /**< Factory used to instantiate the cmGlobalAtmelStudio7Generator          */
@@ -440,13 +490,15 @@ protected:
   /**
    * @brief Writes solution file to an output stream.
    *
-   * @param fout        : output stream
-   * @param root        : root local generator
-   * @param generators  : collection of all local generators for this project
+   * @param fout                  : output stream
+   * @param root                  : root local generator
+   * @param configs               : build configurations of the solution
+   * @param orderedProjectTargets : targets referenced by the solution, startup project first
    */
   void WriteATSLNFile(std::ostream& fout,
                       cmLocalGenerator* root,
-                      std::vector<cmLocalGenerator*>& generators);
+                      std::vector<std::string> const& configs,
+                      OrderedTargetDependSet const& orderedProjectTargets);
 
   /**
    * @brief Writes a single project reference to the Atmel Studio Solution file.
@@ -519,6 +571,12 @@ protected:
    */
   void WriteATSLNFooter(std::ostream& fout);
 
+  /**
+   * @brief Writes the top level build.ninja (Ninja companion mode only) : build rules, one subninja per target
+   * and a phony all-<config> build statement per configuration, the first configuration being built by default.
+   */
+  void WriteNinjaFile();
+
   /**
    * @brief Writes all targets (aka AS7 projects) to solution as references.
    *
@@ -548,6 +606,49 @@ protected:
 
   using UtilityDependsMap = std::map<cmGeneratorTarget const*, std::string>;
   UtilityDependsMap UtilityDepends;
+
+private:
+  /**
+   * @brief Lists the versions of a DFP, reusing the ones stored in the cache when the DFP folder did not change.
+   * @param dfpName : name of the DFP, e.g. "ATmega_DFP"
+   * @return versions sorted from the lowest to the highest
+   */
+  std::vector<std::string> LoadDFPVersions(const std::string& dfpName);
+
+  /**
+   * @brief Lookup a stored GUID or compute one deterministically.
+   * @param name : target name (or solution name)
+   */
+  std::string ComputeGUID(std::string const& name) const;
+
+  /**
+   * @brief Computes the GUID of every target and solution once, before projects are generated.
+   * Solution and project files reference a target's GUID for each dependency edge, they look it up from this table.
+   */
+  void ComputeGUIDTable();
+
+  /**
+   * @brief Computes the fingerprint of a solution file inputs : its projects and their fingerprints, dependencies,
+   * build configurations and solution properties.
+   * @param root              : root local generator of the solution
+   * @param configs           : build configurations of the solution
+   * @param projectTargets    : targets referenced by the solution
+   */
+  std::string ComputeSolutionFingerprint(cmLocalGenerator* root, std::vector<std::string> const& configs,
+                                         OrderedTargetDependSet const& projectTargets);
+
+  /**
+   * @brief Loads the device index from CMakeFiles/AS7DeviceIndex.txt, packs folder is only scanned again
+   * (and the index file rewritten) when it changed since the index was built.
+   */
+  void LoadDeviceIndex();
+
+  std::map<std::string, std::vector<std::string>> PacksInventory; /**< Sorted versions of each DFP used so far, keyed by DFP name */
+  std::mutex PacksInventoryMutex;                                   /**< Guards PacksInventory                                       */
+  bool NinjaCompanion = false;                                      /**< "Atmel Studio 7.0 - Ninja" mode                             */
+  std::unordered_map<std::string, std::string> GUIDs;              /**< GUID of each target and solution, read-only during generation */
+  std::unordered_map<std::string, std::string> ProjectFingerprints; /**< Fingerprint of each project generated so far, keyed by target name */
+  AS7DeviceIndex DeviceIndex;                                       /**< Devices described by the installed packs, read-only during generation */
 };
 
 class cmGlobalAtmelStudio7Generator::OrderedTargetDependSet
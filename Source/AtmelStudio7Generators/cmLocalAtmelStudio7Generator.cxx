@@ -15,15 +15,25 @@ along with this program.  If not, see <https://www.gnu.org/licenses/>.
 
 #include "cmLocalAtmelStudio7Generator.h"
 
+#include <algorithm>
+#include <chrono>
+#include <functional>
+#include <thread>
+
 #include <cmext/algorithm>
 
 #include <cm3p/expat.h>
 
 #include "cmAlgorithms.h"
 #include "cmAtmelStudio7TargetGenerator.h"
+#include "cmAvrGccCompiler.h"
 #include "cmGeneratorTarget.h"
 #include "cmGlobalAtmelStudio7Generator.h"
 #include "cmMakefile.h"
+#include "cmStringAlgorithms.h"
+#include "cmSystemTools.h"
+#include "cmValue.h"
+#include "cmWorkerPool.h"
 #include "cmXMLParser.h"
 #include "cmake.h"
 
@@ -80,9 +90,90 @@ std::set<cmSourceFile const*>& cmLocalAtmelStudio7Generator::GetSourcesVisited(c
   return this->SourcesVisited[const_cast<cmGeneratorTarget*>(target)];
 }
 
+namespace {
+
+/**
+ * @brief Translates the toolchain settings of a project and renders its document to text
+ */
+class TranslateProjectJob : public cmWorkerPool::JobT
+{
+public:
+  TranslateProjectJob(cmAtmelStudio7TargetGenerator* project)
+    : Project(project)
+  {
+  }
+
+  void Process() override { this->Project->TranslateProject(); }
+
+private:
+  cmAtmelStudio7TargetGenerator* Project;
+};
+
+/**
+ * @brief Last job of the queue, stops the worker pool once all projects are translated
+ */
+class TranslateProjectsEndJob : public cmWorkerPool::JobFenceT
+{
+public:
+  void Process() override { this->Pool()->Abort(); }
+};
+
+}
+
+unsigned int cmLocalAtmelStudio7Generator::GetGenerateJobs() const
+{
+  // Serial generation remains the default, CMAKE_AS7_PARALLEL_GENERATE is either a boolean or a number of jobs
+  cmValue value = this->Makefile->GetDefinition("CMAKE_AS7_PARALLEL_GENERATE");
+  if (!value) {
+    return 1;
+  }
+
+  unsigned long jobs = 0;
+  if (cmStrToULong(*value, &jobs)) {
+    return static_cast<unsigned int>(std::max(jobs, 1ul));
+  }
+
+  if (cmIsOn(*value)) {
+    return std::max(std::thread::hardware_concurrency(), 1u);
+  }
+  return 1;
+}
+
+void cmLocalAtmelStudio7Generator::GenerateTargets(const std::vector<cmGeneratorTarget*>& targets, unsigned int jobs)
+{
+  // Project documents are built serially as they query generator targets, which are not thread safe.
+  std::vector<std::unique_ptr<cmAtmelStudio7TargetGenerator>> projects;
+  projects.reserve(targets.size());
+  for (cmGeneratorTarget* target : targets) {
+    projects.emplace_back(cm::make_unique<cmAtmelStudio7TargetGenerator>(
+      target, static_cast<cmGlobalAtmelStudio7Generator*>(this->GetGlobalGenerator())));
+    projects.back()->BuildProject();
+  }
+
+  cmWorkerPool pool;
+  pool.SetThreadCount(std::min(jobs, static_cast<unsigned int>(projects.size())));
+  for (auto& project : projects) {
+    pool.EmplaceJob<TranslateProjectJob>(project.get());
+  }
+  pool.EmplaceJob<TranslateProjectsEndJob>();
+  pool.Process();
+
+  // Project files are written in targets order, whatever the order in which they were translated
+  for (auto& project : projects) {
+    project->WriteProjectFile();
+    if (project->IsUpToDate()) {
+      ++this->UpToDateProjects;
+    }
+  }
+}
+
 void cmLocalAtmelStudio7Generator::Generate()
 {
+  const auto start = std::chrono::steady_clock::now();
   auto target_list = this->GlobalGenerator->GetLocalGeneratorTargetsInOrder(this);
+  const unsigned int jobs = this->GetGenerateJobs();
+  std::vector<cmGeneratorTarget*> parallel_targets;
+
   // Create the project file for each target.
   for (cmGeneratorTarget* gt : target_list) {
     if (!gt->IsInBuildSystem() || gt->GetProperty("EXTERNAL_MSPROJECT")) {
@@ -98,10 +189,54 @@ void cmLocalAtmelStudio7Generator::Generate()
     }
 
     // Generate each target
-    this->GenerateTarget(gt);
+    if (jobs > 1) {
+      parallel_targets.push_back(gt);
+    } else {
+      this->GenerateTarget(gt);
+    }
+  }
+
+  if (!parallel_targets.empty()) {
+    this->GenerateTargets(parallel_targets, jobs);
   }
 
   this->WriteStampFiles();
+
+  if (this->GetCMakeInstance()->GetDebugOutput()) {
+    const auto elapsed = std::chrono::steady_clock::now() - start;
+    cmSystemTools::Message(cmStrCat("   Compiler models cache ", this->GetCurrentSourceDirectory(), " : ",
+                                    this->CompilerModelHits, " hit(s), ", this->CompilerModelMisses, " miss(es)"));
+    cmSystemTools::Message(cmStrCat("   Project files ", this->GetCurrentSourceDirectory(), " : ",
+                                    this->UpToDateProjects, " up to date"));
+    cmSystemTools::Message(cmStrCat("   Generation time ", this->GetCurrentSourceDirectory(), " : ",
+                                    std::chrono::duration_cast<std::chrono::microseconds>(elapsed).count(), " us"));
+  }
+}
+
+std::shared_ptr<const compiler::AbstractCompilerModel> cmLocalAtmelStudio7Generator::GetCompilerModel(
+  const std::string& lang, const std::string& config, const std::vector<cm::string_view>& flags)
+{
+  // Hashes of each flag are combined (boost's hash_combine) so that no joined flag string is built
+  std::size_t flags_hash = flags.size();
+  for (cm::string_view flag : flags) {
+    flags_hash ^= std::hash<cm::string_view>{}(flag) + 0x9e3779b9 + (flags_hash << 6) + (flags_hash >> 2);
+  }
+  const CompilerModelKey key{ lang, config, flags_hash };
+
+  auto found = this->CompilerModels.find(key);
+  if (found != this->CompilerModels.end() &&
+      std::equal(flags.begin(), flags.end(), found->second.Flags.begin(), found->second.Flags.end())) {
+    ++this->CompilerModelHits;
+    return found->second.Model;
+  }
+
+  // Flags are only copied when a new model is parsed
+  ++this->CompilerModelMisses;
+  std::vector<std::string> owned_flags(flags.begin(), flags.end());
+  auto model = std::make_shared<compiler::cmAvrGccCompiler>();
+  model->parse_flags(owned_flags);
+  this->CompilerModels[key] = { std::move(owned_flags), model };
+  return model;
 }
 
 void cmLocalAtmelStudio7Generator::GenerateTarget(cmGeneratorTarget* target)
@@ -109,6 +244,9 @@ void cmLocalAtmelStudio7Generator::GenerateTarget(cmGeneratorTarget* target)
   cmAtmelStudio7TargetGenerator targetGenerator( target,
                                                  static_cast<cmGlobalAtmelStudio7Generator*>(this->GetGlobalGenerator()));
   targetGenerator.Generate();
+  if (targetGenerator.IsUpToDate()) {
+    ++this->UpToDateProjects;
+  }
 }
 
 const char* cmLocalAtmelStudio7Generator::ReportErrorLabel() const
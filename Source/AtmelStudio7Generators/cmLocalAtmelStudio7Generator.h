@@ -15,7 +15,14 @@ along with this program.  If not, see <https://www.gnu.org/licenses/>.
 
 #pragma once
 
+#include <cstddef>
+#include <map>
+#include <memory>
 #include <string>
+#include <tuple>
+#include <vector>
+
+#include <cm/string_view>
 
 #include "cmConfigure.h" // IWYU pragma: keep
 #include "cmLocalGenerator.h"
@@ -23,6 +30,10 @@ along with this program.  If not, see <https://www.gnu.org/licenses/>.
 class cmMakefile;
 class cmGlobalGenerator;
 
+namespace compiler {
+class AbstractCompilerModel;
+}
+
 /**
  * @brief Write Atmel Studio 7 project files.
  *
@@ -50,6 +61,23 @@ public:
    */
   void GenerateTarget(cmGeneratorTarget* target);
 
+  /**
+   * @brief generates AS7 project files for the given targets, using a pool of worker threads.
+   * Project documents are built serially, then translated and rendered concurrently ; project files
+   * are finally written in the order of the given targets, so the output is the same as with GenerateTarget().
+   *
+   * @param targets : targets to be generated
+   * @param jobs    : maximum number of worker threads
+   */
+  void GenerateTargets(const std::vector<cmGeneratorTarget*>& targets, unsigned int jobs);
+
+  /**
+   * @brief Retrieves the number of jobs used to generate the project files of this directory, using
+   * the CMAKE_AS7_PARALLEL_GENERATE variable (ON uses all available cores, a number gives the count of jobs).
+   * @return number of jobs, 1 meaning that project files are generated serially
+   */
+  unsigned int GetGenerateJobs() const;
+
   /**
    * @brief writes a timestamp file used to determine if the current project generation
    * is out of date and needs to be regenerated.
@@ -58,6 +86,23 @@ public:
 
   std::set<cmSourceFile const*>& GetSourcesVisited(cmGeneratorTarget const* target);
 
+  /**
+   * @brief Retrieves the parsed compiler model for a given flag set.
+   *
+   * Flags are mostly inherited from directory-level definitions (CMAKE_<LANG>_FLAGS[_<CONFIG>], compile
+   * definitions and options), so targets of the same directory usually share the exact same flag set.
+   * Parsed models are cached using (language, configuration, flag-string hash) as a key and shared
+   * between all targets of this directory : returned models shall never be modified.
+   *
+   * @param lang    : language of the flag set (C, CXX)
+   * @param config  : upper case build configuration
+   * @param flags   : flag set to be parsed
+   * @return a parsed compiler model, shared with other users of the cache
+   */
+  std::shared_ptr<const compiler::AbstractCompilerModel> GetCompilerModel(const std::string& lang,
+                                                                          const std::string& config,
+                                                                          const std::vector<cm::string_view>& flags);
+
 protected:
   /**
    * @brief get the standardized Visual Studio encoded error label used to report error.
@@ -67,4 +112,19 @@ protected:
 
 private:
   std::map<cmGeneratorTarget*, std::set<cmSourceFile const*>> SourcesVisited;
+
+  /**
+   * @brief Cached compiler model alongside the flags used to build it (used to rule out hash collisions).
+   */
+  struct CompilerModelEntry
+  {
+    std::vector<std::string> Flags;
+    std::shared_ptr<const compiler::AbstractCompilerModel> Model;
+  };
+
+  using CompilerModelKey = std::tuple<std::string, std::string, std::size_t>; /**< (language, config, flag-string hash) */
+  std::map<CompilerModelKey, CompilerModelEntry> CompilerModels;              /**< Parsed compiler models of this directory */
+  std::size_t CompilerModelHits = 0;                                           /**< Number of compiler models served from cache */
+  std::size_t CompilerModelMisses = 0;                                         /**< Number of compiler models parsed            */
+  std::size_t UpToDateProjects = 0;                                            /**< Number of project files whose inputs did not change */
 };
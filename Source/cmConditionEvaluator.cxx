@@ -2,13 +2,16 @@
    file Copyright.txt or https://cmake.org/licensing for details.  */
 #include "cmConditionEvaluator.h"
 
+#include <algorithm>
 #include <array>
 #include <cstdio>
 #include <cstdlib>
 #include <functional>
 #include <iterator>
 #include <list>
+#include <memory>
 #include <sstream>
+#include <unordered_map>
 #include <utility>
 
 #include <cm/string_view>
@@ -19,6 +22,7 @@
 #include "cmExpandedCommandArgument.h"
 #include "cmMakefile.h"
 #include "cmMessageType.h"
+#include "cmRegexCache.h"
 #include "cmState.h"
 #include "cmStringAlgorithms.h"
 #include "cmSystemTools.h"
@@ -93,11 +97,106 @@ struct cmRt2CtSelector<Comp>
   }
 };
 
-std::string bool2string(bool const value)
+// Keywords of conditions, any other argument is an operand.
+enum class Keyword : unsigned char
 {
-  return std::string(std::size_t(1), static_cast<char>('0' + int(value)));
+  None,
+  ParenL,
+  ParenR,
+  AND,
+  COMMAND,
+  DEFINED,
+  EQUAL,
+  EXISTS,
+  GREATER,
+  GREATER_EQUAL,
+  IN_LIST,
+  IS_ABSOLUTE,
+  IS_DIRECTORY,
+  IS_NEWER_THAN,
+  IS_SYMLINK,
+  LESS,
+  LESS_EQUAL,
+  MATCHES,
+  NOT,
+  OR,
+  POLICY,
+  STREQUAL,
+  STRGREATER,
+  STRGREATER_EQUAL,
+  STRLESS,
+  STRLESS_EQUAL,
+  TARGET,
+  TEST,
+  VERSION_EQUAL,
+  VERSION_GREATER,
+  VERSION_GREATER_EQUAL,
+  VERSION_LESS,
+  VERSION_LESS_EQUAL
+};
+
+struct KeywordName
+{
+  cm::string_view Name;
+  Keyword Id;
+};
+
+// Sorted by name for lookups.
+KeywordName const KEYWORDS[] = {
+  { keyParenL, Keyword::ParenL },
+  { keyParenR, Keyword::ParenR },
+  { keyAND, Keyword::AND },
+  { keyCOMMAND, Keyword::COMMAND },
+  { keyDEFINED, Keyword::DEFINED },
+  { keyEQUAL, Keyword::EQUAL },
+  { keyEXISTS, Keyword::EXISTS },
+  { keyGREATER, Keyword::GREATER },
+  { keyGREATER_EQUAL, Keyword::GREATER_EQUAL },
+  { keyIN_LIST, Keyword::IN_LIST },
+  { keyIS_ABSOLUTE, Keyword::IS_ABSOLUTE },
+  { keyIS_DIRECTORY, Keyword::IS_DIRECTORY },
+  { keyIS_NEWER_THAN, Keyword::IS_NEWER_THAN },
+  { keyIS_SYMLINK, Keyword::IS_SYMLINK },
+  { keyLESS, Keyword::LESS },
+  { keyLESS_EQUAL, Keyword::LESS_EQUAL },
+  { keyMATCHES, Keyword::MATCHES },
+  { keyNOT, Keyword::NOT },
+  { keyOR, Keyword::OR },
+  { keyPOLICY, Keyword::POLICY },
+  { keySTREQUAL, Keyword::STREQUAL },
+  { keySTRGREATER, Keyword::STRGREATER },
+  { keySTRGREATER_EQUAL, Keyword::STRGREATER_EQUAL },
+  { keySTRLESS, Keyword::STRLESS },
+  { keySTRLESS_EQUAL, Keyword::STRLESS_EQUAL },
+  { keyTARGET, Keyword::TARGET },
+  { keyTEST, Keyword::TEST },
+  { keyVERSION_EQUAL, Keyword::VERSION_EQUAL },
+  { keyVERSION_GREATER, Keyword::VERSION_GREATER },
+  { keyVERSION_GREATER_EQUAL, Keyword::VERSION_GREATER_EQUAL },
+  { keyVERSION_LESS, Keyword::VERSION_LESS },
+  { keyVERSION_LESS_EQUAL, Keyword::VERSION_LESS_EQUAL },
+};
+
+Keyword findKeyword(std::string const& value)
+{
+  if (value.empty() || value.size() > keyVERSION_GREATER_EQUAL.size()) {
+    return Keyword::None;
+  }
+  auto const it = std::lower_bound(
+    std::begin(KEYWORDS), std::end(KEYWORDS), value,
+    [](KeywordName const& keyword, std::string const& name) {
+      return keyword.Name < name;
+    });
+  if (it == std::end(KEYWORDS) || it->Name != value) {
+    return Keyword::None;
+  }
+  return it->Id;
 }
 
+// Values of the intermediate results of a condition.
+cmExpandedCommandArgument const argumentFalse("0", true);
+cmExpandedCommandArgument const argumentTrue("1", true);
+
 bool looksLikeSpecialVariable(const std::string& var,
                               cm::static_string_view prefix,
                               const std::size_t varNameLen)
@@ -109,110 +208,216 @@ bool looksLikeSpecialVariable(const std::string& var,
 }
 } // anonymous namespace
 
-#if defined(__SUNPRO_CC)
-#  define CM_INHERIT_CTOR(Class, Base, Tpl)                                   \
-    template <typename... Args>                                               \
-    Class(Args&&... args)                                                     \
-      : Base Tpl(std::forward<Args>(args)...)                                 \
-    {                                                                         \
-    }
-#else
-#  define CM_INHERIT_CTOR(Class, Base, Tpl) using Base Tpl ::Base
-#endif
+// BEGIN cmConditionEvaluator::cmCompiledCondition
 
-// BEGIN cmConditionEvaluator::cmArgumentList
-class cmConditionEvaluator::cmArgumentList
-  : public std::list<cmExpandedCommandArgument>
+// A condition compiled into a sequence of operations.
+//
+// Arguments are reduced according to their keywords only: the operations
+// applied to a given sequence of keywords and operands are thus computed
+// once, and replayed on the values of the arguments by Evaluate().
+// Operations read registers: the arguments of the condition come first,
+// followed by the boolean results of the previous operations.
+class cmConditionEvaluator::cmCompiledCondition
 {
-  using base_t = std::list<cmExpandedCommandArgument>;
-
 public:
-  CM_INHERIT_CTOR(cmArgumentList, list, <cmExpandedCommandArgument>);
-
-  class CurrentAndNextIter
+  enum class OpCode : unsigned char
   {
-    friend class cmConditionEvaluator::cmArgumentList;
-
-  public:
-    base_t::iterator current;
-    base_t::iterator next;
+    // Start of a (sub-)expression
+    ClearError,
+    // End of a (sub-)expression
+    Result,
+    ResultFalse,
+    FailParenthesis,
+    FailArguments,
+    // Sub-expression made of the next Size operations
+    Group,
+    // Messages
+    WarnQuotedKeyword,
+    WarnPolicy57,
+    WarnPolicy64,
+    // Predicates
+    Exists,
+    IsDirectory,
+    IsSymlink,
+    IsAbsolute,
+    Command,
+    Policy,
+    Target,
+    Defined,
+    Test,
+    // Binary operators
+    False,
+    Matches,
+    CompareNumbers,
+    CompareStrings,
+    CompareVersions,
+    IsNewerThan,
+    InList,
+    // Boolean operators
+    Not,
+    AndOr,
+  };
 
-    CurrentAndNextIter advance(base_t& args)
+  struct Op
+  {
+    Op(OpCode code)
+      : Code(code)
     {
-      this->current = std::next(this->current);
-      this->next =
-        std::next(this->current, difference_type(this->current != args.end()));
-      return *this;
     }
 
-  private:
-    CurrentAndNextIter(base_t& args)
-      : current(args.begin())
-      , next(std::next(this->current,
-                       difference_type(this->current != args.end())))
-    {
-    }
+    OpCode Code;
+    // Index of the matched operator, as returned by matchKeys()
+    int Select = 0;
+    // Number of operations of a sub-expression
+    std::size_t Size = 0;
+    unsigned int Dst = 0;
+    unsigned int Lhs = 0;
+    unsigned int Rhs = 0;
   };
 
-  class CurrentAndTwoMoreIter
+  // A compiled condition is shared by all the conditions made of the same
+  // sequence of keywords, as given by the key.
+  static std::shared_ptr<cmCompiledCondition const> Get(
+    std::string const& key, cmPolicies::PolicyStatus policy57Status,
+    cmPolicies::PolicyStatus policy64Status);
+
+  // Byte of a key describing an argument.
+  static char KeyOf(Keyword keyword, bool quotedWarn)
   {
-    friend class cmConditionEvaluator::cmArgumentList;
+    return static_cast<char>(static_cast<unsigned char>(keyword) |
+                             (quotedWarn ? 0x80 : 0));
+  }
 
-  public:
-    base_t::iterator current;
-    base_t::iterator next;
-    base_t::iterator nextnext;
+  std::vector<Op> Ops;
+  unsigned int Registers = 0;
 
-    CurrentAndTwoMoreIter advance(base_t& args)
-    {
-      this->current = std::next(this->current);
-      this->next =
-        std::next(this->current, difference_type(this->current != args.end()));
-      this->nextnext =
-        std::next(this->next, difference_type(this->next != args.end()));
-      return *this;
-    }
-
-  private:
-    CurrentAndTwoMoreIter(base_t& args)
-      : current(args.begin())
-      , next(std::next(this->current,
-                       difference_type(this->current != args.end())))
-      , nextnext(
-          std::next(this->next, difference_type(this->next != args.end())))
-    {
-    }
+private:
+  struct Node
+  {
+    Keyword Kind;
+    // Quoted argument interpreted as a keyword while CMP0054 is not set.
+    bool QuotedWarn;
+    unsigned int Register;
   };
+  using NodeList = std::list<Node>;
 
-  CurrentAndNextIter make2ArgsIterator() { return *this; }
-  CurrentAndTwoMoreIter make3ArgsIterator() { return *this; }
+  cmCompiledCondition(NodeList args, cmPolicies::PolicyStatus policy57Status,
+                      cmPolicies::PolicyStatus policy64Status);
 
-  template <typename Iter>
-  void ReduceOneArg(const bool value, Iter args)
-  {
-    *args.current = cmExpandedCommandArgument(bool2string(value), true);
-    this->erase(args.next);
-  }
+  void Emit(OpCode code) { this->Ops.push_back(Op{ code }); }
+
+  bool IsKeyword(Keyword keyword, Node const& node);
 
-  void ReduceTwoArgs(const bool value, CurrentAndTwoMoreIter args)
+  template <typename... Keys>
+  int MatchKeys(Node const& node, Keys... keys)
   {
-    *args.current = cmExpandedCommandArgument(bool2string(value), true);
-    this->erase(args.nextnext);
-    this->erase(args.next);
+    // Get index of the matched key (1-based)
+    Keyword const keywords[] = { keys... };
+    for (std::size_t i = 0; i < sizeof...(keys); ++i) {
+      if (this->IsKeyword(keywords[i], node)) {
+        return static_cast<int>(i + 1);
+      }
+    }
+    return 0;
   }
+
+  void ReduceOneArg(OpCode code, NodeList& args, NodeList::iterator current,
+                    NodeList::iterator next, int select = 0);
+  void ReduceTwoArgs(OpCode code, NodeList& args, NodeList::iterator current,
+                     NodeList::iterator next, NodeList::iterator nextnext,
+                     int select = 0);
+
+  void CompileExpression(NodeList args);
+  bool CompileLevel0(NodeList& args);
+  bool CompileLevel1(NodeList& args);
+  bool CompileLevel2(NodeList& args);
+  bool CompileLevel3(NodeList& args);
+  bool CompileLevel4(NodeList& args);
+
+  cmPolicies::PolicyStatus Policy57Status;
+  cmPolicies::PolicyStatus Policy64Status;
 };
 
-// END cmConditionEvaluator::cmArgumentList
+std::shared_ptr<cmConditionEvaluator::cmCompiledCondition const>
+cmConditionEvaluator::cmCompiledCondition::Get(
+  std::string const& key, cmPolicies::PolicyStatus policy57Status,
+  cmPolicies::PolicyStatus policy64Status)
+{
+  static std::unordered_map<std::string,
+                            std::shared_ptr<cmCompiledCondition const>>
+    conditions;
+  auto const it = conditions.find(key);
+  if (it != conditions.end()) {
+    return it->second;
+  }
 
-cmConditionEvaluator::cmConditionEvaluator(cmMakefile& makefile,
-                                           cmListFileBacktrace bt)
-  : Makefile(makefile)
-  , Backtrace(std::move(bt))
-  , Policy12Status(makefile.GetPolicyStatus(cmPolicies::CMP0012))
-  , Policy54Status(makefile.GetPolicyStatus(cmPolicies::CMP0054))
-  , Policy57Status(makefile.GetPolicyStatus(cmPolicies::CMP0057))
-  , Policy64Status(makefile.GetPolicyStatus(cmPolicies::CMP0064))
+  // The first two bytes hold the policies.
+  NodeList args;
+  for (std::size_t i = 2; i < key.size(); ++i) {
+    auto const byte = static_cast<unsigned char>(key[i]);
+    args.push_back(Node{ static_cast<Keyword>(byte & 0x7f),
+                         (byte & 0x80) != 0,
+                         static_cast<unsigned int>(i - 2) });
+  }
+  std::shared_ptr<cmCompiledCondition const> condition(
+    new cmCompiledCondition(std::move(args), policy57Status, policy64Status));
+  if (conditions.size() >= 4096) {
+    conditions.clear();
+  }
+  conditions.emplace(key, condition);
+  return condition;
+}
+
+cmConditionEvaluator::cmCompiledCondition::cmCompiledCondition(
+  NodeList args, cmPolicies::PolicyStatus policy57Status,
+  cmPolicies::PolicyStatus policy64Status)
+  : Registers(static_cast<unsigned int>(args.size()))
+  , Policy57Status(policy57Status)
+  , Policy64Status(policy64Status)
+{
+  this->CompileExpression(std::move(args));
+}
+
+bool cmConditionEvaluator::cmCompiledCondition::IsKeyword(Keyword keyword,
+                                                          Node const& node)
+{
+  if (node.Kind != keyword) {
+    return false;
+  }
+  if (node.QuotedWarn) {
+    Op op{ OpCode::WarnQuotedKeyword };
+    op.Lhs = node.Register;
+    this->Ops.push_back(op);
+  }
+  return true;
+}
+
+void cmConditionEvaluator::cmCompiledCondition::ReduceOneArg(
+  OpCode code, NodeList& args, NodeList::iterator current,
+  NodeList::iterator next, int select)
 {
+  Op op{ code };
+  op.Select = select;
+  op.Dst = this->Registers++;
+  op.Lhs = next->Register;
+  this->Ops.push_back(op);
+  *current = Node{ Keyword::None, false, op.Dst };
+  args.erase(next);
+}
+
+void cmConditionEvaluator::cmCompiledCondition::ReduceTwoArgs(
+  OpCode code, NodeList& args, NodeList::iterator current,
+  NodeList::iterator next, NodeList::iterator nextnext, int select)
+{
+  Op op{ code };
+  op.Select = select;
+  op.Dst = this->Registers++;
+  op.Lhs = current->Register;
+  op.Rhs = nextnext->Register;
+  this->Ops.push_back(op);
+  *current = Node{ Keyword::None, false, op.Dst };
+  args.erase(nextnext);
+  args.erase(next);
 }
 
 //=========================================================================
@@ -231,57 +436,308 @@ cmConditionEvaluator::cmConditionEvaluator(cmMakefile& makefile,
 // variable names but if the variable name is not found it will use the name
 // directly. AND OR take variables or the values 0 or 1.
 
-bool cmConditionEvaluator::IsTrue(
-  const std::vector<cmExpandedCommandArgument>& args, std::string& errorString,
-  MessageType& status)
+void cmConditionEvaluator::cmCompiledCondition::CompileExpression(
+  NodeList args)
 {
-  errorString.clear();
+  this->Emit(OpCode::ClearError);
 
   // handle empty invocation
   if (args.empty()) {
-    return false;
+    this->Emit(OpCode::ResultFalse);
+    return;
   }
 
-  // store the reduced args in this vector
-  cmArgumentList newArgs(args.begin(), args.end());
-
   // now loop through the arguments and see if we can reduce any of them
   // we do this multiple times. Once for each level of precedence
   // parens
-  using handlerFn_t = bool (cmConditionEvaluator::*)(
-    cmArgumentList&, std::string&, MessageType&);
+  using handlerFn_t = bool (cmCompiledCondition::*)(NodeList&);
   const std::array<handlerFn_t, 5> handlers = { {
-    &cmConditionEvaluator::HandleLevel0, // parenthesis
-    &cmConditionEvaluator::HandleLevel1, // predicates
-    &cmConditionEvaluator::HandleLevel2, // binary ops
-    &cmConditionEvaluator::HandleLevel3, // NOT
-    &cmConditionEvaluator::HandleLevel4  // AND OR
+    &cmCompiledCondition::CompileLevel0, // parenthesis
+    &cmCompiledCondition::CompileLevel1, // predicates
+    &cmCompiledCondition::CompileLevel2, // binary ops
+    &cmCompiledCondition::CompileLevel3, // NOT
+    &cmCompiledCondition::CompileLevel4  // AND OR
   } };
   for (auto fn : handlers) {
     // Call the reducer 'till there is anything to reduce...
     // (i.e., if after an iteration the size becomes smaller)
     auto levelResult = true;
-    for (auto beginSize = newArgs.size();
-         (levelResult = (this->*fn)(newArgs, errorString, status)) &&
-         newArgs.size() < beginSize;
-         beginSize = newArgs.size()) {
+    for (auto beginSize = args.size();
+         (levelResult = (this->*fn)(args)) && args.size() < beginSize;
+         beginSize = args.size()) {
     }
 
     if (!levelResult) {
-      // NOTE `errorString` supposed to be set already
-      return false;
+      // NOTE The failure is supposed to be emitted already
+      return;
     }
   }
 
   // now at the end there should only be one argument left
-  if (newArgs.size() != 1) {
-    errorString = "Unknown arguments specified";
-    status = MessageType::FATAL_ERROR;
+  if (args.size() != 1) {
+    this->Emit(OpCode::FailArguments);
+    return;
+  }
+
+  Op op{ OpCode::Result };
+  op.Lhs = args.front().Register;
+  this->Ops.push_back(op);
+}
+
+//=========================================================================
+// level 0 processes parenthetical expressions
+bool cmConditionEvaluator::cmCompiledCondition::CompileLevel0(NodeList& args)
+{
+  for (auto arg = args.begin(); arg != args.end(); ++arg) {
+    if (this->IsKeyword(Keyword::ParenL, *arg)) {
+      // search for the closing paren for this opening one
+      auto depth = 1;
+      auto argClose = std::next(arg);
+      for (; argClose != args.end() && depth; ++argClose) {
+        depth += int(this->IsKeyword(Keyword::ParenL, *argClose));
+        depth -= int(this->IsKeyword(Keyword::ParenR, *argClose));
+      }
+      if (depth) {
+        this->Emit(OpCode::FailParenthesis);
+        return false;
+      }
+
+      // the parenthetical expression is evaluated as a whole, its
+      // operations follow the group operation
+      std::size_t const group = this->Ops.size();
+      Op op{ OpCode::Group };
+      op.Dst = this->Registers++;
+      this->Ops.push_back(op);
+      this->CompileExpression(NodeList(std::next(arg), std::prev(argClose)));
+      this->Ops[group].Size = this->Ops.size() - group - 1;
+
+      *arg = Node{ Keyword::None, false, op.Dst };
+      // remove the now evaluated parenthetical expression
+      args.erase(std::next(arg), argClose);
+    }
+  }
+  return true;
+}
+
+//=========================================================================
+// level one handles most predicates except for NOT
+bool cmConditionEvaluator::cmCompiledCondition::CompileLevel1(NodeList& args)
+{
+  const auto policy64IsOld = this->Policy64Status == cmPolicies::OLD ||
+    this->Policy64Status == cmPolicies::WARN;
+
+  for (auto current = args.begin(); current != args.end(); ++current) {
+    auto const next = std::next(current);
+
+    // NOTE Checking policies for warnings are not require an access to the
+    // next arg. Check them first!
+    if (this->Policy64Status == cmPolicies::WARN &&
+        this->IsKeyword(Keyword::TEST, *current)) {
+      this->Emit(OpCode::WarnPolicy64);
+    }
+
+    // NOTE Fail fast: All the predicates below require the next arg to be
+    // valid
+    if (next == args.end()) {
+      continue;
+    }
+
+    // does a file exist
+    if (this->IsKeyword(Keyword::EXISTS, *current)) {
+      this->ReduceOneArg(OpCode::Exists, args, current, next);
+    }
+    // does a directory with this name exist
+    else if (this->IsKeyword(Keyword::IS_DIRECTORY, *current)) {
+      this->ReduceOneArg(OpCode::IsDirectory, args, current, next);
+    }
+    // does a symlink with this name exist
+    else if (this->IsKeyword(Keyword::IS_SYMLINK, *current)) {
+      this->ReduceOneArg(OpCode::IsSymlink, args, current, next);
+    }
+    // is the given path an absolute path ?
+    else if (this->IsKeyword(Keyword::IS_ABSOLUTE, *current)) {
+      this->ReduceOneArg(OpCode::IsAbsolute, args, current, next);
+    }
+    // does a command exist
+    else if (this->IsKeyword(Keyword::COMMAND, *current)) {
+      this->ReduceOneArg(OpCode::Command, args, current, next);
+    }
+    // does a policy exist
+    else if (this->IsKeyword(Keyword::POLICY, *current)) {
+      this->ReduceOneArg(OpCode::Policy, args, current, next);
+    }
+    // does a target exist
+    else if (this->IsKeyword(Keyword::TARGET, *current)) {
+      this->ReduceOneArg(OpCode::Target, args, current, next);
+    }
+    // is a variable defined
+    else if (this->IsKeyword(Keyword::DEFINED, *current)) {
+      this->ReduceOneArg(OpCode::Defined, args, current, next);
+    }
+    // does a test exist
+    else if (this->IsKeyword(Keyword::TEST, *current)) {
+      if (policy64IsOld) {
+        continue;
+      }
+      this->ReduceOneArg(OpCode::Test, args, current, next);
+    }
+  }
+  return true;
+}
+
+//=========================================================================
+// level two handles most binary operations except for AND  OR
+bool cmConditionEvaluator::cmCompiledCondition::CompileLevel2(NodeList& args)
+{
+  for (auto current = args.begin(); current != args.end(); ++current) {
+    auto const next = std::next(current);
+    auto const nextnext = next != args.end() ? std::next(next) : next;
+
+    int matchNo;
+
+    // NOTE Handle special case `if(... BLAH_BLAH MATCHES)`
+    // (i.e., w/o regex to match which is possibly result of
+    // variable expansion to an empty string)
+    if (next != args.end() && this->IsKeyword(Keyword::MATCHES, *current)) {
+      this->ReduceOneArg(OpCode::False, args, current, next);
+    }
+
+    // NOTE Fail fast: All the binary ops below require 2 arguments.
+    else if (next == args.end() || nextnext == args.end()) {
+      continue;
+    }
+
+    else if (this->IsKeyword(Keyword::MATCHES, *next)) {
+      this->ReduceTwoArgs(OpCode::Matches, args, current, next, nextnext);
+    }
+
+    else if ((matchNo = this->MatchKeys(
+                *next, Keyword::LESS, Keyword::LESS_EQUAL, Keyword::GREATER,
+                Keyword::GREATER_EQUAL, Keyword::EQUAL))) {
+      this->ReduceTwoArgs(OpCode::CompareNumbers, args, current, next,
+                          nextnext, matchNo);
+    }
+
+    else if ((matchNo = this->MatchKeys(
+                *next, Keyword::STRLESS, Keyword::STRLESS_EQUAL,
+                Keyword::STRGREATER, Keyword::STRGREATER_EQUAL,
+                Keyword::STREQUAL))) {
+      this->ReduceTwoArgs(OpCode::CompareStrings, args, current, next,
+                          nextnext, matchNo);
+    }
+
+    else if ((matchNo = this->MatchKeys(
+                *next, Keyword::VERSION_LESS, Keyword::VERSION_LESS_EQUAL,
+                Keyword::VERSION_GREATER, Keyword::VERSION_GREATER_EQUAL,
+                Keyword::VERSION_EQUAL))) {
+      this->ReduceTwoArgs(OpCode::CompareVersions, args, current, next,
+                          nextnext, matchNo);
+    }
+
+    // is file A newer than file B
+    else if (this->IsKeyword(Keyword::IS_NEWER_THAN, *next)) {
+      this->ReduceTwoArgs(OpCode::IsNewerThan, args, current, next,
+                          nextnext);
+    }
+
+    else if (this->IsKeyword(Keyword::IN_LIST, *next)) {
+
+      if (this->Policy57Status != cmPolicies::OLD &&
+          this->Policy57Status != cmPolicies::WARN) {
+        this->ReduceTwoArgs(OpCode::InList, args, current, next, nextnext);
+      }
+
+      else if (this->Policy57Status == cmPolicies::WARN) {
+        this->Emit(OpCode::WarnPolicy57);
+      }
+    }
+  }
+  return true;
+}
+
+//=========================================================================
+// level 3 handles NOT
+bool cmConditionEvaluator::cmCompiledCondition::CompileLevel3(NodeList& args)
+{
+  for (auto current = args.begin();
+       current != args.end() && std::next(current) != args.end();
+       ++current) {
+    if (this->IsKeyword(Keyword::NOT, *current)) {
+      this->ReduceOneArg(OpCode::Not, args, current, std::next(current));
+    }
+  }
+  return true;
+}
+
+//=========================================================================
+// level 4 handles AND OR
+bool cmConditionEvaluator::cmCompiledCondition::CompileLevel4(NodeList& args)
+{
+  for (auto current = args.begin(); current != args.end(); ++current) {
+    auto const next = std::next(current);
+    if (next == args.end() || std::next(next) == args.end()) {
+      break;
+    }
+
+    int matchNo;
+
+    if ((matchNo = this->MatchKeys(*next, Keyword::AND, Keyword::OR))) {
+      this->ReduceTwoArgs(OpCode::AndOr, args, current, next, std::next(next),
+                          matchNo);
+    }
+  }
+  return true;
+}
+
+// END cmConditionEvaluator::cmCompiledCondition
+
+cmConditionEvaluator::cmConditionEvaluator(cmMakefile& makefile,
+                                           cmListFileBacktrace bt)
+  : Makefile(makefile)
+  , Backtrace(std::move(bt))
+  , Policy12Status(makefile.GetPolicyStatus(cmPolicies::CMP0012))
+  , Policy54Status(makefile.GetPolicyStatus(cmPolicies::CMP0054))
+  , Policy57Status(makefile.GetPolicyStatus(cmPolicies::CMP0057))
+  , Policy64Status(makefile.GetPolicyStatus(cmPolicies::CMP0064))
+{
+}
+
+bool cmConditionEvaluator::IsTrue(
+  const std::vector<cmExpandedCommandArgument>& args, std::string& errorString,
+  MessageType& status)
+{
+  errorString.clear();
+
+  // handle empty invocation
+  if (args.empty()) {
     return false;
   }
 
-  return this->GetBooleanValueWithAutoDereference(newArgs.front(), errorString,
-                                                  status, true);
+  // The operations of a condition only depend on the keywords it holds and
+  // on the policies changing its operators.
+  const auto policy54IsOld = this->Policy54Status == cmPolicies::WARN ||
+    this->Policy54Status == cmPolicies::OLD;
+  std::string key;
+  key.reserve(args.size() + 2);
+  key += static_cast<char>(this->Policy57Status);
+  key += static_cast<char>(this->Policy64Status);
+  for (cmExpandedCommandArgument const& arg : args) {
+    if (arg.WasQuoted() && !policy54IsOld) {
+      key += cmCompiledCondition::KeyOf(Keyword::None, false);
+      continue;
+    }
+    Keyword const keyword = findKeyword(arg.GetValue());
+    key += cmCompiledCondition::KeyOf(
+      keyword,
+      keyword != Keyword::None && arg.WasQuoted() &&
+        this->Policy54Status == cmPolicies::WARN);
+  }
+
+  // Keep the compiled condition alive while it is evaluated.
+  std::shared_ptr<cmCompiledCondition const> const condition =
+    cmCompiledCondition::Get(key, this->Policy57Status, this->Policy64Status);
+  std::vector<char> results(condition->Registers - args.size());
+  return this->Evaluate(*condition, 0, args, results, errorString, status);
 }
 
 //=========================================================================
@@ -330,42 +786,28 @@ cmValue cmConditionEvaluator::GetVariableOrString(
 }
 
 //=========================================================================
-bool cmConditionEvaluator::IsKeyword(
-  cm::static_string_view keyword,
+void cmConditionEvaluator::WarnQuotedKeyword(
   const cmExpandedCommandArgument& argument) const
 {
-  if ((this->Policy54Status != cmPolicies::WARN &&
-       this->Policy54Status != cmPolicies::OLD) &&
-      argument.WasQuoted()) {
-    return false;
-  }
-
-  const auto isKeyword = argument.GetValue() == keyword;
-
-  if (isKeyword && argument.WasQuoted() &&
-      this->Policy54Status == cmPolicies::WARN) {
-    if (!this->Makefile.HasCMP0054AlreadyBeenReported(this->Backtrace.Top())) {
-      std::ostringstream e;
-      // clang-format off
-      e << cmPolicies::GetPolicyWarning(cmPolicies::CMP0054)
-        << "\n"
-           "Quoted keywords like \"" << argument.GetValue() << "\" "
-           "will no longer be interpreted as keywords "
-           "when the policy is set to NEW.  "
-           "Since the policy is not set the OLD behavior will be used.";
-      // clang-format on
-
-      this->Makefile.GetCMakeInstance()->IssueMessage(
-        MessageType::AUTHOR_WARNING, e.str(), this->Backtrace);
-    }
+  if (!this->Makefile.HasCMP0054AlreadyBeenReported(this->Backtrace.Top())) {
+    std::ostringstream e;
+    // clang-format off
+    e << cmPolicies::GetPolicyWarning(cmPolicies::CMP0054)
+      << "\n"
+         "Quoted keywords like \"" << argument.GetValue() << "\" "
+         "will no longer be interpreted as keywords "
+         "when the policy is set to NEW.  "
+         "Since the policy is not set the OLD behavior will be used.";
+    // clang-format on
+
+    this->Makefile.GetCMakeInstance()->IssueMessage(
+      MessageType::AUTHOR_WARNING, e.str(), this->Backtrace);
   }
-
-  return isKeyword;
 }
 
 //=========================================================================
 bool cmConditionEvaluator::GetBooleanValue(
-  cmExpandedCommandArgument& arg) const
+  cmExpandedCommandArgument const& arg) const
 {
   // Check basic and named constants.
   if (cmIsOn(arg.GetValue())) {
@@ -417,7 +859,7 @@ bool cmConditionEvaluator::GetBooleanValueOld(
 //=========================================================================
 // returns the resulting boolean value
 bool cmConditionEvaluator::GetBooleanValueWithAutoDereference(
-  cmExpandedCommandArgument& newArg, std::string& errorString,
+  cmExpandedCommandArgument const& newArg, std::string& errorString,
   MessageType& status, bool const oneArg) const
 {
   // Use the policy if it is set.
@@ -456,363 +898,255 @@ bool cmConditionEvaluator::GetBooleanValueWithAutoDereference(
   return newResult;
 }
 
-template <int N>
-inline int cmConditionEvaluator::matchKeysImpl(
-  const cmExpandedCommandArgument&)
-{
-  // Zero means "not found"
-  return 0;
-}
-
-template <int N, typename T, typename... Keys>
-inline int cmConditionEvaluator::matchKeysImpl(
-  const cmExpandedCommandArgument& arg, T current, Keys... key)
+//=========================================================================
+bool cmConditionEvaluator::Evaluate(
+  cmCompiledCondition const& condition, std::size_t first,
+  const std::vector<cmExpandedCommandArgument>& args,
+  std::vector<char>& results, std::string& errorString, MessageType& status)
 {
-  if (this->IsKeyword(current, arg)) {
-    // Stop searching as soon as smth has found
-    return N;
-  }
-  return matchKeysImpl<N + 1>(arg, key...);
-}
+  using OpCode = cmCompiledCondition::OpCode;
 
-template <typename... Keys>
-inline int cmConditionEvaluator::matchKeys(
-  const cmExpandedCommandArgument& arg, Keys... key)
-{
-  // Get index of the matched key (1-based)
-  return matchKeysImpl<1>(arg, key...);
-}
+  auto const operand =
+    [&](unsigned int reg) -> cmExpandedCommandArgument const& {
+    if (reg < args.size()) {
+      return args[reg];
+    }
+    return results[reg - args.size()] ? argumentTrue : argumentFalse;
+  };
 
-//=========================================================================
-// level 0 processes parenthetical expressions
-bool cmConditionEvaluator::HandleLevel0(cmArgumentList& newArgs,
-                                        std::string& errorString,
-                                        MessageType& status)
-{
-  for (auto arg = newArgs.begin(); arg != newArgs.end(); ++arg) {
-    if (this->IsKeyword(keyParenL, *arg)) {
-      // search for the closing paren for this opening one
-      auto depth = 1;
-      auto argClose = std::next(arg);
-      for (; argClose != newArgs.end() && depth; ++argClose) {
-        depth += int(this->IsKeyword(keyParenL, *argClose)) -
-          int(this->IsKeyword(keyParenR, *argClose));
-      }
-      if (depth) {
+  for (std::size_t i = first;; ++i) {
+    cmCompiledCondition::Op const& op = condition.Ops[i];
+    bool result = false;
+    switch (op.Code) {
+      case OpCode::ClearError:
+        errorString.clear();
+        continue;
+      case OpCode::Result:
+        return this->GetBooleanValueWithAutoDereference(
+          operand(op.Lhs), errorString, status, true);
+      case OpCode::ResultFalse:
+        return false;
+      case OpCode::FailParenthesis:
         errorString = "mismatched parenthesis in condition";
         status = MessageType::FATAL_ERROR;
         return false;
-      }
-
-      // store the reduced args in this vector
-      auto argOpen = std::next(arg);
-      const std::vector<cmExpandedCommandArgument> subExpr(
-        argOpen, std::prev(argClose));
-
-      // now recursively invoke IsTrue to handle the values inside the
-      // parenthetical expression
-      const auto value = this->IsTrue(subExpr, errorString, status);
-      *arg = cmExpandedCommandArgument(bool2string(value), true);
-      argOpen = std::next(arg);
-      // remove the now evaluated parenthetical expression
-      newArgs.erase(argOpen, argClose);
-    }
-  }
-  return true;
-}
-
-//=========================================================================
-// level one handles most predicates except for NOT
-bool cmConditionEvaluator::HandleLevel1(cmArgumentList& newArgs, std::string&,
-                                        MessageType&)
-{
-  const auto policy64IsOld = this->Policy64Status == cmPolicies::OLD ||
-    this->Policy64Status == cmPolicies::WARN;
+      case OpCode::FailArguments:
+        errorString = "Unknown arguments specified";
+        status = MessageType::FATAL_ERROR;
+        return false;
+      case OpCode::Group:
+        // now recursively evaluate the values inside the parenthetical
+        // expression
+        result =
+          this->Evaluate(condition, i + 1, args, results, errorString, status);
+        i += op.Size;
+        break;
 
-  for (auto args = newArgs.make2ArgsIterator(); args.current != newArgs.end();
-       args.advance(newArgs)) {
+      case OpCode::WarnQuotedKeyword:
+        this->WarnQuotedKeyword(operand(op.Lhs));
+        continue;
+      case OpCode::WarnPolicy57: {
+        std::ostringstream e;
+        e << cmPolicies::GetPolicyWarning(cmPolicies::CMP0057)
+          << "\n"
+             "IN_LIST will be interpreted as an operator "
+             "when the policy is set to NEW.  "
+             "Since the policy is not set the OLD behavior will be used.";
 
-    auto policyCheck = [&, this](const cmPolicies::PolicyID id,
-                                 const cmPolicies::PolicyStatus status,
-                                 const cm::static_string_view kw) {
-      if (status == cmPolicies::WARN && this->IsKeyword(kw, *args.current)) {
+        this->Makefile.IssueMessage(MessageType::AUTHOR_WARNING, e.str());
+        continue;
+      }
+      case OpCode::WarnPolicy64: {
         std::ostringstream e;
-        e << cmPolicies::GetPolicyWarning(id) << "\n"
-          << kw
+        e << cmPolicies::GetPolicyWarning(cmPolicies::CMP0064) << "\n"
+          << keyTEST
           << " will be interpreted as an operator "
              "when the policy is set to NEW.  "
              "Since the policy is not set the OLD behavior will be used.";
 
         this->Makefile.IssueMessage(MessageType::AUTHOR_WARNING, e.str());
+        continue;
       }
-    };
-
-    // NOTE Checking policies for warnings are not require an access to the
-    // next arg. Check them first!
-    policyCheck(cmPolicies::CMP0064, this->Policy64Status, keyTEST);
 
-    // NOTE Fail fast: All the predicates below require the next arg to be
-    // valid
-    if (args.next == newArgs.end()) {
-      continue;
-    }
-
-    // does a file exist
-    if (this->IsKeyword(keyEXISTS, *args.current)) {
-      newArgs.ReduceOneArg(cmSystemTools::FileExists(args.next->GetValue()),
-                           args);
-    }
-    // does a directory with this name exist
-    else if (this->IsKeyword(keyIS_DIRECTORY, *args.current)) {
-      newArgs.ReduceOneArg(
-        cmSystemTools::FileIsDirectory(args.next->GetValue()), args);
-    }
-    // does a symlink with this name exist
-    else if (this->IsKeyword(keyIS_SYMLINK, *args.current)) {
-      newArgs.ReduceOneArg(cmSystemTools::FileIsSymlink(args.next->GetValue()),
-                           args);
-    }
-    // is the given path an absolute path ?
-    else if (this->IsKeyword(keyIS_ABSOLUTE, *args.current)) {
-      newArgs.ReduceOneArg(
-        cmSystemTools::FileIsFullPath(args.next->GetValue()), args);
-    }
-    // does a command exist
-    else if (this->IsKeyword(keyCOMMAND, *args.current)) {
-      newArgs.ReduceOneArg(
-        bool(this->Makefile.GetState()->GetCommand(args.next->GetValue())),
-        args);
-    }
-    // does a policy exist
-    else if (this->IsKeyword(keyPOLICY, *args.current)) {
-      cmPolicies::PolicyID pid;
-      newArgs.ReduceOneArg(
-        cmPolicies::GetPolicyID(args.next->GetValue().c_str(), pid), args);
-    }
-    // does a target exist
-    else if (this->IsKeyword(keyTARGET, *args.current)) {
-      newArgs.ReduceOneArg(
-        bool(this->Makefile.FindTargetToUse(args.next->GetValue())), args);
-    }
-    // is a variable defined
-    else if (this->IsKeyword(keyDEFINED, *args.current)) {
-      const auto& var = args.next->GetValue();
-      const auto varNameLen = var.size();
-
-      auto result = false;
-      if (looksLikeSpecialVariable(var, "ENV"_s, varNameLen)) {
-        const auto env = args.next->GetValue().substr(4, varNameLen - 5);
-        result = cmSystemTools::HasEnv(env);
+      // does a file exist
+      case OpCode::Exists:
+        result = cmSystemTools::FileExists(operand(op.Lhs).GetValue());
+        break;
+      // does a directory with this name exist
+      case OpCode::IsDirectory:
+        result = cmSystemTools::FileIsDirectory(operand(op.Lhs).GetValue());
+        break;
+      // does a symlink with this name exist
+      case OpCode::IsSymlink:
+        result = cmSystemTools::FileIsSymlink(operand(op.Lhs).GetValue());
+        break;
+      // is the given path an absolute path ?
+      case OpCode::IsAbsolute:
+        result = cmSystemTools::FileIsFullPath(operand(op.Lhs).GetValue());
+        break;
+      // does a command exist
+      case OpCode::Command:
+        result = bool(
+          this->Makefile.GetState()->GetCommand(operand(op.Lhs).GetValue()));
+        break;
+      // does a policy exist
+      case OpCode::Policy: {
+        cmPolicies::PolicyID pid;
+        result =
+          cmPolicies::GetPolicyID(operand(op.Lhs).GetValue().c_str(), pid);
+        break;
       }
-
-      else if (looksLikeSpecialVariable(var, "CACHE"_s, varNameLen)) {
-        const auto cache = args.next->GetValue().substr(6, varNameLen - 7);
-        result = bool(this->Makefile.GetState()->GetCacheEntryValue(cache));
+      // does a target exist
+      case OpCode::Target:
+        result =
+          bool(this->Makefile.FindTargetToUse(operand(op.Lhs).GetValue()));
+        break;
+      // is a variable defined
+      case OpCode::Defined: {
+        const auto& var = operand(op.Lhs).GetValue();
+        const auto varNameLen = var.size();
+
+        if (looksLikeSpecialVariable(var, "ENV"_s, varNameLen)) {
+          const auto env = var.substr(4, varNameLen - 5);
+          result = cmSystemTools::HasEnv(env);
+        }
+
+        else if (looksLikeSpecialVariable(var, "CACHE"_s, varNameLen)) {
+          const auto cache = var.substr(6, varNameLen - 7);
+          result = bool(this->Makefile.GetState()->GetCacheEntryValue(cache));
+        }
+
+        else {
+          result = this->Makefile.IsDefinitionSet(var);
+        }
+        break;
       }
+      // does a test exist
+      case OpCode::Test:
+        result = bool(this->Makefile.GetTest(operand(op.Lhs).GetValue()));
+        break;
 
-      else {
-        result = this->Makefile.IsDefinitionSet(args.next->GetValue());
-      }
-      newArgs.ReduceOneArg(result, args);
-    }
-    // does a test exist
-    else if (this->IsKeyword(keyTEST, *args.current)) {
-      if (policy64IsOld) {
-        continue;
+      case OpCode::False:
+        break;
+      case OpCode::Matches:
+        if (!this->EvaluateMatches(operand(op.Lhs), operand(op.Rhs), result,
+                                   errorString, status)) {
+          return false;
+        }
+        break;
+      case OpCode::CompareNumbers: {
+        cmValue ldef = this->GetVariableOrString(operand(op.Lhs));
+        cmValue rdef = this->GetVariableOrString(operand(op.Rhs));
+
+        double lhs;
+        double rhs;
+        auto parseDoubles = [&]() {
+          return std::sscanf(ldef->c_str(), "%lg", &lhs) == 1 &&
+            std::sscanf(rdef->c_str(), "%lg", &rhs) == 1;
+        };
+        // clang-format off
+        result = parseDoubles() &&
+          cmRt2CtSelector<
+              std::less, std::less_equal,
+              std::greater, std::greater_equal,
+              std::equal_to
+            >::eval(op.Select, lhs, rhs);
+        // clang-format on
+        break;
       }
-      newArgs.ReduceOneArg(bool(this->Makefile.GetTest(args.next->GetValue())),
-                           args);
-    }
-  }
-  return true;
-}
-
-//=========================================================================
-// level two handles most binary operations except for AND  OR
-bool cmConditionEvaluator::HandleLevel2(cmArgumentList& newArgs,
-                                        std::string& errorString,
-                                        MessageType& status)
-{
-  for (auto args = newArgs.make3ArgsIterator(); args.current != newArgs.end();
-       args.advance(newArgs)) {
-
-    int matchNo;
-
-    // NOTE Handle special case `if(... BLAH_BLAH MATCHES)`
-    // (i.e., w/o regex to match which is possibly result of
-    // variable expansion to an empty string)
-    if (args.next != newArgs.end() &&
-        this->IsKeyword(keyMATCHES, *args.current)) {
-      newArgs.ReduceOneArg(false, args);
-    }
-
-    // NOTE Fail fast: All the binary ops below require 2 arguments.
-    else if (args.next == newArgs.end() || args.nextnext == newArgs.end()) {
-      continue;
-    }
-
-    else if (this->IsKeyword(keyMATCHES, *args.next)) {
-      cmValue def = this->GetDefinitionIfUnquoted(*args.current);
-
-      std::string def_buf;
-      if (!def) {
-        def = cmValue(args.current->GetValue());
-      } else if (cmHasLiteralPrefix(args.current->GetValue(),
-                                    "CMAKE_MATCH_")) {
-        // The string to match is owned by our match result variables.
-        // Move it to our own buffer before clearing them.
-        def_buf = *def;
-        def = cmValue(def_buf);
+      case OpCode::CompareStrings: {
+        const cmValue lhs = this->GetVariableOrString(operand(op.Lhs));
+        const cmValue rhs = this->GetVariableOrString(operand(op.Rhs));
+        const auto val = (*lhs).compare(*rhs);
+        // clang-format off
+        result = cmRt2CtSelector<
+              std::less, std::less_equal,
+              std::greater, std::greater_equal,
+              std::equal_to
+            >::eval(op.Select, val, 0);
+        // clang-format on
+        break;
       }
-
-      this->Makefile.ClearMatches();
-
-      const auto& rex = args.nextnext->GetValue();
-      cmsys::RegularExpression regEntry;
-      if (!regEntry.compile(rex)) {
-        std::ostringstream error;
-        error << "Regular expression \"" << rex << "\" cannot compile";
-        errorString = error.str();
-        status = MessageType::FATAL_ERROR;
-        return false;
+      case OpCode::CompareVersions: {
+        const auto cmpOp = MATCH2CMPOP[op.Select - 1];
+        const std::string& lhs = this->GetVariableOrString(operand(op.Lhs));
+        const std::string& rhs = this->GetVariableOrString(operand(op.Rhs));
+        result = cmSystemTools::VersionCompare(cmpOp, lhs, rhs);
+        break;
       }
-
-      const auto match = regEntry.find(*def);
-      if (match) {
-        this->Makefile.StoreMatches(regEntry);
+      // is file A newer than file B
+      case OpCode::IsNewerThan: {
+        auto fileIsNewer = 0;
+        cmsys::Status ftcStatus = cmSystemTools::FileTimeCompare(
+          operand(op.Lhs).GetValue(), operand(op.Rhs).GetValue(),
+          &fileIsNewer);
+        result = (!ftcStatus || fileIsNewer == 1 || fileIsNewer == 0);
+        break;
       }
-      newArgs.ReduceTwoArgs(match, args);
-    }
+      case OpCode::InList: {
+        cmValue lhs = this->GetVariableOrString(operand(op.Lhs));
+        cmValue rhs =
+          this->Makefile.GetDefinition(operand(op.Rhs).GetValue());
 
-    else if ((matchNo =
-                this->matchKeys(*args.next, keyLESS, keyLESS_EQUAL, keyGREATER,
-                                keyGREATER_EQUAL, keyEQUAL))) {
-
-      cmValue ldef = this->GetVariableOrString(*args.current);
-      cmValue rdef = this->GetVariableOrString(*args.nextnext);
-
-      double lhs;
-      double rhs;
-      auto parseDoubles = [&]() {
-        return std::sscanf(ldef->c_str(), "%lg", &lhs) == 1 &&
-          std::sscanf(rdef->c_str(), "%lg", &rhs) == 1;
-      };
-      // clang-format off
-      const auto result = parseDoubles() &&
-        cmRt2CtSelector<
-            std::less, std::less_equal,
-            std::greater, std::greater_equal,
-            std::equal_to
-          >::eval(matchNo, lhs, rhs);
-      // clang-format on
-      newArgs.ReduceTwoArgs(result, args);
-    }
-
-    else if ((matchNo = this->matchKeys(*args.next, keySTRLESS,
-                                        keySTRLESS_EQUAL, keySTRGREATER,
-                                        keySTRGREATER_EQUAL, keySTREQUAL))) {
-
-      const cmValue lhs = this->GetVariableOrString(*args.current);
-      const cmValue rhs = this->GetVariableOrString(*args.nextnext);
-      const auto val = (*lhs).compare(*rhs);
-      // clang-format off
-      const auto result = cmRt2CtSelector<
-            std::less, std::less_equal,
-            std::greater, std::greater_equal,
-            std::equal_to
-          >::eval(matchNo, val, 0);
-      // clang-format on
-      newArgs.ReduceTwoArgs(result, args);
-    }
-
-    else if ((matchNo =
-                this->matchKeys(*args.next, keyVERSION_LESS,
-                                keyVERSION_LESS_EQUAL, keyVERSION_GREATER,
-                                keyVERSION_GREATER_EQUAL, keyVERSION_EQUAL))) {
-      const auto op = MATCH2CMPOP[matchNo - 1];
-      const std::string& lhs = this->GetVariableOrString(*args.current);
-      const std::string& rhs = this->GetVariableOrString(*args.nextnext);
-      const auto result = cmSystemTools::VersionCompare(op, lhs, rhs);
-      newArgs.ReduceTwoArgs(result, args);
-    }
-
-    // is file A newer than file B
-    else if (this->IsKeyword(keyIS_NEWER_THAN, *args.next)) {
-      auto fileIsNewer = 0;
-      cmsys::Status ftcStatus = cmSystemTools::FileTimeCompare(
-        args.current->GetValue(), args.nextnext->GetValue(), &fileIsNewer);
-      newArgs.ReduceTwoArgs(
-        (!ftcStatus || fileIsNewer == 1 || fileIsNewer == 0), args);
-    }
-
-    else if (this->IsKeyword(keyIN_LIST, *args.next)) {
-
-      if (this->Policy57Status != cmPolicies::OLD &&
-          this->Policy57Status != cmPolicies::WARN) {
-
-        cmValue lhs = this->GetVariableOrString(*args.current);
-        cmValue rhs = this->Makefile.GetDefinition(args.nextnext->GetValue());
-
-        newArgs.ReduceTwoArgs(
-          rhs && cm::contains(cmExpandedList(*rhs, true), *lhs), args);
+        result = rhs && cm::contains(cmExpandedList(*rhs, true), *lhs);
+        break;
       }
 
-      else if (this->Policy57Status == cmPolicies::WARN) {
-        std::ostringstream e;
-        e << cmPolicies::GetPolicyWarning(cmPolicies::CMP0057)
-          << "\n"
-             "IN_LIST will be interpreted as an operator "
-             "when the policy is set to NEW.  "
-             "Since the policy is not set the OLD behavior will be used.";
-
-        this->Makefile.IssueMessage(MessageType::AUTHOR_WARNING, e.str());
+      case OpCode::Not:
+        result = !this->GetBooleanValueWithAutoDereference(
+          operand(op.Lhs), errorString, status);
+        break;
+      case OpCode::AndOr: {
+        const auto lhs = this->GetBooleanValueWithAutoDereference(
+          operand(op.Lhs), errorString, status);
+        const auto rhs = this->GetBooleanValueWithAutoDereference(
+          operand(op.Rhs), errorString, status);
+        // clang-format off
+        result =
+          cmRt2CtSelector<
+              std::logical_and, std::logical_or
+            >::eval(op.Select, lhs, rhs);
+        // clang-format on
+        break;
       }
     }
+    results[op.Dst - args.size()] = result;
   }
-  return true;
 }
 
 //=========================================================================
-// level 3 handles NOT
-bool cmConditionEvaluator::HandleLevel3(cmArgumentList& newArgs,
-                                        std::string& errorString,
-                                        MessageType& status)
+bool cmConditionEvaluator::EvaluateMatches(
+  const cmExpandedCommandArgument& lhs, const cmExpandedCommandArgument& rhs,
+  bool& result, std::string& errorString, MessageType& status)
 {
-  for (auto args = newArgs.make2ArgsIterator(); args.next != newArgs.end();
-       args.advance(newArgs)) {
-    if (this->IsKeyword(keyNOT, *args.current)) {
-      const auto rhs = this->GetBooleanValueWithAutoDereference(
-        *args.next, errorString, status);
-      newArgs.ReduceOneArg(!rhs, args);
-    }
+  cmValue def = this->GetDefinitionIfUnquoted(lhs);
+
+  std::string def_buf;
+  if (!def) {
+    def = cmValue(lhs.GetValue());
+  } else if (cmHasLiteralPrefix(lhs.GetValue(), "CMAKE_MATCH_")) {
+    // The string to match is owned by our match result variables.
+    // Move it to our own buffer before clearing them.
+    def_buf = *def;
+    def = cmValue(def_buf);
   }
-  return true;
-}
 
-//=========================================================================
-// level 4 handles AND OR
-bool cmConditionEvaluator::HandleLevel4(cmArgumentList& newArgs,
-                                        std::string& errorString,
-                                        MessageType& status)
-{
-  for (auto args = newArgs.make3ArgsIterator(); args.nextnext != newArgs.end();
-       args.advance(newArgs)) {
+  this->Makefile.ClearMatches();
 
-    int matchNo;
+  const auto& rex = rhs.GetValue();
+  cmRegexCache::Regex const regEntry = cmRegexCache::Get(rex);
+  if (!regEntry) {
+    std::ostringstream error;
+    error << "Regular expression \"" << rex << "\" cannot compile";
+    errorString = error.str();
+    status = MessageType::FATAL_ERROR;
+    return false;
+  }
 
-    if ((matchNo = this->matchKeys(*args.next, keyAND, keyOR))) {
-      const auto lhs = this->GetBooleanValueWithAutoDereference(
-        *args.current, errorString, status);
-      const auto rhs = this->GetBooleanValueWithAutoDereference(
-        *args.nextnext, errorString, status);
-      // clang-format off
-      const auto result =
-        cmRt2CtSelector<
-            std::logical_and, std::logical_or
-          >::eval(matchNo, lhs, rhs);
-      // clang-format on
-      newArgs.ReduceTwoArgs(result, args);
-    }
+  cmsys::RegularExpressionMatch match;
+  result = regEntry->find(def->c_str(), match);
+  if (result) {
+    this->Makefile.StoreMatches(match);
   }
   return true;
 }
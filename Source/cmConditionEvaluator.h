@@ -4,11 +4,10 @@
 
 #include "cmConfigure.h" // IWYU pragma: keep
 
+#include <cstddef>
 #include <string>
 #include <vector>
 
-#include <cmext/string_view>
-
 #include "cmListFileCache.h"
 #include "cmMessageType.h"
 #include "cmPolicies.h"
@@ -29,7 +28,7 @@ public:
               std::string& errorString, MessageType& status);
 
 private:
-  class cmArgumentList;
+  class cmCompiledCondition;
 
   // Filter the given variable definition based on policy CMP0054.
   cmValue GetDefinitionIfUnquoted(
@@ -37,41 +36,26 @@ private:
 
   cmValue GetVariableOrString(const cmExpandedCommandArgument& argument) const;
 
-  bool IsKeyword(cm::static_string_view keyword,
-                 const cmExpandedCommandArgument& argument) const;
+  // Warn about a quoted argument interpreted as a keyword (CMP0054).
+  void WarnQuotedKeyword(const cmExpandedCommandArgument& argument) const;
 
-  bool GetBooleanValue(cmExpandedCommandArgument& arg) const;
+  bool GetBooleanValue(cmExpandedCommandArgument const& arg) const;
 
   bool GetBooleanValueOld(cmExpandedCommandArgument const& arg,
                           bool one) const;
 
-  bool GetBooleanValueWithAutoDereference(cmExpandedCommandArgument& newArg,
-                                          std::string& errorString,
-                                          MessageType& status,
-                                          bool oneArg = false) const;
-
-  template <int N>
-  int matchKeysImpl(const cmExpandedCommandArgument&);
-
-  template <int N, typename T, typename... Keys>
-  int matchKeysImpl(const cmExpandedCommandArgument&, T, Keys...);
-
-  template <typename... Keys>
-  int matchKeys(const cmExpandedCommandArgument&, Keys...);
-
-  bool HandleLevel0(cmArgumentList& newArgs, std::string& errorString,
-                    MessageType& status);
-
-  bool HandleLevel1(cmArgumentList& newArgs, std::string&, MessageType&);
-
-  bool HandleLevel2(cmArgumentList& newArgs, std::string& errorString,
-                    MessageType& status);
+  bool GetBooleanValueWithAutoDereference(
+    cmExpandedCommandArgument const& newArg, std::string& errorString,
+    MessageType& status, bool oneArg = false) const;
 
-  bool HandleLevel3(cmArgumentList& newArgs, std::string& errorString,
-                    MessageType& status);
+  bool Evaluate(cmCompiledCondition const& condition, std::size_t first,
+                const std::vector<cmExpandedCommandArgument>& args,
+                std::vector<char>& results, std::string& errorString,
+                MessageType& status);
 
-  bool HandleLevel4(cmArgumentList& newArgs, std::string& errorString,
-                    MessageType& status);
+  bool EvaluateMatches(const cmExpandedCommandArgument& lhs,
+                       const cmExpandedCommandArgument& rhs, bool& result,
+                       std::string& errorString, MessageType& status);
 
   cmMakefile& Makefile;
   cmListFileBacktrace Backtrace;
@@ -9,15 +9,19 @@
 
 #include <cm/string_view>
 
+#include "cmStringAlgorithms.h"
+
 cmDefinitions::Def cmDefinitions::NoDef;
 
-cmDefinitions::Def const& cmDefinitions::GetInternal(const std::string& key,
+std::size_t cmDefinitions::Modifications = 0;
+
+cmDefinitions::Def const& cmDefinitions::GetInternal(Key const& key,
                                                      StackIter begin,
                                                      StackIter end, bool raise)
 {
   assert(begin != end);
   {
-    auto it = begin->Map.find(cm::String::borrow(key));
+    auto it = begin->Map.find(key);
     if (it != begin->Map.end()) {
       return it->second;
     }
@@ -27,31 +31,153 @@ cmDefinitions::Def const& cmDefinitions::GetInternal(const std::string& key,
   if (it == end) {
     return cmDefinitions::NoDef;
   }
-  Def const& def = cmDefinitions::GetInternal(key, it, end, raise);
   if (!raise) {
-    return def;
+    return cmDefinitions::GetFromParents(key, begin, end);
+  }
+  Def const& def = cmDefinitions::GetInternal(key, it, end, raise);
+  begin->Modified();
+  return begin->Map.emplace(key.Owned(), def).first->second;
+}
+
+cmDefinitions::Def const& cmDefinitions::GetFromParents(Key const& key,
+                                                        StackIter begin,
+                                                        StackIter end)
+{
+  // Most keys are found in the direct parent: do not cache them.
+  StackIter parent = begin;
+  ++parent;
+  {
+    auto it = parent->Map.find(key);
+    if (it != parent->Map.end()) {
+      return it->second;
+    }
   }
-  return begin->Map.emplace(key, def).first->second;
+
+  // Reuse the depth found by the last lookup if the scopes it skipped
+  // were not modified since.
+  auto lookup = begin->Lookups.find(key);
+  if (lookup != begin->Lookups.end()) {
+    Lookup const& last = lookup->second;
+    StackIter it = parent;
+    std::size_t depth = 0;
+    for (++it; it != end && depth < last.Depth &&
+         it->LastModification <= last.Modifications;
+         ++it) {
+      ++depth;
+    }
+    if (depth == last.Depth) {
+      if (it == end) {
+        return cmDefinitions::NoDef;
+      }
+      auto def = it->Map.find(key);
+      if (def != it->Map.end()) {
+        return def->second;
+      }
+    }
+  }
+
+  if (lookup == begin->Lookups.end()) {
+    lookup = begin->Lookups.emplace(key.Owned(), Lookup()).first;
+  }
+  lookup->second.Depth = 0;
+  lookup->second.Modifications = Modifications;
+  StackIter it = parent;
+  for (++it; it != end; ++it) {
+    auto def = it->Map.find(key);
+    if (def != it->Map.end()) {
+      return def->second;
+    }
+    ++lookup->second.Depth;
+  }
+  return cmDefinitions::NoDef;
 }
 
 cmValue cmDefinitions::Get(const std::string& key, StackIter begin,
                            StackIter end)
 {
-  Def const& def = cmDefinitions::GetInternal(key, begin, end, false);
-  return def.Value ? cmValue(def.Value.str_if_stable()) : nullptr;
+  Def const& def =
+    cmDefinitions::GetInternal(cm::String::borrow(key), begin, end, false);
+  return def.Value ? cmValue(def.Value.get()) : nullptr;
+}
+
+std::shared_ptr<std::vector<std::string> const> cmDefinitions::GetList(
+  const std::string& key, StackIter begin, StackIter end)
+{
+  Def const& def =
+    cmDefinitions::GetInternal(cm::String::borrow(key), begin, end, false);
+  if (!def.Value) {
+    return nullptr;
+  }
+  if (!def.List) {
+    auto list = std::make_shared<std::vector<std::string>>();
+    if (!def.Value->empty()) {
+      cmExpandList(*def.Value, *list, true);
+    }
+    def.List = std::move(list);
+    def.ListIsPlain = def.Value->find_first_of("[]") == std::string::npos;
+  }
+  return def.List;
+}
+
+cmValue cmDefinitions::Append(const std::string& key,
+                              cm::string_view elements, StackIter begin,
+                              StackIter end)
+{
+  Key const k(cm::String::borrow(key));
+  auto local = begin->Map.find(k);
+  if (local != begin->Map.end() && local->second.Value &&
+      local->second.Value.use_count() == 1) {
+    // No other scope sees this value: appending to it in place makes
+    // repeated appends linear.
+    Def& def = local->second;
+    // The split of the value is extended too, unless it is used elsewhere
+    // or the new elements could merge with the last one.
+    bool const extendList = def.List && def.List.use_count() == 1 &&
+      def.ListIsPlain &&
+      (def.Value->empty() || def.Value->back() != '\\') &&
+      elements.find_first_of("[]") == cm::string_view::npos;
+    if (!def.Value->empty()) {
+      *def.Value += ';';
+    }
+    def.Value->append(elements.data(), elements.size());
+    if (!extendList) {
+      def.List.reset();
+    } else if (!def.Value->empty()) {
+      cmExpandList(elements, *def.List, true);
+    }
+    return cmValue(def.Value.get());
+  }
+
+  Def const& def = cmDefinitions::GetInternal(k, begin, end, false);
+  if (!def.Value) {
+    return nullptr;
+  }
+  std::string value = *def.Value;
+  if (!value.empty()) {
+    value += ';';
+  }
+  value.append(elements.data(), elements.size());
+  if (local != begin->Map.end()) {
+    local->second = Def(std::move(value));
+  } else {
+    local = begin->Map.emplace(k.Owned(), Def(std::move(value))).first;
+  }
+  begin->Modified();
+  return cmValue(local->second.Value.get());
 }
 
 void cmDefinitions::Raise(const std::string& key, StackIter begin,
                           StackIter end)
 {
-  cmDefinitions::GetInternal(key, begin, end, true);
+  cmDefinitions::GetInternal(cm::String::borrow(key), begin, end, true);
 }
 
 bool cmDefinitions::HasKey(const std::string& key, StackIter begin,
                            StackIter end)
 {
+  Key const k(cm::String::borrow(key));
   for (StackIter it = begin; it != end; ++it) {
-    if (it->Map.find(cm::String::borrow(key)) != it->Map.end()) {
+    if (it->Map.find(k) != it->Map.end()) {
       return true;
     }
   }
@@ -61,17 +187,17 @@ bool cmDefinitions::HasKey(const std::string& key, StackIter begin,
 cmDefinitions cmDefinitions::MakeClosure(StackIter begin, StackIter end)
 {
   cmDefinitions closure;
-  std::unordered_set<cm::string_view> undefined;
+  std::unordered_set<Key, KeyHash> undefined;
   for (StackIter it = begin; it != end; ++it) {
     // Consider local definitions.
     for (auto const& mi : it->Map) {
       // Use this key if it is not already set or unset.
       if (closure.Map.find(mi.first) == closure.Map.end() &&
-          undefined.find(mi.first.view()) == undefined.end()) {
+          undefined.find(mi.first) == undefined.end()) {
         if (mi.second.Value) {
           closure.Map.insert(mi);
         } else {
-          undefined.emplace(mi.first.view());
+          undefined.insert(mi.first);
         }
       }
     }
@@ -83,14 +209,29 @@ std::vector<std::string> cmDefinitions::ClosureKeys(StackIter begin,
                                                     StackIter end)
 {
   std::vector<std::string> defined;
-  std::unordered_set<cm::string_view> bound;
 
+  // The keys of a single scope, as in directory scopes, are unique.
+  if (begin != end) {
+    StackIter parent = begin;
+    ++parent;
+    if (parent == end) {
+      defined.reserve(begin->Map.size());
+      for (auto const& mi : begin->Map) {
+        if (mi.second.Value) {
+          defined.push_back(*mi.first.Name.str_if_stable());
+        }
+      }
+      return defined;
+    }
+  }
+
+  std::unordered_set<Key, KeyHash> bound;
   for (StackIter it = begin; it != end; ++it) {
     defined.reserve(defined.size() + it->Map.size());
     for (auto const& mi : it->Map) {
       // Use this key if it is not already set or unset.
-      if (bound.emplace(mi.first.view()).second && mi.second.Value) {
-        defined.push_back(*mi.first.str_if_stable());
+      if (bound.insert(mi.first).second && mi.second.Value) {
+        defined.push_back(*mi.first.Name.str_if_stable());
       }
     }
   }
@@ -103,10 +244,12 @@ void cmDefinitions::Set(const std::string& key, cm::string_view value)
   if (key == "CMAKE_PARENT_LIST_FILE") {
     (void)key.c_str();
   }
-    this->Map[key] = Def(value);
+    this->Map[Key(key)] = Def(value);
+  this->Modified();
 }
 
 void cmDefinitions::Unset(const std::string& key)
 {
-  this->Map[key] = Def();
+  this->Map[Key(key)] = Def();
+  this->Modified();
 }
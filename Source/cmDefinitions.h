@@ -4,9 +4,12 @@
 
 #include "cmConfigure.h" // IWYU pragma: keep
 
+#include <cstddef>
 #include <functional>
+#include <memory>
 #include <string>
 #include <unordered_map>
+#include <utility>
 #include <vector>
 
 #include <cm/string_view>
@@ -20,7 +23,8 @@
  *
  * This stores the state of variable definitions (set or unset) for
  * one scope.  Sets are always local.  Gets search parent scopes
- * transitively and save results locally.
+ * transitively and remember which parent scope defines each key, until
+ * one of the parent scopes is modified.
  */
 class cmDefinitions
 {
@@ -31,6 +35,17 @@ public:
 
   static cmValue Get(const std::string& key, StackIter begin, StackIter end);
 
+  /** Get the elements of a value split as a list, keeping empty elements.
+      The split is kept with the value until it is written again.  */
+  static std::shared_ptr<std::vector<std::string> const> GetList(
+    const std::string& key, StackIter begin, StackIter end);
+
+  /** Append elements to a list value, in place if the value is local and
+      not shared with other scopes.  Returns the new value, or nullptr if
+      the key is not defined.  */
+  static cmValue Append(const std::string& key, cm::string_view elements,
+                        StackIter begin, StackIter end);
+
   static void Raise(const std::string& key, StackIter begin, StackIter end);
 
   static bool HasKey(const std::string& key, StackIter begin, StackIter end);
@@ -54,15 +69,67 @@ private:
   public:
     Def() = default;
     Def(cm::string_view value)
-      : Value(value)
+      : Value(std::make_shared<std::string>(value.data(), value.size()))
     {
     }
-    cm::String Value;
+    Def(std::string&& value)
+      : Value(std::make_shared<std::string>(std::move(value)))
+    {
+    }
+    // Shared by the scopes the definition is copied to.
+    std::shared_ptr<std::string> Value;
+    // Elements of Value, split on first use as a list.
+    mutable std::shared_ptr<std::vector<std::string>> List;
+    // Whether Value has no square brackets: elements appended to it are
+    // then split on their own and added to List.
+    mutable bool ListIsPlain = false;
   };
   static Def NoDef;
 
-  std::unordered_map<cm::String, Def> Map;
+  /** Variable name with its hash, computed once per lookup.  */
+  struct Key
+  {
+    Key(cm::String name)
+      : Name(std::move(name))
+      , Hash(std::hash<cm::String>()(this->Name))
+    {
+    }
+    bool operator==(Key const& other) const
+    {
+      return this->Hash == other.Hash && this->Name == other.Name;
+    }
+    /** Get a copy owning its name: looked up keys borrow the caller's.  */
+    Key Owned() const
+    {
+      Key owned = *this;
+      owned.Name.stabilize();
+      return owned;
+    }
+    cm::String Name;
+    std::size_t Hash;
+  };
+  struct KeyHash
+  {
+    std::size_t operator()(Key const& key) const { return key.Hash; }
+  };
+
+  /** Number of parent scopes to skip to find a key.  */
+  struct Lookup
+  {
+    std::size_t Depth;
+    // Value of Modifications when the key was looked up.
+    std::size_t Modifications;
+  };
+
+  std::unordered_map<Key, Def, KeyHash> Map;
+  std::unordered_map<Key, Lookup, KeyHash> Lookups;
+  // Value of Modifications when this scope was last modified.
+  std::size_t LastModification = 0;
+  static std::size_t Modifications;
 
-  static Def const& GetInternal(const std::string& key, StackIter begin,
+  static Def const& GetInternal(Key const& key, StackIter begin,
                                 StackIter end, bool raise);
+  static Def const& GetFromParents(Key const& key, StackIter begin,
+                                   StackIter end);
+  void Modified() { this->LastModification = ++Modifications; }
 };
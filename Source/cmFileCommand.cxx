@@ -48,6 +48,7 @@
 #include "cmNewLineStyle.h"
 #include "cmPolicies.h"
 #include "cmRange.h"
+#include "cmRegexCache.h"
 #include "cmRuntimeDependencyArchive.h"
 #include "cmState.h"
 #include "cmStringAlgorithms.h"
@@ -311,8 +312,7 @@ bool HandleStringsCommand(std::vector<std::string> const& args,
   int limit_input = -1;
   int limit_output = -1;
   unsigned int limit_count = 0;
-  cmsys::RegularExpression regex;
-  bool have_regex = false;
+  cmRegexCache::Regex regex;
   bool newline_consume = false;
   bool hex_conversion_enabled = true;
   enum
@@ -391,12 +391,12 @@ bool HandleStringsCommand(std::vector<std::string> const& args,
       maxlen = len;
       arg_mode = arg_none;
     } else if (arg_mode == arg_regex) {
-      if (!regex.compile(args[i])) {
+      regex = cmRegexCache::Get(args[i]);
+      if (!regex) {
         status.SetError(cmStrCat("STRINGS option REGEX value \"", args[i],
                                  "\" could not be compiled."));
         return false;
       }
-      have_regex = true;
       arg_mode = arg_none;
     } else if (arg_mode == arg_encoding) {
       if (args[i] == "UTF-8") {
@@ -458,6 +458,11 @@ bool HandleStringsCommand(std::vector<std::string> const& args,
     bytes_rem = 3;
   }
 
+  cmsys::RegularExpressionMatch match;
+  auto const matchesRegex = [&regex, &match](std::string const& str) {
+    return !regex || regex->find(str.c_str(), match);
+  };
+
   // Parse strings out of the file.
   int output_size = 0;
   std::vector<std::string> strings;
@@ -536,7 +541,7 @@ bool HandleStringsCommand(std::vector<std::string> const& args,
       // The current line has been terminated.  Check if the current
       // string matches the requirements.  The length may now be as
       // low as zero since blank lines are allowed.
-      if (s.length() >= minlen && (!have_regex || regex.find(s))) {
+      if (s.length() >= minlen && matchesRegex(s)) {
         output_size += static_cast<int>(s.size()) + 1;
         if (limit_output >= 0 && output_size >= limit_output) {
           s.clear();
@@ -552,7 +557,7 @@ bool HandleStringsCommand(std::vector<std::string> const& args,
       // string matches the requirements.  We require that the length
       // be at least one no matter what the user specified.
       if (s.length() >= minlen && !s.empty() &&
-          (!have_regex || regex.find(s))) {
+          matchesRegex(s)) {
         output_size += static_cast<int>(s.size()) + 1;
         if (limit_output >= 0 && output_size >= limit_output) {
           s.clear();
@@ -569,7 +574,7 @@ bool HandleStringsCommand(std::vector<std::string> const& args,
 
     if (maxlen > 0 && s.size() == maxlen) {
       // Terminate a string if the maximum length is reached.
-      if (s.length() >= minlen && (!have_regex || regex.find(s))) {
+      if (s.length() >= minlen && matchesRegex(s)) {
         output_size += static_cast<int>(s.size()) + 1;
         if (limit_output >= 0 && output_size >= limit_output) {
           s.clear();
@@ -585,7 +590,7 @@ bool HandleStringsCommand(std::vector<std::string> const& args,
   // input file or the input size limit.  Check if the current string
   // matches the requirements.
   if ((!limit_count || strings.size() < limit_count) && !s.empty() &&
-      s.length() >= minlen && (!have_regex || regex.find(s))) {
+      s.length() >= minlen && matchesRegex(s)) {
     output_size += static_cast<int>(s.size()) + 1;
     if (limit_output < 0 || output_size < limit_output) {
       strings.push_back(s);
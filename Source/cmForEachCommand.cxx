@@ -163,9 +163,8 @@ bool cmForEachFunctionBlocker::ReplayZipLists(
   for (auto const& var :
        cmMakeRange(this->Args).advance(this->IterationVarsCount)) {
     std::vector<std::string> items;
-    auto const& value = mf.GetSafeDefinition(var);
-    if (!value.empty()) {
-      cmExpandList(value, items, true);
+    if (mf.GetDefinition(var)) {
+      items = *mf.GetDefinitionList(var);
     }
     maxItems = std::max(maxItems, items.size());
     values.emplace_back(std::move(items));
@@ -342,9 +341,9 @@ bool HandleInMode(std::vector<std::string> const& args,
       fb->SetZipLists();
 
     } else if (doing == DoingLists) {
-      auto const& value = makefile.GetSafeDefinition(arg);
-      if (!value.empty()) {
-        cmExpandList(value, fb->Args, true);
+      if (makefile.GetDefinition(arg)) {
+        auto const list = makefile.GetDefinitionList(arg);
+        fb->Args.insert(fb->Args.end(), list->begin(), list->end());
       }
 
     } else if (doing == DoingItems || doing == DoingZipLists) {
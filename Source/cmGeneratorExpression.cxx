@@ -4,6 +4,8 @@
 
 #include <cassert>
 #include <memory>
+#include <mutex>
+#include <unordered_map>
 #include <utility>
 
 #include "cmsys/RegularExpression.hxx"
@@ -16,6 +18,72 @@
 #include "cmStringAlgorithms.h"
 #include "cmSystemTools.h"
 
+struct cmCompiledGeneratorExpression::ParsedInput
+{
+  ParsedInput(std::string input);
+
+  std::string const Input;
+  bool NeedsEvaluation;
+  std::vector<std::unique_ptr<cmGeneratorExpressionEvaluator>> Evaluators;
+};
+
+cmCompiledGeneratorExpression::ParsedInput::ParsedInput(std::string input)
+  : Input(std::move(input))
+{
+  cmGeneratorExpressionLexer l;
+  std::vector<cmGeneratorExpressionToken> tokens = l.Tokenize(this->Input);
+  this->NeedsEvaluation = l.GetSawGeneratorExpression();
+
+  if (this->NeedsEvaluation) {
+    cmGeneratorExpressionParser p(tokens);
+    p.Parse(this->Evaluators);
+  }
+}
+
+namespace {
+
+using ParsedInputPtr =
+  std::shared_ptr<cmCompiledGeneratorExpression::ParsedInput const>;
+
+// Inputs parsed since the cache was last cleared.  Evaluations do not
+// modify the evaluators, so the same properties of many targets parse once.
+struct ParseCache
+{
+  std::mutex Mutex;
+  std::unordered_map<std::string, ParsedInputPtr> Entries;
+};
+
+ParseCache& GetParseCache()
+{
+  static ParseCache cache;
+  return cache;
+}
+
+ParsedInputPtr GetParsedInput(std::string input)
+{
+  using ParsedInput = cmCompiledGeneratorExpression::ParsedInput;
+  // Strings without generator expressions are not worth keeping.
+  if (cmGeneratorExpression::Find(input) == std::string::npos) {
+    return std::make_shared<ParsedInput const>(std::move(input));
+  }
+
+  ParseCache& cache = GetParseCache();
+  {
+    std::lock_guard<std::mutex> lock(cache.Mutex);
+    auto const it = cache.Entries.find(input);
+    if (it != cache.Entries.end()) {
+      return it->second;
+    }
+  }
+  // Parse without the lock: expressions may be compiled by several threads.
+  auto parsed = std::make_shared<ParsedInput const>(input);
+  std::lock_guard<std::mutex> lock(cache.Mutex);
+  return cache.Entries.emplace(std::move(input), std::move(parsed))
+    .first->second;
+}
+
+} // anonymous namespace
+
 cmGeneratorExpression::cmGeneratorExpression(cmListFileBacktrace backtrace)
   : Backtrace(std::move(backtrace))
 {
@@ -60,17 +128,22 @@ const std::string& cmCompiledGeneratorExpression::Evaluate(
   return this->EvaluateWithContext(context, dagChecker);
 }
 
+std::string const& cmCompiledGeneratorExpression::GetInput() const
+{
+  return this->Parsed->Input;
+}
+
 const std::string& cmCompiledGeneratorExpression::EvaluateWithContext(
   cmGeneratorExpressionContext& context,
   cmGeneratorExpressionDAGChecker* dagChecker) const
 {
-  if (!this->NeedsEvaluation) {
-    return this->Input;
+  if (!this->Parsed->NeedsEvaluation) {
+    return this->Parsed->Input;
   }
 
   this->Output.clear();
 
-  for (const auto& it : this->Evaluators) {
+  for (const auto& it : this->Parsed->Evaluators) {
     this->Output += it->Evaluate(&context, dagChecker);
 
     this->SeenTargetProperties.insert(context.SeenTargetProperties.cbegin(),
@@ -83,6 +156,9 @@ const std::string& cmCompiledGeneratorExpression::EvaluateWithContext(
 
   this->MaxLanguageStandard = context.MaxLanguageStandard;
 
+  // Errors are reported again for each configuration.
+  this->HadConfigSensitiveCondition =
+    context.HadError || context.HadConfigSensitiveCondition;
   if (!context.HadError) {
     this->HadContextSensitiveCondition = context.HadContextSensitiveCondition;
     this->HadHeadSensitiveCondition = context.HadHeadSensitiveCondition;
@@ -99,21 +175,21 @@ const std::string& cmCompiledGeneratorExpression::EvaluateWithContext(
 cmCompiledGeneratorExpression::cmCompiledGeneratorExpression(
   cmListFileBacktrace backtrace, std::string input)
   : Backtrace(std::move(backtrace))
-  , Input(std::move(input))
+  , Parsed(GetParsedInput(std::move(input)))
   , EvaluateForBuildsystem(false)
   , Quiet(false)
   , HadContextSensitiveCondition(false)
+  , HadConfigSensitiveCondition(false)
   , HadHeadSensitiveCondition(false)
   , HadLinkLanguageSensitiveCondition(false)
 {
-  cmGeneratorExpressionLexer l;
-  std::vector<cmGeneratorExpressionToken> tokens = l.Tokenize(this->Input);
-  this->NeedsEvaluation = l.GetSawGeneratorExpression();
+}
 
-  if (this->NeedsEvaluation) {
-    cmGeneratorExpressionParser p(tokens);
-    p.Parse(this->Evaluators);
-  }
+void cmGeneratorExpression::ClearParseCache()
+{
+  ParseCache& cache = GetParseCache();
+  std::lock_guard<std::mutex> lock(cache.Mutex);
+  cache.Entries.clear();
 }
 
 std::string cmGeneratorExpression::StripEmptyListElements(
@@ -18,7 +18,6 @@ class cmGeneratorTarget;
 class cmLocalGenerator;
 struct cmGeneratorExpressionContext;
 struct cmGeneratorExpressionDAGChecker;
-struct cmGeneratorExpressionEvaluator;
 
 /** \class cmGeneratorExpression
  * \brief Evaluate generate-time query expression syntax.
@@ -81,6 +80,13 @@ public:
   static void ReplaceInstallPrefix(std::string& input,
                                    const std::string& replacement);
 
+  /**
+   * Forget the inputs parsed so far.  The expressions parsed from the
+   * same input share its evaluators, which are parsed once, until the
+   * cache is cleared at the start of each generate step.
+   */
+  static void ClearParseCache();
+
 private:
   cmListFileBacktrace Backtrace;
 };
@@ -117,13 +123,17 @@ public:
     return this->AllTargetsSeen;
   }
 
-  std::string const& GetInput() const { return this->Input; }
+  std::string const& GetInput() const;
 
   cmListFileBacktrace GetBacktrace() const { return this->Backtrace; }
   bool GetHadContextSensitiveCondition() const
   {
     return this->HadContextSensitiveCondition;
   }
+  bool GetHadConfigSensitiveCondition() const
+  {
+    return this->HadConfigSensitiveCondition;
+  }
   bool GetHadHeadSensitiveCondition() const
   {
     return this->HadHeadSensitiveCondition;
@@ -147,6 +157,9 @@ public:
   void GetMaxLanguageStandard(cmGeneratorTarget const* tgt,
                               std::map<std::string, std::string>& mapping);
 
+  // Evaluators parsed from an input, which they point into.
+  struct ParsedInput;
+
 private:
   const std::string& EvaluateWithContext(
     cmGeneratorExpressionContext& context,
@@ -158,9 +171,8 @@ private:
   friend class cmGeneratorExpression;
 
   cmListFileBacktrace Backtrace;
-  std::vector<std::unique_ptr<cmGeneratorExpressionEvaluator>> Evaluators;
-  const std::string Input;
-  bool NeedsEvaluation;
+  // Shared by the expressions parsed from the same input.
+  std::shared_ptr<ParsedInput const> Parsed;
   bool EvaluateForBuildsystem;
   bool Quiet;
 
@@ -172,6 +184,7 @@ private:
     MaxLanguageStandard;
   mutable std::string Output;
   mutable bool HadContextSensitiveCondition;
+  mutable bool HadConfigSensitiveCondition;
   mutable bool HadHeadSensitiveCondition;
   mutable bool HadLinkLanguageSensitiveCondition;
   mutable std::set<cmGeneratorTarget const*> SourceSensitiveTargets;
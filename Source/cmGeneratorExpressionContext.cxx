@@ -18,6 +18,7 @@ cmGeneratorExpressionContext::cmGeneratorExpressionContext(
   , Quiet(quiet)
   , HadError(false)
   , HadContextSensitiveCondition(false)
+  , HadConfigSensitiveCondition(false)
   , HadHeadSensitiveCondition(false)
   , HadLinkLanguageSensitiveCondition(false)
   , EvaluateForBuildsystem(evaluateForBuildsystem)
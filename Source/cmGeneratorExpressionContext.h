@@ -38,6 +38,8 @@ struct cmGeneratorExpressionContext
   bool Quiet;
   bool HadError;
   bool HadContextSensitiveCondition;
+  // Whether the result may differ between configurations.
+  bool HadConfigSensitiveCondition;
   bool HadHeadSensitiveCondition;
   bool HadLinkLanguageSensitiveCondition;
   bool EvaluateForBuildsystem;
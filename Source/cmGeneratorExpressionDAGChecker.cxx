@@ -47,26 +47,41 @@ cmGeneratorExpressionDAGChecker::cmGeneratorExpressionDAGChecker(
 
 void cmGeneratorExpressionDAGChecker::Initialize()
 {
-  const auto* top = this->Top();
+  if (this->Parent) {
+    this->Parent->Cacheable = false;
+  }
+
   this->CheckResult = this->CheckGraph();
 
+  if (this->CheckResult == DAG && this->SkipsAlreadySeen() &&
+      !this->MarkSeen(this->Target, this->Property)) {
+    this->CheckResult = ALREADY_SEEN;
+  }
+}
+
+bool cmGeneratorExpressionDAGChecker::SkipsAlreadySeen() const
+{
+  const auto* top = this->Top();
+
 #define TEST_TRANSITIVE_PROPERTY_METHOD(METHOD) top->METHOD() ||
 
-  if (this->CheckResult == DAG &&
-      (CM_FOR_EACH_TRANSITIVE_PROPERTY_METHOD(
-        TEST_TRANSITIVE_PROPERTY_METHOD) false)) // NOLINT(*)
+  return CM_FOR_EACH_TRANSITIVE_PROPERTY_METHOD(
+    TEST_TRANSITIVE_PROPERTY_METHOD) false; // NOLINT(*)
 #undef TEST_TRANSITIVE_PROPERTY_METHOD
-  {
-    auto it = top->Seen.find(this->Target);
-    if (it != top->Seen.end()) {
-      const std::set<std::string>& propSet = it->second;
-      if (propSet.find(this->Property) != propSet.end()) {
-        this->CheckResult = ALREADY_SEEN;
-        return;
-      }
-    }
-    top->Seen[this->Target].insert(this->Property);
-  }
+}
+
+bool cmGeneratorExpressionDAGChecker::MarkSeen(
+  cmGeneratorTarget const* target, std::string const& property) const
+{
+  return this->Top()->Seen[target].insert(property).second;
+}
+
+bool cmGeneratorExpressionDAGChecker::IsSeen(
+  cmGeneratorTarget const* target, std::string const& property) const
+{
+  const auto* top = this->Top();
+  auto it = top->Seen.find(target);
+  return it != top->Seen.end() && it->second.count(property) != 0;
 }
 
 cmGeneratorExpressionDAGChecker::Result
@@ -212,6 +227,11 @@ cmGeneratorTarget const* cmGeneratorExpressionDAGChecker::TopTarget() const
   return this->Top()->Target;
 }
 
+std::string const& cmGeneratorExpressionDAGChecker::TopProperty() const
+{
+  return this->Top()->Property;
+}
+
 enum TransitiveProperty
 {
 #define DEFINE_ENUM_ENTRY(NAME) NAME,
@@ -82,8 +82,25 @@ struct cmGeneratorExpressionDAGChecker
   bool GetTransitivePropertiesOnly() const;
   void SetTransitivePropertiesOnly() { this->TransitivePropertiesOnly = true; }
 
+  // Whether the transitive properties already seen by the top checker
+  // are skipped, instead of being evaluated again.
+  bool SkipsAlreadySeen() const;
+
+  // Record a transitive property as seen by the top checker, as if it was
+  // checked.  Returns false if it was already seen.
+  bool MarkSeen(cmGeneratorTarget const* target,
+                std::string const& property) const;
+  bool IsSeen(cmGeneratorTarget const* target,
+              std::string const& property) const;
+
+  // Whether the value evaluated under this checker depends only on the
+  // evaluation context.  It does not as soon as it refers to properties
+  // of other targets, which depend on the properties already seen.
+  bool IsCacheable() const { return this->Cacheable; }
+
   cmGeneratorExpressionDAGChecker const* Top() const;
   cmGeneratorTarget const* TopTarget() const;
+  std::string const& TopProperty() const;
 
 private:
   Result CheckGraph() const;
@@ -97,4 +114,5 @@ private:
   const cmListFileBacktrace Backtrace;
   Result CheckResult;
   bool TransitivePropertiesOnly;
+  mutable bool Cacheable = true;
 };
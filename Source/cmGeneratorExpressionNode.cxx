@@ -64,6 +64,9 @@ std::string cmGeneratorExpressionNode::EvaluateDependentExpression(
   if (cge->GetHadContextSensitiveCondition()) {
     context->HadContextSensitiveCondition = true;
   }
+  if (cge->GetHadConfigSensitiveCondition()) {
+    context->HadConfigSensitiveCondition = true;
+  }
   if (cge->GetHadHeadSensitiveCondition()) {
     context->HadHeadSensitiveCondition = true;
   }
@@ -538,8 +541,13 @@ static const struct TargetGenexEvalNode : public GenexEvaluator
       context->LG, context->Config, context->Quiet, target, target,
       context->EvaluateForBuildsystem, context->Backtrace, context->Language);
 
-    return this->EvaluateExpression("TARGET_GENEX_EVAL", expression,
-                                    &targetContext, content, dagCheckerParent);
+    std::string result =
+      this->EvaluateExpression("TARGET_GENEX_EVAL", expression,
+                               &targetContext, content, dagCheckerParent);
+    if (targetContext.HadConfigSensitiveCondition) {
+      context->HadConfigSensitiveCondition = true;
+    }
+    return result;
   }
 } targetGenexEvalNode;
 
@@ -876,6 +884,7 @@ static const struct ConfigurationNode : public cmGeneratorExpressionNode
     cmGeneratorExpressionDAGChecker* /*dagChecker*/) const override
   {
     context->HadContextSensitiveCondition = true;
+    context->HadConfigSensitiveCondition = true;
     return context->Config;
   }
 } configurationNode;
@@ -902,6 +911,7 @@ static const struct ConfigurationTestNode : public cmGeneratorExpressionNode
       return std::string();
     }
     context->HadContextSensitiveCondition = true;
+    context->HadConfigSensitiveCondition = true;
     for (auto const& param : parameters) {
       if (context->Config.empty()) {
         if (param.empty()) {
@@ -1217,6 +1227,8 @@ static const struct HostLinkNode : public cmGeneratorExpressionNode
       return std::string();
     }
 
+    // The same link options are evaluated for the device link step.
+    context->HadHeadSensitiveCondition = true;
     return context->HeadTarget->IsDeviceLink() ? std::string()
                                                : cmJoin(parameters, ";");
   }
@@ -1242,6 +1254,8 @@ static const struct DeviceLinkNode : public cmGeneratorExpressionNode
       return std::string();
     }
 
+    // The same link options are evaluated for the host link step.
+    context->HadHeadSensitiveCondition = true;
     if (context->HeadTarget->IsDeviceLink()) {
       std::vector<std::string> list;
       cmExpandLists(parameters.begin(), parameters.end(), list);
@@ -1269,6 +1283,9 @@ std::string getLinkedTargetsContent(
   std::string result;
   if (cmLinkImplementationLibraries const* impl =
         target->GetLinkImplementationLibraries(context->Config)) {
+    if (impl->HadConfigSensitiveCondition) {
+      context->HadConfigSensitiveCondition = true;
+    }
     for (cmLinkImplItem const& lib : impl->Libraries) {
       if (lib.Target) {
         // Pretend $<TARGET_PROPERTY:lib.Target,prop> appeared in our
@@ -1280,6 +1297,9 @@ std::string getLinkedTargetsContent(
           context->Language);
         std::string libResult =
           lib.Target->EvaluateInterfaceProperty(prop, &libContext, dagChecker);
+        if (libContext.HadConfigSensitiveCondition) {
+          context->HadConfigSensitiveCondition = true;
+        }
         if (!libResult.empty()) {
           if (result.empty()) {
             result = std::move(libResult);
@@ -1428,6 +1448,7 @@ static const struct TargetPropertyNode : public cmGeneratorExpressionNode
           "link libraries for a static library");
         return std::string();
       }
+      context->HadConfigSensitiveCondition = true;
       return target->GetLinkerLanguage(context->Config);
     }
 
@@ -1511,6 +1532,8 @@ static const struct TargetPropertyNode : public cmGeneratorExpressionNode
 
     if (!haveProp && !target->IsImported() &&
         target->GetType() != cmStateEnums::INTERFACE_LIBRARY) {
+      // Compatible interface properties are found in the link closure.
+      context->HadConfigSensitiveCondition = true;
       if (target->IsLinkInterfaceDependentBoolProperty(propertyName,
                                                        context->Config)) {
         context->HadContextSensitiveCondition = true;
@@ -1550,6 +1573,7 @@ static const struct TargetPropertyNode : public cmGeneratorExpressionNode
       if (target->IsLinkInterfaceDependentNumberMinProperty(propertyName,
                                                             context->Config)) {
         context->HadContextSensitiveCondition = true;
+        context->HadConfigSensitiveCondition = true;
         const char* propContent =
           target->GetLinkInterfaceDependentNumberMinProperty(propertyName,
                                                              context->Config);
@@ -1558,6 +1582,7 @@ static const struct TargetPropertyNode : public cmGeneratorExpressionNode
       if (target->IsLinkInterfaceDependentNumberMaxProperty(propertyName,
                                                             context->Config)) {
         context->HadContextSensitiveCondition = true;
+        context->HadConfigSensitiveCondition = true;
         const char* propContent =
           target->GetLinkInterfaceDependentNumberMaxProperty(propertyName,
                                                              context->Config);
@@ -1650,6 +1675,7 @@ static const struct TargetObjectsNode : public cmGeneratorExpressionNode
     }
 
     std::vector<std::string> objects;
+    context->HadConfigSensitiveCondition = true;
 
     if (gt->IsImported()) {
       cmValue loc = nullptr;
@@ -1720,6 +1746,7 @@ static const struct TargetRuntimeDllsNode : public cmGeneratorExpressionNode
       return std::string();
     }
 
+    context->HadConfigSensitiveCondition = true;
     if (auto* cli = gt->GetLinkInformation(context->Config)) {
       std::vector<std::string> dllPaths;
       auto const& dlls = cli->GetRuntimeDLLs();
@@ -1786,6 +1813,7 @@ static const struct CompileFeaturesNode : public cmGeneratorExpressionNode
     }
 
     bool evalLL = dagChecker && dagChecker->EvaluatingLinkLibraries();
+    context->HadConfigSensitiveCondition = true;
 
     for (auto const& lit : testedFeatures) {
       std::vector<std::string> const& langAvailable =
@@ -2246,6 +2274,8 @@ protected:
       return nullptr;
     }
 
+    // Artifacts are named and placed for each configuration.
+    context->HadConfigSensitiveCondition = true;
     return target;
   }
 };
@@ -12,10 +12,12 @@
 #include <iterator>
 #include <queue>
 #include <sstream>
+#include <tuple>
 #include <unordered_set>
 #include <utility>
 
 #include <cm/memory>
+#include <cm/optional>
 #include <cm/string_view>
 #include <cmext/algorithm>
 #include <cmext/string_view>
@@ -682,6 +684,15 @@ void cmGeneratorTarget::ClearSourcesCache()
   this->Objects.clear();
   this->VisitedConfigsForObjects.clear();
   this->LinkImplMap.clear();
+  // The transitive values cached by other targets may replay ours.
+  if (!this->InterfacePropertyCache.empty()) {
+    for (auto const& lg : this->GlobalGenerator->GetLocalGenerators()) {
+      for (auto const& gt : lg->GetGeneratorTargets()) {
+        gt->InterfacePropertyCache.clear();
+        gt->ConfigIndependentInterfacePropertyCache.clear();
+      }
+    }
+  }
 }
 
 void cmGeneratorTarget::AddSourceCommon(const std::string& src, bool before)
@@ -1296,6 +1307,65 @@ bool cmGeneratorTarget::MaybeHaveInterfaceProperty(
   return i->second;
 }
 
+bool cmGeneratorTarget::InterfacePropertyKey::operator<(
+  InterfacePropertyKey const& other) const
+{
+  return std::tie(this->Property, this->Config, this->Language,
+                  this->TopProperty, this->LocalGenerator,
+                  this->UsageRequirementsOnly, this->EvaluateForBuildsystem) <
+    std::tie(other.Property, other.Config, other.Language, other.TopProperty,
+             other.LocalGenerator, other.UsageRequirementsOnly,
+             other.EvaluateForBuildsystem);
+}
+
+namespace {
+// Whether reused transitive properties are evaluated again and compared.
+bool VerifyInterfacePropertyCache()
+{
+  static bool const verify = [] {
+    std::string value;
+    return cmSystemTools::GetEnv("CMAKE_VERIFY_USAGE_REQUIREMENTS_CACHE",
+                                 value) &&
+      cmIsOn(value);
+  }();
+  return verify;
+}
+}
+
+std::string cmGeneratorTarget::ReuseInterfaceProperty(
+  InterfacePropertyEntry const& entry, std::string const& prop,
+  cmGeneratorExpressionContext* context,
+  cmGeneratorExpressionDAGChecker const& dagChecker, bool markSeen) const
+{
+  std::string result = entry.Value;
+  context->HadContextSensitiveCondition =
+    context->HadContextSensitiveCondition ||
+    entry.HadContextSensitiveCondition;
+  context->HadConfigSensitiveCondition =
+    context->HadConfigSensitiveCondition || entry.HadConfigSensitiveCondition;
+  for (auto it = entry.Reached.begin() + 1; it != entry.Reached.end(); ++it) {
+    InterfacePropertyEntry const* reached = *it;
+    // Skip the targets already seen, as evaluating them would.
+    if (markSeen ? !dagChecker.MarkSeen(reached->Target, prop)
+                 : dagChecker.IsSeen(reached->Target, prop)) {
+      continue;
+    }
+    context->HadContextSensitiveCondition =
+      context->HadContextSensitiveCondition ||
+      reached->HadContextSensitiveCondition;
+    context->HadConfigSensitiveCondition =
+      context->HadConfigSensitiveCondition ||
+      reached->HadConfigSensitiveCondition;
+    if (!reached->StrippedValue.empty()) {
+      if (!result.empty()) {
+        result += ";";
+      }
+      result += reached->StrippedValue;
+    }
+  }
+  return result;
+}
+
 std::string cmGeneratorTarget::EvaluateInterfaceProperty(
   std::string const& prop, cmGeneratorExpressionContext* context,
   cmGeneratorExpressionDAGChecker* dagCheckerParent,
@@ -1328,19 +1398,100 @@ std::string cmGeneratorTarget::EvaluateInterfaceProperty(
       break;
   }
 
+  // Reuse the evaluation made for another consumer.  It only differs by
+  // the targets already seen, which are skipped.
+  InterfacePropertyCacheType::value_type* cached = nullptr;
+  cm::optional<std::string> reused;
+  bool const verify = VerifyInterfacePropertyCache();
+  if (dagChecker.SkipsAlreadySeen()) {
+    InterfacePropertyKey key{ prop,
+                              context->Config,
+                              context->Language,
+                              dagChecker.TopProperty(),
+                              context->LG,
+                              usage_requirements_only,
+                              context->EvaluateForBuildsystem };
+    auto it = this->InterfacePropertyCache.find(key);
+    if (it == this->InterfacePropertyCache.end()) {
+      // Start from the evaluation made for another configuration, if it
+      // did not depend on it.
+      InterfacePropertyKey independentKey = key;
+      independentKey.Config.clear();
+      auto independent =
+        this->ConfigIndependentInterfacePropertyCache.find(independentKey);
+      InterfacePropertyEntry start;
+      if (independent != this->ConfigIndependentInterfacePropertyCache.end()) {
+        start = independent->second;
+      }
+      it = this->InterfacePropertyCache
+             .emplace(std::move(key), std::move(start))
+             .first;
+    }
+    cached = &*it;
+    if (!cached->second.Reached.empty()) {
+      if (!verify) {
+        return this->ReuseInterfaceProperty(cached->second, prop, context,
+                                            dagChecker, true);
+      }
+      reused = this->ReuseInterfaceProperty(cached->second, prop, context,
+                                            dagChecker, false);
+    }
+  }
+  InterfacePropertyEntry* entry = cached ? &cached->second : nullptr;
+
   cmGeneratorTarget const* headTarget =
     context->HeadTarget ? context->HeadTarget : this;
 
-  if (cmValue p = this->GetProperty(prop)) {
+  bool valueCacheable = entry && !entry->ValueCached;
+  if (entry && entry->ValueCached && !verify) {
+    result = entry->Value;
+    context->HadContextSensitiveCondition =
+      context->HadContextSensitiveCondition ||
+      entry->HadContextSensitiveCondition;
+    context->HadConfigSensitiveCondition =
+      context->HadConfigSensitiveCondition ||
+      entry->HadConfigSensitiveCondition;
+  } else if (cmValue p = this->GetProperty(prop)) {
     result = cmGeneratorExpressionNode::EvaluateDependentExpression(
       *p, context->LG, context, headTarget, &dagChecker, this);
+    valueCacheable = valueCacheable && dagChecker.IsCacheable() &&
+      !context->HadHeadSensitiveCondition &&
+      !context->HadLinkLanguageSensitiveCondition;
+  }
+
+  cmLinkInterfaceLibraries const* iface = this->GetLinkInterfaceLibraries(
+    context->Config, headTarget, usage_requirements_only);
+  if (valueCacheable && !(iface && iface->HadHeadSensitiveCondition)) {
+    entry->Target = this;
+    entry->ValueCached = true;
+    entry->Value = result;
+    entry->StrippedValue =
+      cmGeneratorExpression::StripEmptyListElements(result);
+    entry->HadContextSensitiveCondition =
+      context->HadContextSensitiveCondition ||
+      (iface && iface->HadContextSensitiveCondition);
+    // Imported targets without a link interface may have one in another
+    // configuration.
+    entry->HadConfigSensitiveCondition =
+      context->HadConfigSensitiveCondition ||
+      (iface ? iface->HadConfigSensitiveCondition : this->IsImported());
+  } else if (verify && entry && entry->ValueCached &&
+             entry->Value != result) {
+    this->LocalGenerator->GetCMakeInstance()->IssueMessage(
+      MessageType::INTERNAL_ERROR,
+      cmStrCat("Property ", prop, " of target \"", this->GetName(),
+               "\" evaluates to\n  ", result, "\nbut was cached as\n  ",
+               entry->Value),
+      context->Backtrace);
   }
 
-  if (cmLinkInterfaceLibraries const* iface = this->GetLinkInterfaceLibraries(
-        context->Config, headTarget, usage_requirements_only)) {
+  if (iface) {
     context->HadContextSensitiveCondition =
       context->HadContextSensitiveCondition ||
       iface->HadContextSensitiveCondition;
+    context->HadConfigSensitiveCondition =
+      context->HadConfigSensitiveCondition ||
+      iface->HadConfigSensitiveCondition;
     for (cmLinkItem const& lib : iface->Libraries) {
       // Broken code can have a target in its own link interface.
       // Don't follow such link interface entries so as not to create a
@@ -1368,11 +1519,63 @@ std::string cmGeneratorTarget::EvaluateInterfaceProperty(
         context->HadContextSensitiveCondition =
           context->HadContextSensitiveCondition ||
           libContext.HadContextSensitiveCondition;
+        context->HadConfigSensitiveCondition =
+          context->HadConfigSensitiveCondition ||
+          libContext.HadConfigSensitiveCondition;
         context->HadHeadSensitiveCondition =
           context->HadHeadSensitiveCondition ||
           libContext.HadHeadSensitiveCondition;
       }
     }
+  } else if (this->IsImported()) {
+    context->HadConfigSensitiveCondition = true;
+  }
+
+  if (entry && entry->ValueCached && entry->Reached.empty()) {
+    // The evaluation can be reused once the evaluations of all the
+    // libraries it reached can be.
+    std::vector<InterfacePropertyEntry const*> reached{ entry };
+    std::unordered_set<InterfacePropertyEntry const*> unique{ entry };
+    bool complete = true;
+    bool configIndependent = !entry->HadConfigSensitiveCondition;
+    if (iface) {
+      for (cmLinkItem const& lib : iface->Libraries) {
+        if (!lib.Target || lib.Target == this ||
+            !lib.Target->MaybeHaveInterfaceProperty(prop, context,
+                                                    usage_requirements_only)) {
+          continue;
+        }
+        auto it = lib.Target->InterfacePropertyCache.find(cached->first);
+        if (it == lib.Target->InterfacePropertyCache.end() ||
+            it->second.Reached.empty()) {
+          complete = false;
+          break;
+        }
+        for (InterfacePropertyEntry const* e : it->second.Reached) {
+          if (unique.insert(e).second) {
+            reached.push_back(e);
+            configIndependent =
+              configIndependent && !e->HadConfigSensitiveCondition;
+          }
+        }
+      }
+    }
+    if (complete) {
+      entry->Reached = std::move(reached);
+      if (configIndependent) {
+        InterfacePropertyKey independentKey = cached->first;
+        independentKey.Config.clear();
+        this->ConfigIndependentInterfacePropertyCache.emplace(
+          std::move(independentKey), *entry);
+      }
+    }
+  } else if (reused && *reused != result) {
+    this->LocalGenerator->GetCMakeInstance()->IssueMessage(
+      MessageType::INTERNAL_ERROR,
+      cmStrCat("Transitive property ", prop, " of target \"",
+               this->GetName(), "\" evaluates to\n  ", result,
+               "\nbut was cached as\n  ", *reused),
+      context->Backtrace);
   }
 
   return result;
@@ -6430,6 +6633,7 @@ void cmGeneratorTarget::ExpandLinkItems(std::string const& prop,
   }
   iface.HadHeadSensitiveCondition = cge->GetHadHeadSensitiveCondition();
   iface.HadContextSensitiveCondition = cge->GetHadContextSensitiveCondition();
+  iface.HadConfigSensitiveCondition = cge->GetHadConfigSensitiveCondition();
   iface.HadLinkLanguageSensitiveCondition =
     cge->GetHadLinkLanguageSensitiveCondition();
 }
@@ -6938,6 +7142,10 @@ void cmGeneratorTarget::ComputeLinkInterfaceLibraries(
     this->ExpandLinkItems(linkIfaceProp, *explicitLibraries, config,
                           headTarget, usage_requirements_only, iface);
   }
+  if (!cmp0022NEW && !linkIfaceProp.empty()) {
+    // Other configurations may have their own property.
+    iface.HadConfigSensitiveCondition = true;
+  }
 
   // If the link interface is explicit, do not fall back to the link impl.
   if (iface.Explicit) {
@@ -6949,6 +7157,7 @@ void cmGeneratorTarget::ComputeLinkInterfaceLibraries(
         this->GetLinkImplementationLibrariesInternal(config, headTarget)) {
     iface.Libraries.insert(iface.Libraries.end(), impl->Libraries.begin(),
                            impl->Libraries.end());
+    iface.HadConfigSensitiveCondition = impl->HadConfigSensitiveCondition;
     if (this->GetPolicyStatusCMP0022() == cmPolicies::WARN &&
         !this->PolicyWarnedCMP0022 && !usage_requirements_only) {
       // Compare the link implementation fallback link interface to the
@@ -7100,6 +7309,11 @@ const cmLinkInterface* cmGeneratorTarget::GetImportLinkInterface(
     cmExpandList(info->Languages, iface.Languages);
     this->ExpandLinkItems(info->LibrariesProp, info->Libraries, config,
                           headTarget, usage_requirements_only, iface);
+    // Other configurations may import other libraries.
+    if (this->GetType() != cmStateEnums::INTERFACE_LIBRARY &&
+        info->LibrariesProp != "INTERFACE_LINK_LIBRARIES") {
+      iface.HadConfigSensitiveCondition = true;
+    }
     std::vector<std::string> deps = cmExpandedList(info->SharedDeps);
     LookupLinkItemScope scope{ this->LocalGenerator };
     for (std::string const& dep : deps) {
@@ -7326,7 +7540,9 @@ const cmLinkImplementation* cmGeneratorTarget::GetLinkImplementation(
   }
   if (!impl.LibrariesDone) {
     impl.LibrariesDone = true;
-    this->ComputeLinkImplementationLibraries(config, impl, this);
+    if (secondPass || !this->ReuseLinkImplementationLibraries(impl, this)) {
+      this->ComputeLinkImplementationLibraries(config, impl, this);
+    }
   }
   if (!impl.LanguagesDone) {
     impl.LanguagesDone = true;
@@ -7606,11 +7822,37 @@ cmGeneratorTarget::GetLinkImplementationLibrariesInternal(
   cmOptionalLinkImplementation& impl = hm[head];
   if (!impl.LibrariesDone) {
     impl.LibrariesDone = true;
-    this->ComputeLinkImplementationLibraries(config, impl, head);
+    if (!this->ReuseLinkImplementationLibraries(impl, head)) {
+      this->ComputeLinkImplementationLibraries(config, impl, head);
+    }
   }
   return &impl;
 }
 
+bool cmGeneratorTarget::ReuseLinkImplementationLibraries(
+  cmOptionalLinkImplementation& impl, cmGeneratorTarget const* head) const
+{
+  for (auto const& configImpl : this->LinkImplMap) {
+    HeadToLinkImplementationMap const& hm = configImpl.second;
+    auto other = hm.find(head);
+    if (other == hm.end() && !hm.empty() &&
+        !hm.begin()->second.HadHeadSensitiveCondition) {
+      other = hm.begin();
+    }
+    if (other == hm.end() || &other->second == &impl ||
+        !other->second.LibrariesDone ||
+        other->second.HadConfigSensitiveCondition ||
+        other->second.HadLinkLanguageSensitiveCondition) {
+      continue;
+    }
+    // The libraries computed for another configuration do not depend on it.
+    static_cast<cmLinkImplementationLibraries&>(impl) = other->second;
+    impl.HadHeadSensitiveCondition = other->second.HadHeadSensitiveCondition;
+    return true;
+  }
+  return false;
+}
+
 bool cmGeneratorTarget::IsNullImpliedByLinkLibraries(
   const std::string& p) const
 {
@@ -7645,6 +7887,9 @@ void cmGeneratorTarget::ComputeLinkImplementationLibraries(
     if (cge->GetHadContextSensitiveCondition()) {
       impl.HadContextSensitiveCondition = true;
     }
+    if (cge->GetHadConfigSensitiveCondition()) {
+      impl.HadConfigSensitiveCondition = true;
+    }
     if (cge->GetHadLinkLanguageSensitiveCondition()) {
       impl.HadLinkLanguageSensitiveCondition = true;
     }
@@ -7656,6 +7901,10 @@ void cmGeneratorTarget::ComputeLinkImplementationLibraries(
 
       // Skip entries that resolve to the target itself or are empty.
       std::string name = this->CheckCMP0004(lib);
+      if (name != lib) {
+        // Report the problem for each configuration.
+        impl.HadConfigSensitiveCondition = true;
+      }
       if (this->GetPolicyStatusCMP0108() == cmPolicies::NEW) {
         // resolve alias name
         auto* target = this->Makefile->FindTargetToUse(name);
@@ -7665,6 +7914,8 @@ void cmGeneratorTarget::ComputeLinkImplementationLibraries(
       }
       if (name == this->GetName() || name.empty()) {
         if (name == this->GetName()) {
+          // Report the problem for each configuration.
+          impl.HadConfigSensitiveCondition = true;
           bool noMessage = false;
           MessageType messageType = MessageType::FATAL_ERROR;
           std::ostringstream e;
@@ -7732,6 +7983,9 @@ void cmGeneratorTarget::ComputeLinkImplementationLibraries(
   cmTarget::LinkLibraryVectorType const& oldllibs =
     this->Target->GetOriginalLinkLibraries();
   for (cmTarget::LibraryID const& oldllib : oldllibs) {
+    if (oldllib.second != GENERAL_LibraryType) {
+      impl.HadConfigSensitiveCondition = true;
+    }
     if (oldllib.second != GENERAL_LibraryType && oldllib.second != linkType) {
       std::string name = this->CheckCMP0004(oldllib.first);
       if (name == this->GetName() || name.empty()) {
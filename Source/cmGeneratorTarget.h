@@ -400,6 +400,11 @@ public:
                                           cmOptionalLinkImplementation& impl,
                                           const cmGeneratorTarget* head) const;
 
+  // Copy the libraries computed for another configuration, if they do not
+  // depend on it.  Returns false if there are none.
+  bool ReuseLinkImplementationLibraries(cmOptionalLinkImplementation& impl,
+                                        const cmGeneratorTarget* head) const;
+
   struct TargetOrString
   {
     std::string String;
@@ -1010,6 +1015,46 @@ private:
                                   cmGeneratorExpressionContext* context,
                                   bool usage_requirements_only) const;
 
+  // Transitive properties are evaluated once for all the consumers of a
+  // target, as long as they do not depend on the head target.
+  struct InterfacePropertyKey
+  {
+    std::string Property;
+    std::string Config;
+    std::string Language;
+    // Property of the top checker, which some expressions depend on.
+    std::string TopProperty;
+    // Directory of the head target, in which expressions are evaluated.
+    cmLocalGenerator const* LocalGenerator;
+    bool UsageRequirementsOnly;
+    bool EvaluateForBuildsystem;
+
+    bool operator<(InterfacePropertyKey const& other) const;
+  };
+  struct InterfacePropertyEntry
+  {
+    cmGeneratorTarget const* Target = nullptr;
+    // The property of the target itself, as evaluated, if it may be reused.
+    bool ValueCached = false;
+    std::string Value;
+    std::string StrippedValue;
+    bool HadContextSensitiveCondition = false;
+    bool HadConfigSensitiveCondition = false;
+    // Entries of the targets reached by the evaluation, this one first,
+    // in evaluation order.  Empty while one of them cannot be reused.
+    std::vector<InterfacePropertyEntry const*> Reached;
+  };
+  using InterfacePropertyCacheType =
+    std::map<InterfacePropertyKey, InterfacePropertyEntry>;
+  mutable InterfacePropertyCacheType InterfacePropertyCache;
+  // Reusable entries whose evaluation does not depend on the configuration,
+  // keyed without it, for the other configurations to start from.
+  mutable InterfacePropertyCacheType ConfigIndependentInterfacePropertyCache;
+  std::string ReuseInterfaceProperty(
+    InterfacePropertyEntry const& entry, std::string const& prop,
+    cmGeneratorExpressionContext* context,
+    cmGeneratorExpressionDAGChecker const& dagChecker, bool markSeen) const;
+
   using TargetPropertyEntryVector =
     std::vector<std::unique_ptr<TargetPropertyEntry>>;
 
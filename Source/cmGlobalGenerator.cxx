@@ -1390,6 +1390,9 @@ bool cmGlobalGenerator::UnsupportedVariableIsDefined(const std::string& name,
 
 bool cmGlobalGenerator::Compute()
 {
+  // Drop the generator expressions parsed by a previous generate step.
+  cmGeneratorExpression::ClearParseCache();
+
   // Make sure unsupported variables are not used.
   if (this->UnsupportedVariableIsDefined("CMAKE_DEFAULT_BUILD_TYPE",
                                          this->SupportsDefaultBuildType())) {
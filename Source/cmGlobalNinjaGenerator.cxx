@@ -568,6 +568,8 @@ void cmGlobalNinjaGenerator::Generate()
                                            msg.str());
     return;
   }
+  this->SubninjaPerDirectory =
+    this->Makefiles[0]->IsOn("CMAKE_NINJA_SUBNINJA_PER_DIRECTORY");
   if (!this->OpenBuildFileStreams()) {
     return;
   }
@@ -1075,6 +1077,64 @@ cm::optional<std::set<std::string>> cmGlobalNinjaGenerator::ListSubsetWithAll(
   return cm::make_optional(result);
 }
 
+bool cmGlobalNinjaGenerator::OpenDirectoryFileStreams(
+  const std::string& binaryDir)
+{
+  return this->OpenDirectoryFileStream(this->DirectoryFileStream,
+                                       *this->BuildFileStream, binaryDir,
+                                       "directory.ninja");
+}
+
+void cmGlobalNinjaGenerator::CloseDirectoryFileStreams()
+{
+  if (!this->DirectoryFileStream) {
+    return;
+  }
+  this->CloseDirectoryFileStream(this->DirectoryFileStream);
+}
+
+bool cmGlobalNinjaGenerator::OpenDirectoryFileStream(
+  std::unique_ptr<cmGeneratedFileStream>& stream,
+  cmGeneratedFileStream& parent, const std::string& binaryDir,
+  const std::string& name)
+{
+  if (!this->SubninjaPerDirectory) {
+    return true;
+  }
+
+  std::string const path = cmStrCat(binaryDir, "/CMakeFiles/", name);
+  stream = cm::make_unique<cmGeneratedFileStream>(path, false,
+                                                  this->GetMakefileEncoding());
+  if (!(*stream)) {
+    // An error message is generated by the constructor if it cannot
+    // open the file.
+    stream.reset();
+    return false;
+  }
+  // Leave the files of unchanged directories untouched so that ninja and
+  // other tools watching them do not see a change.
+  stream->SetCopyIfDifferent(true);
+
+  this->WriteDisclaimer(*stream);
+  *stream << "# This file contains the build statements of the directory\n"
+          << "# " << binaryDir << "\n\n";
+
+  parent << "subninja "
+         << this->EncodePath(
+              this->NinjaOutputPath(this->ConvertToNinjaPath(path)))
+         << "\n\n";
+  return true;
+}
+
+void cmGlobalNinjaGenerator::CloseDirectoryFileStream(
+  std::unique_ptr<cmGeneratedFileStream>& stream)
+{
+  if (cmSystemTools::GetErrorOccuredFlag()) {
+    stream->setstate(std::ios::failbit);
+  }
+  stream.reset();
+}
+
 void cmGlobalNinjaGenerator::CloseBuildFileStreams()
 {
   if (this->BuildFileStream) {
@@ -2814,6 +2874,44 @@ bool cmGlobalNinjaMultiGenerator::OpenBuildFileStreams()
     });
 }
 
+bool cmGlobalNinjaMultiGenerator::OpenDirectoryFileStreams(
+  const std::string& binaryDir)
+{
+  if (!this->OpenDirectoryFileStream(this->DirectoryCommonFileStream,
+                                     *this->CommonFileStream, binaryDir,
+                                     "directory-common.ninja")) {
+    return false;
+  }
+
+  auto const& configs =
+    this->Makefiles[0]->GetGeneratorConfigs(cmMakefile::IncludeEmptyConfig);
+  for (std::string const& config : configs) {
+    std::unique_ptr<cmGeneratedFileStream> stream;
+    if (!this->OpenDirectoryFileStream(
+          stream, *this->ImplFileStreams.at(config), binaryDir,
+          cmStrCat("directory-impl-", config, ".ninja"))) {
+      return false;
+    }
+    if (stream) {
+      this->DirectoryImplFileStreams[config] = std::move(stream);
+    }
+  }
+  return true;
+}
+
+void cmGlobalNinjaMultiGenerator::CloseDirectoryFileStreams()
+{
+  if (!this->DirectoryCommonFileStream) {
+    return;
+  }
+
+  this->CloseDirectoryFileStream(this->DirectoryCommonFileStream);
+  for (auto& stream : this->DirectoryImplFileStreams) {
+    this->CloseDirectoryFileStream(stream.second);
+  }
+  this->DirectoryImplFileStreams.clear();
+}
+
 void cmGlobalNinjaMultiGenerator::CloseBuildFileStreams()
 {
   if (this->CommonFileStream) {
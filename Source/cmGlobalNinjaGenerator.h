@@ -235,6 +235,9 @@ public:
   virtual cmGeneratedFileStream* GetImplFileStream(
     const std::string& /*config*/) const
   {
+    if (this->DirectoryFileStream) {
+      return this->DirectoryFileStream.get();
+    }
     return this->BuildFileStream.get();
   }
 
@@ -251,6 +254,9 @@ public:
 
   virtual cmGeneratedFileStream* GetCommonFileStream() const
   {
+    if (this->DirectoryFileStream) {
+      return this->DirectoryFileStream.get();
+    }
     return this->BuildFileStream.get();
   }
 
@@ -259,6 +265,13 @@ public:
     return this->RulesFileStream.get();
   }
 
+  /// Write the build statements of the directory whose binary directory is
+  /// @a binaryDir to files of its own, until CloseDirectoryFileStreams() is
+  /// called.  Does nothing unless CMAKE_NINJA_SUBNINJA_PER_DIRECTORY is
+  /// enabled.
+  virtual bool OpenDirectoryFileStreams(const std::string& binaryDir);
+  virtual void CloseDirectoryFileStreams();
+
   std::string const& ConvertToNinjaPath(const std::string& path) const;
   std::string ConvertToNinjaAbsPath(std::string path) const;
 
@@ -477,6 +490,16 @@ protected:
   bool OpenFileStream(std::unique_ptr<cmGeneratedFileStream>& stream,
                       const std::string& name);
 
+  /// Open the file @a name in the CMakeFiles directory of @a binaryDir and
+  /// reference it from @a parent with 'subninja'.  Does nothing unless
+  /// CMAKE_NINJA_SUBNINJA_PER_DIRECTORY is enabled.
+  bool OpenDirectoryFileStream(std::unique_ptr<cmGeneratedFileStream>& stream,
+                               cmGeneratedFileStream& parent,
+                               const std::string& binaryDir,
+                               const std::string& name);
+  void CloseDirectoryFileStream(
+    std::unique_ptr<cmGeneratedFileStream>& stream);
+
   static cm::optional<std::set<std::string>> ListSubsetWithAll(
     const std::set<std::string>& all, const std::set<std::string>& defaults,
     const std::vector<std::string>& items);
@@ -530,6 +553,12 @@ private:
   /// edge of the compilation DAG).
   std::unique_ptr<cmGeneratedFileStream> RulesFileStream;
   std::unique_ptr<cmGeneratedFileStream> CompileCommandsStream;
+  /// The file containing the build statements of the directory being
+  /// generated, if they are written separately.
+  std::unique_ptr<cmGeneratedFileStream> DirectoryFileStream;
+
+  /// Whether each directory writes its build statements to its own files.
+  bool SubninjaPerDirectory = false;
 
   /// The set of rules added to the generated build system.
   std::unordered_set<std::string> Rules;
@@ -684,6 +713,9 @@ public:
   cmGeneratedFileStream* GetImplFileStream(
     const std::string& config) const override
   {
+    if (!this->DirectoryImplFileStreams.empty()) {
+      return this->DirectoryImplFileStreams.at(config).get();
+    }
     return this->ImplFileStreams.at(config).get();
   }
 
@@ -700,9 +732,15 @@ public:
 
   cmGeneratedFileStream* GetCommonFileStream() const override
   {
+    if (this->DirectoryCommonFileStream) {
+      return this->DirectoryCommonFileStream.get();
+    }
     return this->CommonFileStream.get();
   }
 
+  bool OpenDirectoryFileStreams(const std::string& binaryDir) override;
+  void CloseDirectoryFileStreams() override;
+
   void AppendNinjaFileArgument(GeneratedMakeCommand& command,
                                const std::string& config) const override;
 
@@ -735,4 +773,7 @@ private:
     ConfigFileStreams;
   std::unique_ptr<cmGeneratedFileStream> CommonFileStream;
   std::unique_ptr<cmGeneratedFileStream> DefaultFileStream;
+  std::map<std::string, std::unique_ptr<cmGeneratedFileStream>>
+    DirectoryImplFileStreams;
+  std::unique_ptr<cmGeneratedFileStream> DirectoryCommonFileStream;
 };
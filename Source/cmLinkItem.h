@@ -60,6 +60,9 @@ struct cmLinkImplementationLibraries
 
   // Whether the list depends on a genex referencing the configuration.
   bool HadContextSensitiveCondition = false;
+
+  // Whether the list may differ between configurations.
+  bool HadConfigSensitiveCondition = false;
 };
 
 struct cmLinkInterfaceLibraries
@@ -75,6 +78,9 @@ struct cmLinkInterfaceLibraries
 
   // Whether the list depends on a genex referencing the configuration.
   bool HadContextSensitiveCondition = false;
+
+  // Whether the list may differ between configurations.
+  bool HadConfigSensitiveCondition = false;
 };
 
 struct cmLinkInterface : public cmLinkInterfaceLibraries
@@ -7,6 +7,7 @@
 #include <cstdio>
 #include <functional>
 #include <iterator>
+#include <memory>
 #include <set>
 #include <sstream>
 #include <stdexcept>
@@ -26,6 +27,7 @@
 #include "cmMessageType.h"
 #include "cmPolicies.h"
 #include "cmRange.h"
+#include "cmRegexCache.h"
 #include "cmStringAlgorithms.h"
 #include "cmStringReplaceHelper.h"
 #include "cmSubcommandTable.h"
@@ -87,22 +89,20 @@ bool GetListString(std::string& listString, const std::string& var,
   return true;
 }
 
-bool GetList(std::vector<std::string>& list, const std::string& var,
-             const cmMakefile& makefile)
+// Get the elements of a list variable, shared with the variable value
+// instead of copied, or nullptr if it is not defined or on error.
+std::shared_ptr<std::vector<std::string> const> GetConstList(
+  const std::string& var, const cmMakefile& makefile)
 {
-  std::string listString;
-  if (!GetListString(listString, var, makefile)) {
-    return false;
-  }
-  // if the size of the list
-  if (listString.empty()) {
-    return true;
+  // get the old value
+  cmValue listString = makefile.GetDefinition(var);
+  if (!listString) {
+    return nullptr;
   }
-  // expand the variable into a list
-  cmExpandList(listString, list, true);
+  auto list = makefile.GetDefinitionList(var);
   // if no empty elements then just return
-  if (!cm::contains(list, std::string())) {
-    return true;
+  if (!cm::contains(*list, std::string())) {
+    return list;
   }
   // if we have empty elements we need to check policy CMP0007
   switch (makefile.GetPolicyStatus(cmPolicies::CMP0007)) {
@@ -111,30 +111,42 @@ bool GetList(std::vector<std::string>& list, const std::string& var,
       // OLD behavior is to allow compatibility, so recall
       // ExpandListArgument without the true which will remove
       // empty values
-      list.clear();
-      cmExpandList(listString, list);
+      auto oldList = std::make_shared<std::vector<std::string>>();
+      cmExpandList(*listString, *oldList);
       std::string warn =
         cmStrCat(cmPolicies::GetPolicyWarning(cmPolicies::CMP0007),
-                 " List has value = [", listString, "].");
+                 " List has value = [", *listString, "].");
       makefile.IssueMessage(MessageType::AUTHOR_WARNING, warn);
-      return true;
+      return oldList;
     }
-    case cmPolicies::OLD:
+    case cmPolicies::OLD: {
       // OLD behavior is to allow compatibility, so recall
       // ExpandListArgument without the true which will remove
       // empty values
-      list.clear();
-      cmExpandList(listString, list);
-      return true;
+      auto oldList = std::make_shared<std::vector<std::string>>();
+      cmExpandList(*listString, *oldList);
+      return oldList;
+    }
     case cmPolicies::NEW:
-      return true;
+      return list;
     case cmPolicies::REQUIRED_IF_USED:
     case cmPolicies::REQUIRED_ALWAYS:
       makefile.IssueMessage(
         MessageType::FATAL_ERROR,
         cmPolicies::GetRequiredPolicyError(cmPolicies::CMP0007));
-      return false;
+      return nullptr;
   }
+  return list;
+}
+
+bool GetList(std::vector<std::string>& list, const std::string& var,
+             const cmMakefile& makefile)
+{
+  auto const constList = GetConstList(var, makefile);
+  if (!constList) {
+    return false;
+  }
+  list = *constList;
   return true;
 }
 
@@ -148,12 +160,9 @@ bool HandleLengthCommand(std::vector<std::string> const& args,
 
   const std::string& listName = args[1];
   const std::string& variableName = args.back();
-  std::vector<std::string> varArgsExpanded;
-  // do not check the return value here
-  // if the list var is not found varArgsExpanded will have size 0
-  // and we will return 0
-  GetList(varArgsExpanded, listName, status.GetMakefile());
-  size_t length = varArgsExpanded.size();
+  // if the list var is not found the length is 0
+  auto const varArgsExpanded = GetConstList(listName, status.GetMakefile());
+  size_t length = varArgsExpanded ? varArgsExpanded->size() : 0;
   char buffer[1024];
   sprintf(buffer, "%d", static_cast<int>(length));
 
@@ -172,11 +181,12 @@ bool HandleGetCommand(std::vector<std::string> const& args,
   const std::string& listName = args[1];
   const std::string& variableName = args.back();
   // expand the variable
-  std::vector<std::string> varArgsExpanded;
-  if (!GetList(varArgsExpanded, listName, status.GetMakefile())) {
+  auto const list = GetConstList(listName, status.GetMakefile());
+  if (!list) {
     status.GetMakefile().AddDefinition(variableName, "NOTFOUND");
     return true;
   }
+  std::vector<std::string> const& varArgsExpanded = *list;
   // FIXME: Add policy to make non-existing lists an error like empty lists.
   if (varArgsExpanded.empty()) {
     status.SetError("GET given empty list");
@@ -220,19 +230,9 @@ bool HandleAppendCommand(std::vector<std::string> const& args,
     return true;
   }
 
-  cmMakefile& makefile = status.GetMakefile();
-  std::string const& listName = args[1];
-  // expand the variable
-  std::string listString;
-  GetListString(listString, listName, makefile);
-
-  // If `listString` or `args` is empty, no need to append `;`,
-  // then index is going to be `1` and points to the end-of-string ";"
-  auto const offset =
-    std::string::size_type(listString.empty() || args.empty());
-  listString += &";"[offset] + cmJoin(cmMakeRange(args).advance(2), ";");
-
-  makefile.AddDefinition(listName, listString);
+  // Append in place, so that growing a list in a loop is linear.
+  status.GetMakefile().AppendDefinition(
+    args[1], cmJoin(cmMakeRange(args).advance(2), ";"));
   return true;
 }
 
@@ -371,11 +371,12 @@ bool HandleFindCommand(std::vector<std::string> const& args,
   const std::string& listName = args[1];
   const std::string& variableName = args.back();
   // expand the variable
-  std::vector<std::string> varArgsExpanded;
-  if (!GetList(varArgsExpanded, listName, status.GetMakefile())) {
+  auto const list = GetConstList(listName, status.GetMakefile());
+  if (!list) {
     status.GetMakefile().AddDefinition(variableName, "-1");
     return true;
   }
+  std::vector<std::string> const& varArgsExpanded = *list;
 
   auto it = std::find(varArgsExpanded.begin(), varArgsExpanded.end(), args[2]);
   if (it != varArgsExpanded.end()) {
@@ -448,14 +449,14 @@ bool HandleJoinCommand(std::vector<std::string> const& args,
   const std::string& variableName = args[3];
 
   // expand the variable
-  std::vector<std::string> varArgsExpanded;
-  if (!GetList(varArgsExpanded, listName, status.GetMakefile())) {
+  auto const varArgsExpanded = GetConstList(listName, status.GetMakefile());
+  if (!varArgsExpanded) {
     status.GetMakefile().AddDefinition(variableName, "");
     return true;
   }
 
-  std::string value =
-    cmJoin(cmMakeRange(varArgsExpanded.begin(), varArgsExpanded.end()), glue);
+  std::string value = cmJoin(
+    cmMakeRange(varArgsExpanded->begin(), varArgsExpanded->end()), glue);
 
   status.GetMakefile().AddDefinition(variableName, value);
   return true;
@@ -588,18 +589,19 @@ class TransformSelectorRegex : public TransformSelector
 public:
   TransformSelectorRegex(const std::string& regex)
     : TransformSelector("REGEX")
-    , Regex(regex)
+    , Regex(cmRegexCache::Get(regex))
   {
   }
 
-  bool Validate(std::size_t) override { return this->Regex.is_valid(); }
+  bool Validate(std::size_t) override { return this->Regex != nullptr; }
 
   bool InSelection(const std::string& value) override
   {
-    return this->Regex.find(value);
+    return this->Regex->find(value.c_str(), this->Match);
   }
 
-  cmsys::RegularExpression Regex;
+  cmRegexCache::Regex Regex;
+  cmsys::RegularExpressionMatch Match;
 };
 class TransformSelectorIndexes : public TransformSelector
 {
@@ -1317,12 +1319,12 @@ bool HandleSublistCommand(std::vector<std::string> const& args,
   const std::string& variableName = args.back();
 
   // expand the variable
-  std::vector<std::string> varArgsExpanded;
-  if (!GetList(varArgsExpanded, listName, status.GetMakefile()) ||
-      varArgsExpanded.empty()) {
+  auto const list = GetConstList(listName, status.GetMakefile());
+  if (!list || list->empty()) {
     status.GetMakefile().AddDefinition(variableName, "");
     return true;
   }
+  std::vector<std::string> const& varArgsExpanded = *list;
 
   int start;
   int length;
@@ -1335,7 +1337,7 @@ bool HandleSublistCommand(std::vector<std::string> const& args,
     return false;
   }
 
-  using size_type = decltype(varArgsExpanded)::size_type;
+  using size_type = std::vector<std::string>::size_type;
 
   if (start < 0 || size_type(start) >= varArgsExpanded.size()) {
     status.SetError(cmStrCat("begin index: ", start, " is out of range 0 - ",
@@ -1351,9 +1353,11 @@ bool HandleSublistCommand(std::vector<std::string> const& args,
     (length == -1 || size_type(start + length) > varArgsExpanded.size())
     ? varArgsExpanded.size()
     : size_type(start + length);
-  std::vector<std::string> sublist(varArgsExpanded.begin() + start,
-                                   varArgsExpanded.begin() + end);
-  status.GetMakefile().AddDefinition(variableName, cmJoin(sublist, ";"));
+  status.GetMakefile().AddDefinition(
+    variableName,
+    cmJoin(cmMakeRange(varArgsExpanded.begin() + start,
+                       varArgsExpanded.begin() + end),
+           ";"));
   return true;
 }
 
@@ -1472,7 +1476,8 @@ bool HandleFilterCommand(std::vector<std::string> const& args,
 class MatchesRegex
 {
 public:
-  MatchesRegex(cmsys::RegularExpression& in_regex, bool in_includeMatches)
+  MatchesRegex(cmsys::RegularExpression const& in_regex,
+               bool in_includeMatches)
     : regex(in_regex)
     , includeMatches(in_includeMatches)
   {
@@ -1480,11 +1485,13 @@ public:
 
   bool operator()(const std::string& target)
   {
-    return this->regex.find(target) ^ this->includeMatches;
+    return this->regex.find(target.c_str(), this->match) ^
+      this->includeMatches;
   }
 
 private:
-  cmsys::RegularExpression& regex;
+  cmsys::RegularExpression const& regex;
+  cmsys::RegularExpressionMatch match;
   const bool includeMatches;
 };
 
@@ -1494,8 +1501,8 @@ bool FilterRegex(std::vector<std::string> const& args, bool includeMatches,
                  cmExecutionStatus& status)
 {
   const std::string& pattern = args[4];
-  cmsys::RegularExpression regex(pattern);
-  if (!regex.is_valid()) {
+  cmRegexCache::Regex const regex = cmRegexCache::Get(pattern);
+  if (!regex) {
     std::string error =
       cmStrCat("sub-command FILTER, mode REGEX failed to compile regex \"",
                pattern, "\".");
@@ -1506,7 +1513,7 @@ bool FilterRegex(std::vector<std::string> const& args, bool includeMatches,
   auto argsBegin = varArgsExpanded.begin();
   auto argsEnd = varArgsExpanded.end();
   auto newArgsEnd =
-    std::remove_if(argsBegin, argsEnd, MatchesRegex(regex, includeMatches));
+    std::remove_if(argsBegin, argsEnd, MatchesRegex(*regex, includeMatches));
 
   std::string value = cmJoin(cmMakeRange(argsBegin, newArgsEnd), ";");
   status.GetMakefile().AddDefinition(listName, value);
@@ -3,20 +3,29 @@
 #include "cmListFileCache.h"
 
 #include <cassert>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
 #include <memory>
+#include <ratio>
 #include <sstream>
+#include <unordered_map>
 #include <utility>
 
+#include <cmsys/FStream.hxx>
 #ifdef _WIN32
 #  include <cmsys/Encoding.hxx>
 #endif
 
+#include "cmFileTime.h"
 #include "cmListFileLexer.h"
 #include "cmMessageType.h"
 #include "cmMessenger.h"
 #include "cmState.h"
 #include "cmStringAlgorithms.h"
 #include "cmSystemTools.h"
+#include "cmVersion.h"
 
 struct cmListFileParser
 {
@@ -42,6 +51,7 @@ struct cmListFileParser
   std::string FunctionName;
   long FunctionLine;
   std::vector<cmListFileArgument> FunctionArguments;
+  bool IssuedWarning = false;
   enum
   {
     SeparationOkay,
@@ -190,11 +200,27 @@ bool cmListFile::ParseFile(const char* filename, cmMessenger* messenger,
     return false;
   }
 
+  if (cmListFileCache::Find(filename, this->Functions)) {
+    return true;
+  }
+
   bool parseError = false;
+  bool issuedWarning = false;
+  std::size_t const firstFunction = this->Functions.size();
 
   {
     cmListFileParser parser(this, lfbt, messenger);
     parseError = !parser.ParseFile(filename);
+    issuedWarning = parser.IssuedWarning;
+  }
+
+  // Files which produce diagnostics are parsed again each time so that
+  // their diagnostics are issued again.
+  if (!parseError && !issuedWarning) {
+    cmListFileCache::Store(
+      filename,
+      std::vector<cmListFileFunction>(
+        this->Functions.begin() + firstFunction, this->Functions.end()));
   }
 
   return !parseError;
@@ -335,6 +361,7 @@ bool cmListFileParser::AddArgument(cmListFileLexer_Token* token,
     return false;
   }
   this->Messenger->IssueMessage(MessageType::AUTHOR_WARNING, m.str(), lfbt);
+  this->IssuedWarning = true;
   return true;
 }
 
@@ -444,6 +471,319 @@ cm::optional<cmListFileContext> cmListFileParser::CheckNesting() const
   return cm::nullopt;
 }
 
+namespace {
+struct ListFileCacheEntry
+{
+  cmFileTime::TimeType Time = 0;
+  unsigned long Size = 0;
+  std::vector<cmListFileFunction> Functions;
+  bool Used = false;
+};
+
+struct ListFileCacheState
+{
+  std::unordered_map<std::string, ListFileCacheEntry> Entries;
+  bool Modified = false;
+};
+
+ListFileCacheState& GetListFileCacheState()
+{
+  static ListFileCacheState state;
+  return state;
+}
+
+// Current time in the unit and epoch of cmFileTime.
+cmFileTime::TimeType CurrentFileTime()
+{
+  using UnitTime =
+    std::chrono::duration<cmFileTime::TimeType,
+                          std::ratio<1, cmFileTime::UtPerS>>;
+  cmFileTime::TimeType const now =
+    std::chrono::duration_cast<UnitTime>(
+      std::chrono::system_clock::now().time_since_epoch())
+      .count();
+#if defined(_WIN32) && !defined(__CYGWIN__)
+  // File times count from 1601-01-01, the system clock from 1970-01-01.
+  return now + 116444736000000000LL;
+#else
+  return now;
+#endif
+}
+
+// Binary cache files start with this magic, followed by the byte order
+// mark, the format version and the version of the CMake which wrote them,
+// all of them written in native byte order.
+char const ListFileCacheMagic[8] = { 'C', 'M', 'L', 'F', 'C', 'A', 'C', 'H' };
+std::uint32_t const ListFileCacheByteOrder = 0x01020304;
+std::uint32_t const ListFileCacheVersion = 1;
+
+class ListFileCacheWriter
+{
+public:
+  void Write(void const* data, std::size_t size)
+  {
+    this->Buffer.append(static_cast<char const*>(data), size);
+  }
+  void WriteU32(std::uint32_t value) { this->Write(&value, sizeof(value)); }
+  void WriteI64(std::int64_t value) { this->Write(&value, sizeof(value)); }
+  void WriteString(std::string const& value)
+  {
+    this->WriteU32(static_cast<std::uint32_t>(value.size()));
+    this->Write(value.data(), value.size());
+  }
+
+  std::string Buffer;
+};
+
+class ListFileCacheReader
+{
+public:
+  ListFileCacheReader(std::string const& buffer)
+    : Buffer(buffer)
+  {
+  }
+
+  bool Read(void* data, std::size_t size)
+  {
+    if (this->Buffer.size() - this->Position < size) {
+      return false;
+    }
+    memcpy(data, this->Buffer.data() + this->Position, size);
+    this->Position += size;
+    return true;
+  }
+  bool ReadU32(std::uint32_t& value)
+  {
+    return this->Read(&value, sizeof(value));
+  }
+  bool ReadI64(std::int64_t& value)
+  {
+    return this->Read(&value, sizeof(value));
+  }
+  bool ReadString(std::string& value)
+  {
+    std::uint32_t size;
+    if (!this->ReadU32(size) || this->Buffer.size() - this->Position < size) {
+      return false;
+    }
+    value.assign(this->Buffer, this->Position, size);
+    this->Position += size;
+    return true;
+  }
+  bool AtEnd() const { return this->Position == this->Buffer.size(); }
+
+private:
+  std::string const& Buffer;
+  std::size_t Position = 0;
+};
+
+bool ReadListFileCacheEntry(ListFileCacheReader& reader, std::string& path,
+                            ListFileCacheEntry& entry)
+{
+  std::int64_t time;
+  std::int64_t size;
+  std::uint32_t functionCount;
+  if (!reader.ReadString(path) || !reader.ReadI64(time) ||
+      !reader.ReadI64(size) || !reader.ReadU32(functionCount)) {
+    return false;
+  }
+  entry.Time = time;
+  entry.Size = static_cast<unsigned long>(size);
+
+  for (std::uint32_t f = 0; f < functionCount; ++f) {
+    std::string name;
+    std::int64_t line;
+    std::uint32_t argumentCount;
+    if (!reader.ReadString(name) || !reader.ReadI64(line) ||
+        !reader.ReadU32(argumentCount)) {
+      return false;
+    }
+    std::vector<cmListFileArgument> arguments;
+    for (std::uint32_t a = 0; a < argumentCount; ++a) {
+      std::string value;
+      std::uint32_t delim;
+      std::int64_t argumentLine;
+      if (!reader.ReadString(value) || !reader.ReadU32(delim) ||
+          !reader.ReadI64(argumentLine) ||
+          delim > cmListFileArgument::Bracket) {
+        return false;
+      }
+      arguments.emplace_back(std::move(value),
+                             static_cast<cmListFileArgument::Delimiter>(delim),
+                             static_cast<long>(argumentLine));
+    }
+    entry.Functions.emplace_back(std::move(name), static_cast<long>(line),
+                                 std::move(arguments));
+  }
+  return true;
+}
+}
+
+bool cmListFileCache::Find(std::string const& path,
+                           std::vector<cmListFileFunction>& functions)
+{
+  ListFileCacheState& state = GetListFileCacheState();
+  auto entry = state.Entries.find(path);
+  if (entry == state.Entries.end()) {
+    return false;
+  }
+
+  cmFileTime time;
+  if (!time.Load(path) || time.GetTime() != entry->second.Time ||
+      cmSystemTools::FileLength(path) != entry->second.Size) {
+    state.Entries.erase(entry);
+    return false;
+  }
+
+  entry->second.Used = true;
+  functions.insert(functions.end(), entry->second.Functions.begin(),
+                   entry->second.Functions.end());
+  return true;
+}
+
+void cmListFileCache::Store(std::string const& path,
+                            std::vector<cmListFileFunction> functions)
+{
+  cmFileTime time;
+  if (!time.Load(path) ||
+      CurrentFileTime() - time.GetTime() < cmFileTime::UtPerS) {
+    return;
+  }
+
+  ListFileCacheState& state = GetListFileCacheState();
+  ListFileCacheEntry& entry = state.Entries[path];
+  entry.Time = time.GetTime();
+  entry.Size = cmSystemTools::FileLength(path);
+  entry.Functions = std::move(functions);
+  entry.Used = true;
+  state.Modified = true;
+}
+
+bool cmListFileCache::Load(std::string const& cacheFile)
+{
+  cmsys::ifstream fin(cacheFile.c_str(), std::ios::in | std::ios::binary);
+  if (!fin) {
+    return false;
+  }
+  std::ostringstream content;
+  content << fin.rdbuf();
+  std::string const buffer = content.str();
+
+  ListFileCacheReader reader(buffer);
+  char magic[sizeof(ListFileCacheMagic)];
+  std::uint32_t byteOrder;
+  std::uint32_t version;
+  std::string cmakeVersion;
+  std::uint32_t entryCount;
+  if (!reader.Read(magic, sizeof(magic)) ||
+      memcmp(magic, ListFileCacheMagic, sizeof(magic)) != 0 ||
+      !reader.ReadU32(byteOrder) || byteOrder != ListFileCacheByteOrder ||
+      !reader.ReadU32(version) || version != ListFileCacheVersion ||
+      !reader.ReadString(cmakeVersion) ||
+      cmakeVersion != cmVersion::GetCMakeVersion() ||
+      !reader.ReadU32(entryCount)) {
+    return false;
+  }
+
+  // The whole file is read before anything is added to the cache so that
+  // a truncated file does not leave partial entries behind.
+  std::vector<std::pair<std::string, ListFileCacheEntry>> entries;
+  for (std::uint32_t i = 0; i < entryCount; ++i) {
+    std::pair<std::string, ListFileCacheEntry> entry;
+    if (!ReadListFileCacheEntry(reader, entry.first, entry.second)) {
+      return false;
+    }
+    entries.push_back(std::move(entry));
+  }
+  if (!reader.AtEnd()) {
+    return false;
+  }
+
+  ListFileCacheState& state = GetListFileCacheState();
+  for (auto& entry : entries) {
+    state.Entries.emplace(std::move(entry.first), std::move(entry.second));
+  }
+  return true;
+}
+
+bool cmListFileCache::Save(std::string const& cacheFile)
+{
+  ListFileCacheState& state = GetListFileCacheState();
+  if (!state.Modified && cmSystemTools::FileExists(cacheFile)) {
+    return true;
+  }
+
+  // Only the entries used by this process are saved so that entries of
+  // files which are no longer part of the project are eventually dropped.
+  ListFileCacheWriter writer;
+  std::uint32_t entryCount = 0;
+  for (auto const& entry : state.Entries) {
+    if (!entry.second.Used) {
+      continue;
+    }
+    ++entryCount;
+    writer.WriteString(entry.first);
+    writer.WriteI64(entry.second.Time);
+    writer.WriteI64(static_cast<std::int64_t>(entry.second.Size));
+    writer.WriteU32(
+      static_cast<std::uint32_t>(entry.second.Functions.size()));
+    for (cmListFileFunction const& function : entry.second.Functions) {
+      writer.WriteString(function.OriginalName());
+      writer.WriteI64(function.Line());
+      writer.WriteU32(static_cast<std::uint32_t>(function.Arguments().size()));
+      for (cmListFileArgument const& argument : function.Arguments()) {
+        writer.WriteString(argument.Value);
+        writer.WriteU32(static_cast<std::uint32_t>(argument.Delim));
+        writer.WriteI64(argument.Line);
+      }
+    }
+  }
+
+  // Another process may save the same cache file concurrently.
+  char tmpSuffix[16];
+  sprintf(tmpSuffix, ".tmp%05x", cmSystemTools::RandomSeed() & 0xFFFFF);
+  std::string const tmpFile = cmStrCat(cacheFile, tmpSuffix);
+  {
+    cmsys::ofstream fout(tmpFile.c_str(),
+                         std::ios::out | std::ios::binary | std::ios::trunc);
+    if (!fout) {
+      return false;
+    }
+    fout.write(ListFileCacheMagic, sizeof(ListFileCacheMagic));
+    fout.write(reinterpret_cast<char const*>(&ListFileCacheByteOrder),
+               sizeof(ListFileCacheByteOrder));
+    fout.write(reinterpret_cast<char const*>(&ListFileCacheVersion),
+               sizeof(ListFileCacheVersion));
+    std::string const cmakeVersion = cmVersion::GetCMakeVersion();
+    std::uint32_t const cmakeVersionSize =
+      static_cast<std::uint32_t>(cmakeVersion.size());
+    fout.write(reinterpret_cast<char const*>(&cmakeVersionSize),
+               sizeof(cmakeVersionSize));
+    fout.write(cmakeVersion.data(),
+               static_cast<std::streamsize>(cmakeVersion.size()));
+    fout.write(reinterpret_cast<char const*>(&entryCount),
+               sizeof(entryCount));
+    fout.write(writer.Buffer.data(),
+               static_cast<std::streamsize>(writer.Buffer.size()));
+    if (!fout) {
+      return false;
+    }
+  }
+  if (!cmSystemTools::RenameFile(tmpFile, cacheFile)) {
+    cmSystemTools::RemoveFile(tmpFile);
+    return false;
+  }
+  state.Modified = false;
+  return true;
+}
+
+void cmListFileCache::Clear()
+{
+  ListFileCacheState& state = GetListFileCacheState();
+  state.Entries.clear();
+  state.Modified = false;
+}
+
 // We hold either the bottom scope of a directory or a call/file context.
 // Discriminate these cases via the parent pointer.
 struct cmListFileBacktrace::Entry
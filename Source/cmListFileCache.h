@@ -5,6 +5,7 @@
 #include "cmConfigure.h" // IWYU pragma: keep
 
 #include <cstddef>
+#include <functional>
 #include <iosfwd>
 #include <memory>
 #include <string>
@@ -16,13 +17,7 @@
 #include "cmStateSnapshot.h"
 #include "cmSystemTools.h"
 
-/** \class cmListFileCache
- * \brief A class to cache list file contents.
- *
- * cmListFileCache is a class used to cache the contents of parsed
- * cmake list files.
- */
-
+class cmExecutionStatus;
 class cmMessenger;
 
 struct cmCommandContext
@@ -144,6 +139,28 @@ public:
 
   operator cmCommandContext const&() const noexcept { return *this->Impl; }
 
+  // Same type as cmState::Command.
+  using Command = std::function<bool(std::vector<cmListFileArgument> const&,
+                                     cmExecutionStatus&)>;
+
+  // Get the command this function was last resolved to, or nullptr if
+  // the command table changed since (see cmState::GetCommandsGeneration).
+  std::shared_ptr<Command const> GetResolvedCommand(
+    unsigned long generation) const
+  {
+    if (this->Impl->CommandGeneration != generation) {
+      return nullptr;
+    }
+    return this->Impl->ResolvedCommand.lock();
+  }
+
+  void SetResolvedCommand(std::shared_ptr<Command const> const& command,
+                          unsigned long generation) const
+  {
+    this->Impl->ResolvedCommand = command;
+    this->Impl->CommandGeneration = generation;
+  }
+
 private:
   struct Implementation : public cmCommandContext
   {
@@ -154,6 +171,9 @@ private:
     {
     }
     std::vector<cmListFileArgument> Arguments;
+    // Not owned: the body of a recursive function would own itself.
+    mutable std::weak_ptr<Command const> ResolvedCommand;
+    mutable unsigned long CommandGeneration = 0;
   };
 
   std::shared_ptr<Implementation const> Impl;
@@ -279,3 +299,51 @@ struct cmListFile
 
   std::vector<cmListFileFunction> Functions;
 };
+
+/** \class cmListFileCache
+ * \brief A class to cache list file contents.
+ *
+ * cmListFileCache is a class used to cache the contents of parsed
+ * cmake list files.  cmListFile::ParseFile stores the functions of each
+ * parsed file, keyed by its path, modification time and size, so that
+ * files included many times (modules, package configuration files...)
+ * are lexed only once per configure.  The cache can be saved to a file
+ * and loaded back by later runs, which then skip the lexer for every
+ * unchanged file.
+ */
+class cmListFileCache
+{
+public:
+  /**
+   * Look up the functions of a list file.  Returns false if the file
+   * is not cached or was modified since it was cached.
+   */
+  static bool Find(std::string const& path,
+                   std::vector<cmListFileFunction>& functions);
+
+  /**
+   * Store the functions of a list file.  Files modified in the last
+   * second are not stored: a later modification could keep the same
+   * modification time and size.
+   */
+  static void Store(std::string const& path,
+                    std::vector<cmListFileFunction> functions);
+
+  /**
+   * Load the entries saved by a previous run.  Returns false if the
+   * file does not exist or cannot be read.
+   */
+  static bool Load(std::string const& cacheFile);
+
+  /**
+   * Save the entries used by this process, if any of them was not
+   * loaded from cacheFile.  Returns false on write error.
+   */
+  static bool Save(std::string const& cacheFile);
+
+  /**
+   * Drop all entries.  Called at the end of each configure, once they
+   * are saved, so that the parsed files do not outlive the configure.
+   */
+  static void Clear();
+};
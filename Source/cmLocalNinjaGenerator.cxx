@@ -113,6 +113,12 @@ void cmLocalNinjaGenerator::Generate()
     }
   }
 
+  if (!this->GetGlobalNinjaGenerator()->OpenDirectoryFileStreams(
+        this->GetCurrentBinaryDirectory())) {
+    this->GetGlobalNinjaGenerator()->CloseDirectoryFileStreams();
+    return;
+  }
+
   for (const auto& target : this->GetGeneratorTargets()) {
     if (!target->IsInBuildSystem()) {
       continue;
@@ -173,6 +179,8 @@ void cmLocalNinjaGenerator::Generate()
     this->WriteCustomCommandBuildStatements(config);
     this->AdditionalCleanFiles(config);
   }
+
+  this->GetGlobalNinjaGenerator()->CloseDirectoryFileStreams();
 }
 
 // TODO: Picked up from cmLocalUnixMakefileGenerator3.  Refactor it.
@@ -2,7 +2,9 @@
    file Copyright.txt or https://cmake.org/licensing for details.  */
 #include "cmMacroCommand.h"
 
+#include <algorithm>
 #include <cstdio>
+#include <cstdlib>
 #include <utility>
 
 #include <cm/memory>
@@ -22,6 +24,38 @@
 
 namespace {
 
+// A reference to a macro argument within the body of the macro.
+enum class MacroSlot
+{
+  None,    // no reference
+  Formal,  // ${<formal>}, Index is the index of the formal argument
+  Argc,    // ${ARGC}
+  Argn,    // ${ARGN}
+  Argv,    // ${ARGV}
+  ArgvN,   // ${ARGV<Index>}, kept as is if there are not enough arguments
+};
+
+// A literal part of an argument of a command in the macro body, followed by
+// a reference to a macro argument.
+struct MacroSegment
+{
+  std::string Literal;
+  MacroSlot Slot = MacroSlot::None;
+  unsigned int Index = 0;
+};
+
+// An argument of a command in the macro body, split at definition time so
+// that invocations only splice the values of the macro arguments.
+struct MacroArgument
+{
+  std::vector<MacroSegment> Segments;
+
+  // Whether a reference is nested within another variable reference, as in
+  // ${${name}}: its value might form a new reference, which must then be
+  // replaced as well.
+  bool Nested = false;
+};
+
 // define the class for macro commands
 class cmMacroHelperCommand
 {
@@ -33,12 +67,134 @@ public:
   bool operator()(std::vector<cmListFileArgument> const& args,
                   cmExecutionStatus& inStatus) const;
 
+  /**
+   * Split the arguments of the body commands at the macro argument
+   * references.  Called once, when the macro is defined.
+   */
+  void Compile();
+
   std::vector<std::string> Args;
   std::vector<cmListFileFunction> Functions;
   cmPolicies::PolicyMap Policies;
   std::string FilePath;
+
+  // Compiled arguments of each command of Functions.
+  std::vector<std::vector<MacroArgument>> CompiledArguments;
+
+  // Whether formal argument names prevent compiled arguments from being
+  // used, e.g. if they hold braces.
+  bool CompiledArgumentsDisabled = false;
+
+private:
+  MacroSlot ResolveSlot(cm::string_view name, unsigned int& index) const;
+  MacroArgument CompileArgument(std::string const& value) const;
 };
 
+MacroSlot cmMacroHelperCommand::ResolveSlot(cm::string_view name,
+                                            unsigned int& index) const
+{
+  // References are resolved in the order they used to be replaced in:
+  // formal arguments first, then ARGC, ARGN, ARGV and ARGV<n>.
+  for (unsigned int j = 1; j < this->Args.size(); ++j) {
+    if (name == this->Args[j]) {
+      index = j - 1;
+      return MacroSlot::Formal;
+    }
+  }
+  if (name == "ARGC"_s) {
+    return MacroSlot::Argc;
+  }
+  if (name == "ARGN"_s) {
+    return MacroSlot::Argn;
+  }
+  if (name == "ARGV"_s) {
+    return MacroSlot::Argv;
+  }
+  if (name.size() > 4 && name.substr(0, 4) == "ARGV"_s &&
+      name.find_first_not_of("0123456789", 4) == cm::string_view::npos) {
+    // ${ARGV<n>} is only replaced when n is written without leading zeros.
+    // Indices this large cannot match any invocation anyway.
+    cm::string_view const digits = name.substr(4);
+    if ((digits.size() > 1 && digits[0] == '0') || digits.size() > 9) {
+      return MacroSlot::None;
+    }
+    index = static_cast<unsigned int>(
+      std::strtoul(std::string(digits).c_str(), nullptr, 10));
+    return MacroSlot::ArgvN;
+  }
+  return MacroSlot::None;
+}
+
+MacroArgument cmMacroHelperCommand::CompileArgument(
+  std::string const& value) const
+{
+  MacroArgument argument;
+  MacroSegment segment;
+  int openReferences = 0;
+  std::string::size_type pos = 0;
+  while (pos < value.size()) {
+    if (value[pos] == '$' && pos + 1 < value.size() &&
+        value[pos + 1] == '{') {
+      std::string::size_type const close = value.find('}', pos + 2);
+      if (close != std::string::npos) {
+        unsigned int index = 0;
+        MacroSlot const slot = this->ResolveSlot(
+          cm::string_view(value).substr(pos + 2, close - pos - 2), index);
+        if (slot != MacroSlot::None) {
+          if (openReferences > 0) {
+            argument.Nested = true;
+          }
+          segment.Slot = slot;
+          segment.Index = index;
+          argument.Segments.push_back(std::move(segment));
+          segment = MacroSegment();
+          pos = close + 1;
+          continue;
+        }
+      }
+      ++openReferences;
+      segment.Literal += "${";
+      pos += 2;
+      continue;
+    }
+    if (value[pos] == '}' && openReferences > 0) {
+      --openReferences;
+    }
+    segment.Literal += value[pos];
+    ++pos;
+  }
+  if (!segment.Literal.empty() || argument.Segments.empty()) {
+    argument.Segments.push_back(std::move(segment));
+  }
+  return argument;
+}
+
+void cmMacroHelperCommand::Compile()
+{
+  // Formal argument names holding characters of a variable reference could
+  // match across segments: such macros are expanded textually.
+  for (unsigned int j = 1; j < this->Args.size(); ++j) {
+    if (this->Args[j].find_first_of("${}") != std::string::npos) {
+      this->CompiledArgumentsDisabled = true;
+      return;
+    }
+  }
+
+  this->CompiledArguments.reserve(this->Functions.size());
+  for (cmListFileFunction const& func : this->Functions) {
+    std::vector<MacroArgument> arguments;
+    arguments.reserve(func.Arguments().size());
+    for (cmListFileArgument const& k : func.Arguments()) {
+      if (k.Delim == cmListFileArgument::Bracket) {
+        arguments.emplace_back();
+      } else {
+        arguments.push_back(this->CompileArgument(k.Value));
+      }
+    }
+    this->CompiledArguments.push_back(std::move(arguments));
+  }
+}
+
 bool cmMacroHelperCommand::operator()(
   std::vector<cmListFileArgument> const& args,
   cmExecutionStatus& inStatus) const
@@ -68,48 +224,98 @@ bool cmMacroHelperCommand::operator()(
   auto eit = expandedArgs.begin() + (this->Args.size() - 1);
   std::string expandedArgn = cmJoin(cmMakeRange(eit, expandedArgs.end()), ";");
   std::string expandedArgv = cmJoin(expandedArgs, ";");
+
+  // Values holding characters of a variable reference could form new
+  // references once spliced: arguments are then replaced textually, one
+  // reference after the other.
+  bool const spliceValues = !this->CompiledArgumentsDisabled &&
+    std::none_of(expandedArgs.begin(), expandedArgs.end(),
+                 [](std::string const& value) {
+                   return value.find_first_of("${}") != std::string::npos;
+                 });
+  bool textualReplacementReady = false;
   std::vector<std::string> variables;
-  variables.reserve(this->Args.size() - 1);
-  for (unsigned int j = 1; j < this->Args.size(); ++j) {
-    variables.push_back("${" + this->Args[j] + "}");
-  }
   std::vector<std::string> argVs;
-  argVs.reserve(expandedArgs.size());
-  char argvName[60];
-  for (unsigned int j = 0; j < expandedArgs.size(); ++j) {
-    sprintf(argvName, "${ARGV%u}", j);
-    argVs.emplace_back(argvName);
-  }
+  auto const replaceTextually = [&](std::string& value) {
+    if (!textualReplacementReady) {
+      textualReplacementReady = true;
+      variables.reserve(this->Args.size() - 1);
+      for (unsigned int j = 1; j < this->Args.size(); ++j) {
+        variables.push_back("${" + this->Args[j] + "}");
+      }
+      argVs.reserve(expandedArgs.size());
+      char argvName[60];
+      for (unsigned int j = 0; j < expandedArgs.size(); ++j) {
+        sprintf(argvName, "${ARGV%u}", j);
+        argVs.emplace_back(argvName);
+      }
+    }
+    // replace formal arguments
+    for (unsigned int j = 0; j < variables.size(); ++j) {
+      cmSystemTools::ReplaceString(value, variables[j], expandedArgs[j]);
+    }
+    // replace argc
+    cmSystemTools::ReplaceString(value, "${ARGC}", argcDef);
+
+    cmSystemTools::ReplaceString(value, "${ARGN}", expandedArgn);
+    cmSystemTools::ReplaceString(value, "${ARGV}", expandedArgv);
+
+    // if the current argument of the current function has ${ARGV in it
+    // then try replacing ARGV values
+    if (value.find("${ARGV") != std::string::npos) {
+      for (unsigned int t = 0; t < expandedArgs.size(); ++t) {
+        cmSystemTools::ReplaceString(value, argVs[t], expandedArgs[t]);
+      }
+    }
+  };
+  auto const splice = [&](MacroArgument const& compiled, std::string& value) {
+    for (MacroSegment const& segment : compiled.Segments) {
+      value += segment.Literal;
+      switch (segment.Slot) {
+        case MacroSlot::None:
+          break;
+        case MacroSlot::Formal:
+          value += expandedArgs[segment.Index];
+          break;
+        case MacroSlot::Argc:
+          value += argcDef;
+          break;
+        case MacroSlot::Argn:
+          value += expandedArgn;
+          break;
+        case MacroSlot::Argv:
+          value += expandedArgv;
+          break;
+        case MacroSlot::ArgvN:
+          if (segment.Index < expandedArgs.size()) {
+            value += expandedArgs[segment.Index];
+          } else {
+            value += cmStrCat("${ARGV", segment.Index, '}');
+          }
+          break;
+      }
+    }
+  };
+
   // Invoke all the functions that were collected in the block.
   // for each function
-  for (cmListFileFunction const& func : this->Functions) {
+  for (std::size_t f = 0; f < this->Functions.size(); ++f) {
+    cmListFileFunction const& func = this->Functions[f];
     // Replace the formal arguments and then invoke the command.
     std::vector<cmListFileArgument> newLFFArgs;
     newLFFArgs.reserve(func.Arguments().size());
 
     // for each argument of the current function
-    for (cmListFileArgument const& k : func.Arguments()) {
+    for (std::size_t a = 0; a < func.Arguments().size(); ++a) {
+      cmListFileArgument const& k = func.Arguments()[a];
       cmListFileArgument arg;
-      arg.Value = k.Value;
-      if (k.Delim != cmListFileArgument::Bracket) {
-        // replace formal arguments
-        for (unsigned int j = 0; j < variables.size(); ++j) {
-          cmSystemTools::ReplaceString(arg.Value, variables[j],
-                                       expandedArgs[j]);
-        }
-        // replace argc
-        cmSystemTools::ReplaceString(arg.Value, "${ARGC}", argcDef);
-
-        cmSystemTools::ReplaceString(arg.Value, "${ARGN}", expandedArgn);
-        cmSystemTools::ReplaceString(arg.Value, "${ARGV}", expandedArgv);
-
-        // if the current argument of the current function has ${ARGV in it
-        // then try replacing ARGV values
-        if (arg.Value.find("${ARGV") != std::string::npos) {
-          for (unsigned int t = 0; t < expandedArgs.size(); ++t) {
-            cmSystemTools::ReplaceString(arg.Value, argVs[t], expandedArgs[t]);
-          }
-        }
+      if (k.Delim == cmListFileArgument::Bracket) {
+        arg.Value = k.Value;
+      } else if (spliceValues && !this->CompiledArguments[f][a].Nested) {
+        splice(this->CompiledArguments[f][a], arg.Value);
+      } else {
+        arg.Value = k.Value;
+        replaceTextually(arg.Value);
       }
       arg.Delim = k.Delim;
       arg.Line = k.Line;
@@ -170,6 +376,7 @@ bool cmMacroFunctionBlocker::Replay(std::vector<cmListFileFunction> functions,
   f.Args = this->Args;
   f.Functions = std::move(functions);
   f.FilePath = this->GetStartingContext().FilePath;
+  f.Compile();
   mf.RecordPolicies(f.Policies);
   return mf.GetState()->AddScriptedCommand(
     this->Args[0],
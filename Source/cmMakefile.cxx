@@ -147,7 +147,7 @@ void cmMakefile::IssueMessage(MessageType t, std::string const& text) const
       this->ExecutionStatusStack.back()->SetNestedError();
     }
   }
-  this->GetCMakeInstance()->IssueMessage(t, text, this->Backtrace);
+  this->GetCMakeInstance()->IssueMessage(t, text, this->CurrentBacktrace());
 }
 
 bool cmMakefile::CheckCMP0037(std::string const& targetName,
@@ -239,6 +239,18 @@ cmBTStringRange cmMakefile::GetLinkDirectoriesEntries() const
 
 cmListFileBacktrace cmMakefile::GetBacktrace() const
 {
+  return this->CurrentBacktrace();
+}
+
+cmListFileBacktrace& cmMakefile::CurrentBacktrace() const
+{
+  for (PendingCall& call : this->PendingCalls) {
+    this->Backtrace =
+      this->Backtrace.Push(cmListFileContext::FromCommandContext(
+        call.Function, call.Snapshot.GetExecutionListFile(),
+        std::move(call.DeferId)));
+  }
+  this->PendingCalls.clear();
   return this->Backtrace;
 }
 
@@ -340,16 +352,15 @@ public:
                  cm::optional<std::string> deferId, cmExecutionStatus& status)
     : Makefile(mf)
   {
-    cmListFileContext const& lfc = cmListFileContext::FromCommandContext(
-      lff, this->Makefile->StateSnapshot.GetExecutionListFile(),
-      std::move(deferId));
-    this->Makefile->Backtrace = this->Makefile->Backtrace.Push(lfc);
+    // The call frame is added to the backtrace on first use of the latter.
+    this->Makefile->PendingCalls.emplace_back(
+      lff, this->Makefile->StateSnapshot, std::move(deferId));
     ++this->Makefile->RecursionDepth;
     this->Makefile->ExecutionStatusStack.push_back(&status);
 #if !defined(CMAKE_BOOTSTRAP)
     if (this->Makefile->GetCMakeInstance()->IsProfilingEnabled()) {
-      this->Makefile->GetCMakeInstance()->GetProfilingOutput().StartEntry(lff,
-                                                                          lfc);
+      this->Makefile->GetCMakeInstance()->GetProfilingOutput().StartEntry(
+        lff, this->Makefile->CurrentBacktrace().Top());
     }
 #endif
   }
@@ -363,7 +374,11 @@ public:
 #endif
     this->Makefile->ExecutionStatusStack.pop_back();
     --this->Makefile->RecursionDepth;
-    this->Makefile->Backtrace = this->Makefile->Backtrace.Pop();
+    if (!this->Makefile->PendingCalls.empty()) {
+      this->Makefile->PendingCalls.pop_back();
+    } else {
+      this->Makefile->Backtrace = this->Makefile->Backtrace.Pop();
+    }
   }
 
   cmMakefileCall(const cmMakefileCall&) = delete;
@@ -416,17 +431,27 @@ bool cmMakefile::ExecuteCommand(const cmListFileFunction& lff,
     return false;
   }
 
-  // Lookup the command prototype.
-  if (cmState::Command command =
-        this->GetState()->GetCommandByExactName(lff.LowerCaseName())) {
+  // Lookup the command prototype, unless the function was already resolved
+  // against the current set of commands.  The command is held here, as it
+  // could be redefined while it runs.
+  unsigned long const generation = this->GetState()->GetCommandsGeneration();
+  std::shared_ptr<cmState::Command const> command =
+    lff.GetResolvedCommand(generation);
+  if (!command) {
+    command = this->GetState()->FindCommandByExactName(lff.LowerCaseName());
+    if (command) {
+      lff.SetResolvedCommand(command, generation);
+    }
+  }
+  if (command) {
     // Decide whether to invoke the command.
     if (!cmSystemTools::GetFatalErrorOccured()) {
       // if trace is enabled, print out invoke information
       if (this->GetCMakeInstance()->GetTrace()) {
-        this->PrintCommandTrace(lff, this->Backtrace.Top().DeferId);
+        this->PrintCommandTrace(lff, this->CurrentBacktrace().Top().DeferId);
       }
       // Try invoking the command.
-      bool invokeSucceeded = command(lff.Arguments(), status);
+      bool invokeSucceeded = (*command)(lff.Arguments(), status);
       bool hadNestedError = status.GetNestedError();
       if (!invokeSucceeded || hadNestedError) {
         if (!hadNestedError) {
@@ -481,7 +506,8 @@ cmMakefile::IncludeScope::IncludeScope(cmMakefile* mf,
   , CheckCMP0011(false)
   , ReportError(true)
 {
-  this->Makefile->Backtrace = this->Makefile->Backtrace.Push(filenametoread);
+  this->Makefile->Backtrace =
+    this->Makefile->CurrentBacktrace().Push(filenametoread);
 
   this->Makefile->PushFunctionBlockerBarrier();
 
@@ -596,7 +622,7 @@ bool cmMakefile::ReadDependentFile(const std::string& filename,
 
   cmListFile listFile;
   if (!listFile.ParseFile(filenametoread.c_str(), this->GetMessenger(),
-                          this->Backtrace)) {
+                          this->CurrentBacktrace())) {
     return false;
   }
 
@@ -614,7 +640,8 @@ public:
     : Makefile(mf)
     , ReportError(true)
   {
-    this->Makefile->Backtrace = this->Makefile->Backtrace.Push(filenametoread);
+    this->Makefile->Backtrace =
+      this->Makefile->CurrentBacktrace().Push(filenametoread);
 
     this->Makefile->StateSnapshot =
       this->Makefile->GetState()->CreateInlineListFileSnapshot(
@@ -650,7 +677,7 @@ public:
     cmListFileContext lfc;
     lfc.Line = cmListFileContext::DeferPlaceholderLine;
     lfc.FilePath = deferredInFile;
-    this->Makefile->Backtrace = this->Makefile->Backtrace.Push(lfc);
+    this->Makefile->Backtrace = this->Makefile->CurrentBacktrace().Push(lfc);
     this->Makefile->DeferRunning = true;
   }
 
@@ -697,7 +724,7 @@ bool cmMakefile::ReadListFile(const std::string& filename)
 
   cmListFile listFile;
   if (!listFile.ParseFile(filenametoread.c_str(), this->GetMessenger(),
-                          this->Backtrace)) {
+                          this->CurrentBacktrace())) {
     return false;
   }
 
@@ -718,7 +745,7 @@ bool cmMakefile::ReadListFileAsString(const std::string& content,
 
   cmListFile listFile;
   if (!listFile.ParseString(content.c_str(), virtualFileName.c_str(),
-                            this->GetMessenger(), this->Backtrace)) {
+                            this->GetMessenger(), this->CurrentBacktrace())) {
     return false;
   }
 
@@ -816,8 +843,8 @@ void cmMakefile::EnforceDirectoryLevelRules() const
       case cmPolicies::WARN:
         // Warn because the user did not provide a minimum required
         // version.
-        this->GetCMakeInstance()->IssueMessage(MessageType::AUTHOR_WARNING,
-                                               msg.str(), this->Backtrace);
+        this->GetCMakeInstance()->IssueMessage(
+          MessageType::AUTHOR_WARNING, msg.str(), this->CurrentBacktrace());
         CM_FALLTHROUGH;
       case cmPolicies::OLD:
         // OLD behavior is to use policy version 2.4 set in
@@ -827,8 +854,8 @@ void cmMakefile::EnforceDirectoryLevelRules() const
       case cmPolicies::REQUIRED_ALWAYS:
       case cmPolicies::NEW:
         // NEW behavior is to issue an error.
-        this->GetCMakeInstance()->IssueMessage(MessageType::FATAL_ERROR,
-                                               msg.str(), this->Backtrace);
+        this->GetCMakeInstance()->IssueMessage(
+          MessageType::FATAL_ERROR, msg.str(), this->CurrentBacktrace());
         cmSystemTools::SetFatalErrorOccured();
         break;
     }
@@ -894,7 +921,8 @@ struct file_not_persistent
 void cmMakefile::AddGeneratorAction(GeneratorAction action)
 {
   assert(!this->GeneratorActionsInvoked);
-  this->GeneratorActions.emplace_back(std::move(action), this->Backtrace);
+  this->GeneratorActions.emplace_back(std::move(action),
+                                      this->CurrentBacktrace());
 }
 
 void cmMakefile::DoGenerate(cmLocalGenerator& lg)
@@ -934,7 +962,7 @@ void cmMakefile::Generate(cmLocalGenerator& lg)
       "than 2.4. This version of CMake only supports backwards compatibility "
       "with CMake 2.4 or later. For compatibility with older versions please "
       "use any CMake 2.8.x release or lower.",
-      this->Backtrace);
+      this->CurrentBacktrace());
   }
 }
 
@@ -1065,7 +1093,7 @@ cmTarget* cmMakefile::AddCustomCommandToTarget(
   bool command_expand_lists, bool stdPipesUTF8)
 {
   cmTarget* t = this->GetCustomCommandTarget(
-    target, cmObjectLibraryCommands::Reject, this->Backtrace);
+    target, cmObjectLibraryCommands::Reject, this->CurrentBacktrace());
 
   // Validate custom commands.
   if (!t || !this->ValidateCustomCommand(commandLines)) {
@@ -1082,7 +1110,7 @@ cmTarget* cmMakefile::AddCustomCommandToTarget(
   // Dispatch command creation to allow generator expressions in outputs.
   this->AddGeneratorAction(
     [=](cmLocalGenerator& lg, const cmListFileBacktrace& lfbt) {
-      BacktraceGuard guard(this->Backtrace, lfbt);
+      BacktraceGuard guard(this->CurrentBacktrace(), lfbt);
       detail::AddCustomCommandToTarget(
         lg, lfbt, cmCommandOrigin::Project, t, byproducts, depends,
         commandLines, type, GetCStrOrNull(commentStr),
@@ -1144,7 +1172,7 @@ void cmMakefile::AddCustomCommandToOutput(
   // Dispatch command creation to allow generator expressions in outputs.
   this->AddGeneratorAction(
     [=](cmLocalGenerator& lg, const cmListFileBacktrace& lfbt) {
-      BacktraceGuard guard(this->Backtrace, lfbt);
+      BacktraceGuard guard(this->CurrentBacktrace(), lfbt);
       cmSourceFile* sf = detail::AddCustomCommandToOutput(
         lg, lfbt, cmCommandOrigin::Project, outputs, byproducts, depends,
         main_dependency, implicit_depends, commandLines,
@@ -1232,7 +1260,7 @@ void cmMakefile::AppendCustomCommandToOutput(
     // Dispatch command creation to allow generator expressions in outputs.
     this->AddGeneratorAction(
       [=](cmLocalGenerator& lg, const cmListFileBacktrace& lfbt) {
-        BacktraceGuard guard(this->Backtrace, lfbt);
+        BacktraceGuard guard(this->CurrentBacktrace(), lfbt);
         detail::AppendCustomCommandToOutput(lg, lfbt, output, depends,
                                             implicit_depends, commandLines);
       });
@@ -1265,7 +1293,7 @@ cmTarget* cmMakefile::AddUtilityCommand(
   // Dispatch command creation to allow generator expressions in outputs.
   this->AddGeneratorAction(
     [=](cmLocalGenerator& lg, const cmListFileBacktrace& lfbt) {
-      BacktraceGuard guard(this->Backtrace, lfbt);
+      BacktraceGuard guard(this->CurrentBacktrace(), lfbt);
       detail::AddUtilityCommand(
         lg, lfbt, cmCommandOrigin::Project, target, GetCStrOrNull(workingStr),
         byproducts, depends, commandLines, escapeOldStyle,
@@ -1360,10 +1388,10 @@ void cmMakefile::AddLinkDirectory(std::string const& directory, bool before)
 {
   if (before) {
     this->StateSnapshot.GetDirectory().PrependLinkDirectoriesEntry(
-      BT<std::string>(directory, this->Backtrace));
+      BT<std::string>(directory, this->CurrentBacktrace()));
   } else {
     this->StateSnapshot.GetDirectory().AppendLinkDirectoriesEntry(
-      BT<std::string>(directory, this->Backtrace));
+      BT<std::string>(directory, this->CurrentBacktrace()));
   }
 }
 
@@ -1609,7 +1637,7 @@ void cmMakefile::Configure()
   // Add the bottom of all backtraces within this directory.
   // We will never pop this scope because it should be available
   // for messages during the generate step too.
-  this->Backtrace = this->Backtrace.Push(currentStart);
+  this->Backtrace = this->CurrentBacktrace().Push(currentStart);
 
   BuildsystemFileScope scope(this);
 
@@ -1623,7 +1651,7 @@ void cmMakefile::Configure()
 
   cmListFile listFile;
   if (!listFile.ParseFile(currentStart.c_str(), this->GetMessenger(),
-                          this->Backtrace)) {
+                          this->CurrentBacktrace())) {
     return;
   }
   if (this->IsRootMakefile()) {
@@ -1693,7 +1721,7 @@ void cmMakefile::Configure()
         "near the top of the file, but after cmake_minimum_required().\n"
         "CMake is pretending there is a \"project(Project)\" command on "
         "the first line.",
-        this->Backtrace);
+        this->CurrentBacktrace());
       cmListFileFunction project{ "project",
                                   0,
                                   { { "Project", cmListFileArgument::Unquoted,
@@ -1852,16 +1880,17 @@ void cmMakefile::AddIncludeDirectories(const std::vector<std::string>& incs,
   std::string entryString = cmJoin(incs, ";");
   if (before) {
     this->StateSnapshot.GetDirectory().PrependIncludeDirectoriesEntry(
-      BT<std::string>(entryString, this->Backtrace));
+      BT<std::string>(entryString, this->CurrentBacktrace()));
   } else {
     this->StateSnapshot.GetDirectory().AppendIncludeDirectoriesEntry(
-      BT<std::string>(entryString, this->Backtrace));
+      BT<std::string>(entryString, this->CurrentBacktrace()));
   }
 
   // Property on each target:
   for (auto& target : this->Targets) {
     cmTarget& t = target.second;
-    t.InsertInclude(BT<std::string>(entryString, this->Backtrace), before);
+    t.InsertInclude(BT<std::string>(entryString, this->CurrentBacktrace()),
+                    before);
   }
 }
 
@@ -1892,6 +1921,35 @@ void cmMakefile::AddDefinition(const std::string& name, cm::string_view value)
 #endif
 }
 
+void cmMakefile::AppendDefinition(const std::string& name,
+                                  cm::string_view elements)
+{
+  // Read the value first, for variable watches.
+  cmValue const old = this->GetDefinition(name);
+  cmValue value;
+  if (old) {
+    value = this->StateSnapshot.AppendDefinition(name, elements);
+  }
+  if (!value) {
+    // Not a normal variable: start from the cache entry, if any.
+    std::string listString = old ? *old : std::string();
+    if (!listString.empty()) {
+      listString += ';';
+    }
+    listString.append(elements.data(), elements.size());
+    this->AddDefinition(name, listString);
+    return;
+  }
+
+#ifndef CMAKE_BOOTSTRAP
+  cmVariableWatch* vv = this->GetVariableWatch();
+  if (vv) {
+    vv->VariableAccessed(name, cmVariableWatch::VARIABLE_MODIFIED_ACCESS,
+                         value.GetCStr(), this);
+  }
+#endif
+}
+
 void cmMakefile::AddDefinitionBool(const std::string& name, bool value)
 {
   this->AddDefinition(name, value ? "ON" : "OFF");
@@ -2358,7 +2416,7 @@ void cmMakefile::ExpandVariablesCMP0019()
       << w.str();
     /* clang-format on */
     this->GetCMakeInstance()->IssueMessage(MessageType::AUTHOR_WARNING,
-                                           m.str(), this->Backtrace);
+                                           m.str(), this->CurrentBacktrace());
   }
 }
 
@@ -2557,6 +2615,24 @@ const std::string& cmMakefile::GetSafeDefinition(const std::string& name) const
   return this->GetDefinition(name);
 }
 
+std::shared_ptr<std::vector<std::string> const> cmMakefile::GetDefinitionList(
+  const std::string& name) const
+{
+  if (this->StateSnapshot.GetDefinition(name)) {
+    return this->StateSnapshot.GetDefinitionList(name);
+  }
+  cmValue def = this->GetState()->GetInitializedCacheValue(name);
+  if (!def) {
+    return nullptr;
+  }
+  // Cache entries are split each time.
+  auto list = std::make_shared<std::vector<std::string>>();
+  if (!def->empty()) {
+    cmExpandList(*def, *list, true);
+  }
+  return list;
+}
+
 bool cmMakefile::GetDefExpandList(const std::string& name,
                                   std::vector<std::string>& out,
                                   bool emptyArgs) const
@@ -2926,7 +3002,7 @@ MessageType cmMakefile::ExpandVariablesInStringNew(
           switch (var.domain) {
             case NORMAL:
               if (filename && lookup == lineVar) {
-                cmListFileContext const& top = this->Backtrace.Top();
+                cmListFileContext const& top = this->CurrentBacktrace().Top();
                 if (top.DeferId) {
                   varresult = cmStrCat("DEFERRED:"_s, *top.DeferId);
                 } else {
@@ -3343,7 +3419,7 @@ void cmMakefile::AddFunctionBlocker(std::unique_ptr<cmFunctionBlocker> fb)
 {
   if (!this->ExecutionStatusStack.empty()) {
     // Record the context in which the blocker is created.
-    fb->SetStartingContext(this->Backtrace.Top());
+    fb->SetStartingContext(this->CurrentBacktrace().Top());
   }
 
   this->FunctionBlockers.push(std::move(fb));
@@ -3842,8 +3918,8 @@ void cmMakefile::ConfigureString(const std::string& input, std::string& output,
   // Perform variable replacements.
   const char* filename = nullptr;
   long lineNumber = -1;
-  if (!this->Backtrace.Empty()) {
-    const auto& currentTrace = this->Backtrace.Top();
+  if (!this->CurrentBacktrace().Empty()) {
+    const auto& currentTrace = this->CurrentBacktrace().Top();
     filename = currentTrace.FilePath.c_str();
     lineNumber = currentTrace.Line;
   }
@@ -3962,18 +4038,20 @@ int cmMakefile::ConfigureFile(const std::string& infile,
 
 void cmMakefile::SetProperty(const std::string& prop, const char* value)
 {
-  this->StateSnapshot.GetDirectory().SetProperty(prop, value, this->Backtrace);
+  this->StateSnapshot.GetDirectory().SetProperty(prop, value,
+                                                 this->CurrentBacktrace());
 }
 void cmMakefile::SetProperty(const std::string& prop, cmValue value)
 {
-  this->StateSnapshot.GetDirectory().SetProperty(prop, value, this->Backtrace);
+  this->StateSnapshot.GetDirectory().SetProperty(prop, value,
+                                                 this->CurrentBacktrace());
 }
 
 void cmMakefile::AppendProperty(const std::string& prop,
                                 const std::string& value, bool asString)
 {
   this->StateSnapshot.GetDirectory().AppendProperty(prop, value, asString,
-                                                    this->Backtrace);
+                                                    this->CurrentBacktrace());
 }
 
 cmValue cmMakefile::GetProperty(const std::string& prop) const
@@ -4359,11 +4437,11 @@ void cmMakefile::ClearMatches()
   this->MarkVariableAsUsed(nMatchesVariable);
 }
 
-void cmMakefile::StoreMatches(cmsys::RegularExpression& re)
+void cmMakefile::StoreMatches(cmsys::RegularExpressionMatch const& match)
 {
   char highest = 0;
   for (int i = 0; i < 10; i++) {
-    std::string const& m = re.match(i);
+    std::string const& m = match.match(i);
     if (!m.empty()) {
       std::string const& var = matchVariables[i];
       this->AddDefinition(var, m);
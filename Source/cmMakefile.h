@@ -290,6 +290,11 @@ public:
   {
     this->AddDefinition(name, *value);
   }
+  /**
+   * Append elements to a list variable, as list(APPEND) does.  Repeated
+   * appends to a variable of the current scope take linear time.
+   */
+  void AppendDefinition(const std::string& name, cm::string_view elements);
   /**
    * Add bool variable definition to the build.
    */
@@ -499,6 +504,14 @@ public:
   bool IsNormalDefinitionSet(const std::string&) const;
   bool GetDefExpandList(const std::string& name, std::vector<std::string>& out,
                         bool emptyArgs = false) const;
+  /**
+   * Given a variable name, return its value split as a list, keeping
+   * empty elements, or nullptr if it is not defined.  The split of
+   * normal variables is cached until they are set again.  Variable
+   * watches are not notified: read the value with GetDefinition first.
+   */
+  std::shared_ptr<std::vector<std::string> const> GetDefinitionList(
+    const std::string& name) const;
   /**
    * Get the list of all variables in the current space. If argument
    * cacheonly is specified and is greater than 0, then only cache
@@ -900,7 +913,7 @@ public:
   bool IsLoopBlock() const;
 
   void ClearMatches();
-  void StoreMatches(cmsys::RegularExpression& re);
+  void StoreMatches(cmsys::RegularExpressionMatch const& match);
 
   cmStateSnapshot GetStateSnapshot() const;
 
@@ -998,9 +1011,27 @@ protected:
 
 private:
   cmStateSnapshot StateSnapshot;
-  cmListFileBacktrace Backtrace;
+  mutable cmListFileBacktrace Backtrace;
   int RecursionDepth;
 
+  // The frames of the commands being executed are added to the backtrace
+  // only when something reads it: most commands never issue a message.
+  struct PendingCall
+  {
+    PendingCall(cmListFileFunction const& lff, cmStateSnapshot snapshot,
+                cm::optional<std::string> deferId)
+      : Function(lff)
+      , Snapshot(snapshot)
+      , DeferId(std::move(deferId))
+    {
+    }
+    cmListFileFunction Function;
+    cmStateSnapshot Snapshot;
+    cm::optional<std::string> DeferId;
+  };
+  mutable std::vector<PendingCall> PendingCalls;
+  cmListFileBacktrace& CurrentBacktrace() const;
+
   struct DeferCommand
   {
     // Id is empty for an already-executed or canceled operation.
@@ -13,6 +13,7 @@
 #include "cmsys/SystemInformation.hxx"
 
 #include "cmListFileCache.h"
+#include "cmRegexCache.h"
 #include "cmStringAlgorithms.h"
 #include "cmSystemTools.h"
 
@@ -35,6 +36,7 @@ cmMakefileProfilingData::~cmMakefileProfilingData() noexcept
 {
   if (this->ProfileStream.good()) {
     try {
+      this->WriteRegexCacheCounter();
       this->ProfileStream << "]";
       this->ProfileStream.close();
     } catch (...) {
@@ -43,6 +45,38 @@ cmMakefileProfilingData::~cmMakefileProfilingData() noexcept
   }
 }
 
+void cmMakefileProfilingData::WriteRegexCacheCounter()
+{
+  unsigned long const hits = cmRegexCache::GetHits();
+  unsigned long const misses = cmRegexCache::GetMisses();
+  if (hits + misses == 0) {
+    return;
+  }
+
+  if (this->ProfileStream.tellp() > 1) {
+    this->ProfileStream << ",";
+  }
+  cmsys::SystemInformation info;
+  Json::Value v;
+  v["ph"] = "C";
+  v["name"] = "regex cache";
+  v["cat"] = "cmake";
+  v["ts"] = Json::Value::UInt64(
+    std::chrono::duration_cast<std::chrono::microseconds>(
+      std::chrono::steady_clock::now().time_since_epoch())
+      .count());
+  v["pid"] = static_cast<int>(info.GetProcessId());
+  v["tid"] = 0;
+  Json::Value argsValue;
+  argsValue["hits"] = Json::Value::UInt64(hits);
+  argsValue["misses"] = Json::Value::UInt64(misses);
+  argsValue["hitRate"] =
+    static_cast<double>(hits) / static_cast<double>(hits + misses);
+  v["args"] = argsValue;
+
+  this->JsonWriter->write(v, &this->ProfileStream);
+}
+
 void cmMakefileProfilingData::StartEntry(const cmListFileFunction& lff,
                                          cmListFileContext const& lfc)
 {
@@ -22,6 +22,9 @@ public:
   void StopEntry();
 
 private:
+  // Write the hit rate of cmRegexCache as a counter event.
+  void WriteRegexCacheCounter();
+
   cmsys::ofstream ProfileStream;
   std::unique_ptr<Json::StreamWriter> JsonWriter;
 };
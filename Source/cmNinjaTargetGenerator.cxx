@@ -487,9 +487,12 @@ bool cmNinjaTargetGenerator::SetMsvcTargetPdbVariable(
   cmNinjaVars& vars, const std::string& config) const
 {
   cmMakefile* mf = this->GetMakefile();
-  if (mf->GetDefinition("MSVC_C_ARCHITECTURE_ID") ||
-      mf->GetDefinition("MSVC_CXX_ARCHITECTURE_ID") ||
-      mf->GetDefinition("MSVC_CUDA_ARCHITECTURE_ID")) {
+  // The compiler identification defines these variables, possibly empty,
+  // on the first configure only, so check for a value rather than for a
+  // definition.
+  if (cmNonempty(mf->GetDefinition("MSVC_C_ARCHITECTURE_ID")) ||
+      cmNonempty(mf->GetDefinition("MSVC_CXX_ARCHITECTURE_ID")) ||
+      cmNonempty(mf->GetDefinition("MSVC_CUDA_ARCHITECTURE_ID"))) {
     std::string pdbPath;
     std::string compilePdbPath = this->ComputeTargetCompilePDB(config);
     if (this->GeneratorTarget->GetType() == cmStateEnums::EXECUTABLE ||
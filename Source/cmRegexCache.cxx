@@ -0,0 +1,64 @@
+/* Distributed under the OSI-approved BSD 3-Clause License.  See accompanying
+   file Copyright.txt or https://cmake.org/licensing for details.  */
+#include "cmRegexCache.h"
+
+#include <cstddef>
+#include <list>
+#include <unordered_map>
+#include <utility>
+
+namespace {
+
+std::size_t const MaxEntries = 256;
+
+struct Cache
+{
+  using Entry = std::pair<std::string, cmRegexCache::Regex>;
+  // Most recently used entries first.
+  std::list<Entry> Entries;
+  std::unordered_map<std::string, std::list<Entry>::iterator> Index;
+  unsigned long Hits = 0;
+  unsigned long Misses = 0;
+};
+
+Cache& GetCache()
+{
+  static Cache cache;
+  return cache;
+}
+
+} // anonymous namespace
+
+cmRegexCache::Regex cmRegexCache::Get(std::string const& pattern)
+{
+  Cache& cache = GetCache();
+  auto const it = cache.Index.find(pattern);
+  if (it != cache.Index.end()) {
+    ++cache.Hits;
+    cache.Entries.splice(cache.Entries.begin(), cache.Entries, it->second);
+    return it->second->second;
+  }
+
+  ++cache.Misses;
+  auto regex = std::make_shared<cmsys::RegularExpression>();
+  if (!regex->compile(pattern)) {
+    return nullptr;
+  }
+  if (cache.Entries.size() >= MaxEntries) {
+    cache.Index.erase(cache.Entries.back().first);
+    cache.Entries.pop_back();
+  }
+  cache.Entries.emplace_front(pattern, std::move(regex));
+  cache.Index.emplace(pattern, cache.Entries.begin());
+  return cache.Entries.front().second;
+}
+
+unsigned long cmRegexCache::GetHits()
+{
+  return GetCache().Hits;
+}
+
+unsigned long cmRegexCache::GetMisses()
+{
+  return GetCache().Misses;
+}
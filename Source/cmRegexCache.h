@@ -0,0 +1,40 @@
+/* Distributed under the OSI-approved BSD 3-Clause License.  See accompanying
+   file Copyright.txt or https://cmake.org/licensing for details.  */
+#pragma once
+
+#include "cmConfigure.h" // IWYU pragma: keep
+
+#include <memory>
+#include <string>
+
+#include "cmsys/RegularExpression.hxx"
+
+/** \class cmRegexCache
+ * \brief A class to cache compiled regular expressions.
+ *
+ * Commands matching the regular expressions of a project (if(MATCHES),
+ * string(REGEX), list(FILTER), list(TRANSFORM), file(STRINGS REGEX))
+ * usually match a handful of patterns many times, for instance to parse
+ * versions or scan headers in find modules.  cmRegexCache keeps the
+ * most recently used compiled expressions so that each pattern is
+ * compiled once.  The number of cached expressions is bounded, the
+ * least recently used expression being evicted first.
+ */
+class cmRegexCache
+{
+public:
+  using Regex = std::shared_ptr<cmsys::RegularExpression const>;
+
+  /**
+   * Get the compiled expression of a pattern, or nullptr if the pattern
+   * does not compile.  The expression is shared: callers match it with
+   * their own cmsys::RegularExpressionMatch.
+   */
+  static Regex Get(std::string const& pattern);
+
+  /** Get the number of patterns found in the cache.  */
+  static unsigned long GetHits();
+
+  /** Get the number of patterns compiled because they were not cached.  */
+  static unsigned long GetMisses();
+};
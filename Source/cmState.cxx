@@ -4,6 +4,7 @@
 
 #include <algorithm>
 #include <array>
+#include <atomic>
 #include <cassert>
 #include <cstdlib>
 #include <utility>
@@ -32,6 +33,7 @@ cmState::cmState(Mode mode, ProjectKind projectKind)
 {
   this->CacheManager = cm::make_unique<cmCacheManager>();
   this->GlobVerificationManager = cm::make_unique<cmGlobVerificationManager>();
+  this->UpdateCommandsGeneration();
 }
 
 cmState::~cmState() = default;
@@ -398,7 +400,9 @@ void cmState::AddBuiltinCommand(std::string const& name, Command command)
 {
   assert(name == cmSystemTools::LowerCase(name));
   assert(this->BuiltinCommands.find(name) == this->BuiltinCommands.end());
-  this->BuiltinCommands.emplace(name, std::move(command));
+  this->BuiltinCommands.emplace(
+    name, std::make_shared<Command const>(std::move(command)));
+  this->UpdateCommandsGeneration();
 }
 
 static bool InvokeBuiltinCommand(cmState::BuiltinCommand command,
@@ -506,11 +510,14 @@ bool cmState::AddScriptedCommand(std::string const& name, BT<Command> command,
   }
 
   // if the command already exists, give a new name to the old command.
-  if (Command oldCmd = this->GetCommandByExactName(sName)) {
-    this->ScriptedCommands["_" + sName] = oldCmd;
+  if (std::shared_ptr<Command const> oldCmd =
+        this->FindCommandByExactName(sName)) {
+    this->ScriptedCommands["_" + sName] = std::move(oldCmd);
   }
 
-  this->ScriptedCommands[sName] = std::move(command.Value);
+  this->ScriptedCommands[sName] =
+    std::make_shared<Command const>(std::move(command.Value));
+  this->UpdateCommandsGeneration();
   return true;
 }
 
@@ -520,6 +527,16 @@ cmState::Command cmState::GetCommand(std::string const& name) const
 }
 
 cmState::Command cmState::GetCommandByExactName(std::string const& name) const
+{
+  if (std::shared_ptr<Command const> command =
+        this->FindCommandByExactName(name)) {
+    return *command;
+  }
+  return nullptr;
+}
+
+std::shared_ptr<cmState::Command const> cmState::FindCommandByExactName(
+  std::string const& name) const
 {
   auto pos = this->ScriptedCommands.find(name);
   if (pos != this->ScriptedCommands.end()) {
@@ -532,6 +549,18 @@ cmState::Command cmState::GetCommandByExactName(std::string const& name) const
   return nullptr;
 }
 
+unsigned long cmState::GetCommandsGeneration() const
+{
+  return this->CommandsGeneration;
+}
+
+void cmState::UpdateCommandsGeneration()
+{
+  // Functions of cached list files are shared by all instances.
+  static std::atomic<unsigned long> lastGeneration(0);
+  this->CommandsGeneration = ++lastGeneration;
+}
+
 std::vector<std::string> cmState::GetCommandNames() const
 {
   std::vector<std::string> commandNames;
@@ -553,11 +582,13 @@ void cmState::RemoveBuiltinCommand(std::string const& name)
 {
   assert(name == cmSystemTools::LowerCase(name));
   this->BuiltinCommands.erase(name);
+  this->UpdateCommandsGeneration();
 }
 
 void cmState::RemoveUserDefinedCommands()
 {
   this->ScriptedCommands.clear();
+  this->UpdateCommandsGeneration();
 }
 
 void cmState::SetGlobalProperty(const std::string& prop, const char* value)
@@ -151,8 +151,7 @@ public:
   bool GetIsGeneratorMultiConfig() const;
   void SetIsGeneratorMultiConfig(bool b);
 
-  using Command = std::function<bool(std::vector<cmListFileArgument> const&,
-                                     cmExecutionStatus&)>;
+  using Command = cmListFileFunction::Command;
   using BuiltinCommand = bool (*)(std::vector<std::string> const&,
                                   cmExecutionStatus&);
 
@@ -160,6 +159,13 @@ public:
   Command GetCommand(std::string const& name) const;
   // Returns a command from its name, or nullptr
   Command GetCommandByExactName(std::string const& name) const;
+  // Same as GetCommandByExactName, without copying the command
+  std::shared_ptr<Command const> FindCommandByExactName(
+    std::string const& name) const;
+  // Returns a value identifying the current set of commands: it changes
+  // each time a command is added or removed, and is unique across all
+  // cmState instances, so that resolved commands can be cached.
+  unsigned long GetCommandsGeneration() const;
 
   void AddBuiltinCommand(std::string const& name,
                          std::unique_ptr<cmCommand> command);
@@ -248,8 +254,12 @@ private:
 
   cmPropertyDefinitionMap PropertyDefinitions;
   std::vector<std::string> EnabledLanguages;
-  std::unordered_map<std::string, Command> BuiltinCommands;
-  std::unordered_map<std::string, Command> ScriptedCommands;
+  std::unordered_map<std::string, std::shared_ptr<Command const>>
+    BuiltinCommands;
+  std::unordered_map<std::string, std::shared_ptr<Command const>>
+    ScriptedCommands;
+  unsigned long CommandsGeneration = 0;
+  void UpdateCommandsGeneration();
   std::unordered_set<std::string> FlowControlCommands;
   cmPropertyMap GlobalProperties;
   std::unique_ptr<cmCacheManager> CacheManager;
@@ -211,6 +211,14 @@ cmValue cmStateSnapshot::GetDefinition(std::string const& name) const
   return cmDefinitions::Get(name, this->Position->Vars, this->Position->Root);
 }
 
+std::shared_ptr<std::vector<std::string> const>
+cmStateSnapshot::GetDefinitionList(std::string const& name) const
+{
+  assert(this->Position->Vars.IsValid());
+  return cmDefinitions::GetList(name, this->Position->Vars,
+                                this->Position->Root);
+}
+
 bool cmStateSnapshot::IsInitialized(std::string const& name) const
 {
   return cmDefinitions::HasKey(name, this->Position->Vars,
@@ -223,6 +231,13 @@ void cmStateSnapshot::SetDefinition(std::string const& name,
   this->Position->Vars->Set(name, value);
 }
 
+cmValue cmStateSnapshot::AppendDefinition(std::string const& name,
+                                          cm::string_view elements)
+{
+  return cmDefinitions::Append(name, elements, this->Position->Vars,
+                               this->Position->Root);
+}
+
 void cmStateSnapshot::RemoveDefinition(std::string const& name)
 {
   this->Position->Vars->Unset(name);
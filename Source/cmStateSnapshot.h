@@ -5,6 +5,7 @@
 
 #include "cmConfigure.h" // IWYU pragma: keep
 
+#include <memory>
 #include <string>
 #include <vector>
 
@@ -25,8 +26,11 @@ public:
   cmStateSnapshot(cmState* state, cmStateDetail::PositionType position);
 
   cmValue GetDefinition(std::string const& name) const;
+  std::shared_ptr<std::vector<std::string> const> GetDefinitionList(
+    std::string const& name) const;
   bool IsInitialized(std::string const& name) const;
   void SetDefinition(std::string const& name, cm::string_view value);
+  cmValue AppendDefinition(std::string const& name, cm::string_view elements);
   void RemoveDefinition(std::string const& name);
   std::vector<std::string> ClosureKeys() const;
   bool RaiseScope(std::string const& var, const char* varDef);
@@ -6,7 +6,7 @@
 #include <utility>
 #include <vector>
 
-#include "cmsys/RegularExpression.hxx"
+#include "cmRegexCache.h"
 
 class cmMakefile;
 
@@ -18,7 +18,7 @@ public:
 
   bool IsRegularExpressionValid() const
   {
-    return this->RegularExpression.is_valid();
+    return this->RegularExpression != nullptr;
   }
   bool IsReplaceExpressionValid() const
   {
@@ -57,7 +57,7 @@ private:
 
   std::string ErrorString;
   std::string RegExString;
-  cmsys::RegularExpression RegularExpression;
+  cmRegexCache::Regex RegularExpression;
   bool ValidReplaceExpression = true;
   std::string ReplaceExpression;
   std::vector<RegexReplacement> Replacements;
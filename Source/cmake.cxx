@@ -38,10 +38,12 @@
 #include "cmDuration.h"
 #include "cmExternalMakefileProjectGenerator.h"
 #include "cmFileTimeCache.h"
+#include "cmGeneratorExpression.h"
 #include "cmGeneratorTarget.h"
 #include "cmGlobalGenerator.h"
 #include "cmGlobalGeneratorFactory.h"
 #include "cmLinkLineComputer.h"
+#include "cmListFileCache.h"
 #include "cmLocalGenerator.h"
 #include "cmMakefile.h"
 #if !defined(CMAKE_BOOTSTRAP)
@@ -645,9 +647,20 @@ void cmake::ReadListFile(const std::vector<std::string>& args,
 
       mf.SetArgcArgv(args);
     }
+    // Scripts may share a parsed list files cache between runs
+    std::string listFileCache;
+    bool const useListFileCache = this->GetWorkingMode() == SCRIPT_MODE &&
+      cmSystemTools::GetEnv("CMAKE_LISTFILE_CACHE", listFileCache) &&
+      !listFileCache.empty();
+    if (useListFileCache) {
+      cmListFileCache::Load(listFileCache);
+    }
     if (!mf.ReadListFile(path)) {
       cmSystemTools::Error("Error processing file: " + path);
     }
+    if (useListFileCache) {
+      cmListFileCache::Save(listFileCache);
+    }
   }
 }
 
@@ -2119,6 +2132,16 @@ int cmake::ActualConfigure()
   this->FileAPI->ReadQueries();
 #endif
 
+  // List files which did not change since a previous run may be loaded
+  // from a parsed list files cache instead of being parsed again.
+  std::string listFileCache;
+  bool const useListFileCache = !this->GetIsInTryCompile() &&
+    cmSystemTools::GetEnv("CMAKE_LISTFILE_CACHE", listFileCache) &&
+    !listFileCache.empty();
+  if (useListFileCache) {
+    cmListFileCache::Load(listFileCache);
+  }
+
   // actually do the configure
   this->GlobalGenerator->Configure();
   // Before saving the cache
@@ -2158,6 +2181,12 @@ int cmake::ActualConfigure()
 
   this->State->SaveVerificationScript(this->GetHomeOutputDirectory());
   this->SaveCache(this->GetHomeOutputDirectory());
+  if (useListFileCache) {
+    cmListFileCache::Save(listFileCache);
+  }
+  if (!this->GetIsInTryCompile()) {
+    cmListFileCache::Clear();
+  }
   if (cmSystemTools::GetErrorOccuredFlag()) {
     return -1;
   }
@@ -2386,6 +2415,7 @@ int cmake::Generate()
     return -1;
   }
   if (!this->GlobalGenerator->Compute()) {
+    cmGeneratorExpression::ClearParseCache();
     return -1;
   }
   this->GlobalGenerator->Generate();
@@ -2397,6 +2427,7 @@ int cmake::Generate()
     this->RunCheckForUnusedVariables();
   }
   if (cmSystemTools::GetErrorOccuredFlag()) {
+    cmGeneratorExpression::ClearParseCache();
     return -1;
   }
   // Save the cache again after a successful Generate so that any internal
@@ -2408,6 +2439,10 @@ int cmake::Generate()
   this->FileAPI->WriteReplies();
 #endif
 
+  // Do not keep the parsed generator expressions in long-lived processes
+  // such as cmake-gui once the generate step is done.
+  cmGeneratorExpression::ClearParseCache();
+
   return 0;
 }
 
@@ -0,0 +1,200 @@
+/* Distributed under the OSI-approved BSD 3-Clause License.  See accompanying
+   file Copyright.txt or https://cmake.org/licensing for details.  */
+
+// Measures the time spent by the script interpreter on command patterns
+// common in large projects.  Each scenario runs a script in process, so
+// that neither process startup nor the loading of modules is measured.
+//
+// Usage: benchScriptCommands [iterations] [scenario...]
+
+#include <chrono>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <string>
+
+#include <cm/memory>
+#include <cm/string_view>
+
+#include "cmsys/FStream.hxx"
+
+#include "cmGlobalGenerator.h"
+#include "cmMakefile.h"
+#include "cmState.h"
+#include "cmStateDirectory.h"
+#include "cmStateSnapshot.h"
+#include "cmStringAlgorithms.h"
+#include "cmSystemTools.h"
+#include "cmake.h"
+
+namespace {
+
+struct Scenario
+{
+  cm::string_view Name;
+  // Commands run once, before the measured loop.
+  cm::string_view Setup;
+  // Commands run at each iteration, ${i} holding the iteration number.
+  cm::string_view Body;
+};
+
+Scenario const Scenarios[] = {
+  { "macro",
+    "macro(helper_append out name kind)\n"
+    "  set(_helper_value \"${name}_${kind}\")\n"
+    "  if(NOT \"${ARGN}\" STREQUAL \"\")\n"
+    "    string(APPEND _helper_value \"_${ARGV3}\")\n"
+    "  endif()\n"
+    "  list(APPEND ${out} \"${_helper_value}\")\n"
+    "  math(EXPR _helper_count \"${ARGC} + 1\")\n"
+    "endmacro()\n",
+    "  helper_append(result item_${i} static extra)\n" },
+  { "macro-inlined", "",
+    "  set(_helper_value \"item_${i}_static\")\n"
+    "  if(NOT \"extra\" STREQUAL \"\")\n"
+    "    string(APPEND _helper_value \"_extra\")\n"
+    "  endif()\n"
+    "  list(APPEND result \"${_helper_value}\")\n"
+    "  math(EXPR _helper_count \"4 + 1\")\n" },
+  { "macro-many-arguments",
+    "macro(helper_paths a b c d e f g h)\n"
+    "  set(_path \"${a}/${b}/${c}/${d}/${e}/${f}/${g}/${h}/${ARGN}\")\n"
+    "  set(_args \"${ARGC}: ${ARGV} ${ARGV8} ${ARGV9}\")\n"
+    "  if(FALSE)\n"
+    "    message(\"${h}${g}${f}${e}${d}${c}${b}${a} are not used here\")\n"
+    "  endif()\n"
+    "endmacro()\n",
+    "  helper_paths(a${i} b c d e f g h i j)\n" },
+  { "conditions",
+    "set(version 1.2.3)\n"
+    "set(name item_42)\n",
+    "  if(NOT DEFINED undefined_var AND (i GREATER 10 OR i STREQUAL \"5\"))\n"
+    "  endif()\n"
+    "  if(name MATCHES \"^item_([0-9]+)$\" AND "
+    "version VERSION_GREATER_EQUAL 1.2)\n"
+    "  elseif(COMMAND helper OR version VERSION_LESS \"1.0\")\n"
+    "  endif()\n" },
+  { "commands",
+    "function(helper_noop)\n"
+    "endfunction()\n",
+    "  set(_value ${i})\n"
+    "  math(EXPR _next \"${i} + 1\")\n"
+    "  list(LENGTH result _length)\n"
+    "  helper_noop()\n" },
+  { "nested-variables",
+    "set(global_a a)\n"
+    "set(global_b b)\n"
+    "function(helper_level4)\n"
+    "  foreach(_j RANGE 4)\n"
+    "    set(_value \"${global_a}${global_b}${CMAKE_CURRENT_SOURCE_DIR}\")\n"
+    "    if(DEFINED undefined_var)\n"
+    "    endif()\n"
+    "  endforeach()\n"
+    "endfunction()\n"
+    "function(helper_level3)\n"
+    "  helper_level4()\n"
+    "endfunction()\n"
+    "function(helper_level2)\n"
+    "  helper_level3()\n"
+    "endfunction()\n"
+    "function(helper_level1)\n"
+    "  helper_level2()\n"
+    "endfunction()\n",
+    "  helper_level1()\n" },
+  { "list-append", "",
+    "  list(APPEND items item_${i})\n"
+    "  list(LENGTH items _length)\n" },
+  { "list-get",
+    "foreach(_j RANGE 10000)\n"
+    "  list(APPEND items item_${_j})\n"
+    "endforeach()\n",
+    "  list(GET items 5000 _item)\n"
+    "  list(FIND items item_${i} _index)\n" },
+  { "regex",
+    "set(header \"#define PROJECT_VERSION_MAJOR 3\")\n"
+    "set(items item_1 other_2)\n",
+    "  string(REGEX MATCH \"[0-9]+\" _major \"${header}\")\n"
+    "  string(REGEX REPLACE \"^#define ([A-Z_]+) .*$\" \"\\\\1\" _name "
+    "\"${header}\")\n"
+    "  list(FILTER items INCLUDE REGEX \"^item_\")\n" },
+};
+
+bool runScenario(Scenario const& scenario, unsigned long iterations)
+{
+  std::string const script = cmStrCat("benchScriptCommands-", scenario.Name,
+                                      ".cmake");
+  {
+    cmsys::ofstream fout(script.c_str());
+    fout << scenario.Setup << "set(result)\n"
+         << "foreach(i RANGE 1 " << iterations << ")\n"
+         << scenario.Body << "  if(i MATCHES \"000$\")\n"
+         << "    set(result)\n"
+         << "  endif()\n"
+         << "endforeach()\n";
+  }
+
+  // The fastest of a few runs is reported, to filter out system noise.
+  double ms = 0;
+  for (int run = 0; run < 3; ++run) {
+    cmake cm(cmake::RoleScript, cmState::Script);
+    std::string const cwd = cmSystemTools::GetCurrentWorkingDirectory();
+    cm.SetHomeDirectory(cwd);
+    cm.SetHomeOutputDirectory(cwd);
+    cmGlobalGenerator gg(&cm);
+    cmStateSnapshot snapshot = cm.GetCurrentSnapshot();
+    snapshot.GetDirectory().SetCurrentBinary(cwd);
+    snapshot.GetDirectory().SetCurrentSource(cwd);
+    snapshot.SetDefaultDefinitions();
+    auto mf = cm::make_unique<cmMakefile>(&gg, snapshot);
+
+    auto const start = std::chrono::steady_clock::now();
+    bool const result = mf->ReadListFile(script);
+    auto const stop = std::chrono::steady_clock::now();
+    if (!result || cmSystemTools::GetErrorOccuredFlag()) {
+      std::cerr << "Scenario " << scenario.Name << " failed" << std::endl;
+      cmSystemTools::RemoveFile(script);
+      return false;
+    }
+
+    double const runMs =
+      std::chrono::duration<double, std::milli>(stop - start).count();
+    if (run == 0 || runMs < ms) {
+      ms = runMs;
+    }
+  }
+  cmSystemTools::RemoveFile(script);
+
+  std::cout << std::left << std::setw(24) << scenario.Name << std::right
+            << std::setw(10) << iterations << " iterations "
+            << std::setw(10) << std::fixed << std::setprecision(1) << ms
+            << " ms " << std::setw(8) << std::setprecision(2)
+            << ms * 1000.0 / static_cast<double>(iterations)
+            << " us/iteration" << std::endl;
+  return true;
+}
+
+} // anonymous namespace
+
+int main(int argc, char* argv[])
+{
+  unsigned long iterations = 100000;
+  if (argc > 1) {
+    iterations = std::strtoul(argv[1], nullptr, 10);
+    if (iterations == 0) {
+      std::cerr << "Invalid number of iterations: " << argv[1] << std::endl;
+      return 1;
+    }
+  }
+
+  bool success = true;
+  for (Scenario const& scenario : Scenarios) {
+    bool selected = argc <= 2;
+    for (int i = 2; i < argc; ++i) {
+      selected = selected || scenario.Name == argv[i];
+    }
+    if (selected) {
+      success = runScenario(scenario, iterations) && success;
+    }
+  }
+  return success ? 0 : 1;
+}
@@ -0,0 +1,631 @@
+/*
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU Lesser General Public License as published by
+the Free Software Foundation, either version 3.0 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU Lesser General Public License for more details.
+
+You should have received a copy of the GNU Lesser General Public License
+along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#include <atomic>
+#include <cctype>
+#include <chrono>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <new>
+#include <ostream>
+#include <sstream>
+#include <streambuf>
+#include <string>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#ifdef _WIN32
+#  include <windows.h>
+#  include <psapi.h>
+#else
+#  include <fcntl.h>
+#  include <spawn.h>
+#  include <sys/resource.h>
+#  include <sys/wait.h>
+#  include <unistd.h>
+extern char** environ;
+#endif
+
+#include "AS7ToolchainTranslator.h"
+#include "AS7XmlWriter.h"
+
+// Usage : benchAS7Generator [gtest options] [--targets=N] [--sources=N] [--flags=N] [--density=N] [--output=file.json]
+// Each benchmark records its wall time, its allocations and the peak RSS of the process in the output JSON file.
+// Peak memory usage is a process-wide high-water mark : run each benchmark on its own
+// (e.g. --gtest_filter=AS7GeneratorBenchmarks.xml_*) to get comparable peak RSS values.
+
+// Allocations are counted by replacing the global allocation functions. GCC flags the malloc / free pairs once they
+// are inlined in standard containers code.
+#if defined(__GNUC__) && !defined(__clang__) && __GNUC__ >= 11
+#  pragma GCC diagnostic ignored "-Wmismatched-new-delete"
+#endif
+
+/* Allocations counters, shared by the whole executable */
+static std::atomic<std::size_t> allocation_count{ 0 };
+static std::atomic<std::size_t> allocated_bytes{ 0 };
+
+void* operator new(std::size_t size)
+{
+  allocation_count++;
+  allocated_bytes += size;
+  void* memory = std::malloc(size == 0 ? 1 : size);
+  if (memory == nullptr) {
+    throw std::bad_alloc();
+  }
+  return memory;
+}
+
+void* operator new[](std::size_t size)
+{
+  return operator new(size);
+}
+
+void operator delete(void* memory) noexcept
+{
+  std::free(memory);
+}
+
+void operator delete[](void* memory) noexcept
+{
+  std::free(memory);
+}
+
+void operator delete(void* memory, std::size_t) noexcept
+{
+  std::free(memory);
+}
+
+void operator delete[](void* memory, std::size_t) noexcept
+{
+  std::free(memory);
+}
+
+namespace AtmelStudioToolsBenchmarks {
+
+namespace fs = std::filesystem;
+
+/**
+ * @brief Shape of the synthesized projects, may be overridden from the command line
+ */
+struct Parameters
+{
+  std::size_t targets = 400;                     /**< Number of static libraries (plus one executable)           */
+  std::size_t sources = 20;                      /**< Number of C sources per target                             */
+  std::size_t flags = 40;                        /**< Number of compiler flags per build configuration           */
+  std::size_t density = 4;                       /**< Each library links to this many libraries declared before  */
+  std::string output = "as7_benchmark.json";     /**< Results file                                               */
+};
+
+/**
+ * @brief Measures of a benchmarked phase
+ */
+struct Measure
+{
+  long long time_us = 0;          /**< Wall time                                               */
+  long long allocations = 0;      /**< Number of allocations, -1 when they cannot be counted    */
+  long long allocated_bytes = 0;  /**< Allocated bytes, -1 when they cannot be counted          */
+  long long peak_rss_kb = 0;      /**< Peak resident set size of the process running the phase  */
+};
+
+static Parameters parameters;
+static std::map<std::string, Measure> measures; /**< Measures of each phase, written to the output file */
+
+static const std::vector<std::string> configurations = { "Debug", "Release", "MinSizeRel", "RelWithDebInfo" };
+
+/**
+ * @brief Output stream buffer which only counts written bytes, so that the rendered projects
+ * do not weigh in the measured memory usage.
+ */
+class counting_buffer : public std::streambuf
+{
+public:
+  std::size_t count = 0;
+
+protected:
+  int_type overflow(int_type c) override
+  {
+    count++;
+    return traits_type::not_eof(c);
+  }
+
+  std::streamsize xsputn(const char*, std::streamsize n) override
+  {
+    count += static_cast<std::size_t>(n);
+    return n;
+  }
+};
+
+/**
+ * @brief returns the peak resident set size of the process, in kilobytes
+ */
+static std::size_t peak_rss_kb()
+{
+#ifdef _WIN32
+  PROCESS_MEMORY_COUNTERS counters;
+  GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters));
+  return counters.PeakWorkingSetSize / 1024;
+#else
+  struct rusage usage;
+  getrusage(RUSAGE_SELF, &usage);
+#  ifdef __APPLE__
+  return static_cast<std::size_t>(usage.ru_maxrss) / 1024;
+#  else
+  return static_cast<std::size_t>(usage.ru_maxrss);
+#  endif
+#endif
+}
+
+/**
+ * @brief Measures an in-process phase
+ */
+class phase_probe
+{
+public:
+  phase_probe()
+    : start(std::chrono::steady_clock::now())
+    , start_allocations(allocation_count)
+    , start_bytes(allocated_bytes)
+  {
+  }
+
+  Measure stop() const
+  {
+    Measure measure;
+    measure.time_us =
+      std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start).count();
+    measure.allocations = static_cast<long long>(allocation_count - start_allocations);
+    measure.allocated_bytes = static_cast<long long>(allocated_bytes - start_bytes);
+    measure.peak_rss_kb = static_cast<long long>(peak_rss_kb());
+    return measure;
+  }
+
+private:
+  std::chrono::steady_clock::time_point start;
+  std::size_t start_allocations;
+  std::size_t start_bytes;
+};
+
+static void report(const std::string& name, const Measure& measure)
+{
+  std::cout << name << " (" << parameters.targets << " targets, " << parameters.sources << " sources, "
+            << parameters.flags << " flags, " << parameters.density << " dependencies) : " << measure.time_us
+            << " us, " << measure.allocations << " allocations (" << measure.allocated_bytes << " bytes), peak RSS "
+            << measure.peak_rss_kb << " kB" << std::endl;
+  ::testing::Test::RecordProperty("time_us", std::to_string(measure.time_us));
+  ::testing::Test::RecordProperty("allocations", std::to_string(measure.allocations));
+  ::testing::Test::RecordProperty("peak_rss_kb", std::to_string(measure.peak_rss_kb));
+  measures[name] = measure;
+}
+
+static std::string target_name(const std::size_t target)
+{
+  return "lib_" + std::to_string(target);
+}
+
+/**
+ * @brief Builds the compiler flags of a build configuration : all targets share most of them, the last one
+ * is specific to each target so that every target gets its own compiler model.
+ */
+static std::vector<std::string> build_flags(const std::size_t target, const std::size_t config)
+{
+  std::vector<std::string> flags = { "-mmcu=atmega328p" };
+  for (std::size_t i = 0; flags.size() + 1 < parameters.flags; i++) {
+    const std::string id = std::to_string(i);
+    switch (i % 5) {
+      case 0:
+        flags.push_back("-DDEFINITION_" + id + "=" + std::to_string(config));
+        break;
+      case 1:
+        flags.push_back("-Wl,--defsym=symbol_" + id + "=0");
+        break;
+      case 2:
+        flags.push_back("-fgeneric-flag-" + id);
+        break;
+      case 3:
+        flags.push_back("-Wwarning-" + id);
+        break;
+      default:
+        flags.push_back("-I/project/include_" + id);
+        break;
+    }
+  }
+  flags.push_back("-DTARGET_ID=" + std::to_string(target));
+  return flags;
+}
+
+static std::vector<std::size_t> build_dependencies(const std::size_t target)
+{
+  std::vector<std::size_t> out;
+  for (std::size_t dep = (target > parameters.density) ? target - parameters.density : 0; dep < target; dep++) {
+    out.push_back(dep);
+  }
+  return out;
+}
+
+static std::string source_path(const std::size_t target, const std::size_t source)
+{
+  return target_name(target) + "\\source_" + std::to_string(source) + ".c";
+}
+
+// Flags parsing path of the generator : flags of each configuration are parsed by the compiler model, then translated
+// into the toolchain representation
+TEST(AS7GeneratorBenchmarks, flags_parsing)
+{
+  std::vector<std::vector<std::string>> flags;
+  for (std::size_t target = 0; target < parameters.targets; target++) {
+    for (std::size_t config = 0; config < configurations.size(); config++) {
+      flags.push_back(build_flags(target, config));
+    }
+  }
+
+  std::size_t parsed = 0;
+  const phase_probe probe;
+  for (const auto& config_flags : flags) {
+    AvrToolchain::AS7ToolchainTranslator translator;
+    translator.parse(config_flags, "C");
+    parsed += translator.get_compiler("C") != nullptr ? 1 : 0;
+  }
+  const Measure measure = probe.stop();
+
+  ASSERT_EQ(parsed, flags.size());
+  report("flags_parsing", measure);
+}
+
+// Xml serialization of the project files, from already translated toolchains
+TEST(AS7GeneratorBenchmarks, xml_serialization)
+{
+  counting_buffer buffer;
+  std::ostream output(&buffer);
+
+  // Toolchains translation is part of the flags parsing benchmark, only the xml writing is accounted for here
+  Measure measure;
+  for (std::size_t target = 0; target < parameters.targets; target++) {
+    std::vector<AvrToolchain::AS7ToolchainTranslator> translators(configurations.size());
+    for (std::size_t config = 0; config < configurations.size(); config++) {
+      translators[config].parse(build_flags(target, config), "C");
+    }
+
+    const phase_probe probe;
+    {
+      AS7XmlWriter writer(output);
+      writer.write_bom();
+      writer.write_declaration();
+      writer.start_element("Project");
+      writer.attribute("DefaultTargets", "Build");
+      for (std::size_t config = 0; config < configurations.size(); config++) {
+        writer.start_element("PropertyGroup");
+        writer.attribute("Condition", " '$(Configuration)' == '" + configurations[config] + "' ");
+        writer.start_element("ToolchainSettings");
+        translators[config].generate_xml(writer);
+        writer.end_element();
+        writer.end_element();
+    }
+    writer.start_element("ItemGroup");
+    for (std::size_t source = 0; source < parameters.sources; source++) {
+      writer.start_element("Compile");
+      writer.attribute("Include", source_path(target, source));
+      writer.element("SubType", "compile");
+      writer.end_element();
+    }
+    writer.end_element();
+    writer.start_element("ItemGroup");
+    for (std::size_t dep : build_dependencies(target)) {
+      writer.start_element("ProjectReference");
+      writer.attribute("Include", target_name(dep) + ".cproj");
+      writer.element("Name", target_name(dep));
+      writer.end_element();
+    }
+    writer.end_element();
+    writer.end_element();
+    }
+    const Measure project = probe.stop();
+    measure.time_us += project.time_us;
+    measure.allocations += project.allocations;
+    measure.allocated_bytes += project.allocated_bytes;
+    measure.peak_rss_kb = project.peak_rss_kb;
+  }
+
+  ASSERT_GT(buffer.count, parameters.targets * parameters.sources);
+  report("xml_serialization", measure);
+}
+
+static void write_file(const fs::path& path, const std::string& content)
+{
+  std::ofstream file(path, std::ios::binary);
+  file << content;
+}
+
+static std::string read_file(const fs::path& path)
+{
+  std::ifstream file(path, std::ios::binary);
+  std::stringstream content;
+  content << file.rdbuf();
+  return content.str();
+}
+
+static std::string join(const std::vector<std::string>& flags)
+{
+  std::string out;
+  for (const std::string& flag : flags) {
+    out += (out.empty() ? "" : " ") + flag;
+  }
+  return out;
+}
+
+/**
+ * @brief Writes a project made of one directory per static library and an executable linking to the last library.
+ * The compiler is forced (it is never run by the generator) so that no avr toolchain is required.
+ */
+static void write_project(const fs::path& source_dir)
+{
+  fs::create_directories(source_dir);
+
+  std::ostringstream toolchain;
+  toolchain << "set(CMAKE_SYSTEM_NAME Generic)\n"
+            << "set(CMAKE_SYSTEM_PROCESSOR avr)\n"
+            << "set(CMAKE_C_COMPILER \"" << fs::path(CMAKE_COMMAND_PATH).generic_string() << "\")\n"
+            << "set(CMAKE_C_COMPILER_ID GNU)\n"
+            << "set(CMAKE_C_COMPILER_ID_RUN TRUE)\n"
+            << "set(CMAKE_C_COMPILER_FORCED TRUE)\n";
+  write_file(source_dir / "toolchain.cmake", toolchain.str());
+
+  std::ostringstream cmakelists;
+  cmakelists << "cmake_minimum_required(VERSION 3.15)\n"
+             << "project(as7_benchmark C)\n\n";
+  for (std::size_t target = 0; target < parameters.targets; target++) {
+    const std::string name = target_name(target);
+    const fs::path target_dir = source_dir / name;
+    fs::create_directories(target_dir);
+
+    std::ostringstream target_cmakelists;
+    for (std::size_t config = 0; config < configurations.size(); config++) {
+      std::string upper_config = configurations[config];
+      for (char& c : upper_config) {
+        c = static_cast<char>(std::toupper(static_cast<unsigned char>(c)));
+      }
+      target_cmakelists << "set(CMAKE_C_FLAGS_" << upper_config << " \"" << join(build_flags(target, config)) << "\")\n";
+    }
+    target_cmakelists << "add_library(" << name << " STATIC";
+    for (std::size_t source = 0; source < parameters.sources; source++) {
+      const std::string source_name = "source_" + std::to_string(source) + ".c";
+      write_file(target_dir / source_name, "int " + name + "_" + std::to_string(source) + "(void) { return 0; }\n");
+      target_cmakelists << " " << source_name;
+    }
+    target_cmakelists << ")\n";
+    const std::vector<std::size_t> dependencies = build_dependencies(target);
+    if (!dependencies.empty()) {
+      target_cmakelists << "target_link_libraries(" << name << " PUBLIC";
+      for (std::size_t dep : dependencies) {
+        target_cmakelists << " " << target_name(dep);
+      }
+      target_cmakelists << ")\n";
+    }
+    write_file(target_dir / "CMakeLists.txt", target_cmakelists.str());
+    cmakelists << "add_subdirectory(" << name << ")\n";
+  }
+  write_file(source_dir / "main.c", "int main(void) { return 0; }\n");
+  cmakelists << "add_executable(firmware main.c)\n";
+  if (parameters.targets != 0) {
+    cmakelists << "target_link_libraries(firmware PRIVATE " << target_name(parameters.targets - 1) << ")\n";
+  }
+  write_file(source_dir / "CMakeLists.txt", cmakelists.str());
+}
+
+/**
+ * @brief Sums the generation time reported by each local generator in cmake debug output
+ * ("   Generation time <directory> : <time> us")
+ */
+static long long parse_generation_time(const std::string& log)
+{
+  long long out = 0;
+  std::istringstream lines(log);
+  std::string line;
+  while (std::getline(lines, line)) {
+    if (line.rfind("   Generation time ", 0) != 0) {
+      continue;
+    }
+    const std::size_t separator = line.rfind(" : ");
+    if (separator != std::string::npos) {
+      out += std::atoll(line.c_str() + separator + 3);
+    }
+  }
+  return out;
+}
+
+/**
+ * @brief Runs a command, its outputs are redirected to a log file
+ * @param arguments : command and its arguments
+ * @param log_file  : log file path
+ * @param measure   : wall time and peak RSS of the child process
+ * @return exit code of the command
+ */
+static int run_process(const std::vector<std::string>& arguments, const fs::path& log_file, Measure& measure)
+{
+  int exit_code = 1;
+  const auto start = std::chrono::steady_clock::now();
+#ifdef _WIN32
+  std::string command;
+  for (const std::string& argument : arguments) {
+    command += (command.empty() ? "\"" : " \"") + argument + "\"";
+  }
+
+  SECURITY_ATTRIBUTES attributes = { sizeof(SECURITY_ATTRIBUTES), nullptr, TRUE };
+  HANDLE log = CreateFileA(log_file.string().c_str(), GENERIC_WRITE, FILE_SHARE_READ, &attributes, CREATE_ALWAYS,
+                           FILE_ATTRIBUTE_NORMAL, nullptr);
+  STARTUPINFOA startup_info = {};
+  startup_info.cb = sizeof(startup_info);
+  startup_info.dwFlags = STARTF_USESTDHANDLES;
+  startup_info.hStdOutput = log;
+  startup_info.hStdError = log;
+  PROCESS_INFORMATION process = {};
+
+  if (CreateProcessA(nullptr, &command[0], nullptr, nullptr, TRUE, 0, nullptr, nullptr, &startup_info, &process)) {
+    WaitForSingleObject(process.hProcess, INFINITE);
+    DWORD process_exit_code = 1;
+    GetExitCodeProcess(process.hProcess, &process_exit_code);
+    exit_code = static_cast<int>(process_exit_code);
+
+    // Counters of the child process remain available as long as its handle is opened
+    PROCESS_MEMORY_COUNTERS counters;
+    if (GetProcessMemoryInfo(process.hProcess, &counters, sizeof(counters))) {
+      measure.peak_rss_kb = static_cast<long long>(counters.PeakWorkingSetSize / 1024);
+    }
+    CloseHandle(process.hThread);
+    CloseHandle(process.hProcess);
+  }
+  CloseHandle(log);
+#else
+  std::vector<char*> argv;
+  for (const std::string& argument : arguments) {
+    argv.push_back(const_cast<char*>(argument.c_str()));
+  }
+  argv.push_back(nullptr);
+
+  posix_spawn_file_actions_t actions;
+  posix_spawn_file_actions_init(&actions);
+  posix_spawn_file_actions_addopen(&actions, STDOUT_FILENO, log_file.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+  posix_spawn_file_actions_adddup2(&actions, STDOUT_FILENO, STDERR_FILENO);
+
+  pid_t pid;
+  if (posix_spawn(&pid, argv[0], &actions, nullptr, argv.data(), environ) == 0) {
+    int status = 0;
+    struct rusage usage;
+    if (wait4(pid, &status, 0, &usage) == pid && WIFEXITED(status)) {
+      exit_code = WEXITSTATUS(status);
+    }
+#  ifdef __APPLE__
+    measure.peak_rss_kb = static_cast<long long>(usage.ru_maxrss) / 1024;
+#  else
+    measure.peak_rss_kb = static_cast<long long>(usage.ru_maxrss);
+#  endif
+  }
+  posix_spawn_file_actions_destroy(&actions);
+#endif
+  measure.time_us =
+    std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start).count();
+  return exit_code;
+}
+
+// Whole cmake run (configure and generate) with the Atmel Studio 7 generator, in a child process.
+// Allocations of the child process cannot be counted from here, the time spent in cmLocalAtmelStudio7Generator::Generate
+// is read from cmake debug output.
+TEST(AS7GeneratorBenchmarks, generator)
+{
+#ifndef _WIN32
+  GTEST_SKIP() << "Atmel Studio 7 generator is only available on Windows";
+#endif
+  const fs::path root = fs::temp_directory_path() / "as7_benchmark";
+  const fs::path source_dir = root / "src";
+  const fs::path binary_dir = root / "build";
+  fs::remove_all(root);
+  write_project(source_dir);
+  fs::create_directories(binary_dir);
+
+  const std::vector<std::string> command = {
+    CMAKE_COMMAND_PATH, "--debug-output", "-G", "Atmel Studio 7.0", "-S", source_dir.string(), "-B", binary_dir.string(),
+    "-DCMAKE_TOOLCHAIN_FILE=" + (source_dir / "toolchain.cmake").string()
+  };
+  const fs::path log_file = root / "generation.log";
+
+  Measure cmake_run;
+  cmake_run.allocations = -1;
+  cmake_run.allocated_bytes = -1;
+  ASSERT_EQ(run_process(command, log_file, cmake_run), 0) << read_file(log_file);
+
+  Measure generate = cmake_run;
+  generate.time_us = parse_generation_time(read_file(log_file));
+  ASSERT_GT(generate.time_us, 0);
+
+  report("cmake_run", cmake_run);
+  report("local_generators_generate", generate);
+}
+
+/**
+ * @brief Writes parameters and measures to a JSON file
+ */
+static bool write_results(const std::string& path)
+{
+  std::ofstream file(path, std::ios::trunc);
+  file << "{\n"
+       << "  \"parameters\": {\n"
+       << "    \"targets\": " << parameters.targets << ",\n"
+       << "    \"sources_per_target\": " << parameters.sources << ",\n"
+       << "    \"flags_per_config\": " << parameters.flags << ",\n"
+       << "    \"dependencies_per_target\": " << parameters.density << ",\n"
+       << "    \"configurations\": " << configurations.size() << "\n"
+       << "  },\n"
+       << "  \"results\": {";
+  bool first = true;
+  for (const auto& measure : measures) {
+    file << (first ? "\n" : ",\n") << "    \"" << measure.first << "\": { \"time_us\": " << measure.second.time_us
+         << ", \"allocations\": " << measure.second.allocations
+         << ", \"allocated_bytes\": " << measure.second.allocated_bytes
+         << ", \"peak_rss_kb\": " << measure.second.peak_rss_kb << " }";
+    first = false;
+  }
+  file << "\n  }\n}\n";
+  return static_cast<bool>(file);
+}
+
+/**
+ * @brief Reads "--name=value" options, returns false on unknown options
+ */
+static bool parse_arguments(int argc, char** argv)
+{
+  for (int i = 1; i < argc; i++) {
+    const std::string argument = argv[i];
+    const std::size_t separator = argument.find('=');
+    const std::string name = argument.substr(0, separator);
+    const std::string value = (separator == std::string::npos) ? "" : argument.substr(separator + 1);
+    if (name == "--targets") {
+      parameters.targets = std::strtoul(value.c_str(), nullptr, 10);
+    } else if (name == "--sources") {
+      parameters.sources = std::strtoul(value.c_str(), nullptr, 10);
+    } else if (name == "--flags") {
+      parameters.flags = std::strtoul(value.c_str(), nullptr, 10);
+    } else if (name == "--density") {
+      parameters.density = std::strtoul(value.c_str(), nullptr, 10);
+    } else if (name == "--output" && !value.empty()) {
+      parameters.output = value;
+    } else {
+      std::cerr << "Unknown option : " << argument << std::endl;
+      return false;
+    }
+  }
+  return true;
+}
+
+}
+
+int main(int argc, char** argv)
+{
+  // Google test removes its own options from the command line
+  ::testing::InitGoogleTest(&argc, argv);
+  if (!AtmelStudioToolsBenchmarks::parse_arguments(argc, argv)) {
+    return 1;
+  }
+
+  const int result = RUN_ALL_TESTS();
+  if (!AtmelStudioToolsBenchmarks::write_results(AtmelStudioToolsBenchmarks::parameters.output)) {
+    std::cerr << "Could not write " << AtmelStudioToolsBenchmarks::parameters.output << std::endl;
+    return 1;
+  }
+  std::cout << "Results written to " << AtmelStudioToolsBenchmarks::parameters.output << std::endl;
+  return result;
+}
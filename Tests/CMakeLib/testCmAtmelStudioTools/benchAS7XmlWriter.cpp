@@ -0,0 +1,185 @@
+/*
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU Lesser General Public License as published by
+the Free Software Foundation, either version 3.0 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU Lesser General Public License for more details.
+
+You should have received a copy of the GNU Lesser General Public License
+along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#include <chrono>
+#include <iostream>
+#include <ostream>
+#include <streambuf>
+#include <string>
+
+#include <gtest/gtest.h>
+
+#ifdef _WIN32
+#  include <windows.h>
+#  include <psapi.h>
+#else
+#  include <sys/resource.h>
+#endif
+
+#include "pugixml.hpp"
+
+#include "AS7XmlWriter.h"
+
+// Peak memory usage is a process-wide high-water mark : run each benchmark on its own
+// (e.g. --gtest_filter=AS7XmlWriterBenchmarks.dom_*) to get comparable peak RSS values.
+
+namespace AtmelStudioToolsBenchmarks {
+
+constexpr std::size_t source_count = 20000;
+constexpr std::size_t configuration_count = 4;
+
+/**
+ * @brief Output stream buffer which only counts written bytes, so that the rendered project
+ * does not weigh in the measured memory usage.
+ */
+class counting_buffer : public std::streambuf
+{
+public:
+  std::size_t count = 0;
+
+protected:
+  int_type overflow(int_type c) override
+  {
+    count++;
+    return traits_type::not_eof(c);
+  }
+
+  std::streamsize xsputn(const char*, std::streamsize n) override
+  {
+    count += static_cast<std::size_t>(n);
+    return n;
+  }
+};
+
+/**
+ * @brief returns the peak resident set size of the process, in kilobytes
+ */
+static std::size_t peak_rss_kb()
+{
+#ifdef _WIN32
+  PROCESS_MEMORY_COUNTERS counters;
+  GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters));
+  return counters.PeakWorkingSetSize / 1024;
+#else
+  struct rusage usage;
+  getrusage(RUSAGE_SELF, &usage);
+#  ifdef __APPLE__
+  return static_cast<std::size_t>(usage.ru_maxrss) / 1024;
+#  else
+  return static_cast<std::size_t>(usage.ru_maxrss);
+#  endif
+#endif
+}
+
+static std::string source_path(const std::size_t i)
+{
+  return "src\\module_" + std::to_string(i / 100) + "\\source_" + std::to_string(i) + ".c";
+}
+
+static void report(const std::string& name, std::chrono::steady_clock::duration time, std::size_t rss_before,
+                   std::size_t written)
+{
+  const auto time_us = std::chrono::duration_cast<std::chrono::microseconds>(time).count();
+  const std::size_t peak_rss = peak_rss_kb();
+  std::cout << name << " (" << source_count << " sources, " << written << " bytes) : " << time_us << " us, peak RSS "
+            << peak_rss << " kB (+" << (peak_rss - rss_before) << " kB)" << std::endl;
+  ::testing::Test::RecordProperty("time_us", static_cast<int>(time_us));
+  ::testing::Test::RecordProperty("peak_rss_kb", static_cast<int>(peak_rss));
+}
+
+// Writes the project the way cmAtmelStudio7TargetGenerator used to : the whole document is built with pugixml, then saved
+TEST(AS7XmlWriterBenchmarks, dom_project_generation)
+{
+  const std::size_t rss_before = peak_rss_kb();
+  counting_buffer buffer;
+  std::ostream output(&buffer);
+
+  const auto start = std::chrono::steady_clock::now();
+  {
+    pugi::xml_document doc;
+    pugi::xml_node decl = doc.prepend_child(pugi::node_declaration);
+    decl.append_attribute("version") = "1.0";
+    decl.append_attribute("encoding") = "utf-8";
+    pugi::xml_node project_node = doc.append_child("Project");
+    project_node.append_attribute("DefaultTargets") = "Build";
+    for (std::size_t config = 0; config < configuration_count; config++) {
+      pugi::xml_node group_node = project_node.append_child("PropertyGroup");
+      group_node.append_attribute("Condition") = (" '$(Configuration)' == 'Config" + std::to_string(config) + "' ").c_str();
+      pugi::xml_node list_node = group_node.append_child("avrgcc.compiler.symbols.DefSymbols").append_child("ListValues");
+      for (std::size_t i = 0; i < 50; i++) {
+        list_node.append_child("Value").append_child(pugi::node_pcdata).set_value(("DEFINITION_" + std::to_string(i)).c_str());
+      }
+    }
+    pugi::xml_node item_group = project_node.append_child("ItemGroup");
+    for (std::size_t i = 0; i < source_count; i++) {
+      pugi::xml_node compile_node = item_group.append_child("Compile");
+      compile_node.append_attribute("Include") = source_path(i).c_str();
+      compile_node.append_child("SubType").append_child(pugi::node_pcdata).set_value("compile");
+    }
+    doc.save(output, "  ", (pugi::format_indent | pugi::format_write_bom), pugi::xml_encoding::encoding_utf8);
+  }
+  const auto time = std::chrono::steady_clock::now() - start;
+
+  ASSERT_GT(buffer.count, source_count);
+  report("dom", time, rss_before, buffer.count);
+}
+
+// Writes the same project through AS7XmlWriter, with nothing but the opened element names kept in memory
+TEST(AS7XmlWriterBenchmarks, streaming_project_generation)
+{
+  const std::size_t rss_before = peak_rss_kb();
+  counting_buffer buffer;
+  std::ostream output(&buffer);
+
+  const auto start = std::chrono::steady_clock::now();
+  {
+    AS7XmlWriter writer(output);
+    writer.write_bom();
+    writer.write_declaration();
+    writer.start_element("Project");
+    writer.attribute("DefaultTargets", "Build");
+    for (std::size_t config = 0; config < configuration_count; config++) {
+      writer.start_element("PropertyGroup");
+      writer.attribute("Condition", " '$(Configuration)' == 'Config" + std::to_string(config) + "' ");
+      writer.start_element("avrgcc.compiler.symbols.DefSymbols");
+      writer.start_element("ListValues");
+      for (std::size_t i = 0; i < 50; i++) {
+        writer.element("Value", "DEFINITION_" + std::to_string(i));
+      }
+      writer.end_element();
+      writer.end_element();
+      writer.end_element();
+    }
+    writer.start_element("ItemGroup");
+    for (std::size_t i = 0; i < source_count; i++) {
+      writer.start_element("Compile");
+      writer.attribute("Include", source_path(i));
+      writer.element("SubType", "compile");
+      writer.end_element();
+    }
+  }
+  const auto time = std::chrono::steady_clock::now() - start;
+
+  ASSERT_GT(buffer.count, source_count);
+  report("streaming", time, rss_before, buffer.count);
+}
+
+}
+
+int main(int argc, char** argv)
+{
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
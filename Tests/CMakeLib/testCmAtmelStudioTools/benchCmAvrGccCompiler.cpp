@@ -0,0 +1,107 @@
+/*
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU Lesser General Public License as published by
+the Free Software Foundation, either version 3.0 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU Lesser General Public License for more details.
+
+You should have received a copy of the GNU Lesser General Public License
+along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#include <chrono>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "cmAvrGccCompiler.h"
+#include "cmAvrGccCompilerOption.h"
+
+namespace AtmelStudioToolsBenchmarks {
+
+/**
+ * @brief Builds a synthetic command line made of flag_count flags, mixing all kinds of options
+ * handled by cmAvrGccCompiler. One flag out of ten is a duplicate of an earlier one.
+ */
+static std::vector<std::string> build_command_line(const std::size_t flag_count)
+{
+  std::vector<std::string> flags;
+  flags.reserve(flag_count);
+  for (std::size_t i = 0; flags.size() < flag_count; i++) {
+    const std::string id = std::to_string(i);
+    switch (i % 5) {
+      case 0:
+        flags.push_back("-DDEFINITION_" + id + "=" + id);
+        break;
+      case 1:
+        flags.push_back("-Wl,--defsym=symbol_" + id + "=0,--undefined=undef_" + id);
+        break;
+      case 2:
+        flags.push_back("-fgeneric-flag-" + id);
+        break;
+      case 3:
+        flags.push_back("-Wwarning-" + id);
+        break;
+      default:
+        flags.push_back("-mmachine-" + id);
+        break;
+    }
+
+    if (i % 10 == 9 && flags.size() < flag_count) {
+      flags.push_back(flags[i / 2]);
+    }
+  }
+  return flags;
+}
+
+TEST(AvrGccCompilerBenchmarks, parse_2000_flags)
+{
+  constexpr std::size_t flag_count = 2000;
+  constexpr std::size_t iterations = 20;
+  const std::vector<std::string> flags = build_command_line(flag_count);
+  ASSERT_EQ(flags.size(), flag_count);
+
+  std::chrono::steady_clock::duration parsing_time{};
+  std::chrono::steady_clock::duration lookup_time{};
+  for (std::size_t i = 0; i < iterations; i++) {
+    compiler::cmAvrGccCompiler compiler_abstraction;
+
+    auto start = std::chrono::steady_clock::now();
+    compiler_abstraction.parse_flags(flags);
+    parsing_time += std::chrono::steady_clock::now() - start;
+
+    start = std::chrono::steady_clock::now();
+    std::size_t found = 0;
+    for (const auto& flag : flags) {
+      found += compiler_abstraction.has_option(flag) ? 1 : 0;
+    }
+    lookup_time += std::chrono::steady_clock::now() - start;
+
+    // Every flag is recognized, and concatenated linker options are split in two
+    ASSERT_EQ(found, flag_count);
+    ASSERT_EQ(compiler_abstraction.get_options(compiler::CompilerOption::Type::Linker).size(),
+              2 * compiler_abstraction.get_options(compiler::CompilerOption::Type::Definition).size());
+  }
+
+  using std::chrono::microseconds;
+  const auto parsing_us = std::chrono::duration_cast<microseconds>(parsing_time).count() / iterations;
+  const auto lookup_us = std::chrono::duration_cast<microseconds>(lookup_time).count() / iterations;
+  std::cout << "parse_flags(" << flag_count << " flags) : " << parsing_us << " us/iteration" << std::endl;
+  std::cout << "has_option  (" << flag_count << " flags) : " << lookup_us << " us/iteration" << std::endl;
+  RecordProperty("parse_flags_us", static_cast<int>(parsing_us));
+  RecordProperty("has_option_us", static_cast<int>(lookup_us));
+}
+
+}
+
+int main(int argc, char** argv)
+{
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
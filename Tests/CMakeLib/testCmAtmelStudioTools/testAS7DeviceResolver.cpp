@@ -14,11 +14,14 @@ along with this program.  If not, see <https://www.gnu.org/licenses/>.
 */
 
 #include <algorithm>
+#include <chrono>
 #include <string>
 #include <vector>
 
 #include <gtest/gtest.h>
 #include <filesystem>
+#include <fstream>
+#include "AS7DeviceIndex.h"
 #include "AS7DeviceResolver.h"
 
 namespace AtmelStudioToolsTests
@@ -174,6 +177,35 @@ TEST(DeviceNamingConventionTest, test_definition_collection_resolving)
   ASSERT_EQ(resolved, "ATmega328PB");
 }
 
+TEST(DeviceNamingConventionTest, test_malformed_definitions)
+{
+  const std::vector<std::string> data = {
+    "__AVR__",
+    "__AVR_",
+    "__AVR_ATmega328P",
+    "AVR_ATmega328P__",
+    "__SAM__X",
+    "__AT32UC",
+  };
+
+  for (auto& elem : data) {
+    EXPECT_EQ(AS7DeviceResolver::resolve_from_defines(elem), "") << elem;
+  }
+}
+
+TEST(DeviceNamingConventionTest, test_repeated_resolutions)
+{
+  // Results are cached per device string, repeated calls shall not alter them
+  for (int i = 0; i < 3; i++) {
+    EXPECT_EQ(AS7DeviceResolver::resolve_from_mmcu("-mmcu=atmega328p"), "ATmega328P");
+    EXPECT_EQ(AS7DeviceResolver::resolve_from_mmcu("atmega328p"), "ATmega328P");
+    EXPECT_EQ(AS7DeviceResolver::resolve_core_from_name("ATmega328P"), AS7DeviceResolver::Core::ATmega);
+    EXPECT_EQ(AS7DeviceResolver::resolve_core_from_name("ATtiny85"), AS7DeviceResolver::Core::ATtiny);
+    EXPECT_EQ(AS7DeviceResolver::resolve_device_dfp_name("ATmega328P"), "ATmega_DFP");
+    EXPECT_EQ(AS7DeviceResolver::resolve_device_dfp_name("ATtiny85"), "ATtiny_DFP");
+  }
+}
+
 TEST(DeviceNamingConventionTest, test_DFP_resolution)
 {
   std::vector<std::pair<std::string,std::string>> data = {
@@ -234,6 +266,124 @@ TEST(DeviceNamingConventionTest, test_version_finder)
   ASSERT_EQ(AS7DeviceResolver::get_max_packs_version(base_path.string()), "5.0.0");
 }
 
+TEST(DeviceNamingConventionTest, test_versions_ordering)
+{
+  const std::vector<std::string> data = {
+    "1.2.209",
+    "1.10.0",
+    "1.3.0",
+    "1.2.36",
+    "not.a.version",
+    "1.2",
+    "1.2.3.4",
+  };
+
+  auto base_path = std::filesystem::temp_directory_path() / "AS7DeviceResolverOrderingTests";
+  std::filesystem::remove_all(base_path);
+  for (auto& dir : data) {
+    ASSERT_TRUE(std::filesystem::create_directories(base_path / dir));
+  }
+
+  const std::vector<std::string> expected = { "1.2.36", "1.2.209", "1.3.0", "1.10.0" };
+  EXPECT_EQ(AS7DeviceResolver::get_packs_versions(base_path.string()), expected);
+  EXPECT_EQ(AS7DeviceResolver::get_max_packs_version(base_path.string()), "1.10.0");
+  EXPECT_TRUE(AS7DeviceResolver::get_packs_versions((base_path / "missing").string()).empty());
+
+  AS7DeviceResolver::PackVersion version;
+  ASSERT_TRUE(AS7DeviceResolver::parse_pack_version("1.2.209", version));
+  EXPECT_EQ(version, (AS7DeviceResolver::PackVersion{ 1, 2, 209 }));
+  EXPECT_FALSE(AS7DeviceResolver::parse_pack_version("1..2", version));
+  EXPECT_FALSE(AS7DeviceResolver::parse_pack_version("1.2.", version));
+
+  std::filesystem::remove_all(base_path);
+}
+
+
+/**
+ * @brief Writes a minimal .atdf file, the way DFPs describe their devices
+ */
+static void write_atdf(const std::filesystem::path& path, const std::string& name, const std::string& architecture,
+                       const std::string& family, const std::vector<std::string>& signature)
+{
+  std::filesystem::create_directories(path.parent_path());
+  std::ofstream file(path);
+  file << "<?xml version='1.0' encoding='UTF-8'?>\n"
+       << "<avr-tools-device-file>\n"
+       << "  <variants>\n    <variant ordercode=\"" << name << "-AU\" package=\"TQFP32\"/>\n  </variants>\n"
+       << "  <devices>\n"
+       << "    <device name=\"" << name << "\" architecture=\"" << architecture << "\" family=\"" << family << "\">\n"
+       << "      <property-groups>\n        <property-group name=\"SIGNATURES\">\n";
+  for (std::size_t i = 0; i < signature.size(); i++) {
+    file << "          <property name=\"SIGNATURE" << i << "\" value=\"" << signature[i] << "\"/>\n";
+  }
+  file << "        </property-group>\n      </property-groups>\n    </device>\n  </devices>\n</avr-tools-device-file>\n";
+}
+
+TEST(DeviceIndexTest, test_atdf_parsing)
+{
+  AS7DeviceIndex::Device device;
+  const std::string atdf = "<devices><device name=\"ATtiny3214\" architecture=\"AVR8X\" family=\"tinyAVR\">"
+                           "<property name=\"SIGNATURE0\" value=\"0x1e\"/><property name=\"SIGNATURE1\" value=\"0x95\"/>"
+                           "<property name=\"SIGNATURE2\" value=\"0x2\"/></device></devices>";
+  ASSERT_TRUE(AS7DeviceIndex::parse_atdf(atdf, device));
+  EXPECT_EQ(device.name, "ATtiny3214");
+  EXPECT_EQ(device.key, "attiny3214");
+  EXPECT_EQ(device.architecture, "AVR8X");
+  EXPECT_EQ(device.family, "tinyAVR");
+  EXPECT_EQ(device.signature, "0x1E9502");
+
+  EXPECT_FALSE(AS7DeviceIndex::parse_atdf("<devices></devices>", device));
+}
+
+TEST(DeviceIndexTest, test_packs_indexing)
+{
+  auto base_path = std::filesystem::temp_directory_path() / "AS7DeviceIndexTests";
+  std::filesystem::remove_all(base_path);
+  const auto packs = base_path / "packs";
+  const auto index_file = (base_path / "AS7DeviceIndex.txt").string();
+
+  // Only the highest version of each DFP is indexed
+  write_atdf(packs / "atmel" / "ATmega_DFP" / "1.2.209" / "atdf" / "ATmega328P.atdf", "ATmega328P", "AVR8", "megaAVR", { "0x1e", "0x95", "0x0f" });
+  write_atdf(packs / "atmel" / "ATmega_DFP" / "1.2.209" / "atdf" / "ATmega2560.atdf", "ATmega2560", "AVR8", "megaAVR", { "0x1e", "0x98", "0x01" });
+  write_atdf(packs / "atmel" / "ATmega_DFP" / "1.2.36" / "atdf" / "ATmega48.atdf", "ATmega48", "AVR8", "megaAVR", { "0x1e", "0x92", "0x05" });
+  write_atdf(packs / "atmel" / "ATtiny_DFP" / "1.10.348" / "atdf" / "ATtiny85.atdf", "ATtiny85", "AVR8", "tinyAVR", { "0x1e", "0x93", "0x0b" });
+
+  AS7DeviceIndex index;
+  EXPECT_FALSE(index.load_or_scan(packs.string(), index_file));
+  ASSERT_EQ(index.size(), 3u);
+
+  const AS7DeviceIndex::Device* device = index.find("atmega328p");
+  ASSERT_NE(device, nullptr);
+  EXPECT_EQ(device->name, "ATmega328P");
+  EXPECT_EQ(device->dfp_name, "ATmega_DFP");
+  EXPECT_EQ(device->version, "1.2.209");
+  EXPECT_EQ(device->signature, "0x1E950F");
+  EXPECT_EQ(device->get_include_dir(), "%24(PackRepoDir)\\atmel\\ATmega_DFP\\1.2.209\\include\\");
+  EXPECT_EQ(device->get_gcc_dev_dir(), "%24(PackRepoDir)\\atmel\\ATmega_DFP\\1.2.209\\gcc\\dev\\atmega328p");
+  EXPECT_EQ(index.find("ATmega328P"), device);
+  EXPECT_EQ(index.find("ATmega48"), nullptr);
+  EXPECT_EQ(index.find("atmega328"), nullptr);
+  EXPECT_EQ(index.find("ATtiny85")->dfp_name, "ATtiny_DFP");
+
+  // Index file is reused as long as the packs folder does not change
+  AS7DeviceIndex reloaded;
+  EXPECT_TRUE(reloaded.load_or_scan(packs.string(), index_file));
+  ASSERT_EQ(reloaded.size(), 3u);
+  EXPECT_EQ(reloaded.find("ATtiny85")->signature, "0x1E930B");
+  EXPECT_FALSE(reloaded.load(index_file, "another stamp"));
+
+  // Installing a new DFP version modifies the DFP folder, so the index is rebuilt
+  std::filesystem::create_directories(packs / "atmel" / "ATtiny_DFP" / "1.10.400");
+  const auto tiny_dfp = packs / "atmel" / "ATtiny_DFP";
+  std::filesystem::last_write_time(tiny_dfp, std::filesystem::last_write_time(tiny_dfp) + std::chrono::seconds(10));
+  write_atdf(tiny_dfp / "1.10.400" / "atdf" / "ATtiny85.atdf", "ATtiny85", "AVR8", "tinyAVR", { "0x1e", "0x93", "0x0b" });
+  AS7DeviceIndex rebuilt;
+  EXPECT_FALSE(rebuilt.load_or_scan(packs.string(), index_file));
+  EXPECT_EQ(rebuilt.find("ATtiny85")->version, "1.10.400");
+
+  std::filesystem::remove_all(base_path);
+}
+
 }
 
 int main(int argc, char** argv)
@@ -0,0 +1,274 @@
+/*
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU Lesser General Public License as published by
+the Free Software Foundation, either version 3.0 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU Lesser General Public License for more details.
+
+You should have received a copy of the GNU Lesser General Public License
+along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#include <chrono>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+namespace AtmelStudioToolsTests
+{
+
+namespace fs = std::filesystem;
+
+static const int mesh_targets = 1000; /**< Number of static libraries in the mesh                    */
+static const int mesh_density = 8;    /**< Each library links to this many libraries declared before */
+
+static void write_file(const fs::path& path, const std::string& content)
+{
+  std::ofstream file(path, std::ios::binary);
+  file << content;
+}
+
+static std::string read_file(const fs::path& path)
+{
+  std::ifstream file(path, std::ios::binary);
+  std::stringstream content;
+  content << file.rdbuf();
+  return content.str();
+}
+
+/**
+ * @brief Writes a project made of static libraries, each of them linking to the mesh_density previous ones,
+ * and an executable linking to the last library.
+ * The compiler is forced (it is never run by the generator) so that no avr toolchain is required.
+ * @param source_dir  : directory the project is written to
+ * @param targets     : number of static libraries
+ */
+static void write_mesh_project(const fs::path& source_dir, const int targets = mesh_targets)
+{
+  fs::create_directories(source_dir);
+
+  std::ostringstream toolchain;
+  toolchain << "set(CMAKE_SYSTEM_NAME Generic)\n"
+            << "set(CMAKE_SYSTEM_PROCESSOR avr)\n"
+            << "set(CMAKE_C_COMPILER \"" << fs::path(CMAKE_COMMAND_PATH).generic_string() << "\")\n"
+            << "set(CMAKE_C_COMPILER_ID GNU)\n"
+            << "set(CMAKE_C_COMPILER_ID_RUN TRUE)\n"
+            << "set(CMAKE_C_COMPILER_FORCED TRUE)\n"
+            << "set(CMAKE_C_FLAGS \"-mmcu=atmega328p -Wall -Wextra\")\n";
+  write_file(source_dir / "toolchain.cmake", toolchain.str());
+
+  std::ostringstream cmakelists;
+  cmakelists << "cmake_minimum_required(VERSION 3.15)\n"
+             << "project(as7_mesh C)\n\n";
+  for (int i = 0; i < targets; i++) {
+    const std::string name = "lib_" + std::to_string(i);
+    write_file(source_dir / (name + ".c"), "int " + name + "(void) { return " + std::to_string(i) + "; }\n");
+    cmakelists << "add_library(" << name << " STATIC " << name << ".c)\n";
+    if (i > 0) {
+      cmakelists << "target_link_libraries(" << name << " PUBLIC";
+      for (int dep = (i > mesh_density) ? i - mesh_density : 0; dep < i; dep++) {
+        cmakelists << " lib_" << dep;
+      }
+      cmakelists << ")\n";
+    }
+  }
+  write_file(source_dir / "main.c", "int main(void) { return 0; }\n");
+  cmakelists << "add_executable(mesh main.c)\n"
+             << "target_link_libraries(mesh PRIVATE lib_" << (targets - 1) << ")\n";
+  write_file(source_dir / "CMakeLists.txt", cmakelists.str());
+}
+
+/**
+ * @brief Runs the Atmel Studio 7 generator on a project
+ * @param options : additional command line options (e.g. cache entries definitions)
+ * @return generation time, in milliseconds
+ */
+static long long run_generator(const fs::path& source_dir, const fs::path& binary_dir, const std::string& options = "")
+{
+  const std::string command = "\"\"" + std::string(CMAKE_COMMAND_PATH) + "\" -G \"Atmel Studio 7.0\" -S \"" +
+    source_dir.string() + "\" -B \"" + binary_dir.string() + "\" -DCMAKE_TOOLCHAIN_FILE=\"" +
+    (source_dir / "toolchain.cmake").string() + "\" " + options + " > \"" + (binary_dir / "generation.log").string() + "\" 2>&1\"";
+
+  const auto start = std::chrono::steady_clock::now();
+  const int result = std::system(command.c_str());
+  const auto stop = std::chrono::steady_clock::now();
+
+  EXPECT_EQ(result, 0) << read_file(binary_dir / "generation.log");
+  return std::chrono::duration_cast<std::chrono::milliseconds>(stop - start).count();
+}
+
+/**
+ * @brief Extracts the content of all occurrences of an element from an xml string
+ * @param xml         : xml string
+ * @param element     : element name
+ * @param attributes  : element holds attributes
+ */
+static std::vector<std::string> find_elements(const std::string& xml, const std::string& element, bool attributes = false)
+{
+  std::vector<std::string> out;
+  const std::string start_tag = "<" + element + (attributes ? " " : ">");
+  const std::string end_tag = "</" + element + ">";
+  std::size_t pos = xml.find(start_tag);
+  while (pos != std::string::npos) {
+    pos += start_tag.size();
+    const std::size_t end = xml.find(end_tag, pos);
+    out.push_back(xml.substr(pos, end - pos));
+    pos = xml.find(start_tag, end);
+  }
+  return out;
+}
+
+/**
+ * @brief Reads all project and solution files of a binary directory
+ * @return content of each file, keyed by file name
+ */
+static std::map<std::string, std::string> read_project_files(const fs::path& binary_dir)
+{
+  std::map<std::string, std::string> out;
+  for (const fs::directory_entry& entry : fs::directory_iterator(binary_dir)) {
+    const fs::path extension = entry.path().extension();
+    if (extension == ".cproj" || extension == ".atsln") {
+      out[entry.path().filename().string()] = read_file(entry.path());
+    }
+  }
+  return out;
+}
+
+// Generation time of a dense dependency graph : solution and project files reference a GUID for each dependency edge.
+TEST(AS7GeneratorMesh, dependency_mesh_generation)
+{
+#ifndef _WIN32
+  GTEST_SKIP() << "Atmel Studio 7 generator is only available on Windows";
+#endif
+  const fs::path root = fs::temp_directory_path() / "as7_mesh";
+  const fs::path source_dir = root / "src";
+  const fs::path binary_dir = root / "build";
+  fs::remove_all(root);
+  write_mesh_project(source_dir);
+  fs::create_directories(binary_dir);
+
+  const long long first_generation = run_generator(source_dir, binary_dir);
+  const long long regeneration = run_generator(source_dir, binary_dir);
+  std::cout << mesh_targets << " targets mesh (" << mesh_density << " dependencies per target) : generated in "
+            << first_generation << " ms, regenerated in " << regeneration << " ms" << std::endl;
+  ::testing::Test::RecordProperty("first_generation_ms", std::to_string(first_generation));
+  ::testing::Test::RecordProperty("regeneration_ms", std::to_string(regeneration));
+
+  // Project references shall point to the GUID of the referenced projects
+  std::map<std::string, std::string> guids;
+  std::vector<std::string> project_files;
+  for (int i = 0; i < mesh_targets; i++) {
+    project_files.push_back("lib_" + std::to_string(i));
+  }
+  project_files.push_back("mesh");
+  for (const std::string& name : project_files) {
+    const std::vector<std::string> guid = find_elements(read_file(binary_dir / (name + ".cproj")), "ProjectGuid");
+    ASSERT_EQ(guid.size(), 1u) << name;
+    guids[name] = "{" + guid[0] + "}";
+  }
+
+  std::size_t references = 0;
+  for (const std::string& name : project_files) {
+    for (const std::string& reference : find_elements(read_file(binary_dir / (name + ".cproj")), "ProjectReference", true)) {
+      const std::vector<std::string> referenced_name = find_elements(reference, "Name");
+      const std::vector<std::string> referenced_guid = find_elements(reference, "Project");
+      ASSERT_EQ(referenced_name.size(), 1u) << name;
+      ASSERT_EQ(referenced_guid.size(), 1u) << name;
+      EXPECT_EQ(referenced_guid[0], guids[referenced_name[0]]) << name << " references " << referenced_name[0];
+      references++;
+    }
+  }
+  EXPECT_GE(references, static_cast<std::size_t>((mesh_targets - mesh_density) * mesh_density));
+
+  // Every project is listed in the solution, with the GUID written in its project file
+  const std::string solution = read_file(binary_dir / "as7_mesh.atsln");
+  for (const auto& guid : guids) {
+    EXPECT_NE(solution.find(guid.second), std::string::npos) << guid.first;
+  }
+}
+
+// Project files generated on a worker pool are byte-identical to the ones generated serially.
+TEST(AS7GeneratorMesh, parallel_generation_matches_serial_generation)
+{
+#ifndef _WIN32
+  GTEST_SKIP() << "Atmel Studio 7 generator is only available on Windows";
+#endif
+  const int targets = 64;
+  const fs::path root = fs::temp_directory_path() / "as7_parallel";
+  const fs::path source_dir = root / "src";
+  const fs::path binary_dir = root / "build";
+  fs::remove_all(root);
+  write_mesh_project(source_dir, targets);
+  fs::create_directories(binary_dir);
+
+  // GUIDs are stored in the cache, so all generations share the same binary directory
+  run_generator(source_dir, binary_dir, "-DCMAKE_AS7_PARALLEL_GENERATE=OFF");
+  const std::map<std::string, std::string> serial_files = read_project_files(binary_dir);
+  ASSERT_EQ(serial_files.size(), static_cast<std::size_t>(targets + 2)); // libraries, executable and solution
+
+  for (const std::string jobs : { "ON", "3" }) {
+    // Project files are written again only if they are missing, whatever their fingerprint
+    for (const auto& file : serial_files) {
+      fs::remove(binary_dir / file.first);
+    }
+    run_generator(source_dir, binary_dir, "-DCMAKE_AS7_PARALLEL_GENERATE=" + jobs);
+
+    const std::map<std::string, std::string> parallel_files = read_project_files(binary_dir);
+    ASSERT_EQ(parallel_files.size(), serial_files.size()) << "CMAKE_AS7_PARALLEL_GENERATE=" << jobs;
+    for (const auto& file : serial_files) {
+      const auto parallel_file = parallel_files.find(file.first);
+      ASSERT_NE(parallel_file, parallel_files.end()) << file.first;
+      EXPECT_EQ(parallel_file->second, file.second) << file.first << " with CMAKE_AS7_PARALLEL_GENERATE=" << jobs;
+    }
+  }
+}
+
+
+// Solution file is only written again when its projects or their inputs changed.
+TEST(AS7GeneratorMesh, solution_is_skipped_when_projects_are_unchanged)
+{
+#ifndef _WIN32
+  GTEST_SKIP() << "Atmel Studio 7 generator is only available on Windows";
+#endif
+  const int targets = 8;
+  const fs::path root = fs::temp_directory_path() / "as7_solution";
+  const fs::path source_dir = root / "src";
+  const fs::path binary_dir = root / "build";
+  const fs::path solution_file = binary_dir / "as7_mesh.atsln";
+  fs::remove_all(root);
+  write_mesh_project(source_dir, targets);
+  fs::create_directories(binary_dir);
+  run_generator(source_dir, binary_dir);
+
+  // A solution written again would lose this edit, even with an unchanged content
+  const std::string edited_solution = read_file(solution_file) + "# edited\n";
+  write_file(solution_file, edited_solution);
+  run_generator(source_dir, binary_dir);
+  EXPECT_EQ(read_file(solution_file), edited_solution);
+
+  // Adding a project changes the project set
+  write_mesh_project(source_dir, targets + 1);
+  run_generator(source_dir, binary_dir);
+  const std::string solution = read_file(solution_file);
+  EXPECT_EQ(solution.find("# edited"), std::string::npos);
+  EXPECT_NE(solution.find("\"lib_" + std::to_string(targets) + "\""), std::string::npos);
+}
+
+}
+
+int main(int argc, char** argv)
+{
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
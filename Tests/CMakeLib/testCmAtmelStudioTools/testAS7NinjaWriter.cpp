@@ -0,0 +1,170 @@
+/*
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU Lesser General Public License as published by
+the Free Software Foundation, either version 3.0 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU Lesser General Public License for more details.
+
+You should have received a copy of the GNU Lesser General Public License
+along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include <gtest/gtest.h>
+#include "AS7NinjaWriter.h"
+#include "AvrGCC8Toolchain.h"
+
+namespace AtmelStudioToolsTests
+{
+
+static AvrToolchain::AS7AvrGCC8 make_toolchain()
+{
+  AvrToolchain::AS7AvrGCC8 toolchain;
+  toolchain.common.Device = "-mmcu=atmega328p -B \"%24(PackRepoDir)\\atmel\\ATmega_DFP\\1.2.209\\gcc\\dev\\atmega328p\"";
+  toolchain.avrgcc.optimizations.level = "Optimize for size (-Os)";
+  toolchain.avrgcc.directories.include_paths = { "C:\\project\\include dir" };
+  toolchain.common.outputfiles.srec = false;
+  return toolchain;
+}
+
+static AS7NinjaWriter::Target make_target()
+{
+  AS7NinjaWriter::Target target;
+  target.name = "firmware";
+  target.source_dir = "/project";
+  target.binary_dir = "/project/build";
+  target.type = AS7NinjaWriter::OutputType::Executable;
+  target.c_sources = { "/project/src/main.c", "/project/src/drivers/uart.c" };
+  target.dependencies = { "hal" };
+  return target;
+}
+
+TEST(AS7NinjaWriterTest, escape_path)
+{
+  EXPECT_EQ(AS7NinjaWriter::escape_path("/project/build/main.o"), "/project/build/main.o");
+  EXPECT_EQ(AS7NinjaWriter::escape_path("C:/my project/$lib.a"), "C$:/my$ project/$$lib.a");
+}
+
+TEST(AS7NinjaWriterTest, flags_conversion)
+{
+  const std::vector<std::string> flags = {
+    "-Os",
+    "-IC:\\project\\include dir",
+    "-B",
+    "%24(PackRepoDir)\\atmel\\ATmega_DFP\\1.2.209\\gcc\\dev\\atmega328p",
+    "-DPRICE=$5",
+    "",
+  };
+  EXPECT_EQ(AS7NinjaWriter::to_variable_value(flags),
+            "-Os \"-IC:/project/include dir\" -B \"${as7_pack_repo_dir}/atmel/ATmega_DFP/1.2.209/gcc/dev/atmega328p\" -DPRICE=$$5");
+}
+
+TEST(AS7NinjaWriterTest, executable_configuration)
+{
+  std::ostringstream out;
+  AS7NinjaWriter writer(out);
+  writer.write_configuration(make_target(), "Debug", make_toolchain());
+  const std::string content = out.str();
+
+  // Objects mirror the sources layout
+  EXPECT_NE(content.find("build /project/build/Debug/firmware.dir/src/main.c.o: AS7_C_COMPILER /project/src/main.c\n"), std::string::npos);
+  EXPECT_NE(content.find("build /project/build/Debug/firmware.dir/src/drivers/uart.c.o: AS7_C_COMPILER /project/src/drivers/uart.c\n"), std::string::npos);
+  EXPECT_NE(content.find("\"-IC:/project/include dir\""), std::string::npos);
+
+  // Executable is relinked whenever one of its dependencies changes
+  EXPECT_NE(content.find("build /project/build/Debug/firmware.elf: AS7_C_LINKER /project/build/Debug/firmware.dir/src/main.c.o "
+                         "/project/build/Debug/firmware.dir/src/drivers/uart.c.o | hal-Debug\n"),
+            std::string::npos);
+  EXPECT_NE(content.find("-Wl,-Map=/project/build/Debug/firmware.map"), std::string::npos);
+
+  // Only enabled images are produced
+  EXPECT_NE(content.find("build /project/build/Debug/firmware.hex: AS7_HEX /project/build/Debug/firmware.elf\n"), std::string::npos);
+  EXPECT_NE(content.find("build /project/build/Debug/firmware.eep: AS7_EEP /project/build/Debug/firmware.elf\n"), std::string::npos);
+  EXPECT_NE(content.find("build /project/build/Debug/firmware.lss: AS7_LSS /project/build/Debug/firmware.elf\n"), std::string::npos);
+  EXPECT_EQ(content.find("AS7_SREC"), std::string::npos);
+
+  EXPECT_NE(content.find("build firmware-Debug: phony /project/build/Debug/firmware.elf /project/build/Debug/firmware.hex "
+                         "/project/build/Debug/firmware.eep /project/build/Debug/firmware.lss\n"),
+            std::string::npos);
+}
+
+TEST(AS7NinjaWriterTest, static_library_configuration)
+{
+  AS7NinjaWriter::Target target = make_target();
+  target.name = "hal";
+  target.type = AS7NinjaWriter::OutputType::StaticLibrary;
+  target.c_sources = { "/project/src/hal.c" };
+  target.cxx_sources = { "/project/src/timer.cpp" };
+  target.dependencies.clear();
+
+  std::ostringstream out;
+  AS7NinjaWriter writer(out);
+  writer.write_configuration(target, "Release", make_toolchain());
+  const std::string content = out.str();
+
+  EXPECT_NE(content.find("build /project/build/Release/hal.dir/src/timer.cpp.o: AS7_CXX_COMPILER /project/src/timer.cpp\n"), std::string::npos);
+  EXPECT_NE(content.find("build /project/build/Release/libhal.a: AS7_ARCHIVER /project/build/Release/hal.dir/src/hal.c.o "
+                         "/project/build/Release/hal.dir/src/timer.cpp.o\n  archiver_flags = -r\n"),
+            std::string::npos);
+  EXPECT_NE(content.find("build hal-Release: phony /project/build/Release/libhal.a\n"), std::string::npos);
+  EXPECT_EQ(content.find("AS7_HEX"), std::string::npos);
+}
+
+TEST(AS7NinjaWriterTest, sources_with_the_same_name)
+{
+  AS7NinjaWriter::Target target = make_target();
+  target.c_sources = { "/project/src/main.c" };
+  target.cxx_sources = { "/project/src/main.cpp" };
+
+  std::ostringstream out;
+  AS7NinjaWriter writer(out);
+  writer.write_configuration(target, "Debug", make_toolchain());
+  const std::string content = out.str();
+
+  // Each source builds its own object, ninja would reject the whole manifest otherwise
+  EXPECT_NE(content.find("build /project/build/Debug/firmware.dir/src/main.c.o: AS7_C_COMPILER /project/src/main.c\n"), std::string::npos);
+  EXPECT_NE(content.find("build /project/build/Debug/firmware.dir/src/main.cpp.o: AS7_CXX_COMPILER /project/src/main.cpp\n"),
+            std::string::npos);
+}
+
+TEST(AS7NinjaWriterTest, rules_and_aggregates)
+{
+  AS7NinjaWriter::Tools tools;
+  tools.c_compiler = "/opt/avr gcc/bin/avr-gcc";
+  tools.cxx_compiler = "avr-g++";
+  tools.archiver = "avr-ar";
+  tools.objcopy = "avr-objcopy";
+  tools.objdump = "avr-objdump";
+  tools.pack_repo_dir = "C:/Program Files (x86)/Atmel/Studio/7.0/packs";
+
+  std::ostringstream out;
+  AS7NinjaWriter writer(out);
+  writer.write_rules(tools);
+  writer.write_subninja("/project/build/CMakeFiles/firmware.as7.ninja");
+  writer.write_configuration_aggregate({ "firmware", "hal" }, "Debug");
+  writer.write_default("all-Debug");
+  const std::string content = out.str();
+
+  EXPECT_NE(content.find("as7_pack_repo_dir = C:/Program Files (x86)/Atmel/Studio/7.0/packs\n"), std::string::npos);
+  EXPECT_NE(content.find("rule AS7_C_COMPILER\n  command = \"/opt/avr gcc/bin/avr-gcc\" -x c $flags"), std::string::npos);
+  EXPECT_NE(content.find("rule AS7_CXX_LINKER\n"), std::string::npos);
+  EXPECT_NE(content.find("  deps = gcc\n"), std::string::npos);
+  EXPECT_NE(content.find("subninja /project/build/CMakeFiles/firmware.as7.ninja\n"), std::string::npos);
+  EXPECT_NE(content.find("build all-Debug: phony firmware-Debug hal-Debug\n"), std::string::npos);
+  EXPECT_NE(content.find("\ndefault all-Debug\n"), std::string::npos);
+}
+
+}
+
+int main(int argc, char** argv)
+{
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
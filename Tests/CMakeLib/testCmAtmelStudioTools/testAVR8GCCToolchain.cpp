@@ -14,7 +14,10 @@ along with this program.  If not, see <https://www.gnu.org/licenses/>.
 */
 
 #include <algorithm>
+#include <memory>
+#include <sstream>
 #include <string>
+#include <thread>
 #include <vector>
 #include <filesystem>
 
@@ -28,6 +31,7 @@ along with this program.  If not, see <https://www.gnu.org/licenses/>.
 #include "cmAvrGccLinkerOption.h"
 #include "AvrGCC8Toolchain.h"
 #include "AS7ToolchainTranslator.h"
+#include "AS7XmlWriter.h"
 #include "cmStringUtils.h"
 #include "pugixml.hpp"
 
@@ -67,6 +71,243 @@ TEST_F(AVR8GCCTests, toolchain_includes_persistence)
 
 }
 
+/**
+ * @brief Prepares the translator for a new configuration, the same way cmAtmelStudio7TargetGenerator does
+ */
+static void prepare_configuration(AvrToolchain::AS7ToolchainTranslator& translator,
+                                  const std::shared_ptr<const compiler::AbstractCompilerModel>& model)
+{
+  translator.toolchain.avrgcc.clear();
+  translator.toolchain.avrgcccpp.clear();
+  translator.toolchain.assembler.clear();
+  translator.toolchain.linker.clear();
+  translator.set_compiler(model, "C");
+  translator.toolchain.linker.libraries.libraries.push_back("libm");
+}
+
+static void start_configuration(AS7XmlWriter& writer, const std::string& config)
+{
+  writer.start_element("PropertyGroup");
+  writer.attribute("Condition", " '$(Configuration)' == '" + config + "' ");
+  writer.start_element("ToolchainSettings");
+  writer.start_element("AvrGcc");
+}
+
+static void end_configuration(AS7XmlWriter& writer)
+{
+  writer.end_element();
+  writer.end_element();
+  writer.end_element();
+}
+
+// The streaming writer shall give the exact same output as pugixml's indented format,
+// which was used to write project files so far.
+TEST_F(AVR8GCCTests, xml_writer_matches_pugixml_output)
+{
+  pugi::xml_document doc;
+  pugi::xml_node decl = doc.prepend_child(pugi::node_declaration);
+  decl.append_attribute("version") = "1.0";
+  decl.append_attribute("encoding") = "utf-8";
+  pugi::xml_node project_node = doc.append_child("Project");
+  project_node.append_attribute("DefaultTargets") = "Build";
+  project_node.append_attribute("Condition") = " '$(Configuration)' == 'R&D <\"beta\">' ";
+  pugi::xml_node group_node = project_node.append_child("PropertyGroup");
+  group_node.append_child("Empty");
+  group_node.append_child("Value").append_child(pugi::node_pcdata).set_value("a < b && c > d");
+  pugi::xml_node attributes_node = group_node.append_child("documentation");
+  attributes_node.append_attribute("help") = "";
+  pugi::xml_node list_node = group_node.append_child("ListValues");
+  list_node.append_child("Value").append_child(pugi::node_pcdata).set_value("F_CPU=16000000UL");
+  list_node.append_child("Value").append_child(pugi::node_pcdata).set_value("C:\\include dir");
+  pugi::xml_node compile_node = project_node.append_child("Compile");
+  compile_node.append_attribute("Include") = "C:\\src\\main.c";
+  compile_node.append_child("SubType").append_child(pugi::node_pcdata).set_value("compile");
+
+  std::ostringstream expected;
+  doc.save(expected, "  ", (pugi::format_indent | pugi::format_write_bom), pugi::xml_encoding::encoding_utf8);
+
+  std::ostringstream written;
+  {
+    AS7XmlWriter writer(written);
+    writer.write_bom();
+    writer.write_declaration();
+    writer.start_element("Project");
+    writer.attribute("DefaultTargets", "Build");
+    writer.attribute("Condition", " '$(Configuration)' == 'R&D <\"beta\">' ");
+    writer.start_element("PropertyGroup");
+    writer.element("Empty");
+    writer.element("Value", "a < b && c > d");
+    writer.start_element("documentation");
+    writer.attribute("help", "");
+    writer.end_element();
+    writer.start_element("ListValues");
+    writer.element("Value", "F_CPU=16000000UL");
+    writer.element("Value", "C:\\include dir");
+    writer.end_element();
+    writer.end_element();
+    writer.start_element("Compile");
+    writer.attribute("Include", "C:\\src\\main.c");
+    writer.element("SubType", "compile");
+    // Opened elements are closed when the writer goes out of scope
+  }
+
+  EXPECT_EQ(written.str(), expected.str());
+  EXPECT_EQ(AS7XmlWriter::escape("a < b && c > d"), "a &lt; b &amp;&amp; c &gt; d");
+  EXPECT_EQ(AS7XmlWriter::escape("\"quoted\"\n"), "\"quoted\"\n");
+  EXPECT_EQ(AS7XmlWriter::escape("\"quoted\"\n", true), "&quot;quoted&quot;&#10;");
+}
+
+// Translating recorded configurations concurrently (one thread per project) and inserting them
+// in the project skeleton shall give the exact same output as a single translator generating
+// configurations in a row.
+TEST_F(AVR8GCCTests, deferred_translation_is_byte_identical)
+{
+  const std::vector<std::vector<std::string>> flag_sets = {
+    { "-O0", "-g3", "-DDEBUG=1", "-Wall", "-ffunction-sections" },
+    { "-mmcu=atmega328p", "-Os", "-Wl,--gc-sections,--relax", "-DNDEBUG" },
+    { "-mmcu=attiny85", "-O2", "-fdata-sections", "-funsigned-char" },
+  };
+
+  // Compiler models are shared between projects, as the local generator's cache does
+  std::vector<std::shared_ptr<const compiler::AbstractCompilerModel>> models;
+  for (const auto& flags : flag_sets) {
+    auto model = std::make_shared<compiler::cmAvrGccCompiler>();
+    model->parse_flags(flags);
+    models.push_back(model);
+  }
+
+  const std::vector<std::string> configurations = { "Debug", "Release", "MinSizeRel" };
+  const std::size_t project_count = 8;
+
+  // Serial reference
+  std::vector<std::string> expected;
+  for (std::size_t project = 0; project < project_count; project++) {
+    std::ostringstream content;
+    {
+      AS7XmlWriter writer(content);
+      writer.start_element("Project");
+      AvrToolchain::AS7ToolchainTranslator translator;
+      for (std::size_t config = 0; config < configurations.size(); config++) {
+        prepare_configuration(translator, models[(project + config) % models.size()]);
+        start_configuration(writer, configurations[config]);
+        translator.generate_xml(writer);
+        end_configuration(writer);
+      }
+    }
+    expected.push_back(content.str());
+  }
+
+  // Configurations are recorded first, then translated concurrently
+  struct PendingToolchain
+  {
+    std::size_t offset;
+    std::size_t level;
+    AvrToolchain::AS7ToolchainTranslator translator;
+  };
+  std::vector<std::string> skeletons;
+  std::vector<std::vector<PendingToolchain>> pending(project_count);
+  for (std::size_t project = 0; project < project_count; project++) {
+    std::ostringstream skeleton;
+    {
+      AS7XmlWriter writer(skeleton);
+      writer.start_element("Project");
+      AvrToolchain::AS7ToolchainTranslator translator;
+      for (std::size_t config = 0; config < configurations.size(); config++) {
+        prepare_configuration(translator, models[(project + config) % models.size()]);
+        start_configuration(writer, configurations[config]);
+        writer.close_start_tag();
+        pending[project].push_back({ static_cast<std::size_t>(skeleton.tellp()), writer.level(), translator });
+        end_configuration(writer);
+      }
+    }
+    skeletons.push_back(skeleton.str());
+  }
+
+  std::vector<std::string> rendered(project_count);
+  std::vector<std::thread> workers;
+  for (std::size_t project = 0; project < project_count; project++) {
+    workers.emplace_back([&, project]() {
+      auto& toolchains = pending[project];
+      const std::string& skeleton = skeletons[project];
+      std::ostringstream content;
+      std::size_t copied = 0;
+      for (std::size_t i = 0; i < toolchains.size(); i++) {
+        if (i != 0) {
+          toolchains[i].translator.inherit_shared_settings(toolchains[i - 1].translator);
+        }
+        content << skeleton.substr(copied, toolchains[i].offset - copied);
+        copied = toolchains[i].offset;
+        AS7XmlWriter writer(content, "  ", toolchains[i].level);
+        toolchains[i].translator.generate_xml(writer);
+      }
+      content << skeleton.substr(copied);
+      rendered[project] = content.str();
+    });
+  }
+  for (auto& worker : workers) {
+    worker.join();
+  }
+
+  for (std::size_t project = 0; project < project_count; project++) {
+    EXPECT_FALSE(expected[project].empty());
+    EXPECT_EQ(rendered[project], expected[project]) << "project " << project;
+  }
+}
+// Flags generated for command line builds shall follow the toolchain settings, in Atmel Studio 7 order
+TEST_F(AVR8GCCTests, command_line_flags_generation)
+{
+  AvrToolchain::AS7AvrGCC8 toolchain;
+  toolchain.common.Device = "-mmcu=atmega328p -B \"%24(PackRepoDir)\\atmel\\ATmega_DFP\\1.2.209\\gcc\\dev\\atmega328p\"";
+  toolchain.avrgcc.symbols.def_symbols = { "F_CPU=16000000UL" };
+  toolchain.avrgcc.directories.include_paths = { "C:/project/include" };
+  toolchain.avrgcc.optimizations.level = "Optimize for size (-Os)";
+  toolchain.avrgcc.optimizations.debug_level = "None";
+  toolchain.avrgcc.miscellaneous.other_flags = "-std=gnu11";
+  toolchain.avrgcccpp.optimizations.level = "Optimize more (-O2)";
+
+  const std::vector<std::string> expected_c = {
+    "-funsigned-char",
+    "-funsigned-bitfields",
+    "-DF_CPU=16000000UL",
+    "-IC:/project/include",
+    "-Os",
+    "-ffunction-sections",
+    "-fdata-sections",
+    "-fpack-struct",
+    "-fshort-enums",
+    "-Wall",
+    "-Wextra",
+    "-mmcu=atmega328p",
+    "-B",
+    "%24(PackRepoDir)\\atmel\\ATmega_DFP\\1.2.209\\gcc\\dev\\atmega328p",
+    "-std=gnu11",
+  };
+  EXPECT_EQ(toolchain.generate_compile_flags("C"), expected_c);
+
+  // C++ flags come from the avrgcccpp settings, -Wextra is not part of Atmel Studio 7 C++ defaults
+  const std::vector<std::string> cxx_flags = toolchain.generate_compile_flags("CXX");
+  EXPECT_NE(std::find(cxx_flags.begin(), cxx_flags.end(), "-O2"), cxx_flags.end());
+  EXPECT_EQ(std::find(cxx_flags.begin(), cxx_flags.end(), "-Wextra"), cxx_flags.end());
+  EXPECT_EQ(std::find(cxx_flags.begin(), cxx_flags.end(), "-DF_CPU=16000000UL"), cxx_flags.end());
+
+  toolchain.linker.libraries.libraries = { "libm", "custom" };
+  toolchain.linker.libraries.search_path = { "C:/project/lib" };
+  const std::vector<std::string> expected_link = {
+    "-Wl,-Map=out.map",
+    "-Wl,--start-group",
+    "-Wl,-lm",
+    "-Wl,-lcustom",
+    "-Wl,--end-group",
+    "-LC:/project/lib",
+    "-Wl,-static",
+    "-Wl,--gc-sections",
+    "-mmcu=atmega328p",
+    "-B",
+    "%24(PackRepoDir)\\atmel\\ATmega_DFP\\1.2.209\\gcc\\dev\\atmega328p",
+  };
+  EXPECT_EQ(toolchain.generate_link_flags("out.map"), expected_link);
+}
+
 }
 
 int main(int argc, char** argv)
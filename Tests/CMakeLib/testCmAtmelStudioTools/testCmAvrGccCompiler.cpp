@@ -14,7 +14,9 @@ along with this program.  If not, see <https://www.gnu.org/licenses/>.
 */
 
 #include <algorithm>
+#include <fstream>
 #include <string>
+#include <string_view>
 #include <vector>
 #include <filesystem>
 
@@ -29,7 +31,7 @@ along with this program.  If not, see <https://www.gnu.org/licenses/>.
 #include "AvrGCC8Toolchain.h"
 #include "AS7ToolchainTranslator.h"
 #include "cmStringUtils.h"
-#include "pugixml.hpp"
+#include "AS7XmlWriter.h"
 
 namespace AtmelStudioToolsTests {
 
@@ -154,6 +156,38 @@ TEST(AvrGccCompilerFlagsParsing, test_linker_concatenated_options)
 
 }
 
+TEST(AvrGccCompilerFlagsParsing, test_indexed_lookups)
+{
+  const std::vector<std::string> flags = { "-g", "-Wa,-g", "-Wl,--gc-sections", "-DFOO=1", "-mmcu=atmega328p",
+                                           "-Wl,--relax,--gc-sections", "-DFOO=1", "-mmcu=atmega2560" };
+  compiler::cmAvrGccCompiler compiler_abstraction;
+  compiler_abstraction.parse_flags(flags);
+
+  // Lookups by name are still checked against the option's own semantics
+  EXPECT_TRUE(compiler_abstraction.has_option("-Wa,-g"));
+  EXPECT_TRUE(compiler_abstraction.has_option("-g"));
+  EXPECT_FALSE(compiler_abstraction.has_option("-Wl,-g"));
+  EXPECT_FALSE(compiler_abstraction.has_option("-DFOO"));
+  EXPECT_TRUE(compiler_abstraction.has_option("-DFOO=1"));
+  EXPECT_TRUE(compiler_abstraction.has_option("--gc-sections"));
+  EXPECT_TRUE(compiler_abstraction.has_option("Wl,--relax"));
+
+  // Exact token lookups
+  ASSERT_NE(compiler_abstraction.get_option("-mmcu"), nullptr);
+  EXPECT_EQ(compiler_abstraction.get_option("-mmcu")->get_type(), compiler::CompilerOption::Type::Machine);
+  EXPECT_EQ(compiler_abstraction.get_option("--gc-sections"), nullptr);
+  EXPECT_NE(compiler_abstraction.get_option("-Wl,--gc-sections"), nullptr);
+
+  // Duplicates are discarded
+  EXPECT_EQ(compiler_abstraction.get_options(compiler::CompilerOption::Type::Linker).size(), 2u);
+  EXPECT_EQ(compiler_abstraction.get_options(compiler::CompilerOption::Type::Definition).size(), 1u);
+  EXPECT_EQ(compiler_abstraction.get_options(compiler::CompilerOption::Type::Machine).size(), 1u);
+
+  compiler_abstraction.clear();
+  EXPECT_FALSE(compiler_abstraction.has_option("-g"));
+  EXPECT_EQ(compiler_abstraction.get_option("-mmcu"), nullptr);
+}
+
 TEST(AvrGccCompilerFlagsParsing, test_machine_options)
 {
 
@@ -202,6 +236,71 @@ TEST(AvrGccCompilerFlagsParsing, test_compiler_flags_factory_optimization_flags)
   ASSERT_EQ(built_flag[0]->get_type(), compiler::CompilerOption::Type::Optimization);
 }
 
+TEST(AvrGccCompilerFlagsParsing, test_compiler_flags_factory_classification)
+{
+  using Type = compiler::CompilerOption::Type;
+  const std::vector<std::pair<std::string, Type>> flags = {
+    { "-Wl,--gc-sections", Type::Linker },
+    { "-Wlogical-op", Type::Warning },
+    { "-Wa,-g", Type::Warning },
+    { "-fsyntax-only", Type::Warning },
+    { "-ffunction-sections", Type::Generic },
+    { "-pedantic-errors", Type::Warning },
+    { "-pipe", Type::Generic },
+    { "-save-temps", Type::Generic },
+    { "-std=gnu99", Type::LanguageStandard },
+    { "-v", Type::Generic },
+    { "-O", Type::Optimization },
+    { "-mmcu=atmega328p", Type::Machine },
+  };
+
+  for (const auto& f : flags) {
+    Type type = Type::Generic;
+    EXPECT_TRUE(compiler::CompilerOptionFactory::classify(f.first, type)) << f.first;
+    EXPECT_EQ(type, f.second) << f.first;
+  }
+
+  const std::vector<std::string> invalid_flags = { "-Ifoo", "-Lbar", "-c", "-Ofoo", "-gfoo", "main.c" };
+  for (const auto& f : invalid_flags) {
+    EXPECT_FALSE(compiler::CompilerOptionFactory::is_valid(f)) << f;
+  }
+}
+
+TEST(AvrGccCompilerFlagsParsing, test_remove_duplicated_flags)
+{
+  const std::string flags = "-Wall -include a.h -Wall -include b.h -include a.h -Xlinker --gc-sections "
+                            "-Xlinker -Map=x.map -Xlinker --gc-sections -D A -D B -DA -D A -O2 -O2";
+  std::vector<std::string> tokens = cmutils::strings::split(flags);
+  std::vector<std::string_view> views(tokens.begin(), tokens.end());
+
+  compiler::CompilerOptionFactory::remove_duplicates(views);
+  const std::vector<std::string_view> expected = { "-Wall", "-include", "a.h", "-include", "b.h", "-Xlinker",
+                                                   "--gc-sections", "-Xlinker", "-Map=x.map", "-D", "A", "-D",
+                                                   "B", "-DA", "-O2" };
+  EXPECT_EQ(views, expected);
+
+  // A trailing option has no argument to be compared with
+  std::vector<std::string_view> trailing = { "-include", "a.h", "-include" };
+  compiler::CompilerOptionFactory::remove_duplicates(trailing);
+  EXPECT_EQ(trailing, (std::vector<std::string_view>{ "-include", "a.h", "-include" }));
+}
+
+TEST(AvrGccCompilerFlagsParsing, test_options_outlive_compiler_model)
+{
+  compiler::cmAvrGccCompiler::OptionsVec machine_options;
+  {
+    compiler::cmAvrGccCompiler compiler_abstraction;
+    compiler_abstraction.parse_flags("-mmcu=atmega328p -O2 -Wl,--relax");
+    machine_options = compiler_abstraction.get_options(compiler::CompilerOption::Type::Machine);
+    compiler_abstraction.clear();
+    EXPECT_FALSE(compiler_abstraction.has_option("-mmcu"));
+  }
+
+  ASSERT_EQ(machine_options.size(), 1u);
+  EXPECT_EQ(machine_options[0]->get_token(), "-mmcu");
+  EXPECT_EQ(static_cast<compiler::MachineOption*>(machine_options[0].get())->value, "atmega328p");
+}
+
 TEST(AvrGcc8Representation, convert_from_compiler_abstraction_all_ok)
 {
   const std::vector<std::string> flags = { "-Wall", "-DTEST_DEFINITION=33", "-Wextra", "-Werror", "-pedantic", "-pedantic-errors",
@@ -222,7 +321,6 @@ TEST(AvrGcc8Representation, convert_from_compiler_abstraction_all_ok)
   compiler_abstraction.parse_flags(flags);
 
   AvrToolchain::AS7AvrGCC8 toolchain;
-  pugi::xml_node node;
   toolchain.convert_from(compiler_abstraction);
 
   // Checking the general abstraction of avrgcc
@@ -294,7 +392,6 @@ TEST(AvrGcc8Representation, convert_from_compiler_abstraction_misc_flags_redirec
   compiler_abstraction.parse_flags(flags);
 
   AvrToolchain::AS7AvrGCC8 toolchain;
-  pugi::xml_node node;
   toolchain.convert_from(compiler_abstraction);
   ASSERT_TRUE(toolchain.avrgcc.general.change_default_chartype_unsigned);
   ASSERT_TRUE(toolchain.avrgcc.general.change_stack_pointer_without_disabling_interrupt);
@@ -306,13 +403,30 @@ TEST(AvrGcc8Representation, convert_from_compiler_abstraction_misc_flags_redirec
   compare_misc(toolchain.avrgcc.miscellaneous.other_flags, expected_misc_flags);
 }
 
+TEST(AS7ToolchainTranslatorTests, shared_compiler_model_is_not_modified)
+{
+  auto model = std::make_shared<compiler::cmAvrGccCompiler>();
+  model->parse_flags(std::vector<std::string>{ "-Wall", "-O2", "-mmcu=atmega328p" });
+
+  AvrToolchain::AS7ToolchainTranslator translator;
+  translator.set_compiler(model, "C");
+  ASSERT_EQ(translator.get_compiler("C"), model.get());
+  ASSERT_EQ(translator.get_targeted_language(), "C");
+
+  // Parsing new flags for the same language shall not alter the shared model
+  translator.parse({ "-Wextra" }, "C");
+  EXPECT_NE(translator.get_compiler("C"), model.get());
+  EXPECT_TRUE(model->has_option("-Wall"));
+  EXPECT_FALSE(model->has_option("-Wextra"));
+  EXPECT_NE(model->get_option("-mmcu"), nullptr);
+
+  // Unsupported languages are ignored
+  translator.set_compiler(model, "ASM");
+  EXPECT_EQ(translator.get_compiler("ASM"), nullptr);
+}
+
 TEST_F(FlagParsingFixture, test_generate_xml)
 {
-  pugi::xml_document doc;
-  // Prepend delcaration node will look like this : <?xml version="1.0" encoding="utf-8"?>
-  pugi::xml_node project_node = doc.append_child(pugi::node_element);
-  project_node.set_name("Testing Xml generation");
-  toolchain_translator.generate_xml(project_node);
   auto out_dir = std::filesystem::temp_directory_path() / "CMakeLibTests" / "AtmelStudio7Tools";
 
   if(!std::filesystem::exists(out_dir))
@@ -320,7 +434,16 @@ TEST_F(FlagParsingFixture, test_generate_xml)
     ASSERT_TRUE(std::filesystem::create_directories(out_dir));
   }
 
-  ASSERT_TRUE(doc.save_file((out_dir / "testfile.xml").c_str()));
+  std::ofstream file(out_dir / "testfile.xml", std::ios::binary);
+  ASSERT_TRUE(file.is_open());
+  {
+    AS7XmlWriter writer(file);
+    writer.write_declaration();
+    writer.start_element("TestingXmlGeneration");
+    toolchain_translator.generate_xml(writer);
+  }
+  file.close();
+  ASSERT_TRUE(file.good());
 }
 
 
@@ -0,0 +1,197 @@
+/* Distributed under the OSI-approved BSD 3-Clause License.  See accompanying
+   file Copyright.txt or https://cmake.org/licensing for details.  */
+#include <iostream>
+#include <iterator>
+#include <string>
+#include <vector>
+
+#include "cmsys/FStream.hxx"
+
+#include "cmFileTimes.h"
+#include "cmListFileCache.h"
+#include "cmMessenger.h"
+#include "cmSystemTools.h"
+#include "cmVersion.h"
+
+namespace {
+
+void writeFile(std::string const& path, std::string const& content)
+{
+  cmsys::ofstream fout(path.c_str(), std::ios::out | std::ios::binary);
+  fout << content;
+}
+
+std::string readFile(std::string const& path)
+{
+  cmsys::ifstream fin(path.c_str(), std::ios::in | std::ios::binary);
+  return std::string((std::istreambuf_iterator<char>(fin)),
+                     std::istreambuf_iterator<char>());
+}
+
+bool sameFunctions(std::vector<cmListFileFunction> const& actual,
+                   std::vector<cmListFileFunction> const& expected)
+{
+  if (actual.size() != expected.size()) {
+    std::cerr << "Expected " << expected.size() << " functions, got "
+              << actual.size() << std::endl;
+    return false;
+  }
+  for (std::size_t i = 0; i < actual.size(); ++i) {
+    if (actual[i].OriginalName() != expected[i].OriginalName() ||
+        actual[i].LowerCaseName() != expected[i].LowerCaseName() ||
+        actual[i].Line() != expected[i].Line() ||
+        actual[i].Arguments() != expected[i].Arguments()) {
+      std::cerr << "Function " << i << " differs: "
+                << actual[i].OriginalName() << " (line " << actual[i].Line()
+                << ")" << std::endl;
+      return false;
+    }
+    for (std::size_t a = 0; a < actual[i].Arguments().size(); ++a) {
+      if (actual[i].Arguments()[a].Line != expected[i].Arguments()[a].Line) {
+        std::cerr << "Line of argument " << a << " of function " << i
+                  << " differs" << std::endl;
+        return false;
+      }
+    }
+  }
+  return true;
+}
+
+} // anonymous namespace
+
+int testListFileCache(int argc, char* argv[])
+{
+  if (argc < 2) {
+    std::cout << "Invalid arguments.\n";
+    return -1;
+  }
+
+  // Files modified in the last second are not cached: list files of this
+  // test get the modification time of a source file instead.
+  cmFileTimes const oldTimes(std::string(argv[1]) + "/CMakeLists.txt");
+  if (!oldTimes.IsValid()) {
+    std::cout << "Cannot load the times of the reference file.\n";
+    return -1;
+  }
+
+  cmMessenger messenger;
+  std::string const listFile = "testListFileCache.cmake";
+  std::string const content = "set(A 1)\n"
+                              "If(A)\n"
+                              "  message(STATUS \"a ; b\" [[c]]\n"
+                              "          d)\n"
+                              "endif()\n";
+  writeFile(listFile, content);
+  oldTimes.Store(listFile);
+
+  cmListFile parsed;
+  if (!parsed.ParseFile(listFile.c_str(), &messenger,
+                        cmListFileBacktrace())) {
+    std::cerr << "Cannot parse " << listFile << std::endl;
+    return 1;
+  }
+
+  // Parsed functions are cached
+  std::vector<cmListFileFunction> cached;
+  if (!cmListFileCache::Find(listFile, cached) ||
+      !sameFunctions(cached, parsed.Functions)) {
+    std::cerr << "Parsed file is not cached" << std::endl;
+    return 1;
+  }
+
+  // Cached functions are returned by the next parse of the file
+  cmListFile reparsed;
+  if (!reparsed.ParseFile(listFile.c_str(), &messenger,
+                          cmListFileBacktrace()) ||
+      !sameFunctions(reparsed.Functions, parsed.Functions)) {
+    std::cerr << "Cached file is not returned" << std::endl;
+    return 1;
+  }
+
+  std::string const cacheFile = "testListFileCache.bin";
+  cmSystemTools::RemoveFile(cacheFile);
+  if (!cmListFileCache::Save(cacheFile)) {
+    std::cerr << "Cannot save " << cacheFile << std::endl;
+    return 1;
+  }
+
+  // A modified file is parsed again
+  writeFile(listFile, "set(B 2)\n");
+  cached.clear();
+  if (cmListFileCache::Find(listFile, cached)) {
+    std::cerr << "Modified file is still cached" << std::endl;
+    return 1;
+  }
+  cmListFile modified;
+  if (!modified.ParseFile(listFile.c_str(), &messenger,
+                          cmListFileBacktrace()) ||
+      modified.Functions.size() != 1 ||
+      modified.Functions[0].LowerCaseName() != "set") {
+    std::cerr << "Modified file is not parsed again" << std::endl;
+    return 1;
+  }
+
+  // Saved entries are loaded back for files which did not change since
+  writeFile(listFile, content);
+  oldTimes.Store(listFile);
+  if (!cmListFileCache::Load(cacheFile)) {
+    std::cerr << "Cannot load " << cacheFile << std::endl;
+    return 1;
+  }
+  cached.clear();
+  if (!cmListFileCache::Find(listFile, cached) ||
+      !sameFunctions(cached, parsed.Functions)) {
+    std::cerr << "Saved entry is not loaded" << std::endl;
+    return 1;
+  }
+
+  // Files which were just written are not cached
+  std::string const recentFile = "testListFileCacheRecent.cmake";
+  writeFile(recentFile, content);
+  cmListFile recent;
+  if (!recent.ParseFile(recentFile.c_str(), &messenger,
+                        cmListFileBacktrace())) {
+    std::cerr << "Cannot parse " << recentFile << std::endl;
+    return 1;
+  }
+  cached.clear();
+  if (cmListFileCache::Find(recentFile, cached)) {
+    std::cerr << "Recently modified file is cached" << std::endl;
+    return 1;
+  }
+
+  // Cleared entries are parsed again
+  cmListFileCache::Clear();
+  cached.clear();
+  if (cmListFileCache::Find(listFile, cached)) {
+    std::cerr << "Cleared entry is still cached" << std::endl;
+    return 1;
+  }
+
+  // Truncated cache files are rejected
+  std::string const saved = readFile(cacheFile);
+  std::string const truncatedFile = "testListFileCacheTruncated.bin";
+  writeFile(truncatedFile, saved.substr(0, saved.size() - 3));
+  if (cmListFileCache::Load(truncatedFile)) {
+    std::cerr << "Truncated cache file is loaded" << std::endl;
+    return 1;
+  }
+
+  // Cache files written by another version of CMake are rejected
+  std::string const cmakeVersion = cmVersion::GetCMakeVersion();
+  std::string::size_type const versionPos = saved.find(cmakeVersion);
+  if (versionPos == std::string::npos) {
+    std::cerr << "CMake version is not saved in " << cacheFile << std::endl;
+    return 1;
+  }
+  std::string otherVersion = saved;
+  otherVersion[versionPos] = otherVersion[versionPos] == '9' ? '8' : '9';
+  std::string const otherVersionFile = "testListFileCacheOtherVersion.bin";
+  writeFile(otherVersionFile, otherVersion);
+  if (cmListFileCache::Load(otherVersionFile)) {
+    std::cerr << "Cache file of another CMake version is loaded" << std::endl;
+    return 1;
+  }
+
+  return 0;
+}
@@ -0,0 +1,81 @@
+/* Distributed under the OSI-approved BSD 3-Clause License.  See accompanying
+   file Copyright.txt or https://cmake.org/licensing for details.  */
+#include <iostream>
+#include <string>
+
+#include "cmsys/RegularExpression.hxx"
+
+#include "cmRegexCache.h"
+
+namespace {
+
+bool get(std::string const& pattern, cmRegexCache::Regex& regex,
+         bool expectHit)
+{
+  unsigned long const hits = cmRegexCache::GetHits();
+  unsigned long const misses = cmRegexCache::GetMisses();
+  regex = cmRegexCache::Get(pattern);
+  if (!regex) {
+    std::cerr << "Cannot compile \"" << pattern << "\"" << std::endl;
+    return false;
+  }
+  if (cmRegexCache::GetHits() != hits + (expectHit ? 1 : 0) ||
+      cmRegexCache::GetMisses() != misses + (expectHit ? 0 : 1)) {
+    std::cerr << "Expected a cache " << (expectHit ? "hit" : "miss")
+              << " for \"" << pattern << "\"" << std::endl;
+    return false;
+  }
+  return true;
+}
+
+} // anonymous namespace
+
+int testRegexCache(int /*unused*/, char* /*unused*/[])
+{
+  cmRegexCache::Regex regex;
+  cmRegexCache::Regex other;
+  if (!get("^item_([0-9]+)$", regex, false) ||
+      !get("^item_([0-9]+)$", other, true)) {
+    return 1;
+  }
+
+  // The cached expression is shared, its matches are not
+  cmsys::RegularExpressionMatch match;
+  cmsys::RegularExpressionMatch otherMatch;
+  if (regex != other || !regex->find("item_12", match) ||
+      !other->find("item_345", otherMatch) || match.match(1) != "12" ||
+      otherMatch.match(1) != "345") {
+    std::cerr << "Cached expression is not shared" << std::endl;
+    return 1;
+  }
+
+  // Invalid patterns are reported and not cached
+  if (cmRegexCache::Get("(unbalanced") || cmRegexCache::Get("(unbalanced")) {
+    std::cerr << "Invalid pattern compiled" << std::endl;
+    return 1;
+  }
+
+  // The least recently used expressions are evicted first
+  cmRegexCache::Regex evicted;
+  if (!get("^evicted_([0-9]+)$", evicted, false)) {
+    return 1;
+  }
+  for (int i = 0; i < 1000; ++i) {
+    if (!get("^item_([0-9]+)$", regex, true) ||
+        !get("^pattern_" + std::to_string(i) + "$", other, false)) {
+      return 1;
+    }
+  }
+  if (!get("^pattern_999$", other, true) ||
+      !get("^pattern_0$", other, false)) {
+    return 1;
+  }
+
+  // Evicted expressions stay valid while they are used
+  if (!evicted->find("evicted_6", match) || match.match(1) != "6") {
+    std::cerr << "Evicted expression is not valid" << std::endl;
+    return 1;
+  }
+
+  return 0;
+}
@@ -29,3 +29,10 @@ if (NOT numInvocations EQUAL 1)
   set(RunCMake_TEST_FAILED
       "Unexpected number of lowercase command names: ${numInvocations}")
 endif()
+file(STRINGS ${ProfilingTestOutput} regexCacheCounter
+  REGEX [["name"[ ]*:[ ]*"regex cache"]])
+list(LENGTH regexCacheCounter numCounters)
+if (NOT numCounters EQUAL 1)
+  set(RunCMake_TEST_FAILED
+      "Unexpected number of regex cache counters: ${numCounters}")
+endif()
@@ -3,3 +3,9 @@ endfunction()
 
 # This must not appear in the profiling output as uppercase
 __TESTING_COMMAND_CASE()
+
+# Matches of the same pattern hit the regex cache
+foreach(i RANGE 3)
+  if("item_${i}" MATCHES "^item_[0-9]+$")
+  endif()
+endforeach()
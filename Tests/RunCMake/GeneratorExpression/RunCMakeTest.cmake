@@ -26,6 +26,13 @@ run_cmake(TARGET_PROPERTY-INCLUDE_DIRECTORIES)
 run_cmake(TARGET_PROPERTY-LOCATION)
 run_cmake(TARGET_PROPERTY-SOURCES)
 run_cmake(TARGET_PROPERTY-ALIAS_GLOBAL)
+run_cmake(TARGET_PROPERTY-shared-input)
+set(ENV{CMAKE_VERIFY_USAGE_REQUIREMENTS_CACHE} 1)
+run_cmake(TARGET_PROPERTY-transitive-reuse)
+if(RunCMake_GENERATOR_IS_MULTI_CONFIG)
+  run_cmake(TARGET_PROPERTY-transitive-configs)
+endif()
+unset(ENV{CMAKE_VERIFY_USAGE_REQUIREMENTS_CACHE})
 run_cmake(LINK_ONLY-not-linking)
 run_cmake(TARGET_EXISTS-no-arg)
 run_cmake(TARGET_EXISTS-empty-arg)
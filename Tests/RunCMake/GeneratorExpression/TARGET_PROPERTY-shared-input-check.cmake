@@ -0,0 +1,18 @@
+unset(RunCMake_TEST_FAILED)
+
+foreach(name IN ITEMS alpha beta)
+  set(file "${RunCMake_TEST_BINARY_DIR}/shared-input-${name}.txt")
+  if(NOT EXISTS "${file}")
+    string(APPEND RunCMake_TEST_FAILED "missing ${file}\n")
+    continue()
+  endif()
+  file(READ "${file}" content)
+  if (NOT content MATCHES "KIND:([^\n]*)\n" OR
+      NOT CMAKE_MATCH_1 STREQUAL "${name}_kind")
+    string(APPEND RunCMake_TEST_FAILED "wrong KIND for ${name}: \"${CMAKE_MATCH_1}\"\n")
+  endif()
+  if (NOT content MATCHES "DEFINITIONS:([^\n]*)\n" OR
+      NOT CMAKE_MATCH_1 STREQUAL "OWN_${name};FOR_${name}_kind")
+    string(APPEND RunCMake_TEST_FAILED "wrong DEFINITIONS for ${name}: \"${CMAKE_MATCH_1}\"\n")
+  endif()
+endforeach()
@@ -0,0 +1,19 @@
+cmake_minimum_required(VERSION 3.19)
+enable_language(C)
+
+# Targets using the very same generator expression strings, parsed once
+# and evaluated in the context of each target.
+add_library(shared INTERFACE)
+target_compile_definitions(shared INTERFACE FOR_$<TARGET_PROPERTY:KIND>)
+
+foreach(name IN ITEMS alpha beta)
+  add_library(${name} STATIC empty.c)
+  set_property(TARGET ${name} PROPERTY KIND ${name}_kind)
+  target_compile_definitions(${name} PRIVATE OWN_$<TARGET_PROPERTY:NAME>)
+  target_link_libraries(${name} PRIVATE shared)
+  file(GENERATE OUTPUT "shared-input-$<TARGET_PROPERTY:NAME>.txt"
+    CONTENT "KIND:$<TARGET_PROPERTY:KIND>
+DEFINITIONS:$<TARGET_PROPERTY:COMPILE_DEFINITIONS>
+"
+    TARGET ${name})
+endforeach()
@@ -0,0 +1,20 @@
+unset(RunCMake_TEST_FAILED)
+
+foreach(config IN ITEMS Debug Release)
+  file(READ "${RunCMake_TEST_BINARY_DIR}/out-${config}.txt" content)
+  if(config STREQUAL "Debug")
+    set(expected_INCLUDES1 "/include/plain;/include/base;/include/debug_only")
+    set(expected_INCLUDES2 "/include/plain;/include/base;/include/debug_only")
+  else()
+    set(expected_INCLUDES1 "/include/plain;/include/base")
+    set(expected_INCLUDES2 "/include/plain;/include/base")
+  endif()
+  set(expected_DEFINITIONS1 "BASE;PER_CONFIG_${config}")
+  set(expected_DEFINITIONS2 "BASE")
+  foreach(name IN ITEMS INCLUDES1 INCLUDES2 DEFINITIONS1 DEFINITIONS2)
+    if(NOT content MATCHES "${name}:([^\n]*)\n" OR
+        NOT CMAKE_MATCH_1 STREQUAL "${expected_${name}}")
+      string(APPEND RunCMake_TEST_FAILED "wrong content for ${name} in ${config}: \"${CMAKE_MATCH_1}\"\n")
+    endif()
+  endforeach()
+endforeach()
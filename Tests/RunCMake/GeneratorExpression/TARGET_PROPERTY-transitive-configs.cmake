@@ -0,0 +1,32 @@
+cmake_minimum_required(VERSION 3.14)
+enable_language(C)
+set(CMAKE_CONFIGURATION_TYPES Debug Release)
+
+# Usage requirements evaluated for one configuration are reused for the
+# others unless they depend on it.
+add_library(base STATIC empty.c)
+target_include_directories(base PUBLIC /include/base)
+target_compile_definitions(base PUBLIC BASE)
+
+add_library(plain STATIC empty.c)
+target_include_directories(plain PUBLIC /include/plain)
+target_link_libraries(plain PUBLIC base)
+
+add_library(debug_only STATIC empty.c)
+target_include_directories(debug_only PUBLIC /include/debug_only)
+
+add_library(per_config STATIC empty.c)
+target_compile_definitions(per_config PUBLIC PER_CONFIG_$<CONFIG>)
+target_link_libraries(per_config PUBLIC $<$<CONFIG:Debug>:debug_only> base)
+
+add_library(consumer1 STATIC empty.c)
+target_link_libraries(consumer1 PRIVATE plain per_config)
+
+add_library(consumer2 STATIC empty.c)
+target_link_libraries(consumer2 PRIVATE plain debug debug_only)
+
+file(GENERATE OUTPUT out-$<CONFIG>.txt CONTENT "INCLUDES1:$<TARGET_PROPERTY:consumer1,INCLUDE_DIRECTORIES>
+INCLUDES2:$<TARGET_PROPERTY:consumer2,INCLUDE_DIRECTORIES>
+DEFINITIONS1:$<TARGET_PROPERTY:consumer1,COMPILE_DEFINITIONS>
+DEFINITIONS2:$<TARGET_PROPERTY:consumer2,COMPILE_DEFINITIONS>
+")
@@ -0,0 +1,20 @@
+file(READ "${RunCMake_TEST_BINARY_DIR}/out.txt" content)
+
+unset(RunCMake_TEST_FAILED)
+
+if (NOT content MATCHES "INCLUDES1:([^\n]*)\n" OR
+    NOT CMAKE_MATCH_1 STREQUAL "/include/left;/include/base;/include/right")
+  string(APPEND RunCMake_TEST_FAILED "wrong content for INCLUDES1: \"${CMAKE_MATCH_1}\"\n")
+endif()
+if (NOT content MATCHES "INCLUDES2:([^\n]*)\n" OR
+    NOT CMAKE_MATCH_1 STREQUAL "/include/right;/include/base;/include/left")
+  string(APPEND RunCMake_TEST_FAILED "wrong content for INCLUDES2: \"${CMAKE_MATCH_1}\"\n")
+endif()
+if (NOT content MATCHES "DEFINITIONS1:([^\n]*)\n" OR
+    NOT CMAKE_MATCH_1 STREQUAL "BASE;RIGHT_FOR_consumer1")
+  string(APPEND RunCMake_TEST_FAILED "wrong content for DEFINITIONS1: \"${CMAKE_MATCH_1}\"\n")
+endif()
+if (NOT content MATCHES "DEFINITIONS2:([^\n]*)\n" OR
+    NOT CMAKE_MATCH_1 STREQUAL "RIGHT_FOR_consumer2;BASE")
+  string(APPEND RunCMake_TEST_FAILED "wrong content for DEFINITIONS2: \"${CMAKE_MATCH_1}\"\n")
+endif()
@@ -0,0 +1,32 @@
+cmake_minimum_required(VERSION 3.14)
+enable_language(C)
+
+# Static libraries sharing dependencies, whose transitive usage
+# requirements are evaluated once and reused by the later consumers.
+add_library(base STATIC empty.c)
+target_include_directories(base PUBLIC /include/base)
+target_compile_definitions(base PUBLIC BASE)
+
+add_library(left STATIC empty.c)
+target_include_directories(left PUBLIC /include/left)
+target_link_libraries(left PUBLIC base)
+
+add_library(right STATIC empty.c)
+target_include_directories(right PUBLIC /include/right)
+target_compile_definitions(right PUBLIC RIGHT_FOR_$<TARGET_PROPERTY:NAME>)
+target_link_libraries(right PUBLIC base)
+
+add_library(top STATIC empty.c)
+target_link_libraries(top PUBLIC left right)
+
+add_library(consumer1 STATIC empty.c)
+target_link_libraries(consumer1 PRIVATE top)
+
+add_library(consumer2 STATIC empty.c)
+target_link_libraries(consumer2 PRIVATE right top)
+
+file(GENERATE OUTPUT out.txt CONTENT "INCLUDES1:$<TARGET_PROPERTY:consumer1,INCLUDE_DIRECTORIES>
+INCLUDES2:$<TARGET_PROPERTY:consumer2,INCLUDE_DIRECTORIES>
+DEFINITIONS1:$<TARGET_PROPERTY:consumer1,COMPILE_DEFINITIONS>
+DEFINITIONS2:$<TARGET_PROPERTY:consumer2,COMPILE_DEFINITIONS>
+")
@@ -74,6 +74,24 @@ run_cmake_with_options(CustomCommandDepfile -DCMAKE_BUILD_TYPE=Debug)
 run_cmake(CustomCommandJobPool)
 run_cmake(JobPoolUsesTerminal)
 
+function(run_SubninjaPerDirectory)
+  set(RunCMake_TEST_BINARY_DIR ${RunCMake_BINARY_DIR}/SubninjaPerDirectory-build)
+  set(RunCMake_TEST_OPTIONS -DSubninjaPerDirectory_B=1)
+  run_cmake(SubninjaPerDirectory)
+  unset(RunCMake_TEST_OPTIONS)
+  set(RunCMake_TEST_NO_CLEAN 1)
+  run_cmake_command(SubninjaPerDirectory-build ${CMAKE_COMMAND} --build .)
+  foreach(dir IN ITEMS a b)
+    file(TIMESTAMP
+      "${RunCMake_TEST_BINARY_DIR}/SubninjaPerDirectory/${dir}/CMakeFiles/directory.ninja"
+      ${dir}_before "%s")
+  endforeach()
+  execute_process(COMMAND ${CMAKE_COMMAND} -E sleep 1.25) # handle 1s resolution
+  run_cmake_command(SubninjaPerDirectory-reconfigure
+    ${CMAKE_COMMAND} -DSubninjaPerDirectory_B=2 .)
+endfunction()
+run_SubninjaPerDirectory()
+
 run_cmake(RspFileC)
 run_cmake(RspFileCXX)
 if(TEST_Fortran)
@@ -0,0 +1,18 @@
+file(READ "${RunCMake_TEST_BINARY_DIR}/build.ninja" build)
+foreach(dir IN ITEMS "" "SubninjaPerDirectory/a/" "SubninjaPerDirectory/b/")
+  if(NOT build MATCHES "\nsubninja ${dir}CMakeFiles/directory\\.ninja\n")
+    string(APPEND RunCMake_TEST_FAILED
+      "build.ninja does not include ${dir}CMakeFiles/directory.ninja.\n")
+  endif()
+endforeach()
+if(build MATCHES "\nbuild [^\n]*dep\\.c\\.o")
+  string(APPEND RunCMake_TEST_FAILED
+    "build.ninja contains the build statements of a directory.\n")
+endif()
+
+file(READ "${RunCMake_TEST_BINARY_DIR}/SubninjaPerDirectory/a/CMakeFiles/directory.ninja" a)
+if(NOT a MATCHES "\nbuild SubninjaPerDirectory/a/CMakeFiles/a\\.dir/")
+  string(APPEND RunCMake_TEST_FAILED
+    "SubninjaPerDirectory/a/CMakeFiles/directory.ninja does not contain the "
+    "build statements of target a.\n")
+endif()
@@ -0,0 +1,13 @@
+foreach(dir IN ITEMS a b)
+  file(TIMESTAMP
+    "${RunCMake_TEST_BINARY_DIR}/SubninjaPerDirectory/${dir}/CMakeFiles/directory.ninja"
+    ${dir}_after "%s")
+endforeach()
+if(NOT a_after STREQUAL a_before)
+  string(APPEND RunCMake_TEST_FAILED
+    "The unchanged file of directory a was rewritten.\n")
+endif()
+if(b_after STREQUAL b_before)
+  string(APPEND RunCMake_TEST_FAILED
+    "The changed file of directory b was not rewritten.\n")
+endif()
@@ -0,0 +1,7 @@
+enable_language(C)
+
+set(CMAKE_NINJA_SUBNINJA_PER_DIRECTORY ON)
+
+add_library(top STATIC dep.c)
+add_subdirectory(SubninjaPerDirectory/a)
+add_subdirectory(SubninjaPerDirectory/b)
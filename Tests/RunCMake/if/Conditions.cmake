@@ -0,0 +1,199 @@
+cmake_minimum_required(VERSION 3.22)
+
+# Evaluates each condition with if(), elseif() and while() in its own
+# script, with the policies conditions depend on set to ${policy} (WARN
+# leaves them unset), and compares a summary of the results and of the
+# diagnostics, in order, with Conditions-${policy}.txt.
+
+set(conditions
+  [[TRUE]]
+  [[FALSE]]
+  [[]]
+  [[NOT]]
+  [[NOT NOT]]
+  [[x]]
+  [["x"]]
+  [[NOT x]]
+  [[x AND y]]
+  [[x OR y]]
+  [[NOT x AND y]]
+  [[x AND NOT y OR z]]
+  [[( x )]]
+  [[(x AND (y OR NOT z))]]
+  [[((x))]]
+  [[()]]
+  [[( )]]
+  [[(]]
+  [[)]]
+  [[( x]]
+  [[x )]]
+  [[( ( x ) ]]
+  [[x ( y ) z]]
+  [["AND"]]
+  [[x "AND" y]]
+  [["NOT" x]]
+  [["(" x ")"]]
+  [[x STREQUAL "x"]]
+  [["x" STREQUAL "1"]]
+  [[x "STREQUAL" y]]
+  [[1 STREQUAL 1]]
+  [[v MATCHES "^a(b)c$"]]
+  [[v MATCHES]]
+  [[MATCHES]]
+  [[MATCHES x]]
+  [[v MATCHES "("]]
+  [["v" MATCHES "a"]]
+  [[CMAKE_MATCH_1 MATCHES "b"]]
+  [[(v MATCHES "(x)") OR (v MATCHES "(a)")]]
+  [[( v MATCHES "(" ) OR TRUE]]
+  [[x LESS 3]]
+  [[n GREATER 2]]
+  [[n EQUAL 5]]
+  [[2.5 LESS_EQUAL 2.5]]
+  [[a LESS b]]
+  [[ver VERSION_LESS 1.10]]
+  [[ver VERSION_GREATER_EQUAL "1.2.3"]]
+  [[a STRLESS b]]
+  [[y STRGREATER_EQUAL x]]
+  [[a IN_LIST lst]]
+  [[c IN_LIST lst]]
+  [[q IN_LIST nolist]]
+  [[DEFINED x]]
+  [[DEFINED nope]]
+  [[DEFINED ENV{PATH}]]
+  [[DEFINED ENV{NOPE_ZZ}]]
+  [[DEFINED CACHE{cv}]]
+  [[DEFINED "x"]]
+  [[NOT DEFINED x]]
+  [[EXISTS ${CMAKE_CURRENT_LIST_DIR}]]
+  [[IS_DIRECTORY ${CMAKE_CURRENT_LIST_DIR}]]
+  [[IS_ABSOLUTE ${CMAKE_CURRENT_LIST_DIR}]]
+  [[IS_ABSOLUTE rel]]
+  [[IS_SYMLINK ${CMAKE_CURRENT_LIST_DIR}]]
+  [[COMMAND message]]
+  [[COMMAND nope]]
+  [[POLICY CMP0054]]
+  [[TARGET t]]
+  [[TEST t]]
+  [[${CMAKE_CURRENT_LIST_DIR} IS_NEWER_THAN ${CMAKE_CURRENT_LIST_DIR}/nonexistent]]
+  [[TEST]]
+  [[x TEST]]
+  [[EXISTS]]
+  [[NOT EXISTS ${CMAKE_CURRENT_LIST_DIR}/nonexistent AND x]]
+  [[2]]
+  [[0]]
+  [[ON]]
+  [[OFF-NOTFOUND]]
+  [[yes]]
+  [["1"]]
+  [[1]]
+  [[one]]
+  [[x AND]]
+  [[AND x]]
+  [[x y]]
+  [[NOT (x STREQUAL y) AND (n GREATER 3 OR ver VERSION_EQUAL 1.2)]]
+  [[x STREQUAL y STREQUAL 0]]
+  [[NOT MATCHES x]]
+  [[x MATCHES MATCHES]]
+  [[( x ) ( y )]]
+  [[x OR y AND z]]
+  [["1" AND "0"]]
+  [["0" OR "ON"]]
+  [[one STREQUAL "1"]]
+  [[EQUAL EQUAL EQUAL]]
+  )
+
+set(variables [[
+set(x 1)
+set(y 0)
+set(z ON)
+set(v abc)
+set(n 5)
+set(ver 1.2)
+set(lst "a;b")
+set(1 "one-var")
+set(one 1)
+set(AND 0)
+set(cv 1 CACHE STRING "")
+set(CMAKE_MATCH_1 b)
+set(CMAKE_MATCH_COUNT 1)
+]])
+
+set(policy_settings "")
+if(NOT policy STREQUAL "WARN")
+  foreach(p CMP0012 CMP0054 CMP0057 CMP0064)
+    string(APPEND policy_settings "cmake_policy(SET ${p} ${policy})\n")
+  endforeach()
+endif()
+
+set(summary "")
+foreach(condition IN LISTS conditions)
+  file(WRITE "${CMAKE_CURRENT_BINARY_DIR}/condition.cmake" "${policy_settings}${variables}if(${condition})
+  message(\"T\")
+elseif(${condition})
+  message(\"E\")
+else()
+  message(\"F\")
+endif()
+message(\"[\${CMAKE_MATCH_0}][\${CMAKE_MATCH_1}][\${CMAKE_MATCH_COUNT}]\")
+set(i 0)
+while(NOT i EQUAL 2 AND (${condition}))
+  math(EXPR i \"\${i}+1\")
+endwhile()
+message(\"w\${i}\")
+")
+  execute_process(COMMAND ${CMAKE_COMMAND} -P condition.cmake
+    WORKING_DIRECTORY "${CMAKE_CURRENT_BINARY_DIR}"
+    OUTPUT_VARIABLE output
+    ERROR_VARIABLE output
+    )
+
+  # Keep the results, and the kind, line, command and reason of each
+  # diagnostic.
+  # List elements may not hold '[' or ']'.
+  string(REPLACE ";" "<semicolon>" output "${output}")
+  string(REPLACE "[" "<lb>" output "${output}")
+  string(REPLACE "]" "<rb>" output "${output}")
+  string(REPLACE "\n" ";" lines "${output}")
+  set(results "")
+  set(block "")
+  set(text "")
+  foreach(line IN LISTS lines ITEMS "CMake End:")
+    set(header "")
+    set(result "")
+    if(line MATCHES "^CMake ([A-Za-z]+)[^:]*:([0-9]*) ?(\\([a-z_]*\\))?")
+      set(header "${CMAKE_MATCH_1}${CMAKE_MATCH_2}${CMAKE_MATCH_3}")
+    elseif(line MATCHES "^(T|E|F|w[0-9]+|<lb>.*<rb><lb>.*<rb><lb>.*<rb>)$")
+      set(result " ${line}")
+    else()
+      string(APPEND text " ${line}")
+      continue()
+    endif()
+
+    # A diagnostic ends with the next diagnostic or result.
+    if(block AND NOT block MATCHES "^Deprecation")
+      string(REGEX REPLACE "[ ]+" " " text "${text}")
+      if(text MATCHES "Policy (CMP[0-9]+)")
+        string(APPEND block " ${CMAKE_MATCH_1}")
+      elseif(text MATCHES "(Unknown arguments specified|mismatched parenthesis|cannot compile|Parse error)")
+        string(APPEND block " ${CMAKE_MATCH_1}")
+      endif()
+      string(APPEND results " <${block}>")
+    endif()
+    set(block "${header}")
+    set(text "")
+    string(APPEND results "${result}")
+  endforeach()
+  string(REPLACE "<semicolon>" ";" results "${results}")
+  string(REPLACE "<lb>" "[" results "${results}")
+  string(REPLACE "<rb>" "]" results "${results}")
+  string(APPEND summary "${condition} =>${results}\n")
+endforeach()
+
+file(WRITE "${CMAKE_CURRENT_BINARY_DIR}/Conditions-${policy}.txt" "${summary}")
+file(READ "${CMAKE_CURRENT_LIST_DIR}/Conditions-${policy}.txt" expected)
+string(REPLACE "\r\n" "\n" expected "${expected}")
+if(NOT summary STREQUAL expected)
+  message(SEND_ERROR "Summary differs from Conditions-${policy}.txt:\n"
+    "  ${CMAKE_CURRENT_BINARY_DIR}/Conditions-${policy}.txt")
+endif()
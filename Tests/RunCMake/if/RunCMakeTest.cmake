@@ -17,3 +17,8 @@ run_cmake(IncompleteMatchesFail)
 
 run_cmake(TestNameThatExists)
 run_cmake(TestNameThatDoesNotExist)
+
+foreach(policy WARN OLD NEW)
+  run_cmake_command(Conditions-${policy}
+    ${CMAKE_COMMAND} -Dpolicy=${policy} -P ${RunCMake_SOURCE_DIR}/Conditions.cmake)
+endforeach()
@@ -0,0 +1,67 @@
+list(APPEND test)
+if(test)
+    message(FATAL_ERROR "failed")
+endif()
+
+list(APPEND test satu)
+if(NOT test STREQUAL "satu")
+    message(FATAL_ERROR "failed")
+endif()
+
+list(APPEND test dua)
+list(GET test 1 item)
+if(NOT test STREQUAL "satu;dua" OR NOT item STREQUAL "dua")
+    message(FATAL_ERROR "failed")
+endif()
+
+list(APPEND test "" tiga)
+list(LENGTH test length)
+if(NOT test STREQUAL "satu;dua;;tiga" OR NOT length EQUAL 4)
+    message(FATAL_ERROR "failed")
+endif()
+
+# Scope test
+function(foo)
+    list(APPEND test empat)
+    list(LENGTH test length)
+    if(NOT test STREQUAL "satu;dua;;tiga;empat" OR NOT length EQUAL 5)
+        message(FATAL_ERROR "failed")
+    endif()
+    set(test "${test}" PARENT_SCOPE)
+    list(APPEND test lima)
+    if(NOT test STREQUAL "satu;dua;;tiga;empat;lima")
+        message(FATAL_ERROR "failed")
+    endif()
+endfunction()
+
+foo()
+
+list(LENGTH test length)
+if(NOT test STREQUAL "satu;dua;;tiga;empat" OR NOT length EQUAL 5)
+    message(FATAL_ERROR "failed")
+endif()
+
+# Split test
+set(split a)
+list(LENGTH split length)
+list(APPEND split "b\\")
+list(LENGTH split length)
+list(APPEND split c "[d")
+list(LENGTH split length)
+list(APPEND split "e]")
+list(LENGTH split length)
+list(GET split 1 item)
+if(NOT length EQUAL 3 OR NOT item STREQUAL "b;c")
+    message(FATAL_ERROR "failed")
+endif()
+
+# Cache entry test
+set(cached "satu;dua" CACHE STRING "")
+list(APPEND cached tiga)
+if(NOT cached STREQUAL "satu;dua;tiga")
+    message(FATAL_ERROR "failed")
+endif()
+unset(cached)
+if(NOT cached STREQUAL "satu;dua")
+    message(FATAL_ERROR "failed")
+endif()
@@ -102,6 +102,9 @@ run_cmake(SORT-NoCaseOption)
 # Successful tests
 run_cmake(SORT)
 
+# Successful tests
+run_cmake(APPEND)
+
 # argument tests
 run_cmake(PREPEND-NoArgs)
 # Successful tests
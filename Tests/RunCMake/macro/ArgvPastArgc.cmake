@@ -0,0 +1,26 @@
+cmake_minimum_required(VERSION 3.22)
+include(${CMAKE_CURRENT_LIST_DIR}/CheckValue.cmake)
+
+set(ARGV1 outer)
+set(ARGV01 outer-01)
+
+macro(past a)
+  set(argv0 "${ARGV0}")
+  set(argv1 "${ARGV1}")
+  set(argv01 "${ARGV01}")
+  set(argv00 "${ARGV00}")
+  set(argv10 "${ARGV10}")
+endmacro()
+
+# ARGV<n> past ARGC is not replaced and reads the variable
+past(first)
+check_value("\${ARGV0}" "${argv0}" "first")
+check_value("\${ARGV1}" "${argv1}" "outer")
+check_value("\${ARGV01}" "${argv01}" "outer-01")
+check_value("\${ARGV00}" "${argv00}" "")
+check_value("\${ARGV10}" "${argv10}" "")
+
+past(first second)
+check_value("\${ARGV1}" "${argv1}" "second")
+check_value("\${ARGV01}" "${argv01}" "outer-01")
+check_value("\${ARGV10}" "${argv10}" "")
@@ -0,0 +1,17 @@
+cmake_minimum_required(VERSION 3.22)
+include(${CMAKE_CURRENT_LIST_DIR}/CheckValue.cmake)
+
+set(b outer)
+
+macro(bracket a)
+  set(unreplaced [[${a} ${ARGV}]])
+  set(a_value "${a}")
+endmacro()
+
+# References within bracket arguments of the body are not replaced
+bracket([[${b} ${a} ;x]])
+check_value("bracket body" "${unreplaced}" "\${a} \${ARGV}")
+check_value("\${a}" "${a_value}" "outer  ;x")
+
+bracket([=[value]=])
+check_value("\${a}" "${a_value}" "value")
@@ -0,0 +1,5 @@
+function(check_value name actual expected)
+  if(NOT "${actual}" STREQUAL "${expected}")
+    message(SEND_ERROR "${name}:\n  actual:   [${actual}]\n  expected: [${expected}]")
+  endif()
+endfunction()
@@ -0,0 +1,24 @@
+cmake_minimum_required(VERSION 3.22)
+include(${CMAKE_CURRENT_LIST_DIR}/CheckValue.cmake)
+
+macro(formal_argn ARGN)
+  set(argn "${ARGN}")
+  set(argc "${ARGC}")
+  set(argv "${ARGV}")
+endmacro()
+formal_argn(a b c)
+check_value("\${ARGN}" "${argn}" "a")
+check_value("\${ARGC}" "${argc}" "3")
+check_value("\${ARGV}" "${argv}" "a;b;c")
+
+macro(formal_argv0 ARGV0 b)
+  set(argv0 "${ARGV0}")
+  set(b_value "${b}")
+  set(argv1 "${ARGV1}")
+  set(argn "${ARGN}")
+endmacro()
+formal_argv0(x y z)
+check_value("\${ARGV0}" "${argv0}" "x")
+check_value("\${b}" "${b_value}" "y")
+check_value("\${ARGV1}" "${argv1}" "y")
+check_value("\${ARGN}" "${argn}" "z")
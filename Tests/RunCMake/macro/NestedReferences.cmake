@@ -0,0 +1,20 @@
+cmake_minimum_required(VERSION 3.22)
+include(${CMAKE_CURRENT_LIST_DIR}/CheckValue.cmake)
+
+set(n 1)
+set(x n)
+set(ARGV1 outer)
+
+macro(nested a b)
+  set(name_of_name "${${x}}")
+  set(argv_of_n "${ARGV${n}}")
+  set(argv_of_argc "${ARGV${ARGC}}")
+  set(name_of_a "${${a}}")
+endmacro()
+nested(x second)
+
+check_value("\${\${x}}" "${name_of_name}" "1")
+# ARGV${n} is not a reference to a macro argument, it reads the variable
+check_value("\${ARGV\${n}}" "${argv_of_n}" "outer")
+check_value("\${ARGV\${ARGC}}" "${argv_of_argc}" "")
+check_value("\${\${a}}" "${name_of_a}" "n")
@@ -0,0 +1,7 @@
+include(RunCMake)
+
+run_cmake_script(NestedReferences)
+run_cmake_script(ArgvPastArgc)
+run_cmake_script(FormalArgumentNames)
+run_cmake_script(SpecialCharacters)
+run_cmake_script(BracketArguments)
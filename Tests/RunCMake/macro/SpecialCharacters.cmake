@@ -0,0 +1,29 @@
+cmake_minimum_required(VERSION 3.22)
+include(${CMAKE_CURRENT_LIST_DIR}/CheckValue.cmake)
+
+set(b outer)
+
+macro(special a b)
+  set(a_value "${a}")
+  set(b_value "${b}")
+  set(argn "${ARGN}")
+  set(argv "${ARGV}")
+endmacro()
+
+# A replaced value may form a new reference, which is then evaluated
+special("\${b}" "{" "}" "$")
+check_value("\${a}" "${a_value}" "{")
+check_value("\${b}" "${b_value}" "{")
+check_value("\${ARGN}" "${argn}" "};$")
+check_value("\${ARGV}" "${argv}" "outer;{;};$")
+
+special("\${a}" "\${ARGN}")
+check_value("\${a}" "${a_value}" "")
+check_value("\${b}" "${b_value}" "")
+check_value("\${ARGN}" "${argn}" "")
+check_value("\${ARGV}" "${argv}" ";")
+
+special("x}" "{y")
+check_value("\${a}" "${a_value}" "x}")
+check_value("\${b}" "${b_value}" "{y")
+check_value("\${ARGV}" "${argv}" "x};{y")
@@ -0,0 +1,48 @@
+set(TOP "top")
+set(UNSET_LATER "top")
+
+macro(check var expected)
+  if(NOT "${${var}}" STREQUAL "${expected}")
+    message(FATAL_ERROR
+      "${var} should be \"${expected}\" in ${CMAKE_CURRENT_FUNCTION}, "
+      "not \"${${var}}\"")
+  endif()
+endmacro()
+
+function(_raise_from_inner)
+  set(TOP "inner" PARENT_SCOPE)
+  unset(UNSET_LATER PARENT_SCOPE)
+endfunction()
+
+function(_inner)
+  foreach(i RANGE 3)
+    check(TOP "top")
+    check(UNSET_LATER "top")
+    if(DEFINED MISSING)
+      message(FATAL_ERROR "MISSING defined in _inner")
+    endif()
+  endforeach()
+  _raise_from_inner()
+  check(TOP "inner")
+  check(UNSET_LATER "")
+  set(MISSING "inner" PARENT_SCOPE)
+endfunction()
+
+function(_middle)
+  _inner()
+  check(TOP "top")
+  check(MISSING "inner")
+endfunction()
+
+function(_outer)
+  check(TOP "top")
+  _middle()
+  check(TOP "top")
+  if(DEFINED MISSING)
+    message(FATAL_ERROR "MISSING defined in _outer")
+  endif()
+endfunction()
+
+_outer()
+check(TOP "top")
+check(UNSET_LATER "top")
@@ -48,7 +48,10 @@ if (NOT CMAKE_C_COMPILER_ID STREQUAL "Intel")
   run_cmake_target(genex_LINK_LANG_AND_ID mod LinkOptions_mod --config Release)
   run_cmake_target(genex_LINK_LANG_AND_ID exe LinkOptions_exe --config Release)
 
+  # Check that transitive options are not reused between link steps.
+  set(ENV{CMAKE_VERIFY_USAGE_REQUIREMENTS_CACHE} 1)
   run_cmake(genex_DEVICE_LINK)
+  unset(ENV{CMAKE_VERIFY_USAGE_REQUIREMENTS_CACHE})
 
   run_cmake_target(genex_DEVICE_LINK interface LinkOptions_shared_interface --config Release)
   run_cmake_target(genex_DEVICE_LINK private LinkOptions_private --config Release)
@@ -59,6 +62,7 @@ if (NOT CMAKE_C_COMPILER_ID STREQUAL "Intel")
       run_cmake_target(genex_DEVICE_LINK CMP0105_OLD LinkOptions_CMP0105_OLD --config Release)
       run_cmake_target(genex_DEVICE_LINK CMP0105_NEW LinkOptions_CMP0105_NEW --config Release)
       run_cmake_target(genex_DEVICE_LINK device LinkOptions_device --config Release)
+      run_cmake_target(genex_DEVICE_LINK transitive LinkOptions_transitive --config Release)
 
       if (RunCMake_GENERATOR MATCHES "(Ninja|Unix Makefiles)")
         run_cmake_target(genex_DEVICE_LINK host_link_options LinkOptions_host_link_options --config Release ${VERBOSE})
@@ -51,6 +51,13 @@ if (CMake_TEST_CUDA)
     add_executable(LinkOptions_host_link_options LinkOptionsDevice.cu)
     set_property(TARGET LinkOptions_host_link_options PROPERTY CUDA_SEPARABLE_COMPILATION ON)
     target_link_options(LinkOptions_host_link_options PRIVATE -Wl,OPT1 -Xlinker=OPT2 "SHELL:-Xlinker OPT3" "SHELL:LINKER:OPT4 LINKER:OPT5")
+
+    # The host and device link steps must not share the transitive options.
+    add_library(LinkOptions_transitive_interface INTERFACE)
+    target_link_libraries(LinkOptions_transitive_interface INTERFACE LinkOptions_interface)
+    add_executable(LinkOptions_transitive LinkOptionsDevice.cu)
+    set_property(TARGET LinkOptions_transitive PROPERTY CUDA_SEPARABLE_COMPILATION ON)
+    target_link_libraries(LinkOptions_transitive PRIVATE LinkOptions_transitive_interface)
   endif()
 
   add_executable(LinkOptions_no_device LinkOptionsDevice.cu)